@@ -9,6 +9,7 @@
 
 class Matrix4;
 class Plane3;
+class IBrush;
 
 const std::string RKEY_ENABLE_TEXTURE_LOCK("user/ui/brush/textureLock");
 
@@ -17,6 +18,20 @@ class BrushCreator :
 {
 public:
 	virtual scene::INodePtr createBrush() = 0;
+
+	/**
+	 * Builds the B-Reps of all brushes changed since the last call, using
+	 * the worker threads. This is called before rendering the scene.
+	 */
+	virtual void evaluateChangedBReps() = 0;
+
+	/**
+	 * Builds the B-Reps of the given brushes, using the worker threads.
+	 * The brushes must not be inserted in the scene yet.
+	 *
+	 * @throws: std::runtime_error if the B-Rep of a brush can't be built.
+	 */
+	virtual void evaluateBReps(const std::vector<IBrush*>& brushes) = 0;
 };
 
 // The structure defining a single corner point of an IWinding
@@ -139,6 +154,14 @@ public:
 	 */
 	virtual void updateFaceVisibility() = 0;
 
+	/**
+	 * Builds the face windings and the B-Rep of this brush, if it has been
+	 * invalidated since the last call. This touches no state outside this
+	 * brush, so different brushes can be evaluated on different threads,
+	 * as long as they are not inserted in the scene yet.
+	 */
+	virtual void evaluateBRep() const = 0;
+
 	// Saves the current state to the undo stack.
 	// Call this before manipulating the brush to make your action undo-able.
 	virtual void undoSave() = 0;
@@ -177,6 +177,21 @@ public:
       inherited(false)
     {}
 
+    /**
+     * Construct a non-inherited EntityClassAttribute referring to the given
+     * (possibly shared) strings.
+     */
+    EntityClassAttribute(const StringPtr& typeRef_,
+                         const StringPtr& nameRef_,
+                         const StringPtr& valueRef_,
+                         const StringPtr& descRef_)
+    : _typeRef(typeRef_),
+      _nameRef(nameRef_),
+      _valueRef(valueRef_),
+      _descRef(descRef_),
+      inherited(false)
+    {}
+
     /**
      * Construct a inherited EntityClassAttribute with a true inherited flag.
      * The strings are taken from the inherited attribute.
@@ -271,9 +286,9 @@ public:
      *
      * @return
      * A reference to the named EntityClassAttribute. If the named attribute is
-     * not found, an empty EntityClassAttribute is returned.
+     * not found, an empty EntityClassAttribute is returned. Inherited attributes
+     * are owned by the ancestor defining them, hence the reference is const.
      */
-    virtual EntityClassAttribute& getAttribute(const std::string& name) = 0;
     virtual const EntityClassAttribute& getAttribute(const std::string& name) const = 0;
 
     /**
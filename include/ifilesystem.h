@@ -98,6 +98,17 @@ public:
 		 * down. An empty default implementation is provided.
 		 */
 		virtual void onFileSystemShutdown() {}
+
+		/**
+		 * Notification of changes to the files in the loose directories of
+		 * the VFS, which have been modified, added or removed on disk while
+		 * the VFS is initialised. The changes are collected for a moment and
+		 * passed in one batch, the filenames are VFS paths.
+		 *
+		 * This method is invoked on the main thread. An empty default
+		 * implementation is provided.
+		 */
+		virtual void onFilesChanged(const StringSet& filenames) {}
 	};
 
 	/// \brief Adds a root search \p path.
@@ -146,6 +157,10 @@ public:
 	/// \brief Returns the absolute filename for a relative \p name, or "" if not found.
 	virtual std::string findFile(const std::string& name) = 0;
 
+	/// \brief Returns the absolute path of the file on disk providing \p filename, which is
+	/// either the loose file or the pak file containing it, or "" if not found.
+	virtual std::string findPhysicalFile(const std::string& filename) = 0;
+
 	/// \brief Returns the filesystem root for an absolute \p name, or "" if not found.
 	/// This can be used to convert an absolute name to a relative name.
 	virtual std::string findRoot(const std::string& name) = 0;
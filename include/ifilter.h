@@ -175,6 +175,13 @@ public:
 	 */
 	virtual bool isEntityVisible(const FilterRule::Type type, const Entity& entity) = 0;	
 
+	/**
+	 * Notifies the filter system that a face or patch shader of the given
+	 * brush or patch node has changed. The filter system keeps track of the
+	 * materials in use, to update just the affected nodes on filter toggles.
+	 */
+	virtual void onShaderChanged(const scene::INode& node) = 0;
+
 	// =====  API for Filter management and editing =====
 
 	/**
@@ -2,6 +2,9 @@
 
 #include <set>
 #include <string>
+#include <vector>
+#include <climits>
+#include <algorithm>
 #include "imodule.h"
 
 namespace scene {
@@ -12,6 +15,149 @@ typedef boost::shared_ptr<INode> INodePtr;
 // A list of named layers
 typedef std::set<int> LayerList;
 
+/**
+ * greebo: The layers of a node, stored as one bit per layer ID. Layer IDs
+ * are handed out from 0 upwards, so the first block stored inline covers the
+ * layers of most maps without any allocation. A node is visible if its mask
+ * intersects with the mask of the visible layers.
+ */
+class LayerMask
+{
+	typedef unsigned long Block;
+	static const int BITS_PER_BLOCK = sizeof(Block) * CHAR_BIT;
+
+	Block _first;
+
+	// Blocks for layer IDs beyond the first block, usually empty
+	std::vector<Block> _more;
+
+public:
+	LayerMask() :
+		_first(0)
+	{}
+
+	void set(int layerID)
+	{
+		if (layerID < 0) return;
+
+		std::size_t index = layerID / BITS_PER_BLOCK;
+
+		if (index > _more.size())
+		{
+			_more.resize(index, 0);
+		}
+
+		getBlock(index) |= Block(1) << (layerID % BITS_PER_BLOCK);
+	}
+
+	void reset(int layerID)
+	{
+		if (layerID < 0 || static_cast<std::size_t>(layerID / BITS_PER_BLOCK) > _more.size())
+		{
+			return;
+		}
+
+		getBlock(layerID / BITS_PER_BLOCK) &= ~(Block(1) << (layerID % BITS_PER_BLOCK));
+	}
+
+	bool test(int layerID) const
+	{
+		if (layerID < 0 || static_cast<std::size_t>(layerID / BITS_PER_BLOCK) > _more.size())
+		{
+			return false;
+		}
+
+		return (getBlock(layerID / BITS_PER_BLOCK) & (Block(1) << (layerID % BITS_PER_BLOCK))) != 0;
+	}
+
+	void clear()
+	{
+		_first = 0;
+		_more.clear();
+	}
+
+	// Returns TRUE if no layer is set
+	bool none() const
+	{
+		if (_first != 0) return false;
+
+		for (std::size_t i = 0; i < _more.size(); ++i)
+		{
+			if (_more[i] != 0) return false;
+		}
+
+		return true;
+	}
+
+	// Returns TRUE if both masks have at least one layer in common
+	bool intersects(const LayerMask& other) const
+	{
+		if ((_first & other._first) != 0) return true;
+
+		std::size_t common = std::min(_more.size(), other._more.size());
+
+		for (std::size_t i = 0; i < common; ++i)
+		{
+			if ((_more[i] & other._more[i]) != 0) return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Returns the lowest layer ID in this mask which is equal to or larger
+	 * than <start>, or -1 if there is none. Use this to iterate over the set
+	 * layers: for (int i = mask.findNext(0); i != -1; i = mask.findNext(i+1))
+	 */
+	int findNext(int start) const
+	{
+		int end = static_cast<int>(_more.size() + 1) * BITS_PER_BLOCK;
+
+		for (int layerID = start; layerID < end; ++layerID)
+		{
+			Block block = getBlock(layerID / BITS_PER_BLOCK);
+
+			if (block == 0)
+			{
+				// Skip to the next block
+				layerID += BITS_PER_BLOCK - 1 - layerID % BITS_PER_BLOCK;
+				continue;
+			}
+
+			if ((block & (Block(1) << (layerID % BITS_PER_BLOCK))) != 0)
+			{
+				return layerID;
+			}
+		}
+
+		return -1;
+	}
+
+	// Returns the set layers as LayerList
+	LayerList getLayers() const
+	{
+		LayerList layers;
+
+		for (int i = findNext(0); i != -1; i = findNext(i+1))
+		{
+			layers.insert(i);
+		}
+
+		return layers;
+	}
+
+private:
+	Block& getBlock(std::size_t index)
+	{
+		return index == 0 ? _first : _more[index - 1];
+	}
+
+	Block getBlock(std::size_t index) const
+	{
+		return index == 0 ? _first : _more[index - 1];
+	}
+};
+
 /**
  * greebo: Interface of a Layered object.
  */
@@ -41,6 +187,11 @@ public:
      * Return the set of layers to which this object is assigned.
      */
     virtual LayerList getLayers() const = 0;
+
+	/**
+	 * Return the layers of this object as bitmask, this doesn't copy anything.
+	 */
+	virtual const LayerMask& getLayerMask() const = 0;
 };
 
 class ILayerSystem :
@@ -146,6 +146,18 @@ public:
 	 * throws: FailureException on any error.
 	 */
 	virtual void readFromStream(std::istream& stream) = 0;
+
+	/**
+	 * Like readFromStream(), for a stream which has been opened from the given
+	 * map file. Readers can use the filename to maintain additional files next
+	 * to the map, like a cache. The default implementation just reads the stream.
+	 *
+	 * throws: FailureException on any error.
+	 */
+	virtual void readFromFile(std::istream& stream, const std::string& filename)
+	{
+		readFromStream(stream);
+	}
 };
 
 class IMapImportFilter
@@ -86,6 +86,14 @@ public:
 	 * Returns the float values of the given frame index.
 	 */
 	virtual const FrameKeys& getFrameKeys(std::size_t index) const = 0;
+
+	/**
+	 * Returns the position and orientation of the given joint in the given
+	 * frame, relative to its parent joint. This is the base frame key with
+	 * the frame's values applied, bounds are [0..getNumFrames()) and
+	 * [0..getNumJoints()).
+	 */
+	virtual const Key& getFrameKey(std::size_t frame, std::size_t jointNum) const = 0;
 };
 typedef boost::shared_ptr<IMD5Anim> IMD5AnimPtr;
 
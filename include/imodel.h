@@ -128,6 +128,25 @@ public:
 };
 typedef boost::shared_ptr<ModelNode> ModelNodePtr;
 
+/**
+ * A model load split up into two steps: parse() reads and parses the model
+ * file and is called on a worker thread, finish() creates the IModel
+ * (GL resources, shaders) from the parsed data on the main thread.
+ */
+class ModelPreload
+{
+public:
+	virtual ~ModelPreload() {}
+
+	// Reads and parses the model file, this is called on a worker thread
+	virtual void parse() = 0;
+
+	// Constructs the model from the parsed data, this is called on the main thread
+	// after parse() has been finished. Returns NULL if the model could not be loaded.
+	virtual IModelPtr finish() = 0;
+};
+typedef boost::shared_ptr<ModelPreload> ModelPreloadPtr;
+
 } // namespace model
 
 // Utility methods
@@ -163,6 +182,17 @@ public:
 	 *           NULL if the model loader could not load the file.
 	 */
 	virtual model::IModelPtr loadModelFromPath(const std::string& path) = 0;
+
+	/**
+	 * Prepares the model at the given VFS path for loading in the background.
+	 * The file is opened right away, the returned object can then be handed
+	 * to a worker thread for parsing.
+	 *
+	 * @returns: the preload object or NULL if the file can't be opened or this
+	 *           loader doesn't support background loading, use loadModelFromPath()
+	 *           in that case.
+	 */
+	virtual model::ModelPreloadPtr preloadModelFromPath(const std::string& path) = 0;
 };
 typedef boost::shared_ptr<ModelLoader> ModelLoaderPtr;
 
@@ -25,6 +25,19 @@ public:
 	 */
 	virtual scene::INodePtr getModelNode(const std::string& modelPath) = 0;
 
+	/**
+	 * Like getModelNode(), but doesn't block if the model has to be loaded
+	 * from disk first. In that case the model file is parsed on a worker
+	 * thread and a placeholder box is returned. Once the model is ready,
+	 * the entities the placeholders are attached to get their model refreshed,
+	 * which happens on the main thread.
+	 *
+	 * Models which can't be loaded in the background are loaded right away.
+	 *
+	 * @returns: a valid scene::INodePtr, which is never NULL.
+	 */
+	virtual scene::INodePtr getModelNodeAsync(const std::string& modelPath) = 0;
+
 	/**
 	 * greebo: Get the IModel object for the given VFS path. The request is cached,
 	 *         so calling this with the same path twice will return the same
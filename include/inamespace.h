@@ -93,6 +93,18 @@ public:
      * namespace.
 	 */
 	virtual void ensureNoConflicts(const scene::INodePtr& root) = 0;
+
+	/**
+	 * \brief
+	 * Moves the given scene graph into this namespace, renaming the nodes
+	 * which conflict with the names in this namespace.
+	 *
+	 * This does the same as ensureNoConflicts() followed by connect(), but the
+	 * nodes are moved over directly instead of being disconnected from the
+	 * temporary namespace used for renaming first. Use this when pasting or
+	 * importing large amounts of entities.
+	 */
+	virtual void importNames(const scene::INodePtr& root) = 0;
 };
 typedef boost::shared_ptr<INamespace> INamespacePtr;
 
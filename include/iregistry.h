@@ -63,9 +63,11 @@ public:
 	virtual void exportToFile(const std::string& key, const std::string& filename = "-") = 0;
 
 	// Retrieves the nodelist corresponding for the specified XPath (wraps to xml::Document)
+	// Note: the "value" attributes returned by get() are cached, so these must only be
+	// written through set() or setAttribute(), and nodes only removed through deleteXPath().
 	virtual xml::NodeList findXPath(const std::string& path) = 0;
 
-	// Creates an empty key
+	// Creates an empty key, use setAttribute() to fill in its attributes
 	virtual xml::Node createKey(const std::string& key) = 0;
 
 	// Creates a new node named <key> as children of <path> with the name attribute set to <name>
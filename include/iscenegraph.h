@@ -52,6 +52,9 @@ public:
 
 		// Gets called when <node> is removed from the scenegraph
 		virtual void onSceneNodeErase(const INodePtr& node) {}
+
+		// Gets called when the layers of <node> have been changed
+		virtual void onSceneNodeLayersChanged(const INodePtr& node, const LayerMask& previousLayers) {}
 	};
 
 	// Returns the root-node of the graph.
@@ -84,6 +87,9 @@ public:
 	// A specific node has changed its bounds
 	virtual void nodeBoundsChanged(const scene::INodePtr& node) = 0;
 
+	// A specific node has been added to or removed from layers
+	virtual void nodeLayersChanged(const scene::INodePtr& node, const LayerMask& previousLayers) = 0;
+
 	// A walker class to be used in "foreachNodeInVolume"
 	class Walker
 	{
@@ -84,6 +84,7 @@ public:
 		/** greebo: This gets called upon selection change.
 		 *
 		 * @instance: The instance that got affected (this may also be the parent brush of a FaceInstance).
+		 * This is empty if several nodes have been changed at once (like in an area selection).
 		 * @isComponent: is TRUE if the changed selectable is a component (like a FaceInstance, VertexInstance).
 		 */
 		virtual void selectionChanged(const scene::INodePtr& node, bool isComponent) = 0;
@@ -28,6 +28,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include <ostream>
 #include <vector>
+#include <sigc++/signal.h>
 
 #include "Texture.h"
 #include "ShaderLayer.h"
@@ -397,6 +398,15 @@ public:
   virtual void unrealise() = 0;
   virtual void refresh() = 0;
 
+	/**
+	 * Signal emitted when single materials have been changed without
+	 * unrealising the whole material manager, e.g. after their material file
+	 * or one of their images has been modified on disk. The names of the
+	 * changed materials are passed, anything derived from these (like
+	 * OpenGL shader passes) needs to be rebuilt.
+	 */
+	virtual sigc::signal<void, const StringSet&> signal_materialsReloaded() const = 0;
+
 	/** Determine whether the shader system is realised. This may be used
 	 * by components which need to ensure the shaders are realised before
 	 * they start trying to display them.
@@ -424,6 +434,14 @@ public:
 	 */
 	virtual bool materialExists(const std::string& name) = 0;
 
+	/**
+	 * Parses the definitions of the named materials in advance, spreading
+	 * the work over the worker threads. Call this before a large number of
+	 * materials is requested, e.g. after a map has been loaded. Unknown names
+	 * are ignored.
+	 */
+	virtual void preloadMaterials(const StringSet& names) = 0;
+
 	virtual void foreachShaderName(const ShaderNameCallback& callback) = 0;
 
 	/**
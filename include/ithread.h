@@ -1,6 +1,8 @@
 #pragma once
 
 #include <glibmm.h>
+#include <vector>
+#include <algorithm>
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -17,4 +19,74 @@ public:
 
     /// Execute the given function in a separate thread
     virtual void execute(boost::function<void()> func) const = 0;
+
+    /// A set of jobs to be processed by executeAndWait()
+    typedef std::vector< boost::function<void()> > Jobs;
+
+    /**
+     * \brief
+     * Execute all the given jobs on a set of worker threads and block until
+     * every one of them has finished.
+     *
+     * The jobs are processed in no particular order, so they must not depend
+     * on each other. If a job throws a std::exception, the remaining jobs are
+     * still processed, after which the (first) error message is re-thrown in
+     * the calling thread as std::runtime_error.
+     *
+     * The calling thread takes part in processing the jobs. The worker
+     * threads are kept alive between calls, so this can be used on per-frame
+     * paths, and it may be called from within a job.
+     */
+    virtual void executeAndWait(const Jobs& jobs) const = 0;
+
+    /// Returns the number of worker threads used by executeAndWait()
+    virtual std::size_t getNumWorkers() const = 0;
+
+    /// Function processing the index range [first, last)
+    typedef boost::function<void(std::size_t first, std::size_t last)> RangeFunction;
+
+private:
+    // Job passing a single chunk to a RangeFunction
+    class RangeJob
+    {
+        RangeFunction _func;
+        std::size_t _first;
+        std::size_t _last;
+
+    public:
+        RangeJob(const RangeFunction& func, std::size_t first, std::size_t last) :
+            _func(func),
+            _first(first),
+            _last(last)
+        {}
+
+        void operator()() const
+        {
+            _func(_first, _last);
+        }
+    };
+
+public:
+
+    /**
+     * \brief
+     * Convenience method splitting the index range [0..count) into contiguous
+     * chunks, which are passed to the given function using executeAndWait().
+     * A few more chunks than worker threads are used, to even out the
+     * differing cost of the individual items.
+     */
+    void executeInChunks(std::size_t count, const RangeFunction& func) const
+    {
+        std::size_t numJobs = std::min(count, getNumWorkers() * 4);
+
+        Jobs jobs;
+        jobs.reserve(numJobs);
+
+        for (std::size_t i = 0; i < numJobs; ++i)
+        {
+            jobs.push_back(RangeJob(func, count * i / numJobs, count * (i + 1) / numJobs));
+        }
+
+        executeAndWait(jobs);
+    }
 };
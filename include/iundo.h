@@ -27,6 +27,7 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 
 #include "imodule.h"
 #include <cstddef>
+#include <sigc++/signal.h>
 
 /* greebo: An UndoMemento has to be allocated on the heap
  * and contains all the information that is needed to describe
@@ -110,6 +111,13 @@ public:
 	// it immediately from the stack, therefore it never existed.
 	virtual void cancel() = 0;
 
+	// Returns true while an operation has been started and is not yet
+	// finished or cancelled. All changes in this timespan are recorded into it.
+	virtual bool operationStarted() const = 0;
+
+	// Emitted after the current operation has been finished or cancelled
+	virtual sigc::signal<void> signal_operationFinished() const = 0;
+
 	virtual void trackerAttach(UndoTracker& tracker) = 0;
 	virtual void trackerDetach(UndoTracker& tracker) = 0;
 };
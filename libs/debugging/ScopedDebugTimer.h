@@ -123,4 +123,35 @@ public:
 	}
 };
 
+/**
+ * Measures the wall-clock time since construction (or the last restart()).
+ * Unlike the ScopedDebugTimer this is active in release builds too, it's
+ * meant to be used by the benchmark commands.
+ */
+class StopWatch
+{
+private:
+	timeval _start;
+
+public:
+	StopWatch()
+	{
+		restart();
+	}
+
+	void restart()
+	{
+		gettimeofday(&_start, NULL);
+	}
+
+	// Returns the number of seconds elapsed since the start
+	double getSeconds() const
+	{
+		timeval now;
+		gettimeofday(&now, NULL);
+
+		return now - _start;
+	}
+};
+
 #endif /*SCOPEDDEBUGTIMER_H_*/
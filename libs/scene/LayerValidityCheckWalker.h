@@ -29,15 +29,16 @@ public:
 	// Returns true if the node has been "fixed"
 	static bool ProcessNode(const INodePtr& node)
 	{
-		LayerList list = node->getLayers();
+		// Iterate over a copy, the node's mask changes when removing layers
+		LayerMask layers = node->getLayerMask();
 
 		bool fixed = false;
 
-		for (LayerList::iterator i = list.begin(); i != list.end(); ++i)
+		for (int i = layers.findNext(0); i != -1; i = layers.findNext(i+1))
 		{
-			if (!GlobalLayerSystem().layerExists(*i))
+			if (!GlobalLayerSystem().layerExists(i))
 			{
-				node->removeFromLayer(*i);
+				node->removeFromLayer(i);
 				fixed = true;
 			}
 		}
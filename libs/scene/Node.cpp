@@ -60,7 +60,7 @@ Node::Node() :
 	_instantiated(false)
 {
 	// Each node is part of layer 0 by default
-	_layers.insert(0);
+	_layers.set(0);
 }
 
 Node::Node(const Node& other) :
@@ -130,35 +130,63 @@ bool Node::excluded() const
 
 void Node::addToLayer(int layerId)
 {
-	_layers.insert(layerId);
+	if (_layers.test(layerId)) return;
+
+	LayerMask previousLayers = _layers;
+	_layers.set(layerId);
+
+	layersChanged(previousLayers);
 }
 
 void Node::moveToLayer(int layerId)
 {
+	LayerMask previousLayers = _layers;
+
 	_layers.clear();
-	_layers.insert(layerId);
+	_layers.set(layerId);
+
+	layersChanged(previousLayers);
 }
 
 void Node::removeFromLayer(int layerId)
 {
 	// Look up the layer ID and remove it from the list
-	LayerList::iterator found = _layers.find(layerId);
-
-	if (found != _layers.end()) {
-		_layers.erase(found);
+	if (_layers.test(layerId)) {
+		LayerMask previousLayers = _layers;
+		_layers.reset(layerId);
 
 		// greebo: Make sure that every node is at least member of layer 0
-		if (_layers.empty()) {
-			_layers.insert(0);
+		if (_layers.none()) {
+			_layers.set(0);
 		}
+
+		layersChanged(previousLayers);
 	}
 }
 
 LayerList Node::getLayers() const
+{
+	return _layers.getLayers();
+}
+
+const LayerMask& Node::getLayerMask() const
 {
 	return _layers;
 }
 
+void Node::layersChanged(const LayerMask& previousLayers)
+{
+	// Only nodes in the scene are of interest to the layer system
+	if (!_instantiated) return;
+
+	GraphPtr sceneGraph = _sceneGraph.lock();
+
+	if (sceneGraph)
+	{
+		sceneGraph->nodeLayersChanged(shared_from_this(), previousLayers);
+	}
+}
+
 void Node::addChildNode(const INodePtr& node)
 {
 	// Add the node to the TraversableNodeSet, this triggers an
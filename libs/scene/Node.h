@@ -59,8 +59,8 @@ private:
 	// Is true when the node is part of the scenegraph
 	bool _instantiated;
 
-	// The list of layers this object is associated to
-	LayerList _layers;
+	// The layers this object is associated to
+	LayerMask _layers;
 
 protected:
 	// If this node is attached to a parent entity, this is the reference to it
@@ -99,6 +99,7 @@ public:
     virtual void removeFromLayer(int layerId);
 	virtual void moveToLayer(int layerId);
     virtual LayerList getLayers() const;
+	virtual const LayerMask& getLayerMask() const;
 
 	virtual void addChildNode(const INodePtr& node);
 	virtual void removeChildNode(const INodePtr& node);
@@ -196,6 +197,9 @@ protected:
 	virtual void removeAllChildNodes();
 
 private:
+	// Notifies the scenegraph about changed layer memberships
+	void layersChanged(const LayerMask& previousLayers);
+
 	void evaluateBounds() const;
 	void evaluateChildBounds() const;
 	void evaluateTransform() const;
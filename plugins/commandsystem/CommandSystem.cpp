@@ -108,9 +108,11 @@ void CommandSystem::saveBinds() {
 
 		if (st == NULL || st->isReadonly()) continue; // not a statement or readonly
 
-		xml::Node node = GlobalRegistry().createKeyWithName(RKEY_COMMANDSYSTEM_BINDS, "bind", i->first);
+		GlobalRegistry().createKeyWithName(RKEY_COMMANDSYSTEM_BINDS, "bind", i->first);
 
-		node.setAttributeValue("value", st->getValue());
+		// Values are written through the registry, which caches them
+		GlobalRegistry().setAttribute(RKEY_COMMANDSYSTEM_BINDS + "/bind[@name='" + i->first + "']",
+									  "value", st->getValue());
 	}
 }
 
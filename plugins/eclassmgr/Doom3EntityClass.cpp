@@ -8,9 +8,10 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/erase.hpp>
-#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/make_shared.hpp>
+#include <algorithm>
+#include <set>
 
 namespace eclass
 {
@@ -45,6 +46,82 @@ boost::optional<std::string> suffixedKey(const std::string& key,
     }
 }
 
+typedef boost::shared_ptr<std::string> StringPtr;
+
+// Orders the pooled strings by content
+struct StringPtrLess
+{
+    bool operator()(const StringPtr& lhs, const StringPtr& rhs) const
+    {
+        return *lhs < *rhs;
+    }
+};
+
+typedef std::set<StringPtr, StringPtrLess> StringPool;
+
+// The strings referenced by the attributes of all entity classes
+StringPool& getStringPool()
+{
+    static StringPool _pool;
+    return _pool;
+}
+
+// Returns the pooled instance of the given string
+StringPtr internString(const StringPtr& str)
+{
+    return *getStringPool().insert(str).first;
+}
+
+StringPtr internString(const std::string& str)
+{
+    return internString(boost::make_shared<std::string>(str));
+}
+
+// Compares attributes by name, ignoring case
+struct AttributeNameLess
+{
+    bool operator()(const EntityClassAttribute& lhs, const std::string& rhs) const
+    {
+        return string_compare_nocase(lhs.getName().c_str(), rhs.c_str()) < 0;
+    }
+
+    bool operator()(const std::string& lhs, const EntityClassAttribute& rhs) const
+    {
+        return string_compare_nocase(lhs.c_str(), rhs.getName().c_str()) < 0;
+    }
+
+    bool operator()(const EntityClassAttribute& lhs, const EntityClassAttribute& rhs) const
+    {
+        return string_compare_nocase(lhs.getName().c_str(), rhs.getName().c_str()) < 0;
+    }
+};
+
+struct StringLessNocase
+{
+    bool operator()(const std::string* lhs, const std::string* rhs) const
+    {
+        return string_compare_nocase(lhs->c_str(), rhs->c_str()) < 0;
+    }
+};
+
+// Takes descriptive properties from the other attribute of the same name
+// which are missing on the existing one
+void mergeAttribute(EntityClassAttribute& existing, const EntityClassAttribute& other)
+{
+    if (!other.getDescription().empty() && existing.getDescription().empty())
+    {
+        // Use the shared string reference to save memory
+        existing.setDescription(other.getDescriptionRef());
+    }
+
+    // Check if we have a more descriptive type than "text"
+    if (other.getType() != "text" && existing.getType() == "text")
+    {
+        // Use the shared string reference to save memory
+        existing.setType(other.getTypeRef());
+    }
+}
+
 } // namespace
 
 // Attachment helper object
@@ -324,28 +401,43 @@ const std::string& Doom3EntityClass::getFillShader() const
  */
 void Doom3EntityClass::addAttribute(const EntityClassAttribute& attribute)
 {
-    // Try to insert the class attribute
-    std::pair<EntityAttributeMap::iterator, bool> result = _attributes.insert(
-        EntityAttributeMap::value_type(attribute.getNameRef(), attribute)
+    // Refer to the pooled strings
+    EntityClassAttribute pooled(
+        internString(attribute.getTypeRef()),
+        internString(attribute.getNameRef()),
+        internString(attribute.getValueRef()),
+        internString(attribute.getDescriptionRef())
     );
 
-    if (!result.second)
-    {
-        EntityClassAttribute& existing = result.first->second;
+    Attributes::iterator i = std::lower_bound(
+        _attributes.begin(), _attributes.end(), pooled.getName(), AttributeNameLess()
+    );
 
+    if (i == _attributes.end() || AttributeNameLess()(pooled.getName(), *i))
+    {
+        _attributes.insert(i, pooled);
+    }
+    else
+    {
         // greebo: Attribute already existed, check if we have some
         // descriptive properties to be added to the existing one.
-        if (!attribute.getDescription().empty() && existing.getDescription().empty())
+        mergeAttribute(*i, pooled);
+    }
+}
+
+void Doom3EntityClass::releaseUnusedStrings()
+{
+    StringPool& pool = getStringPool();
+
+    for (StringPool::iterator i = pool.begin(); i != pool.end(); /* in-loop increment */)
+    {
+        if (i->unique())
         {
-            // Use the shared string reference to save memory
-            existing.setDescription(attribute.getDescriptionRef());
+            pool.erase(i++);
         }
-
-        // Check if we have a more descriptive type than "text"
-        if (attribute.getType() != "text" && existing.getType() == "text")
+        else
         {
-            // Use the shared string reference to save memory
-            existing.setType(attribute.getTypeRef());
+            ++i;
         }
     }
 }
@@ -373,24 +465,36 @@ void Doom3EntityClass::forEachClassAttribute(
     boost::function<void(const EntityClassAttribute&)> visitor,
     bool editorKeys) const
 {
-    for (EntityAttributeMap::const_iterator i = _attributes.begin();
-         i != _attributes.end();
-         ++i)
+    // Collect the visible attributes in name order, the first class along
+    // the parent chain defining an attribute overrides its ancestors
+    typedef std::map<const std::string*, const EntityClassAttribute*, StringLessNocase> VisibleAttributes;
+    VisibleAttributes visible;
+
+    for (const Doom3EntityClass* eclass = this; eclass != NULL; eclass = eclass->_parent)
     {
-        // Visit if it is a non-editor key or we are visiting all keys
-        if (editorKeys || !boost::algorithm::istarts_with(*i->first, "editor_"))
+        for (Attributes::const_iterator i = eclass->_attributes.begin();
+             i != eclass->_attributes.end();
+             ++i)
         {
-            visitor(i->second);
+            // Visit if it is a non-editor key or we are visiting all keys
+            if (editorKeys || !boost::algorithm::istarts_with(i->getName(), "editor_"))
+            {
+                visible.insert(VisibleAttributes::value_type(&i->getName(), &(*i)));
+            }
         }
     }
-}
 
-namespace
-{
-    void copyInheritedAttribute(Doom3EntityClass* target,
-                                const EntityClassAttribute& attr)
+    for (VisibleAttributes::const_iterator i = visible.begin(); i != visible.end(); ++i)
     {
-        target->addAttribute(EntityClassAttribute(attr, true));
+        if (findOwnAttribute(*i->first) == i->second)
+        {
+            visitor(*i->second);
+        }
+        else
+        {
+            // Attributes owned by the ancestors are passed as inherited
+            visitor(EntityClassAttribute(*i->second, true));
+        }
     }
 }
 
@@ -404,7 +508,8 @@ void Doom3EntityClass::resolveInheritance(EntityClasses& classmap)
     // Lookup the parent name and return if it is not set. Also return if the
     // parent name is the same as our own classname, to avoid infinite
     // recursion.
-    std::string parName = getAttribute("inherit").getValue();
+    const EntityClassAttribute* inherit = findOwnAttribute("inherit");
+    std::string parName = inherit != NULL ? inherit->getValue() : "";
     if (parName.empty() || parName == _name)
         return;
 
@@ -415,13 +520,21 @@ void Doom3EntityClass::resolveInheritance(EntityClasses& classmap)
         // Recursively resolve inheritance of parent
         pIter->second->resolveInheritance(classmap);
 
-        // Copy attributes from the parent to the child, including editor keys
-        pIter->second->forEachClassAttribute(
-            boost::bind(&copyInheritedAttribute, this, _1), true
-        );
-
-        // Set our parent pointer
+        // Set our parent pointer, the inherited attributes are looked up
+        // along the parent chain from now on
         _parent = pIter->second.get();
+
+        // Our own attributes might lack the type or description given by
+        // the ancestors (which are visible in the entity inspector)
+        for (Attributes::iterator i = _attributes.begin(); i != _attributes.end(); ++i)
+        {
+            const EntityClassAttribute* inherited = _parent->findAttribute(i->getName());
+
+            if (inherited != NULL)
+            {
+                mergeAttribute(*i, *inherited);
+            }
+        }
     }
     else
     {
@@ -465,24 +578,43 @@ void Doom3EntityClass::resolveInheritance(EntityClasses& classmap)
     }
 }
 
-// Find a single attribute
-EntityClassAttribute& Doom3EntityClass::getAttribute(const std::string& name)
+const EntityClassAttribute* Doom3EntityClass::findOwnAttribute(const std::string& name) const
+{
+    Attributes::const_iterator i = std::lower_bound(
+        _attributes.begin(), _attributes.end(), name, AttributeNameLess()
+    );
+
+    return (i != _attributes.end() && !AttributeNameLess()(name, *i)) ? &(*i) : NULL;
+}
+
+EntityClassAttribute* Doom3EntityClass::findOwnAttribute(const std::string& name)
 {
-    StringPtr ref(new std::string(name));
+    return const_cast<EntityClassAttribute*>(
+        static_cast<const Doom3EntityClass*>(this)->findOwnAttribute(name)
+    );
+}
 
-    EntityAttributeMap::iterator f = _attributes.find(ref);
+const EntityClassAttribute* Doom3EntityClass::findAttribute(const std::string& name) const
+{
+    for (const Doom3EntityClass* eclass = this; eclass != NULL; eclass = eclass->_parent)
+    {
+        const EntityClassAttribute* attribute = eclass->findOwnAttribute(name);
 
-    return (f != _attributes.end()) ? f->second : _emptyAttribute;
+        if (attribute != NULL)
+        {
+            return attribute;
+        }
+    }
+
+    return NULL;
 }
 
 // Find a single attribute
 const EntityClassAttribute& Doom3EntityClass::getAttribute(const std::string& name) const
 {
-    StringPtr ref(new std::string(name));
+    const EntityClassAttribute* attribute = findAttribute(name);
 
-    EntityAttributeMap::const_iterator f = _attributes.find(ref);
-
-    return (f != _attributes.end()) ? f->second : _emptyAttribute;
+    return (attribute != NULL) ? *attribute : _emptyAttribute;
 }
 
 void Doom3EntityClass::clear()
@@ -499,6 +631,7 @@ void Doom3EntityClass::clear()
     _attributes.clear();
     _model.clear();
     _skin.clear();
+    _parent = NULL;
     _inheritanceResolved = false;
 
     _modName = "base";
@@ -581,7 +714,9 @@ void Doom3EntityClass::parseFromTokens(parser::DefTokeniser& tokeniser)
         _attachments->parseDefAttachKeys(key, value);
 
         // Add the EntityClassAttribute for this key/val
-        if (getAttribute(key).getType().empty())
+        EntityClassAttribute* existing = findOwnAttribute(key);
+
+        if (existing == NULL)
         {
             // Following key-specific processing, add the keyvalue to the eclass
             EntityClassAttribute attribute("text", key, value, "");
@@ -589,10 +724,10 @@ void Doom3EntityClass::parseFromTokens(parser::DefTokeniser& tokeniser)
             // Type is empty, attribute does not exist, add it.
             addAttribute(attribute);
         }
-        else if (getAttribute(key).getValue().empty())
+        else if (existing->getValue().empty())
         {
             // Attribute type is set, but value is empty, set the value.
-            getAttribute(key).setValue(value);
+            existing->setValue(internString(value));
         }
         else
         {
@@ -31,23 +31,11 @@ typedef boost::shared_ptr<Doom3EntityClass> Doom3EntityClassPtr;
 class Doom3EntityClass
 : public IEntityClass
 {
-    typedef boost::shared_ptr<std::string> StringPtr;
-
-    class StringCompareFunctor
-    {
-    public:
-        bool operator()(const StringPtr& lhs, const StringPtr& rhs) const
-        {
-            //return boost::algorithm::ilexicographical_compare(lhs, rhs); // this is slow!
-            return string_compare_nocase(lhs->c_str(), rhs->c_str()) < 0;
-        }
-    };
-
     // The name of this entity class
     std::string _name;
 
     // Parent class pointer (or NULL)
-    IEntityClass* _parent;
+    Doom3EntityClass* _parent;
 
     // Should this entity type be treated as a light?
     bool _isLight;
@@ -64,28 +52,24 @@ class Doom3EntityClass
     // Does this entity have a fixed size?
     bool _fixedSize;
 
-    // Map of named EntityAttribute structures. EntityAttributes are picked
-    // up from the DEF file during parsing. Ignores key case.
+    // The EntityClassAttributes defined by this class itself, sorted by name
+    // (ignoring case). They are picked up from the DEF file during parsing.
 
-    // greebo: I've changed the EntityAttributeMap key type to StringPtr, to save
-    // more than 130 MB of string data used for just the keys. A default TDM installation
-    // has about 780k entity class attributes after resolving inheritance.
-    // However, the memory saving comes with a performance cost since we need 
-    // to convert the incoming std::string queries to StringRefs before passing
-    // them to std::map::find(). During a regular DarkRadiant startup 
-    // there are about 64k find() operations, a single idLight
-    // creation costs about 30-40 find() operations, which is ok I guess.
-
-    typedef std::map<StringPtr, EntityClassAttribute, StringCompareFunctor> EntityAttributeMap;
-    EntityAttributeMap _attributes;
+    // Inherited attributes are not copied into the child classes, lookups
+    // fall back to the parent chain instead. A default TDM installation used to
+    // have about 780k attributes after resolving inheritance, most of them
+    // copies of their parents' entries. The strings are shared between all
+    // classes through a pool, as the same keys and values occur in many defs.
+    typedef std::vector<EntityClassAttribute> Attributes;
+    Attributes _attributes;
 
     // The model and skin for this entity class (if it has one)
     std::string _model;
     std::string _skin;
 
     // Flag to indicate inheritance resolved. An EntityClass resolves its
-    // inheritance by copying all values from the parent onto the child,
-    // after recursively instructing the parent to resolve its own inheritance.
+    // inheritance by linking itself to the parent, after recursively
+    // instructing the parent to resolve its own inheritance.
     bool _inheritanceResolved;
 
     // Name of the mod owning this class
@@ -110,6 +94,13 @@ private:
     void parseEditorSpawnarg(const std::string& key, const std::string& value);
     void setIsLight(bool val);
 
+    // Lookup of an attribute defined by this class itself (or NULL)
+    const EntityClassAttribute* findOwnAttribute(const std::string& name) const;
+    EntityClassAttribute* findOwnAttribute(const std::string& name);
+
+    // Lookup of an attribute along the parent chain (or NULL)
+    const EntityClassAttribute* findAttribute(const std::string& name) const;
+
 public:
 
     /**
@@ -146,6 +137,12 @@ public:
     /// Add a new attribute
     void addAttribute(const EntityClassAttribute& attribute);
 
+    /**
+     * Drop the pooled attribute strings which are no longer used by any
+     * entity class. To be called after (re)parsing the DEF files.
+     */
+    static void releaseUnusedStrings();
+
     // IEntityClass implementation
     std::string getName() const;
     const IEntityClass* getParent() const;
@@ -156,7 +153,6 @@ public:
     const Vector3& getColour() const;
     const std::string& getWireShader() const;
     const std::string& getFillShader() const;
-    EntityClassAttribute& getAttribute(const std::string& name);
     const EntityClassAttribute& getAttribute(const std::string& name) const;
     void forEachClassAttribute(boost::function<void(const EntityClassAttribute&)>,
                                bool) const;
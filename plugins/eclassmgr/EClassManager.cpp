@@ -11,6 +11,7 @@
 #include "Doom3ModelDef.h"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/bind.hpp>
 
 #include "debugging/ScopedDebugTimer.h"
@@ -177,6 +178,9 @@ void EClassManager::resolveInheritance()
 	{
 		worldspawn->setColour(worlspawnColour);
 	}
+
+	// The strings of the previous contents of re-parsed classes can go now
+	Doom3EntityClass::releaseUnusedStrings();
 }
 
 void EClassManager::realise()
@@ -221,7 +225,10 @@ void EClassManager::unrealise()
     if (_realised)
 	{
        	_entityClasses.clear();
+       	_defFiles.clear();
        	_realised = false;
+
+       	Doom3EntityClass::releaseUnusedStrings();
     }
 }
 
@@ -239,6 +246,106 @@ void EClassManager::forEachModelDef(ModelDefVisitor& visitor)
 	}
 }
 
+void EClassManager::onFilesChanged(const StringSet& filenames)
+{
+	if (!_realised) return;
+
+	StringSet defFiles;
+
+	for (StringSet::const_iterator i = filenames.begin(); i != filenames.end(); ++i)
+	{
+		if (boost::algorithm::istarts_with(*i, "def/") && boost::algorithm::iends_with(*i, ".def"))
+		{
+			defFiles.insert(*i);
+		}
+	}
+
+	if (!defFiles.empty())
+	{
+		reloadDefFiles(defFiles);
+	}
+}
+
+void EClassManager::reloadDefFiles(const StringSet& filenames)
+{
+	// Like reloadDefs(), the existing classes are parsed again in place
+	_curParseStamp++;
+
+	StringSet parsedFiles;
+	StringSet pendingFiles(filenames);
+
+	// The classes no longer defined by their file, kept alive until the
+	// classes inheriting from them have been parsed again
+	EntityClasses removedClasses;
+
+	while (!pendingFiles.empty())
+	{
+		for (StringSet::const_iterator i = pendingFiles.begin(); i != pendingFiles.end(); ++i)
+		{
+			rMessage() << "[eclassmgr] Reloading " << *i << std::endl;
+
+			parseFile(*i);
+			parsedFiles.insert(*i);
+		}
+
+		// Drop the classes of the re-parsed files which haven't been encountered
+		// this time, the file (or the class in it) has been removed
+		for (EntityClasses::iterator i = _entityClasses.begin(); i != _entityClasses.end(); /* in-loop increment */)
+		{
+			DefFiles::iterator file = _defFiles.find(i->first);
+
+			if (i->second->getParseStamp() != _curParseStamp && file != _defFiles.end() &&
+				pendingFiles.find(file->second) != pendingFiles.end())
+			{
+				rMessage() << "[eclassmgr] Removing entityDef " << i->first << std::endl;
+
+				removedClasses.insert(*i);
+				_defFiles.erase(file);
+				_entityClasses.erase(i++);
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		pendingFiles.clear();
+
+		// The descendants of a re-parsed or removed class derive their model, light
+		// and colour settings from it, so their files need to be parsed again too
+		for (EntityClasses::const_iterator i = _entityClasses.begin(); i != _entityClasses.end(); ++i)
+		{
+			if (i->second->getParseStamp() == _curParseStamp) continue;
+
+			for (const IEntityClass* parent = i->second->getParent(); parent != NULL;
+				 parent = parent->getParent())
+			{
+				EntityClasses::const_iterator removed = removedClasses.find(parent->getName());
+
+				if (static_cast<const Doom3EntityClass*>(parent)->getParseStamp() != _curParseStamp &&
+					(removed == removedClasses.end() || removed->second.get() != parent))
+				{
+					continue;
+				}
+
+				DefFiles::const_iterator file = _defFiles.find(i->first);
+
+				if (file != _defFiles.end() && parsedFiles.find(file->second) == parsedFiles.end())
+				{
+					pendingFiles.insert(file->second);
+				}
+
+				break;
+			}
+		}
+	}
+
+	// Resolve the inheritance of the re-parsed classes
+	resolveInheritance();
+
+	_defsReloadedSignal.emit();
+}
+
 void EClassManager::reloadDefs()
 {
 	// greebo: Leave all current entityclasses as they are, just invoke the
@@ -303,7 +410,8 @@ void EClassManager::onFileSystemShutdown()
 
 // Parse the provided stream containing the contents of a single .def file.
 // Extract all entitydefs and create objects accordingly.
-void EClassManager::parse(TextInputStream& inStr, const std::string& modDir)
+void EClassManager::parse(TextInputStream& inStr, const std::string& modDir,
+                          const std::string& filename)
 {
 	// Construct a tokeniser for the stream
 	std::istream is(&inStr);
@@ -352,6 +460,8 @@ void EClassManager::parse(TextInputStream& inStr, const std::string& modDir)
         	// Parse the contents of the eclass (excluding name)
 			i->second->parseFromTokens(tokeniser);
 
+			_defFiles[sName] = filename;
+
 			// Set the mod directory
         	i->second->setModName(modDir);
         }
@@ -399,15 +509,18 @@ void EClassManager::parse(TextInputStream& inStr, const std::string& modDir)
 
 void EClassManager::visit(const std::string& filename)
 {
-	const std::string fullname = "def/" + filename;
+	parseFile("def/" + filename);
+}
 
-	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(fullname);
+void EClassManager::parseFile(const std::string& filename)
+{
+	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(filename);
 
 	if (file == NULL) return;
 
 	try {
 		// Parse entity defs from the file
-		parse(file->getInputStream(), file->getModName());
+		parse(file->getInputStream(), file->getModName(), filename);
 	}
 		catch (parser::ParseException& e) {
 			rError() << "[eclassmgr] failed to parse " << filename
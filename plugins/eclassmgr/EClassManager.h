@@ -49,6 +49,10 @@ class EClassManager :
 	// definitions have been parsed
 	std::size_t _curParseStamp;
 
+	// The def file (VFS path) each entity class has been parsed from
+	typedef std::map<std::string, std::string> DefFiles;
+	DefFiles _defFiles;
+
     sigc::signal<void> _defsReloadedSignal;
 
 public:
@@ -67,6 +71,7 @@ public:
     // VFS::Observer implementation
     virtual void onFileSystemInitialise();
     virtual void onFileSystemShutdown();
+    virtual void onFilesChanged(const StringSet& filenames);
 
     // Find the modeldef with the given name
     virtual IModelDefPtr findModel(const std::string& name) const;
@@ -91,7 +96,13 @@ private:
     Doom3EntityClassPtr findInternal(const std::string& name) const;
 
 	// Parses the given inputstream for DEFs.
-	void parse(TextInputStream& inStr, const std::string& modDir);
+	void parse(TextInputStream& inStr, const std::string& modDir, const std::string& filename);
+
+	// Opens and parses the given def file (VFS path)
+	void parseFile(const std::string& filename);
+
+	// Re-parses the given def files and the ones defining classes inheriting from them
+	void reloadDefFiles(const StringSet& filenames);
 
 	// Recursively resolves the inheritance of the model defs
 	void resolveModelInheritance(const std::string& name, const Doom3ModelDefPtr& model);
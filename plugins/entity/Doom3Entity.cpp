@@ -7,9 +7,26 @@
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/pool/pool_alloc.hpp>
+#include <algorithm>
 
 namespace entity {
 
+namespace
+{
+	// KeyValues and their shared_ptr reference counts are allocated together
+	// from a pool, avoiding a heap allocation for each spawnarg
+	typedef boost::fast_pool_allocator<KeyValue> KeyValueAllocator;
+
+	// Orders index entries by key hash
+	inline bool compareHash(const std::pair<std::size_t, std::size_t>& a,
+							const std::pair<std::size_t, std::size_t>& b)
+	{
+		return a.first < b.first;
+	}
+}
+
 Doom3Entity::Doom3Entity(const IEntityClassPtr& eclass) :
 	_eclass(eclass),
 	_undo(_keyValues, boost::bind(&Doom3Entity::importState, this, _1)),
@@ -30,7 +47,7 @@ Doom3Entity::Doom3Entity(const Doom3Entity& other) :
 		 i != other._keyValues.end();
 		 ++i)
 	{
-		insert(i->first, i->second->get());
+		insert(i->first.getName(), i->second->get());
 	}
 }
 
@@ -72,7 +89,7 @@ void Doom3Entity::attachObserver(Observer* observer)
 	// Now notify the observer about all the existing keys
 	for(KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
     {
-		observer->onKeyInsert(i->first, *i->second);
+		observer->onKeyInsert(i->first.getName(), *i->second);
 	}
 }
 
@@ -95,7 +112,7 @@ void Doom3Entity::detachObserver(Observer* observer)
 	// Call onKeyErase() for every spawnarg, so that the observer gets cleanly shut down
 	for(KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
     {
-		observer->onKeyErase(i->first, *i->second);
+		observer->onKeyErase(i->first.getName(), *i->second);
 	}
 }
 
@@ -144,7 +161,7 @@ void Doom3Entity::forEachKeyValue(Visitor& visitor) const
 {
 	for(KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
 	{
-		visitor.visit(i->first, i->second->get());
+		visitor.visit(i->first.getName(), i->second->get());
 	}
 }
 
@@ -152,7 +169,7 @@ void Doom3Entity::forEachKeyValue(KeyValueVisitor& visitor)
 {
 	for(KeyValues::iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
 	{
-		visitor.visit(i->first, *i->second);
+		visitor.visit(i->first.getName(), *i->second);
 	}
 }
 
@@ -207,10 +224,10 @@ Entity::KeyValuePairs Doom3Entity::getKeyValuePairs(const std::string& prefix) c
 	for (KeyValues::const_iterator i = _keyValues.begin(); i != _keyValues.end(); ++i)
 	{
 		// If the prefix matches, add to list
-		if (boost::algorithm::istarts_with(i->first, prefix))
+		if (boost::algorithm::istarts_with(i->first.getName(), prefix))
 		{
 			list.push_back(
-				std::pair<std::string, std::string>(i->first, i->second->get())
+				std::pair<std::string, std::string>(i->first.getName(), i->second->get())
 			);
 		}
 	}
@@ -276,7 +293,7 @@ void Doom3Entity::notifyErase(const std::string& key, KeyValue& value)
 	_observerMutex = false;
 }
 
-void Doom3Entity::insert(const std::string& key, const KeyValuePtr& keyValue)
+void Doom3Entity::insert(const InternedKey& key, const KeyValuePtr& keyValue)
 {
 	// Insert the new key at the end of the list
 	KeyValues::iterator i = _keyValues.insert(
@@ -284,8 +301,10 @@ void Doom3Entity::insert(const std::string& key, const KeyValuePtr& keyValue)
 		KeyValuePair(key, keyValue)
 	);
 
+	indexInsert(_keyValues.size() - 1);
+
 	// Dereference the iterator to get a KeyValue& reference and notify the observers
-	notifyInsert(key, *i->second);
+	notifyInsert(key.getName(), *i->second);
 
 	if (_instanced)
 	{
@@ -305,7 +324,7 @@ void Doom3Entity::insert(const std::string& key, const std::string& value)
 
         // Notify observers of key change, using the found key as argument
 		// as the case of the incoming "key" might be different
-        notifyChange(i->first, value);
+        notifyChange(i->first.getName(), value);
 	}
 	else
 	{
@@ -314,8 +333,9 @@ void Doom3Entity::insert(const std::string& key, const std::string& value)
 
 		// Allocate a new KeyValue object and insert it into the map
 		insert(
-			key,
-			KeyValuePtr(new KeyValue(value, _eclass->getAttribute(key).getValue()))
+			InternedKey(key),
+			boost::allocate_shared<KeyValue>(KeyValueAllocator(),
+				value, _eclass->getAttribute(key).getValue())
 		);
 	}
 }
@@ -328,16 +348,18 @@ void Doom3Entity::erase(const KeyValues::iterator& i)
 	}
 
 	// Retrieve the key and value from the vector before deletion
-	std::string key(i->first);
+	InternedKey key(i->first);
 	KeyValuePtr value(i->second);
+	std::size_t position = i - _keyValues.begin();
 
 	// Actually delete the object from the list
 	_keyValues.erase(i);
+	indexErase(position);
 
 	// Notify about the deletion
-	notifyErase(key, *value);
+	notifyErase(key.getName(), *value);
 
-	// Scope ends here, the KeyValue object will be deleted automatically
+	// Scope ends here, the KeyValue object will be returned to the pool
 	// as the boost::shared_ptr useCount will reach zero.
 }
 
@@ -355,34 +377,102 @@ void Doom3Entity::erase(const std::string& key)
 
 Doom3Entity::KeyValues::const_iterator Doom3Entity::find(const std::string& key) const
 {
-	for (KeyValues::const_iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
+	return _keyValues.begin() + findIndex(key);
+}
+
+Doom3Entity::KeyValues::iterator Doom3Entity::find(const std::string& key)
+{
+	return _keyValues.begin() + findIndex(key);
+}
+
+std::size_t Doom3Entity::findIndex(const std::string& key) const
+{
+	std::size_t hash = InternedKey::getHash(key);
+
+	if (_keyIndex.empty())
+	{
+		// Few keys, compare the hashes in the list
+		for (std::size_t i = 0; i < _keyValues.size(); ++i)
+		{
+			const InternedKey& candidate = _keyValues[i].first;
+
+			if (candidate.getHash() == hash && boost::iequals(candidate.getName(), key))
+			{
+				return i;
+			}
+		}
+	}
+	else
 	{
-		if (boost::iequals(i->first, key))
+		std::pair<KeyIndex::const_iterator, KeyIndex::const_iterator> range =
+			std::equal_range(_keyIndex.begin(), _keyIndex.end(), IndexEntry(hash, 0), compareHash);
+
+		for (KeyIndex::const_iterator i = range.first; i != range.second; ++i)
 		{
-			return i;
+			if (boost::iequals(_keyValues[i->second].first.getName(), key))
+			{
+				return i->second;
+			}
 		}
 	}
 
 	// Not found
-	return _keyValues.end();
+	return _keyValues.size();
 }
 
-Doom3Entity::KeyValues::iterator Doom3Entity::find(const std::string& key)
+void Doom3Entity::indexInsert(std::size_t position)
 {
-	for (KeyValues::iterator i = _keyValues.begin();
-		 i != _keyValues.end();
-		 ++i)
+	if (_keyValues.size() <= MAX_UNINDEXED_KEYS)
 	{
-		if (boost::iequals(i->first, key))
+		return;
+	}
+
+	if (_keyIndex.empty())
+	{
+		// Crossing the threshold, index all the keys
+		_keyIndex.reserve(_keyValues.size());
+
+		for (std::size_t i = 0; i < _keyValues.size(); ++i)
 		{
-			return i;
+			_keyIndex.push_back(IndexEntry(_keyValues[i].first.getHash(), i));
 		}
+
+		std::stable_sort(_keyIndex.begin(), _keyIndex.end(), compareHash);
+		return;
 	}
 
-	// Not found
-	return _keyValues.end();
+	IndexEntry entry(_keyValues[position].first.getHash(), position);
+
+	_keyIndex.insert(
+		std::upper_bound(_keyIndex.begin(), _keyIndex.end(), entry, compareHash),
+		entry
+	);
+}
+
+void Doom3Entity::indexErase(std::size_t position)
+{
+	if (_keyValues.size() <= MAX_UNINDEXED_KEYS)
+	{
+		_keyIndex.clear();
+		return;
+	}
+
+	for (KeyIndex::iterator i = _keyIndex.begin(); i != _keyIndex.end();)
+	{
+		if (i->second == position)
+		{
+			i = _keyIndex.erase(i);
+			continue;
+		}
+
+		// The following keys moved up by one
+		if (i->second > position)
+		{
+			--i->second;
+		}
+
+		++i;
+	}
 }
 
 } // namespace entity
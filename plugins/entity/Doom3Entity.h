@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "KeyValue.h"
+#include "InternedKey.h"
 #include <boost/shared_ptr.hpp>
 
 /** greebo: This is the implementation of the class Entity.
@@ -21,6 +22,8 @@ namespace entity {
 /// - Notifies observers when a pair is inserted or removed.
 /// - Provides undo support through the global undo system.
 /// - New keys are appended to the end of the list.
+/// - Keys are interned, lookups compare their hashes before the strings.
+///   Entities with many keys use an additional index sorted by hash.
 class Doom3Entity :
 	public Entity
 {
@@ -28,13 +31,22 @@ class Doom3Entity :
 
 	typedef boost::shared_ptr<KeyValue> KeyValuePtr;
 
-	// A key value pair using a dynamically allocated value
-	typedef std::pair<std::string, KeyValuePtr> KeyValuePair;
+	// A key value pair using an interned key and a pooled value
+	typedef std::pair<InternedKey, KeyValuePtr> KeyValuePair;
 
 	// The unsorted list of KeyValue pairs
 	typedef std::vector<KeyValuePair> KeyValues;
 	KeyValues _keyValues;
 
+	// Key hash and position in _keyValues, sorted by hash. This index is
+	// only maintained for entities having more than MAX_UNINDEXED_KEYS keys,
+	// below that scanning the key hashes in the list is faster.
+	typedef std::pair<std::size_t, std::size_t> IndexEntry;
+	typedef std::vector<IndexEntry> KeyIndex;
+	KeyIndex _keyIndex;
+
+	static const std::size_t MAX_UNINDEXED_KEYS = 16;
+
 	typedef std::set<Observer*> Observers;
 	Observers _observers;
 
@@ -99,7 +111,7 @@ private:
     void notifyChange(const std::string& k, const std::string& v);
 	void notifyErase(const std::string& key, KeyValue& value);
 
-	void insert(const std::string& key, const KeyValuePtr& keyValue);
+	void insert(const InternedKey& key, const KeyValuePtr& keyValue);
 	void insert(const std::string& key, const std::string& value);
 
 	void erase(const KeyValues::iterator& i);
@@ -108,6 +120,13 @@ private:
 	KeyValues::iterator find(const std::string& key);
 	KeyValues::const_iterator find(const std::string& key) const;
 
+	// Returns the position of the given key in _keyValues, or _keyValues.size() if not found
+	std::size_t findIndex(const std::string& key) const;
+
+	// Keep the key index in sync after a key has been appended or erased at the given position
+	void indexInsert(std::size_t position);
+	void indexErase(std::size_t position);
+
 	void forEachKeyValue_instanceAttach(MapFile* map);
 	void forEachKeyValue_instanceDetach(MapFile* map);
 };
@@ -0,0 +1,55 @@
+#include "InternedKey.h"
+
+#include <map>
+
+namespace entity
+{
+
+namespace
+{
+	// The pool of all keys, std::map never moves its elements
+	typedef std::map<std::string, std::size_t> KeyPool;
+
+	KeyPool& getKeyPool()
+	{
+		static KeyPool _pool;
+		return _pool;
+	}
+}
+
+InternedKey::InternedKey(const std::string& name)
+{
+	KeyPool& pool = getKeyPool();
+
+	KeyPool::iterator found = pool.lower_bound(name);
+
+	if (found == pool.end() || found->first != name)
+	{
+		found = pool.insert(found, KeyPool::value_type(name, getHash(name)));
+	}
+
+	_data = &*found;
+}
+
+std::size_t InternedKey::getHash(const std::string& name)
+{
+	// FNV-1a over the lowercase characters
+	std::size_t hash = 2166136261U;
+
+	for (std::string::const_iterator i = name.begin(); i != name.end(); ++i)
+	{
+		char c = *i;
+
+		if (c >= 'A' && c <= 'Z')
+		{
+			c += 'a' - 'A';
+		}
+
+		hash ^= static_cast<unsigned char>(c);
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+} // namespace
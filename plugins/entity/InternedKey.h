@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <cstddef>
+
+namespace entity
+{
+
+/**
+ * A spawnarg key string stored in a global pool. Entities share the same
+ * handful of key names ("classname", "origin", "name", ...), so every
+ * distinct key is allocated only once and the entities just store a pointer.
+ *
+ * Along with the string the pool stores its case-insensitive hash, which is
+ * used by Doom3Entity to look up keys without comparing strings. The pool is
+ * not locked, keys must be interned on the main thread only.
+ */
+class InternedKey
+{
+private:
+	// An element of the pool: the key string and its hash
+	typedef std::pair<const std::string, std::size_t> Data;
+
+	const Data* _data;
+
+public:
+	// Looks up the given key in the pool, adding it if not present yet
+	explicit InternedKey(const std::string& name);
+
+	// The key string, the reference stays valid for the lifetime of the module
+	const std::string& getName() const
+	{
+		return _data->first;
+	}
+
+	// The case-insensitive hash of the key, see getHash(const std::string&)
+	std::size_t getHash() const
+	{
+		return _data->second;
+	}
+
+	// Interned keys are unique, so comparing the pointers is sufficient
+	bool operator==(const InternedKey& other) const
+	{
+		return _data == other._data;
+	}
+
+	bool operator!=(const InternedKey& other) const
+	{
+		return _data != other._data;
+	}
+
+	// Calculates the case-insensitive hash of the given key, keys
+	// differing only in case result in the same value
+	static std::size_t getHash(const std::string& name);
+};
+
+} // namespace
@@ -29,7 +29,8 @@ void ModelKey::refreshModel()
 	// Check if we have a skinnable model and remember the skin
 	SkinnedModelPtr skinned = boost::dynamic_pointer_cast<SkinnedModel>(_modelNode);
 
-	std::string skin = skinned ? skinned->getSkin() : "";
+	// Placeholders aren't skinned, use the keyvalue in that case
+	std::string skin = skinned ? skinned->getSkin() : _skin;
 	
 	attachModelNode();
 	
@@ -79,7 +80,7 @@ void ModelKey::attachModelNode()
 
 	// We have a non-empty model key, send the request to
 	// the model cache to acquire a new child node
-	_modelNode = GlobalModelCache().getModelNode(_modelPath);
+	_modelNode = GlobalModelCache().getModelNodeAsync(_modelPath);
 
 	// The model loader should not return NULL, but a sanity check is always ok
 	if (_modelNode)
@@ -107,6 +108,8 @@ void ModelKey::attachModelNode()
 
 void ModelKey::skinChanged(const std::string& value)
 {
+	_skin = value;
+
 	// Check if we have a skinnable model
 	SkinnedModelPtr skinned = boost::dynamic_pointer_cast<SkinnedModel>(_modelNode);
 
@@ -7,6 +7,10 @@
  * greebo: A ModelKey object watches the "model" spawnarg of
  * an entity. As soon as the keyvalue changes, the according
  * modelnode is loaded and inserted into the entity's Traversable.
+ *
+ * Models not in the cache yet are loaded in the background, a placeholder
+ * node is inserted meanwhile. The model cache calls refreshModel() on the
+ * entity once the model is ready.
  */
 class ModelKey
 {
@@ -18,6 +22,10 @@ private:
 
 	std::string _modelPath;
 
+	// The last value of the "skin" spawnarg, to apply it to models
+	// which are replacing a placeholder
+	std::string _skin;
+
 	// To deactivate model handling during node destruction
 	bool _active;
 
@@ -121,7 +121,15 @@ void EntityList::selectionChanged(const scene::INodePtr& node, bool isComponent)
 
 	_callbackActive = true;
 
-	_treeModel.updateSelectionStatus(treeView()->get_selection(), node);
+	if (node)
+	{
+		_treeModel.updateSelectionStatus(treeView()->get_selection(), node);
+	}
+	else
+	{
+		// Several nodes have changed at once, update them all
+		_treeModel.updateSelectionStatus(treeView()->get_selection());
+	}
 
 	_callbackActive = false;
 }
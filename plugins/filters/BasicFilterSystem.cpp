@@ -1,9 +1,9 @@
 #include "BasicFilterSystem.h"
 
-#include "InstanceUpdateWalker.h"
 #include "ShaderUpdateWalker.h"
 
 #include "iradiant.h"
+#include "ithread.h"
 #include "itextstream.h"
 #include "iscenegraph.h"
 #include "iregistry.h"
@@ -12,6 +12,8 @@
 #include "ishaders.h"
 
 #include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <stdexcept>
 
 namespace filters
 {
@@ -28,10 +30,40 @@ namespace {
 
 	// Registry key for persistent filter setting
 	const std::string RKEY_USER_ACTIVE_FILTERS = RKEY_USER_FILTER_BASE + "//activeFilter";
+
+	// Subgraphs with fewer entities are evaluated on the calling thread
+	const std::size_t MIN_ENTITIES_FOR_WORKERS = 1024;
+
+	bool rulesAreEqual(const FilterRules& a, const FilterRules& b)
+	{
+		if (a.size() != b.size()) return false;
+
+		for (std::size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].type != b[i].type || a[i].entityKey != b[i].entityKey ||
+				a[i].match != b[i].match || a[i].show != b[i].show)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
 }
 
 void BasicFilterSystem::setAllFilterStates(bool state)
 {
+	// Collect the rule types of the filters changing their state
+	unsigned int changedTypes = 0;
+
+	for (FilterTable::const_iterator i = _availableFilters.begin(); i != _availableFilters.end(); ++i)
+	{
+		if (getFilterState(i->first) != state)
+		{
+			changedTypes |= i->second.getRuleTypes();
+		}
+	}
+
 	if (state)
 	{
 		_activeFilters = _availableFilters;
@@ -43,10 +75,10 @@ void BasicFilterSystem::setAllFilterStates(bool state)
 
 	// Invalidate the visibility cache to force new values to be
 	// loaded from the filters themselves
-	_visibilityCache.clear();
+	clearCaches();
 
-	// Update the scenegraph instances
-	update();
+	// Update the affected scenegraph instances
+	updateChangedRules(changedTypes);
 
 	updateEvents();
 
@@ -56,6 +88,14 @@ void BasicFilterSystem::setAllFilterStates(bool state)
 	GlobalSceneGraph().sceneChanged();
 }
 
+void BasicFilterSystem::printUpdateStatsCmd(const cmd::ArgumentList& args)
+{
+	const FilterIndex::Stats& stats = _index.getLastUpdateStats();
+
+	rMessage() << "Last filter toggle: " << stats.evaluated << " of " << _index.size()
+		<< " nodes re-evaluated, " << stats.changed << " nodes changed their visibility" << std::endl;
+}
+
 void BasicFilterSystem::setAllFilterStatesCmd(const cmd::ArgumentList& args)
 {
 	if (args.size() != 1)
@@ -87,8 +127,15 @@ void BasicFilterSystem::initialiseModule(const ApplicationContext& ctx)
 	// user-defined filters
 	addFiltersFromXML(userFilters, false);
 
+	// Collect the keys used by the filters activated above
+	clearCaches();
+
 	// Add the (de-)activate all commands
 	GlobalCommandSystem().addCommand("SetAllFilterStates", boost::bind(&BasicFilterSystem::setAllFilterStatesCmd, this, _1), cmd::ARGTYPE_INT);
+	GlobalCommandSystem().addCommand("FilterUpdateStats", boost::bind(&BasicFilterSystem::printUpdateStatsCmd, this, _1));
+
+	// Keep track of the nodes in the scene
+	GlobalSceneGraph().addSceneObserver(&_index);
 
 	// Register two shortcuts
 	GlobalCommandSystem().addStatement("ActivateAllFilters", "SetAllFilterStates 1");
@@ -175,6 +222,9 @@ void BasicFilterSystem::addFiltersFromXML(const xml::NodeList& nodes, bool readO
 // Shut down the Filters module, saving active filters to registry
 void BasicFilterSystem::shutdownModule() {
 
+	GlobalSceneGraph().removeSceneObserver(&_index);
+	_index.clear();
+
 	// Remove the existing set of active filter nodes
 	GlobalRegistry().deleteXPath(RKEY_USER_ACTIVE_FILTERS);
 
@@ -242,10 +292,20 @@ sigc::signal<void> BasicFilterSystem::filtersChangedSignal() const
 void BasicFilterSystem::update()
 {
 	// Update shaders first, so that nodes can judge whether they're hidden on basis of their texture
-	updateShaders();
+	MaterialNames changedMaterials;
+	updateShaders(changedMaterials);
 
 	// Now update the scene
 	updateScene();
+
+	// All entities have been evaluated with the current class visibility
+	FilterIndex::EntityClassBuckets& classes = _index.getEntityClasses();
+
+	for (FilterIndex::EntityClassBuckets::iterator i = classes.begin(); i != classes.end(); ++i)
+	{
+		i->second.visible = isEntityClassVisible(i->second);
+		i->second.evaluated = true;
+	}
 }
 
 void BasicFilterSystem::forEachFilter(IFilterVisitor& visitor) {
@@ -274,6 +334,10 @@ std::string BasicFilterSystem::getFilterEventName(const std::string& filter) {
 void BasicFilterSystem::setFilterState(const std::string& filter, bool state) {
 
 	assert(!_availableFilters.empty());
+
+	FilterTable::const_iterator f = _availableFilters.find(filter);
+	unsigned int changedTypes = (f != _availableFilters.end()) ? f->second.getRuleTypes() : 0;
+
 	if (state) {
 		// Copy the filter to the active filters list
 		_activeFilters.insert(
@@ -288,10 +352,10 @@ void BasicFilterSystem::setFilterState(const std::string& filter, bool state) {
 
 	// Invalidate the visibility cache to force new values to be
 	// loaded from the filters themselves
-	_visibilityCache.clear();
+	clearCaches();
 
-	// Update the scenegraph instances
-	update();
+	// Update the scenegraph instances affected by this filter's rules
+	updateChangedRules(changedTypes);
 
 	_filtersChangedSignal.emit();
 
@@ -345,7 +409,7 @@ bool BasicFilterSystem::addFilter(const std::string& filterName, const FilterRul
 	);
 
 	// Clear the cache, the rules have changed
-	_visibilityCache.clear();
+	clearCaches();
 
 	_filtersChangedSignal.emit();
 
@@ -368,8 +432,10 @@ bool BasicFilterSystem::removeFilter(const std::string& filter) {
 
 		// Check if the filter was active
 		FilterTable::iterator found = _activeFilters.find(f->first);
+		unsigned int changedTypes = 0;
 
 		if (found != _activeFilters.end()) {
+			changedTypes = found->second.getRuleTypes();
 			_activeFilters.erase(found);
 		}
 
@@ -377,7 +443,14 @@ bool BasicFilterSystem::removeFilter(const std::string& filter) {
 		_availableFilters.erase(f);
 
 		// Clear the cache, the rules have changed
-		_visibilityCache.clear();
+		clearCaches();
+
+		// Update the nodes affected by the rules of an active filter
+		if (changedTypes != 0)
+		{
+			updateChangedRules(changedTypes);
+			GlobalSceneGraph().sceneChanged();
+		}
 
 		_filtersChangedSignal.emit();
 
@@ -506,11 +579,27 @@ bool BasicFilterSystem::isVisible(const FilterRule::Type type, const std::string
 
 bool BasicFilterSystem::isEntityVisible(const FilterRule::Type type, const Entity& entity)
 {
+	return isEntityVisible(type, entity, _entityVisibilityCache);
+}
+
+bool BasicFilterSystem::isEntityVisible(const FilterRule::Type type, const Entity& entity,
+										StringFlagCache& cache) const
+{
+	// Entities sharing the class name or the tested spawnargs share the result
+	std::string cacheKey = getEntityCacheKey(type, entity);
+
+	StringFlagCache::const_iterator cacheIter = cache.find(cacheKey);
+
+	if (cacheIter != cache.end())
+	{
+		return cacheIter->second;
+	}
+
 	// Otherwise, walk the list of active filters to find a value for
 	// this item.
 	bool visFlag = true; // default if no filters modify it
 
-	for (FilterTable::iterator activeIter = _activeFilters.begin();
+	for (FilterTable::const_iterator activeIter = _activeFilters.begin();
 		 activeIter != _activeFilters.end();
 		 ++activeIter)
 	{
@@ -524,9 +613,63 @@ bool BasicFilterSystem::isEntityVisible(const FilterRule::Type type, const Entit
 		}
 	}
 
+	cache.insert(StringFlagCache::value_type(cacheKey, visFlag));
+
 	return visFlag;
 }
 
+std::string BasicFilterSystem::getEntityCacheKey(const FilterRule::Type type, const Entity& entity) const
+{
+	std::string key(1, static_cast<char>('0' + type));
+
+	if (type == FilterRule::TYPE_ENTITYCLASS)
+	{
+		key += entity.getEntityClass()->getName();
+	}
+	else if (type == FilterRule::TYPE_ENTITYKEYVALUE)
+	{
+		for (std::vector<std::string>::const_iterator i = _entityKeys.begin();
+			 i != _entityKeys.end(); ++i)
+		{
+			key += entity.getKeyValue(*i);
+			key += '\0';
+		}
+	}
+
+	return key;
+}
+
+void BasicFilterSystem::evaluateEntities(EntityVisibilityList& entities,
+										 std::size_t first, std::size_t last) const
+{
+	// Each range uses its own cache, the shared one is not locked
+	StringFlagCache cache;
+
+	for (std::size_t i = first; i < last; ++i)
+	{
+		const Entity& entity = *entities[i].first;
+
+		entities[i].second = isEntityVisible(FilterRule::TYPE_ENTITYCLASS, entity, cache) &&
+							 isEntityVisible(FilterRule::TYPE_ENTITYKEYVALUE, entity, cache);
+	}
+}
+
+void BasicFilterSystem::clearCaches()
+{
+	_visibilityCache.clear();
+	_entityVisibilityCache.clear();
+
+	// Collect the keys the active filters are testing
+	std::set<std::string> keys;
+
+	for (FilterTable::const_iterator i = _activeFilters.begin(); i != _activeFilters.end(); ++i)
+	{
+		i->second.getEntityKeys(keys);
+	}
+
+	_entityKeys.assign(keys.begin(), keys.end());
+}
+
 FilterRules BasicFilterSystem::getRuleSet(const std::string& filter) {
 	FilterTable::iterator f = _availableFilters.find(filter);
 
@@ -543,11 +686,32 @@ bool BasicFilterSystem::setFilterRules(const std::string& filter,
 	FilterTable::iterator f = _availableFilters.find(filter);
 
 	if (f != _availableFilters.end() && !f->second.isReadOnly()) {
-		// Apply the ruleset
+		if (rulesAreEqual(f->second.getRuleSet(), ruleSet))
+		{
+			return true; // nothing to do
+		}
+
+		FilterTable::iterator active = _activeFilters.find(filter);
+
+		unsigned int changedTypes = f->second.getRuleTypes();
+
+		// Apply the ruleset, to the active copy as well
 		f->second.setRules(ruleSet);
 
+		if (active != _activeFilters.end())
+		{
+			active->second.setRules(ruleSet);
+		}
+
 		// Clear the cache, the ruleset has changed
-		_visibilityCache.clear();
+		clearCaches();
+
+		// Update the nodes affected by the old or the new rules of an active filter
+		if (active != _activeFilters.end())
+		{
+			updateChangedRules(changedTypes | f->second.getRuleTypes());
+			GlobalSceneGraph().sceneChanged();
+		}
 
 		_filtersChangedSignal.emit();
 
@@ -557,10 +721,44 @@ bool BasicFilterSystem::setFilterRules(const std::string& filter,
 	return false; // not found or readonly
 }
 
+void BasicFilterSystem::evaluateEntityList(EntityVisibilityList& entities)
+{
+	if (entities.size() >= MIN_ENTITIES_FOR_WORKERS)
+	{
+		try
+		{
+			GlobalRadiant().getThreadManager().executeInChunks(entities.size(),
+				boost::bind(&BasicFilterSystem::evaluateEntities, this, boost::ref(entities), _1, _2));
+			return;
+		}
+		catch (std::runtime_error& e)
+		{
+			rError() << "Failed to evaluate entity filters on the worker threads: "
+				<< e.what() << std::endl;
+
+			// Evaluate all of them again below
+		}
+	}
+
+	for (EntityVisibilityList::iterator i = entities.begin(); i != entities.end(); ++i)
+	{
+		i->second = isEntityVisible(FilterRule::TYPE_ENTITYCLASS, *i->first) &&
+					isEntityVisible(FilterRule::TYPE_ENTITYKEYVALUE, *i->first);
+	}
+}
+
 void BasicFilterSystem::updateSubgraph(const scene::INodePtr& root) {
+	// Evaluate the entities first, the scene is not changed until all of them
+	// are done, so this can be handed to the worker threads for larger subgraphs
+	EntityVisibilityList entities;
+	EntityCollector collector(entities);
+	Node_traverseSubgraph(root, collector);
+
+	evaluateEntityList(entities);
+
 	// Construct an InstanceUpdateWalker and traverse the scenegraph to update
 	// all instances
-	InstanceUpdateWalker walker;
+	InstanceUpdateWalker walker(entities);
 	Node_traverseSubgraph(root, walker);
 }
 
@@ -570,10 +768,141 @@ void BasicFilterSystem::updateScene() {
 	updateSubgraph(GlobalSceneGraph().root());
 }
 
+void BasicFilterSystem::updateChangedRules(unsigned int ruleTypes)
+{
+	FilterIndex::Stats stats;
+
+	// Material visibility changes affect the brushes and patches using them
+	MaterialNames changedMaterials;
+
+	if (ruleTypes & (1 << FilterRule::TYPE_TEXTURE))
+	{
+		updateShaders(changedMaterials);
+	}
+
+	if (ruleTypes & ((1 << FilterRule::TYPE_ENTITYCLASS) | (1 << FilterRule::TYPE_ENTITYKEYVALUE)))
+	{
+		// Spawnarg rules can affect any entity, class rules only those
+		// of the classes changing their visibility
+		updateEntities((ruleTypes & (1 << FilterRule::TYPE_ENTITYKEYVALUE)) != 0, stats);
+	}
+
+	if (ruleTypes & (1 << FilterRule::TYPE_OBJECT))
+	{
+		// Object rules affect all the brushes and patches
+		updatePrimitives(_index.getBrushes(), stats);
+		updatePrimitives(_index.getPatches(), stats);
+	}
+	else if (!changedMaterials.empty())
+	{
+		FilterIndex::NodeSet primitives;
+		_index.getPrimitives(changedMaterials, primitives);
+
+		updatePrimitives(primitives, stats);
+	}
+
+	_index.setLastUpdateStats(stats);
+}
+
+bool BasicFilterSystem::isEntityClassVisible(const FilterIndex::EntityClassBucket& bucket)
+{
+	// All entities of the bucket share the class name
+	return isEntityVisible(FilterRule::TYPE_ENTITYCLASS, *Node_getEntity(*bucket.entities.begin()));
+}
+
+void BasicFilterSystem::updateEntities(bool allEntities, FilterIndex::Stats& stats)
+{
+	FilterIndex::EntityClassBuckets& classes = _index.getEntityClasses();
+
+	// Collect the entities to re-evaluate
+	std::vector<scene::INodePtr> nodes;
+	EntityVisibilityList entities;
+
+	for (FilterIndex::EntityClassBuckets::iterator i = classes.begin(); i != classes.end(); ++i)
+	{
+		FilterIndex::EntityClassBucket& bucket = i->second;
+
+		bool visible = isEntityClassVisible(bucket);
+		bool classChanged = !bucket.evaluated || bucket.visible != visible;
+
+		bucket.visible = visible;
+		bucket.evaluated = true;
+
+		if (!allEntities && !classChanged)
+		{
+			continue;
+		}
+
+		for (FilterIndex::NodeSet::const_iterator n = bucket.entities.begin();
+			 n != bucket.entities.end(); ++n)
+		{
+			nodes.push_back(*n);
+			entities.push_back(EntityVisibilityList::value_type(Node_getEntity(*n), true));
+		}
+	}
+
+	evaluateEntityList(entities);
+
+	stats.evaluated += entities.size();
+
+	for (std::size_t i = 0; i < nodes.size(); ++i)
+	{
+		bool wasVisible = !nodes[i]->isFiltered();
+
+		if (entities[i].second == wasVisible)
+		{
+			continue; // unchanged
+		}
+
+		// Show or hide the entity, this re-evaluates the primitives of entities becoming visible
+		EntityVisibilityList single(1, entities[i]);
+		InstanceUpdateWalker walker(single);
+		Node_traverseSubgraph(nodes[i], walker);
+
+		++stats.changed;
+	}
+}
+
+void BasicFilterSystem::updatePrimitives(const FilterIndex::NodeSet& nodes, FilterIndex::Stats& stats)
+{
+	// The walker doesn't encounter any entities here
+	EntityVisibilityList noEntities;
+	InstanceUpdateWalker walker(noEntities);
+
+	for (FilterIndex::NodeSet::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+	{
+		const scene::INodePtr& node = *i;
+
+		// The primitives of hidden entities stay hidden
+		scene::INodePtr parent = node->getParent();
+
+		if (parent && parent->isFiltered())
+		{
+			continue;
+		}
+
+		bool wasFiltered = node->isFiltered();
+
+		Node_traverseSubgraph(node, walker);
+
+		++stats.evaluated;
+
+		if (node->isFiltered() != wasFiltered)
+		{
+			++stats.changed;
+		}
+	}
+}
+
+void BasicFilterSystem::onShaderChanged(const scene::INode& node)
+{
+	_index.onShaderChanged(node);
+}
+
 // Update scenegraph instances with filtered status
-void BasicFilterSystem::updateShaders() {
+void BasicFilterSystem::updateShaders(MaterialNames& changedMaterials) {
 	// Construct a ShaderVisitor to traverse the shaders
-	ShaderUpdateWalker walker;
+	ShaderUpdateWalker walker(changedMaterials);
 	GlobalMaterialManager().foreachShader(walker);
 }
 
@@ -591,6 +920,8 @@ const StringSet& BasicFilterSystem::getDependencies() const {
 		_dependencies.insert(MODULE_GAMEMANAGER);
 		_dependencies.insert(MODULE_EVENTMANAGER);
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_RADIANT);
+		_dependencies.insert(MODULE_SCENEGRAPH);
 	}
 
 	return _dependencies;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "XMLFilter.h"
+#include "InstanceUpdateWalker.h"
+#include "FilterIndex.h"
 #include "imodule.h"
 #include "ifilter.h"
 #include "icommandsystem.h"
@@ -32,6 +34,16 @@ class BasicFilterSystem
 	typedef std::map<std::string, bool> StringFlagCache;
 	StringFlagCache _visibilityCache;
 
+	// Cache of entity visibility flags, indexed by the rule type combined
+	// with the entity class name or the values of the keys in _entityKeys
+	StringFlagCache _entityVisibilityCache;
+
+	// The spawnarg keys tested by the active filters
+	std::vector<std::string> _entityKeys;
+
+	// The entities by class and the brushes and patches by material
+	FilterIndex _index;
+
     sigc::signal<void> _filtersChangedSignal;
 
 private:
@@ -40,12 +52,45 @@ private:
 	// flag on Nodes depending on their entity class
 	void updateScene();
 
-	void updateShaders();
+	// Updates the material visibility, the names of the changed materials are
+	// added to the given set
+	void updateShaders(MaterialNames& changedMaterials);
+
+	// Re-evaluates the nodes affected by the given rule types (a combination
+	// of (1 << FilterRule::Type) bits), leaving all others alone
+	void updateChangedRules(unsigned int ruleTypes);
+
+	// Re-evaluates the entities of the classes changing their visibility, or all
+	// of them if allEntities is set, walking those changing their visibility
+	void updateEntities(bool allEntities, FilterIndex::Stats& stats);
+
+	// Re-evaluates the given brushes and patches
+	void updatePrimitives(const FilterIndex::NodeSet& nodes, FilterIndex::Stats& stats);
+
+	// Checks the class of the given index bucket against the active filters
+	bool isEntityClassVisible(const FilterIndex::EntityClassBucket& bucket);
+
+	// Evaluates the visibility of the given entities, on the worker threads if there are many
+	void evaluateEntityList(EntityVisibilityList& entities);
 
 	void updateEvents();
 
 	void addFiltersFromXML(const xml::NodeList& nodes, bool readOnly);
 
+	// Invalidates the visibility caches after the (active) rules have changed
+	void clearCaches();
+
+	// Returns the key the visibility of the given entity is cached with
+	std::string getEntityCacheKey(const FilterRule::Type type, const Entity& entity) const;
+
+	// Checks the entity against the active filters, using and updating the given cache
+	bool isEntityVisible(const FilterRule::Type type, const Entity& entity,
+						 StringFlagCache& cache) const;
+
+	// Evaluates the visibility of the entities in the range [first, last),
+	// this is thread-safe as long as the scene is not modified
+	void evaluateEntities(EntityVisibilityList& entities, std::size_t first, std::size_t last) const;
+
 public:
     virtual ~BasicFilterSystem() {}
 
@@ -76,6 +121,9 @@ public:
 	// Query whether an entity is visible or filtered out
 	bool isEntityVisible(const FilterRule::Type type, const Entity& entity);
 
+	// Keeps the material index up to date
+	void onShaderChanged(const scene::INode& node);
+
 	// Whether this filter is read-only and can't be changed
 	bool filterIsReadOnly(const std::string& filter);
 
@@ -102,6 +150,9 @@ public:
 	// Command target, inspects arguments and passes on to the 
 	void setAllFilterStatesCmd(const cmd::ArgumentList& args);
 
+	// Command target, prints the node counts of the last filter toggle
+	void printUpdateStatsCmd(const cmd::ArgumentList& args);
+
 	// RegisterableModule implementation
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
@@ -0,0 +1,223 @@
+#include "FilterIndex.h"
+
+#include "ientity.h"
+#include "ieclass.h"
+#include "ibrush.h"
+#include "ipatch.h"
+
+namespace filters
+{
+
+FilterIndex::FilterIndex() :
+	_numEntities(0)
+{}
+
+FilterIndex::EntityClassBuckets& FilterIndex::getEntityClasses()
+{
+	return _entityClasses;
+}
+
+const FilterIndex::NodeSet& FilterIndex::getBrushes() const
+{
+	return _brushes;
+}
+
+const FilterIndex::NodeSet& FilterIndex::getPatches() const
+{
+	return _patches;
+}
+
+void FilterIndex::getPrimitives(const MaterialNames& materials, NodeSet& primitives)
+{
+	updateChangedPrimitives();
+
+	for (MaterialNames::const_iterator m = materials.begin(); m != materials.end(); ++m)
+	{
+		MaterialBuckets::const_iterator bucket = _materials.find(*m);
+
+		if (bucket != _materials.end())
+		{
+			primitives.insert(bucket->second.begin(), bucket->second.end());
+		}
+	}
+}
+
+std::size_t FilterIndex::size() const
+{
+	return _numEntities + _brushes.size() + _patches.size();
+}
+
+const FilterIndex::Stats& FilterIndex::getLastUpdateStats() const
+{
+	return _lastUpdate;
+}
+
+void FilterIndex::setLastUpdateStats(const Stats& stats)
+{
+	_lastUpdate = stats;
+}
+
+void FilterIndex::clear()
+{
+	_entityClasses.clear();
+	_numEntities = 0;
+	_brushes.clear();
+	_patches.clear();
+	_materials.clear();
+	_primitives.clear();
+	_changedPrimitives.clear();
+}
+
+void FilterIndex::onShaderChanged(const scene::INode& node)
+{
+	// Nodes outside the scene (or not yet inserted) are ignored, the materials
+	// are looked up on insertion. The lookup is deferred until the next texture
+	// filter toggle, as a single brush reports the change of each of its faces.
+	if (_primitives.find(&node) != _primitives.end())
+	{
+		_changedPrimitives.insert(&node);
+	}
+}
+
+void FilterIndex::onSceneNodeInsert(const scene::INodePtr& node)
+{
+	Entity* entity = Node_getEntity(node);
+
+	if (entity != NULL)
+	{
+		EntityClassBucket& bucket = _entityClasses[entity->getEntityClass()->getName()];
+
+		if (bucket.entities.insert(node).second)
+		{
+			// The new entity hasn't been evaluated with the class visibility
+			bucket.evaluated = false;
+			++_numEntities;
+		}
+	}
+	else if (Node_isBrush(node))
+	{
+		_brushes.insert(node);
+		insertPrimitive(node);
+	}
+	else if (Node_isPatch(node))
+	{
+		_patches.insert(node);
+		insertPrimitive(node);
+	}
+}
+
+void FilterIndex::onSceneNodeErase(const scene::INodePtr& node)
+{
+	Entity* entity = Node_getEntity(node);
+
+	if (entity != NULL)
+	{
+		EntityClassBuckets::iterator bucket = _entityClasses.find(entity->getEntityClass()->getName());
+
+		if (bucket != _entityClasses.end() && bucket->second.entities.erase(node) > 0)
+		{
+			--_numEntities;
+
+			if (bucket->second.entities.empty())
+			{
+				_entityClasses.erase(bucket);
+			}
+		}
+	}
+	else if (Node_isBrush(node))
+	{
+		_brushes.erase(node);
+		erasePrimitive(node);
+	}
+	else if (Node_isPatch(node))
+	{
+		_patches.erase(node);
+		erasePrimitive(node);
+	}
+}
+
+void FilterIndex::insertPrimitive(const scene::INodePtr& node)
+{
+	Primitive& primitive = _primitives[node.get()];
+
+	primitive.node = node;
+	getMaterials(node, primitive.materials);
+
+	for (MaterialNames::const_iterator m = primitive.materials.begin();
+		 m != primitive.materials.end(); ++m)
+	{
+		_materials[*m].insert(node);
+	}
+}
+
+void FilterIndex::erasePrimitive(const scene::INodePtr& node)
+{
+	Primitives::iterator primitive = _primitives.find(node.get());
+
+	if (primitive == _primitives.end())
+	{
+		return;
+	}
+
+	const MaterialNames& materials = primitive->second.materials;
+
+	for (MaterialNames::const_iterator m = materials.begin(); m != materials.end(); ++m)
+	{
+		MaterialBuckets::iterator bucket = _materials.find(*m);
+
+		if (bucket == _materials.end()) continue;
+
+		bucket->second.erase(node);
+
+		if (bucket->second.empty())
+		{
+			_materials.erase(bucket);
+		}
+	}
+
+	_changedPrimitives.erase(node.get());
+	_primitives.erase(primitive);
+}
+
+void FilterIndex::updateChangedPrimitives()
+{
+	std::set<const scene::INode*> changed;
+	changed.swap(_changedPrimitives);
+
+	for (std::set<const scene::INode*>::const_iterator i = changed.begin(); i != changed.end(); ++i)
+	{
+		Primitives::const_iterator primitive = _primitives.find(*i);
+
+		if (primitive == _primitives.end()) continue;
+
+		// Copy the reference, erasing the entry releases the stored one
+		scene::INodePtr node = primitive->second.node;
+
+		erasePrimitive(node);
+		insertPrimitive(node);
+	}
+}
+
+void FilterIndex::getMaterials(const scene::INodePtr& node, MaterialNames& materials)
+{
+	IBrush* brush = Node_getIBrush(node);
+
+	if (brush != NULL)
+	{
+		for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
+		{
+			materials.insert(brush->getFace(i).getShader());
+		}
+
+		return;
+	}
+
+	IPatch* patch = Node_getIPatch(node);
+
+	if (patch != NULL)
+	{
+		materials.insert(patch->getShader());
+	}
+}
+
+} // namespace
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "iscenegraph.h"
+#include "ifilter.h"
+#include <map>
+#include <set>
+#include <string>
+#include <boost/algorithm/string/compare.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+namespace filters
+{
+
+// Case-insensitive ordering for material names
+struct MaterialNameLess
+{
+	bool operator()(const std::string& a, const std::string& b) const
+	{
+		return boost::algorithm::ilexicographical_compare(a, b);
+	}
+};
+typedef std::set<std::string, MaterialNameLess> MaterialNames;
+
+/**
+ * Keeps track of the filterable nodes in the global scene graph. Entities
+ * are grouped by their entity class name, brushes and patches by the
+ * materials they are using. This allows the filter system to re-evaluate
+ * just the nodes of the classes and materials changing their visibility
+ * when a filter is toggled, instead of walking the whole scene.
+ *
+ * The index is following the insertions and removals, and the shader
+ * changes reported through onShaderChanged(). It doesn't evaluate the
+ * inserted nodes: on map load the nodes are inserted before they capture
+ * their shaders, the full update afterwards takes care of them.
+ */
+class FilterIndex :
+	public scene::Graph::Observer
+{
+public:
+	typedef std::set<scene::INodePtr> NodeSet;
+
+	// The entities of a single class
+	struct EntityClassBucket
+	{
+		NodeSet entities;
+
+		// The class visibility the entities have last been evaluated with,
+		// only valid if the evaluated flag is set
+		bool visible;
+		bool evaluated;
+
+		EntityClassBucket() :
+			visible(true),
+			evaluated(false)
+		{}
+	};
+	typedef std::map<std::string, EntityClassBucket> EntityClassBuckets;
+
+	// Number of nodes looked at and actually changed by an update
+	struct Stats
+	{
+		std::size_t evaluated;
+		std::size_t changed;
+
+		Stats() :
+			evaluated(0),
+			changed(0)
+		{}
+	};
+
+private:
+	EntityClassBuckets _entityClasses;
+	std::size_t _numEntities;
+
+	NodeSet _brushes;
+	NodeSet _patches;
+
+	// The brushes and patches using each material
+	typedef std::map<std::string, NodeSet, MaterialNameLess> MaterialBuckets;
+	MaterialBuckets _materials;
+
+	// The materials each brush and patch has been filed under
+	struct Primitive
+	{
+		scene::INodePtr node;
+		MaterialNames materials;
+	};
+	typedef std::map<const scene::INode*, Primitive> Primitives;
+	Primitives _primitives;
+
+	// Primitives reporting a shader change since their materials were looked up
+	std::set<const scene::INode*> _changedPrimitives;
+
+	Stats _lastUpdate;
+
+public:
+	FilterIndex();
+
+	// The entities by class name, the filter system keeps the class visibility up to date
+	EntityClassBuckets& getEntityClasses();
+
+	const NodeSet& getBrushes() const;
+	const NodeSet& getPatches() const;
+
+	// Adds the brushes and patches using one of the given materials to the given set
+	void getPrimitives(const MaterialNames& materials, NodeSet& primitives);
+
+	std::size_t size() const;
+
+	// Statistics of the last filter update
+	const Stats& getLastUpdateStats() const;
+	void setLastUpdateStats(const Stats& stats);
+
+	// Forgets about all nodes
+	void clear();
+
+	// Notification that a face or patch shader of the given node has changed
+	void onShaderChanged(const scene::INode& node);
+
+	// scene::Graph::Observer implementation
+	void onSceneNodeInsert(const scene::INodePtr& node);
+	void onSceneNodeErase(const scene::INodePtr& node);
+
+private:
+	// Files the primitive under the materials it is currently using
+	void insertPrimitive(const scene::INodePtr& node);
+	void erasePrimitive(const scene::INodePtr& node);
+
+	// Re-files the primitives which reported a shader change
+	void updateChangedPrimitives();
+
+	// Adds the materials used by the given brush or patch to the given set
+	static void getMaterials(const scene::INodePtr& node, MaterialNames& materials);
+};
+
+} // namespace
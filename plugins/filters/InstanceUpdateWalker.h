@@ -7,9 +7,39 @@
 #include "ipatch.h"
 
 #include "scenelib.h"
+#include <vector>
 
 namespace filters {
 
+// Entities and their visibility, in the order they are visited by the InstanceUpdateWalker
+typedef std::vector< std::pair<Entity*, bool> > EntityVisibilityList;
+
+// Walker: collects the entities of a subgraph, their visibility is evaluated afterwards
+class EntityCollector :
+	public scene::NodeVisitor
+{
+private:
+	EntityVisibilityList& _entities;
+
+public:
+	EntityCollector(EntityVisibilityList& entities) :
+		_entities(entities)
+	{}
+
+	bool pre(const scene::INodePtr& node)
+	{
+		Entity* entity = Node_getEntity(node);
+
+		if (entity != NULL)
+		{
+			_entities.push_back(EntityVisibilityList::value_type(entity, true));
+			return false;
+		}
+
+		return true;
+	}
+};
+
 // Walker: de-selects a complete subgraph
 class Deselector :
 	public scene::NodeVisitor
@@ -56,12 +86,18 @@ private:
 	bool _patchesAreVisible;
 	bool _brushesAreVisible;
 
+	// The precalculated entity visibility and the next entity expected
+	const EntityVisibilityList& _entityVisibility;
+	std::size_t _nextEntity;
+
 public:
-	InstanceUpdateWalker() :
+	InstanceUpdateWalker(const EntityVisibilityList& entityVisibility) :
 		_hideWalker(true),
 		_showWalker(false),
 		_patchesAreVisible(GlobalFilterSystem().isVisible(FilterRule::TYPE_OBJECT, "patch")),
-		_brushesAreVisible(GlobalFilterSystem().isVisible(FilterRule::TYPE_OBJECT, "brush"))
+		_brushesAreVisible(GlobalFilterSystem().isVisible(FilterRule::TYPE_OBJECT, "brush")),
+		_entityVisibility(entityVisibility),
+		_nextEntity(0)
 	{
 
 	}
@@ -74,9 +110,19 @@ public:
 
 		if (entity != NULL)
 		{
-			// Check the eclass first
-			bool entityIsVisible = GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYCLASS, *entity) &&
-								   GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYKEYVALUE, *entity);
+			bool entityIsVisible;
+
+			if (_nextEntity < _entityVisibility.size() &&
+				_entityVisibility[_nextEntity].first == entity)
+			{
+				entityIsVisible = _entityVisibility[_nextEntity++].second;
+			}
+			else
+			{
+				// Not collected beforehand, check the eclass first
+				entityIsVisible = GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYCLASS, *entity) &&
+								  GlobalFilterSystem().isEntityVisible(FilterRule::TYPE_ENTITYKEYVALUE, *entity);
+			}
 
 			Node_traverseSubgraph(
 				node,
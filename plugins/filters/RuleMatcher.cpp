@@ -0,0 +1,147 @@
+#include "RuleMatcher.h"
+
+#include "itextstream.h"
+#include <cstring>
+
+namespace filters
+{
+
+namespace
+{
+	// Characters having a special meaning in a regular expression
+	const char* const REGEX_SPECIAL_CHARS = ".[]{}()*+?|^$\\";
+}
+
+RuleMatcher::RuleMatcher(const std::string& expression)
+{
+	if (parseWildcards(expression))
+	{
+		if (_segments.size() == 1)
+		{
+			_kind = KIND_LITERAL;
+		}
+		else if (_segments.size() == 2 && _segments.back().empty())
+		{
+			_kind = KIND_PREFIX;
+		}
+		else
+		{
+			_kind = KIND_WILDCARD;
+		}
+
+		return;
+	}
+
+	_segments.clear();
+
+	try
+	{
+		_regex.assign(expression);
+		_kind = KIND_REGEX;
+	}
+	catch (boost::regex_error& ex)
+	{
+		rWarning() << "[filters] Invalid match expression " << expression
+			<< ": " << ex.what() << std::endl;
+		_kind = KIND_INVALID;
+	}
+}
+
+RuleMatcher::Kind RuleMatcher::getKind() const
+{
+	return _kind;
+}
+
+bool RuleMatcher::matches(const std::string& str) const
+{
+	switch (_kind)
+	{
+	case KIND_LITERAL:
+		return str == _segments.front();
+
+	case KIND_PREFIX:
+		return str.size() >= _segments.front().size() &&
+			   str.compare(0, _segments.front().size(), _segments.front()) == 0;
+
+	case KIND_WILDCARD:
+		return matchesWildcards(str);
+
+	case KIND_REGEX:
+		return boost::regex_match(str, _regex);
+
+	default:
+		return false;
+	};
+}
+
+bool RuleMatcher::parseWildcards(const std::string& expression)
+{
+	_segments.push_back(std::string());
+
+	for (std::size_t i = 0; i < expression.size(); ++i)
+	{
+		char c = expression[i];
+
+		if (c == '.' && i + 1 < expression.size() && expression[i + 1] == '*')
+		{
+			// A wildcard, start a new segment
+			_segments.push_back(std::string());
+			++i;
+		}
+		else if (c == '\\')
+		{
+			// An escaped special character is a literal, other escapes like
+			// "\d" or the word boundary "\<" are left to the regex
+			if (i + 1 >= expression.size() || expression[i + 1] == '\0' ||
+				std::strchr(REGEX_SPECIAL_CHARS, expression[i + 1]) == NULL)
+			{
+				return false;
+			}
+
+			_segments.back() += expression[++i];
+		}
+		else if (std::strchr(REGEX_SPECIAL_CHARS, c) != NULL)
+		{
+			return false;
+		}
+		else
+		{
+			_segments.back() += c;
+		}
+	}
+
+	return true;
+}
+
+bool RuleMatcher::matchesWildcards(const std::string& str) const
+{
+	const std::string& first = _segments.front();
+	const std::string& last = _segments.back();
+
+	if (str.size() < first.size() + last.size() ||
+		str.compare(0, first.size(), first) != 0 ||
+		str.compare(str.size() - last.size(), last.size(), last) != 0)
+	{
+		return false;
+	}
+
+	// Find the segments in between in order, between the first and the last one
+	std::size_t pos = first.size();
+	std::size_t end = str.size() - last.size();
+
+	for (std::size_t i = 1; i + 1 < _segments.size(); ++i)
+	{
+		std::size_t found = str.find(_segments[i], pos);
+
+		if (found == std::string::npos || found + _segments[i].size() > end)
+		{
+			return false;
+		}
+
+		pos = found + _segments[i].size();
+	}
+
+	return true;
+}
+
+} // namespace
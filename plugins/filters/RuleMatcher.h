@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/regex.hpp>
+
+namespace filters
+{
+
+/**
+ * The compiled form of a filter rule's match expression. Most expressions
+ * in the stock filters are plain names or names combined with ".*"
+ * wildcards, which are matched by simple string comparisons. Everything
+ * else is handed to a boost::regex, which is constructed only once.
+ *
+ * Matching is thread-safe, a matcher can be used by several threads at once.
+ */
+class RuleMatcher
+{
+public:
+	enum Kind
+	{
+		KIND_LITERAL,	// "func_static"
+		KIND_PREFIX,	// "textures/common/.*"
+		KIND_WILDCARD,	// ".*caulk.*", literal text mixed with ".*"
+		KIND_REGEX,		// anything else
+		KIND_INVALID,	// the regex failed to compile, never matches
+	};
+
+private:
+	Kind _kind;
+
+	// The literal text between the ".*" wildcards, the first segment has to
+	// match the beginning of the string, the last one the end of it
+	std::vector<std::string> _segments;
+
+	boost::regex _regex;
+
+public:
+	// Compiles the given regular expression
+	explicit RuleMatcher(const std::string& expression);
+
+	Kind getKind() const;
+
+	// Returns true if the given string matches the whole expression (like boost::regex_match)
+	bool matches(const std::string& str) const;
+
+private:
+	// Splits the expression into literal segments, returns false if it's not of that form
+	bool parseWildcards(const std::string& expression);
+
+	bool matchesWildcards(const std::string& str) const;
+};
+typedef std::vector<RuleMatcher> RuleMatchers;
+
+} // namespace
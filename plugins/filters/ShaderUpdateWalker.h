@@ -3,6 +3,7 @@
 
 #include "ishaders.h"
 #include "ifilter.h"
+#include "FilterIndex.h"
 
 namespace filters {
 
@@ -13,13 +14,25 @@ namespace filters {
 class ShaderUpdateWalker :
 	public shaders::ShaderVisitor
 {
+private:
+	// Receives the names of the shaders changing their visibility
+	MaterialNames& _changed;
+
 public:
+	ShaderUpdateWalker(MaterialNames& changed) :
+		_changed(changed)
+	{}
+
 	void visit(const MaterialPtr& shader)
 	{
 		// Set the shader's visibility based on the current filter settings
-		shader->setVisible(
-			GlobalFilterSystem().isVisible(FilterRule::TYPE_TEXTURE, shader->getName())
-		);
+		bool visible = GlobalFilterSystem().isVisible(FilterRule::TYPE_TEXTURE, shader->getName());
+
+		if (visible != shader->isVisible())
+		{
+			_changed.insert(shader->getName());
+			shader->setVisible(visible);
+		}
 	}
 };
 
@@ -3,7 +3,6 @@
 #include "ientity.h"
 #include "ieclass.h"
 #include "ifilter.h"
-#include <boost/regex.hpp>
 #include <boost/algorithm/string/erase.hpp>
 
 namespace filters {
@@ -24,24 +23,20 @@ bool XMLFilter::isVisible(const FilterRule::Type type, const std::string& name)
 
 	bool visible = true; // default if unmodified by rules
 
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	for (std::size_t i = 0; i < _rules.size(); ++i)
 	{
 		// Check the item type.
-		if (ruleIter->type != type)
+		if (_rules[i].type != type)
 		{
 			continue;
 		}
 
-		// If we have a rule for this item, use boost's regex to match the query name
-		// against the "match" parameter
-		boost::regex ex(ruleIter->match);
-
-		if (boost::regex_match(name, ex))
+		// If we have a rule for this item, match the query name against
+		// the compiled "match" parameter
+		if (_matchers[i].matches(name))
 		{
 			// Overwrite the visible flag with the value from the rule.
-			visible = ruleIter->show;
+			visible = _rules[i].show;
 		}
 	}
 
@@ -53,38 +48,53 @@ bool XMLFilter::isEntityVisible(const FilterRule::Type type, const Entity& entit
 {
 	bool visible = true; // default if unmodified by rules
 
-	IEntityClassConstPtr eclass = entity.getEntityClass();
-	
-	for (FilterRules::const_iterator ruleIter = _rules.begin();
-		 ruleIter != _rules.end();
-		 ++ruleIter)
+	if (type == FilterRule::TYPE_ENTITYCLASS)
+	{
+		// All the rules test the same name
+		return isVisible(type, entity.getEntityClass()->getName());
+	}
+	else if (type != FilterRule::TYPE_ENTITYKEYVALUE)
 	{
-		if (ruleIter->type != type)
+		return visible;
+	}
+
+	for (std::size_t i = 0; i < _rules.size(); ++i)
+	{
+		if (_rules[i].type != type)
 		{
 			continue;
 		}
 
-		if (type == FilterRule::TYPE_ENTITYCLASS)
+		if (_matchers[i].matches(entity.getKeyValue(_rules[i].entityKey)))
 		{
-			boost::regex ex(ruleIter->match);
-
-			if (boost::regex_match(eclass->getName(), ex))
-			{
-				visible = ruleIter->show;
-			}
+			visible = _rules[i].show;
 		}
-		else if (type == FilterRule::TYPE_ENTITYKEYVALUE)
-		{
-			boost::regex ex(ruleIter->match);
+	}
+
+	return visible;
+}
 
-			if (boost::regex_match(entity.getKeyValue(ruleIter->entityKey), ex))
-			{
-				visible = ruleIter->show;
-			}
+void XMLFilter::getEntityKeys(std::set<std::string>& keys) const
+{
+	for (FilterRules::const_iterator i = _rules.begin(); i != _rules.end(); ++i)
+	{
+		if (i->type == FilterRule::TYPE_ENTITYKEYVALUE)
+		{
+			keys.insert(i->entityKey);
 		}
 	}
+}
 
-	return visible;
+unsigned int XMLFilter::getRuleTypes() const
+{
+	unsigned int types = 0;
+
+	for (FilterRules::const_iterator i = _rules.begin(); i != _rules.end(); ++i)
+	{
+		types |= 1 << i->type;
+	}
+
+	return types;
 }
 
 // The command target
@@ -115,6 +125,14 @@ FilterRules XMLFilter::getRuleSet() {
 
 void XMLFilter::setRules(const FilterRules& rules) {
 	_rules = rules;
+
+	// Compile the new match expressions
+	_matchers.clear();
+
+	for (FilterRules::const_iterator i = _rules.begin(); i != _rules.end(); ++i)
+	{
+		_matchers.push_back(RuleMatcher(i->match));
+	}
 }
 
 void XMLFilter::updateEventName() {
@@ -1,9 +1,11 @@
 #ifndef XMLFILTER_H_
 #define XMLFILTER_H_
 
+#include <set>
 #include <string>
 #include <vector>
 #include "ifilter.h"
+#include "RuleMatcher.h"
 
 namespace filters
 {
@@ -25,6 +27,9 @@ private:
 	// Ordered list of rule objects
 	FilterRules _rules;
 
+	// The compiled match expressions, one for each rule
+	RuleMatchers _matchers;
+
 	// True if this filter can't be changed
 	bool _readonly;
 
@@ -51,6 +56,7 @@ public:
 	void addRule(const FilterRule::Type type, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::Create(type, match, show));
+		_matchers.push_back(RuleMatcher(match));
 	}
 
 	/** Add an entitykeyvalue rule to this filter.
@@ -68,6 +74,7 @@ public:
 	void addEntityKeyValueRule(const std::string& key, const std::string& match, bool show)
 	{
 		_rules.push_back(FilterRule::CreateEntityKeyValueRule(key, match, show));
+		_matchers.push_back(RuleMatcher(match));
 	}
 
 	/** Test a given item for visibility against all of the rules
@@ -92,6 +99,16 @@ public:
 	 */
 	bool isEntityVisible(const FilterRule::Type type, const Entity& entity) const;
 
+	/** Adds the spawnarg keys tested by the entitykeyvalue rules of this
+	 * filter to the given set.
+	 */
+	void getEntityKeys(std::set<std::string>& keys) const;
+
+	/** Returns the types of the rules in this filter, as a combination
+	 * of (1 << FilterRule::Type) bits.
+	 */
+	unsigned int getRuleTypes() const;
+
 	/** greebo: Returns the name of the toggle event associated to this filter
 	 */
 	std::string getEventName() const;
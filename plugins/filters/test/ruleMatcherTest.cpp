@@ -0,0 +1,133 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ruleMatcherTest
+#include <boost/test/unit_test.hpp>
+
+#include "../RuleMatcher.h"
+
+using namespace filters;
+
+namespace
+{
+	// Match expressions as found in the stock filters and some more unusual ones
+	const char* const EXPRESSIONS[] =
+	{
+		"func_static",
+		"worldspawn",
+		"textures/common/.*",
+		"textures/common/caulk",
+		".*caulk.*",
+		".*caulk",
+		"light.*_.*",
+		".*aa.*aa",
+		"a.*b.*c",
+		".*",
+		"",
+		"func\\.static",
+		"textures/\\(old\\)/.*",
+		"atdm:.*\\+.*",
+		"\\<func_.*",
+		"func_(static|emitter)",
+		"[a-z]+_static",
+		"light_?.*",
+		"model\\d",
+		"a\\-b",
+	};
+
+	const char* const SUBJECTS[] =
+	{
+		"",
+		"func_static",
+		"func_statics",
+		"xfunc_static",
+		"func.static",
+		"funcxstatic",
+		"func_emitter",
+		"worldspawn",
+		"textures/common/caulk",
+		"textures/common/",
+		"textures/commonx",
+		"textures/(old)/wall",
+		"textures/old/wall",
+		"caulk",
+		"textures/darkmod/caulk_sky",
+		"light",
+		"light_",
+		"lightx_y",
+		"aa",
+		"aaa",
+		"aaaa",
+		"abc",
+		"acb",
+		"a_b_c",
+		"atdm:ai+human",
+		"atdm:ai_human",
+		"model5",
+		"a-b",
+	};
+
+	const std::size_t NUM_EXPRESSIONS = sizeof(EXPRESSIONS) / sizeof(EXPRESSIONS[0]);
+	const std::size_t NUM_SUBJECTS = sizeof(SUBJECTS) / sizeof(SUBJECTS[0]);
+}
+
+BOOST_AUTO_TEST_CASE(classifyLiterals)
+{
+	BOOST_CHECK_EQUAL(RuleMatcher("func_static").getKind(), RuleMatcher::KIND_LITERAL);
+	BOOST_CHECK_EQUAL(RuleMatcher("textures/common/caulk").getKind(), RuleMatcher::KIND_LITERAL);
+	BOOST_CHECK_EQUAL(RuleMatcher("").getKind(), RuleMatcher::KIND_LITERAL);
+
+	// Escaped special characters are part of the literal
+	BOOST_CHECK_EQUAL(RuleMatcher("func\\.static").getKind(), RuleMatcher::KIND_LITERAL);
+	BOOST_CHECK_EQUAL(RuleMatcher("a\\+b\\*").getKind(), RuleMatcher::KIND_LITERAL);
+}
+
+BOOST_AUTO_TEST_CASE(classifyPrefixes)
+{
+	BOOST_CHECK_EQUAL(RuleMatcher("textures/common/.*").getKind(), RuleMatcher::KIND_PREFIX);
+	BOOST_CHECK_EQUAL(RuleMatcher("textures/\\(old\\)/.*").getKind(), RuleMatcher::KIND_PREFIX);
+}
+
+BOOST_AUTO_TEST_CASE(classifyWildcards)
+{
+	BOOST_CHECK_EQUAL(RuleMatcher(".*caulk.*").getKind(), RuleMatcher::KIND_WILDCARD);
+	BOOST_CHECK_EQUAL(RuleMatcher(".*caulk").getKind(), RuleMatcher::KIND_WILDCARD);
+	BOOST_CHECK_EQUAL(RuleMatcher("a.*b.*c").getKind(), RuleMatcher::KIND_WILDCARD);
+	BOOST_CHECK_EQUAL(RuleMatcher("atdm:.*\\+.*").getKind(), RuleMatcher::KIND_WILDCARD);
+}
+
+BOOST_AUTO_TEST_CASE(classifyRegexes)
+{
+	BOOST_CHECK_EQUAL(RuleMatcher("func_(static|emitter)").getKind(), RuleMatcher::KIND_REGEX);
+	BOOST_CHECK_EQUAL(RuleMatcher("[a-z]+_static").getKind(), RuleMatcher::KIND_REGEX);
+	BOOST_CHECK_EQUAL(RuleMatcher("light_?.*").getKind(), RuleMatcher::KIND_REGEX);
+
+	// Escapes of ordinary characters have a meaning of their own
+	BOOST_CHECK_EQUAL(RuleMatcher("\\<func_.*").getKind(), RuleMatcher::KIND_REGEX);
+	BOOST_CHECK_EQUAL(RuleMatcher("model\\d").getKind(), RuleMatcher::KIND_REGEX);
+	BOOST_CHECK_EQUAL(RuleMatcher("a\\-b").getKind(), RuleMatcher::KIND_REGEX);
+}
+
+BOOST_AUTO_TEST_CASE(classifyInvalid)
+{
+	BOOST_CHECK_EQUAL(RuleMatcher("[abc").getKind(), RuleMatcher::KIND_INVALID);
+	BOOST_CHECK_EQUAL(RuleMatcher("abc\\").getKind(), RuleMatcher::KIND_INVALID);
+
+	BOOST_CHECK(!RuleMatcher("[abc").matches("[abc"));
+	BOOST_CHECK(!RuleMatcher("abc\\").matches("abc\\"));
+}
+
+BOOST_AUTO_TEST_CASE(matchLikeRegex)
+{
+	for (std::size_t e = 0; e < NUM_EXPRESSIONS; ++e)
+	{
+		RuleMatcher matcher(EXPRESSIONS[e]);
+		boost::regex regex(EXPRESSIONS[e]);
+
+		for (std::size_t s = 0; s < NUM_SUBJECTS; ++s)
+		{
+			BOOST_CHECK_MESSAGE(
+				matcher.matches(SUBJECTS[s]) == boost::regex_match(std::string(SUBJECTS[s]), regex),
+				"expression \"" << EXPRESSIONS[e] << "\" on \"" << SUBJECTS[s] << "\""
+			);
+		}
+	}
+}
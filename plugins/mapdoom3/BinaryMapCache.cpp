@@ -0,0 +1,445 @@
+#include "BinaryMapCache.h"
+
+#include "itextstream.h"
+#include "ipatch.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace map
+{
+
+namespace
+{
+	const char* const CACHE_FILE_EXTENSION = "cache";
+	const char MAGIC[4] = { 'D', 'R', 'M', 'C' };
+
+	const boost::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	const boost::uint64_t FNV_PRIME = 1099511628211ULL;
+
+	// Returns the number of bytes occupied by an array of the given records
+	template<typename RecordType>
+	std::size_t getArraySize(boost::uint32_t count)
+	{
+		return static_cast<std::size_t>(count) * sizeof(RecordType);
+	}
+
+	template<typename RecordType>
+	void writeArray(std::ostream& stream, const std::vector<RecordType>& records)
+	{
+		if (!records.empty())
+		{
+			stream.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(RecordType));
+		}
+	}
+}
+
+BinaryMapCache::BinaryMapCache() :
+	_header(NULL),
+	_entities(NULL),
+	_keyValues(NULL),
+	_primitives(NULL),
+	_faces(NULL),
+	_patchControls(NULL)
+{}
+
+std::string BinaryMapCache::getFilename(const std::string& mapFilename)
+{
+	return mapFilename + CACHE_FILE_EXTENSION;
+}
+
+boost::uint64_t BinaryMapCache::getContentHash(const std::string& mapText)
+{
+	// 64 bit FNV-1a
+	boost::uint64_t hash = FNV_OFFSET_BASIS;
+
+	for (std::string::const_iterator i = mapText.begin(); i != mapText.end(); ++i)
+	{
+		hash ^= static_cast<unsigned char>(*i);
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+bool BinaryMapCache::load(const std::string& filename, boost::uint64_t contentHash, std::size_t contentSize)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	cache::Header header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		header.version != cache::VERSION ||
+		header.contentHash != contentHash ||
+		header.contentSize != contentSize)
+	{
+		return false;
+	}
+
+	std::size_t size = sizeof(cache::Header) +
+		getArraySize<boost::uint32_t>(header.numStrings) +
+		header.stringDataSize +
+		getArraySize<cache::EntityRecord>(header.numEntities) +
+		getArraySize<cache::KeyValueRecord>(header.numKeyValues) +
+		getArraySize<cache::PrimitiveRecord>(header.numPrimitives) +
+		getArraySize<cache::FaceRecord>(header.numFaces) +
+		getArraySize<cache::PatchControlRecord>(header.numPatchControls);
+
+	// The section sizes must add up to the file size
+	file.seekg(0, std::ios::end);
+
+	if (static_cast<std::size_t>(file.tellg()) != size)
+	{
+		return false;
+	}
+
+	// Read the whole file in one go, the records are accessed in place
+	_buffer.resize(size);
+	std::memcpy(&_buffer[0], &header, sizeof(header));
+
+	file.seekg(sizeof(header), std::ios::beg);
+
+	if (!file.read(&_buffer[sizeof(header)], size - sizeof(header)))
+	{
+		return false;
+	}
+
+	const char* pos = &_buffer[0];
+
+	_header = reinterpret_cast<const cache::Header*>(pos);
+	pos += sizeof(cache::Header);
+
+	const boost::uint32_t* stringOffsets = reinterpret_cast<const boost::uint32_t*>(pos);
+	pos += getArraySize<boost::uint32_t>(header.numStrings);
+
+	const char* stringData = pos;
+	pos += header.stringDataSize;
+
+	_entities = reinterpret_cast<const cache::EntityRecord*>(pos);
+	pos += getArraySize<cache::EntityRecord>(header.numEntities);
+
+	_keyValues = reinterpret_cast<const cache::KeyValueRecord*>(pos);
+	pos += getArraySize<cache::KeyValueRecord>(header.numKeyValues);
+
+	_primitives = reinterpret_cast<const cache::PrimitiveRecord*>(pos);
+	pos += getArraySize<cache::PrimitiveRecord>(header.numPrimitives);
+
+	_faces = reinterpret_cast<const cache::FaceRecord*>(pos);
+	pos += getArraySize<cache::FaceRecord>(header.numFaces);
+
+	_patchControls = reinterpret_cast<const cache::PatchControlRecord*>(pos);
+
+	// Convert the string table, each string is null-terminated
+	_strings.clear();
+	_strings.reserve(header.numStrings);
+
+	for (std::size_t i = 0; i < header.numStrings; ++i)
+	{
+		if (stringOffsets[i] >= header.stringDataSize ||
+			std::memchr(stringData + stringOffsets[i], '\0', header.stringDataSize - stringOffsets[i]) == NULL)
+		{
+			return false;
+		}
+
+		_strings.push_back(std::string(stringData + stringOffsets[i]));
+	}
+
+	return validate();
+}
+
+bool BinaryMapCache::validate() const
+{
+	std::size_t nextKeyValue = 0;
+	std::size_t nextPrimitive = 0;
+
+	// The entities are referring to consecutive ranges of keyvalues and primitives
+	for (std::size_t i = 0; i < _header->numEntities; ++i)
+	{
+		const cache::EntityRecord& entity = _entities[i];
+
+		if (entity.firstKeyValue != nextKeyValue || entity.firstPrimitive != nextPrimitive)
+		{
+			return false;
+		}
+
+		nextKeyValue += entity.numKeyValues;
+		nextPrimitive += entity.numPrimitives;
+	}
+
+	if (nextKeyValue != _header->numKeyValues || nextPrimitive != _header->numPrimitives)
+	{
+		return false;
+	}
+
+	for (std::size_t i = 0; i < _header->numKeyValues; ++i)
+	{
+		if (_keyValues[i].key >= _strings.size() || _keyValues[i].value >= _strings.size())
+		{
+			return false;
+		}
+	}
+
+	std::size_t nextFace = 0;
+	std::size_t nextPatchControl = 0;
+
+	for (std::size_t i = 0; i < _header->numPrimitives; ++i)
+	{
+		const cache::PrimitiveRecord& primitive = _primitives[i];
+
+		switch (primitive.type)
+		{
+		case cache::PRIMITIVE_BRUSHDEF3:
+			if (primitive.firstItem != nextFace) return false;
+			nextFace += primitive.numItems;
+			break;
+
+		case cache::PRIMITIVE_PATCHDEF2:
+		case cache::PRIMITIVE_PATCHDEF3:
+			if (primitive.firstItem != nextPatchControl ||
+				primitive.shader >= _strings.size() ||
+				static_cast<std::size_t>(primitive.width) * primitive.height != primitive.numItems)
+			{
+				return false;
+			}
+			nextPatchControl += primitive.numItems;
+			break;
+
+		default:
+			return false;
+		}
+	}
+
+	if (nextFace != _header->numFaces || nextPatchControl != _header->numPatchControls)
+	{
+		return false;
+	}
+
+	for (std::size_t i = 0; i < _header->numFaces; ++i)
+	{
+		if (_faces[i].shader >= _strings.size())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::size_t BinaryMapCache::getNumEntities() const
+{
+	return _header != NULL ? _header->numEntities : 0;
+}
+
+const cache::EntityRecord& BinaryMapCache::getEntity(std::size_t index) const
+{
+	return _entities[index];
+}
+
+const cache::KeyValueRecord& BinaryMapCache::getKeyValue(std::size_t index) const
+{
+	return _keyValues[index];
+}
+
+const cache::PrimitiveRecord& BinaryMapCache::getPrimitive(std::size_t index) const
+{
+	return _primitives[index];
+}
+
+const cache::FaceRecord& BinaryMapCache::getFace(std::size_t index) const
+{
+	return _faces[index];
+}
+
+const cache::PatchControlRecord& BinaryMapCache::getPatchControl(std::size_t index) const
+{
+	return _patchControls[index];
+}
+
+const std::string& BinaryMapCache::getString(std::size_t index) const
+{
+	return _strings[index];
+}
+
+BinaryMapCacheWriter::BinaryMapCacheWriter(boost::uint64_t contentHash, std::size_t contentSize)
+{
+	std::memset(&_header, 0, sizeof(_header));
+	std::memcpy(_header.magic, MAGIC, sizeof(MAGIC));
+
+	_header.version = cache::VERSION;
+	_header.contentHash = contentHash;
+	_header.contentSize = contentSize;
+}
+
+void BinaryMapCacheWriter::addEntity(const KeyValues& keyValues)
+{
+	cache::EntityRecord entity;
+
+	entity.firstKeyValue = static_cast<boost::uint32_t>(_keyValues.size());
+	entity.numKeyValues = static_cast<boost::uint32_t>(keyValues.size());
+	entity.firstPrimitive = static_cast<boost::uint32_t>(_primitives.size());
+	entity.numPrimitives = 0;
+
+	_entities.push_back(entity);
+
+	for (KeyValues::const_iterator i = keyValues.begin(); i != keyValues.end(); ++i)
+	{
+		cache::KeyValueRecord keyValue;
+
+		keyValue.key = getStringIndex(i->first);
+		keyValue.value = getStringIndex(i->second);
+
+		_keyValues.push_back(keyValue);
+	}
+}
+
+void BinaryMapCacheWriter::addBrush(const BrushDef3Faces& faces)
+{
+	cache::PrimitiveRecord& primitive = addPrimitive(cache::PRIMITIVE_BRUSHDEF3);
+
+	primitive.firstItem = static_cast<boost::uint32_t>(_faces.size());
+	primitive.numItems = static_cast<boost::uint32_t>(faces.size());
+
+	for (BrushDef3Faces::const_iterator i = faces.begin(); i != faces.end(); ++i)
+	{
+		cache::FaceRecord face;
+
+		// The parsers are reading single precision values, so this is lossless
+		face.plane[0] = static_cast<float>(i->plane.normal().x());
+		face.plane[1] = static_cast<float>(i->plane.normal().y());
+		face.plane[2] = static_cast<float>(i->plane.normal().z());
+		face.plane[3] = static_cast<float>(i->plane.dist());
+
+		face.texdef[0] = static_cast<float>(i->texdef.xx());
+		face.texdef[1] = static_cast<float>(i->texdef.yx());
+		face.texdef[2] = static_cast<float>(i->texdef.tx());
+		face.texdef[3] = static_cast<float>(i->texdef.xy());
+		face.texdef[4] = static_cast<float>(i->texdef.yy());
+		face.texdef[5] = static_cast<float>(i->texdef.ty());
+
+		face.shader = getStringIndex(i->shader);
+
+		_faces.push_back(face);
+	}
+}
+
+void BinaryMapCacheWriter::addPatch(const IPatch& patch, bool patchDef3)
+{
+	cache::PrimitiveRecord& primitive = addPrimitive(
+		patchDef3 ? cache::PRIMITIVE_PATCHDEF3 : cache::PRIMITIVE_PATCHDEF2);
+
+	primitive.shader = getStringIndex(patch.getShader());
+	primitive.width = static_cast<boost::uint32_t>(patch.getWidth());
+	primitive.height = static_cast<boost::uint32_t>(patch.getHeight());
+	primitive.firstItem = static_cast<boost::uint32_t>(_patchControls.size());
+	primitive.numItems = primitive.width * primitive.height;
+
+	if (patchDef3)
+	{
+		Subdivisions subdivisions = patch.getSubdivisions();
+		primitive.subdivX = subdivisions.x();
+		primitive.subdivY = subdivisions.y();
+	}
+
+	// Same order as in the map file: column-major
+	for (std::size_t c = 0; c < patch.getWidth(); ++c)
+	{
+		for (std::size_t r = 0; r < patch.getHeight(); ++r)
+		{
+			const PatchControl& ctrl = patch.ctrlAt(r, c);
+			cache::PatchControlRecord record;
+
+			record.vertex[0] = static_cast<float>(ctrl.vertex[0]);
+			record.vertex[1] = static_cast<float>(ctrl.vertex[1]);
+			record.vertex[2] = static_cast<float>(ctrl.vertex[2]);
+			record.texcoord[0] = static_cast<float>(ctrl.texcoord[0]);
+			record.texcoord[1] = static_cast<float>(ctrl.texcoord[1]);
+
+			_patchControls.push_back(record);
+		}
+	}
+}
+
+cache::PrimitiveRecord& BinaryMapCacheWriter::addPrimitive(cache::PrimitiveType type)
+{
+	cache::PrimitiveRecord primitive;
+	std::memset(&primitive, 0, sizeof(primitive));
+
+	primitive.type = type;
+
+	_primitives.push_back(primitive);
+	_entities.back().numPrimitives++;
+
+	return _primitives.back();
+}
+
+boost::uint32_t BinaryMapCacheWriter::getStringIndex(const std::string& str)
+{
+	StringIndexMap::const_iterator found = _stringIndices.find(str);
+
+	if (found != _stringIndices.end())
+	{
+		return found->second;
+	}
+
+	boost::uint32_t index = static_cast<boost::uint32_t>(_stringOffsets.size());
+
+	_stringIndices.insert(StringIndexMap::value_type(str, index));
+	_stringOffsets.push_back(static_cast<boost::uint32_t>(_stringData.size()));
+
+	_stringData.append(str.c_str(), str.size() + 1);
+
+	return index;
+}
+
+bool BinaryMapCacheWriter::save(const std::string& filename)
+{
+	// Keep the following records 4-byte aligned
+	_stringData.resize((_stringData.size() + 3) & ~static_cast<std::size_t>(3), '\0');
+
+	_header.numStrings = static_cast<boost::uint32_t>(_stringOffsets.size());
+	_header.stringDataSize = static_cast<boost::uint32_t>(_stringData.size());
+	_header.numEntities = static_cast<boost::uint32_t>(_entities.size());
+	_header.numKeyValues = static_cast<boost::uint32_t>(_keyValues.size());
+	_header.numPrimitives = static_cast<boost::uint32_t>(_primitives.size());
+	_header.numFaces = static_cast<boost::uint32_t>(_faces.size());
+	_header.numPatchControls = static_cast<boost::uint32_t>(_patchControls.size());
+
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		rError() << "[mapdoom3] Could not open map cache file for writing: " << filename << std::endl;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+	writeArray(file, _stringOffsets);
+	file.write(_stringData.data(), _stringData.size());
+	writeArray(file, _entities);
+	writeArray(file, _keyValues);
+	writeArray(file, _primitives);
+	writeArray(file, _faces);
+	writeArray(file, _patchControls);
+
+	if (!file)
+	{
+		file.close();
+
+		// Don't leave a truncated cache file behind
+		std::remove(filename.c_str());
+
+		rError() << "[mapdoom3] Failed to write map cache file: " << filename << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+} // namespace map
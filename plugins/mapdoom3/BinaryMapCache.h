@@ -0,0 +1,188 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "primitiveparsers/BrushDef3.h"
+
+class IPatch;
+
+namespace map
+{
+
+const char* const RKEY_MAP_USE_BINARY_CACHE = "user/ui/map/useBinaryCache";
+
+/**
+ * The binary map cache is a sidecar file stored next to a map file
+ * (mymap.map => mymap.mapcache), holding everything needed to reconstruct
+ * the map's scene without parsing the text: the entity spawnargs, the brush
+ * planes and texdefs and the patch control points. All strings (spawnargs,
+ * shader names) are interned in a single string table.
+ *
+ * The file consists of a header followed by arrays of fixed-size, 4-byte
+ * aligned records, which are accessed in place after loading the file.
+ * The cache is keyed by a hash of the map text, a cache file not matching
+ * the map it is sitting next to is ignored.
+ */
+namespace cache
+{
+
+const boost::uint32_t VERSION = 1;
+
+enum PrimitiveType
+{
+	PRIMITIVE_BRUSHDEF3 = 0,
+	PRIMITIVE_PATCHDEF2 = 1,
+	PRIMITIVE_PATCHDEF3 = 2,
+};
+
+struct Header
+{
+	char magic[4];
+	boost::uint32_t version;
+	boost::uint64_t contentHash;
+	boost::uint64_t contentSize;
+
+	boost::uint32_t numStrings;
+	boost::uint32_t stringDataSize;	// padded to a multiple of 4
+	boost::uint32_t numEntities;
+	boost::uint32_t numKeyValues;
+	boost::uint32_t numPrimitives;
+	boost::uint32_t numFaces;
+	boost::uint32_t numPatchControls;
+	boost::uint32_t reserved;
+};
+
+struct EntityRecord
+{
+	boost::uint32_t firstKeyValue;
+	boost::uint32_t numKeyValues;
+	boost::uint32_t firstPrimitive;
+	boost::uint32_t numPrimitives;
+};
+
+struct KeyValueRecord
+{
+	boost::uint32_t key;	// string index
+	boost::uint32_t value;	// string index
+};
+
+struct PrimitiveRecord
+{
+	boost::uint32_t type;		// PrimitiveType
+	boost::uint32_t shader;		// string index, patches only
+	boost::uint32_t firstItem;	// index of the first face or patch control
+	boost::uint32_t numItems;
+	boost::uint32_t width;		// patch dimensions
+	boost::uint32_t height;
+	boost::uint32_t subdivX;	// fixed patch subdivisions (patchDef3 only)
+	boost::uint32_t subdivY;
+};
+
+struct FaceRecord
+{
+	float plane[4];		// normal and distance
+	float texdef[6];	// xx, yx, tx, xy, yy, ty
+	boost::uint32_t shader;	// string index
+};
+
+struct PatchControlRecord
+{
+	float vertex[3];
+	float texcoord[2];
+};
+
+} // namespace cache
+
+/**
+ * Read access to a loaded cache file.
+ */
+class BinaryMapCache
+{
+private:
+	std::vector<char> _buffer;
+
+	const cache::Header* _header;
+	const cache::EntityRecord* _entities;
+	const cache::KeyValueRecord* _keyValues;
+	const cache::PrimitiveRecord* _primitives;
+	const cache::FaceRecord* _faces;
+	const cache::PatchControlRecord* _patchControls;
+
+	// The string table, converted once on load
+	std::vector<std::string> _strings;
+
+public:
+	BinaryMapCache();
+
+	// Returns the name of the cache file belonging to the given map file
+	static std::string getFilename(const std::string& mapFilename);
+
+	// Returns the hash value the cache is keyed with
+	static boost::uint64_t getContentHash(const std::string& mapText);
+
+	/**
+	 * Loads the given cache file. Returns false if the file doesn't exist,
+	 * is damaged or doesn't belong to the map text with the given hash and size.
+	 * All record indices are range-checked here, so the accessors can trust them.
+	 */
+	bool load(const std::string& filename, boost::uint64_t contentHash, std::size_t contentSize);
+
+	std::size_t getNumEntities() const;
+
+	const cache::EntityRecord& getEntity(std::size_t index) const;
+	const cache::KeyValueRecord& getKeyValue(std::size_t index) const;
+	const cache::PrimitiveRecord& getPrimitive(std::size_t index) const;
+	const cache::FaceRecord& getFace(std::size_t index) const;
+	const cache::PatchControlRecord& getPatchControl(std::size_t index) const;
+	const std::string& getString(std::size_t index) const;
+
+private:
+	bool validate() const;
+};
+
+/**
+ * Assembles the records of a map, in file order, and writes them to a cache file.
+ */
+class BinaryMapCacheWriter
+{
+public:
+	typedef std::map<std::string, std::string> KeyValues;
+
+private:
+	cache::Header _header;
+
+	std::vector<cache::EntityRecord> _entities;
+	std::vector<cache::KeyValueRecord> _keyValues;
+	std::vector<cache::PrimitiveRecord> _primitives;
+	std::vector<cache::FaceRecord> _faces;
+	std::vector<cache::PatchControlRecord> _patchControls;
+
+	// String interning, strings are stored in order of appearance
+	typedef std::map<std::string, boost::uint32_t> StringIndexMap;
+	StringIndexMap _stringIndices;
+	std::vector<boost::uint32_t> _stringOffsets;
+	std::string _stringData;
+
+public:
+	BinaryMapCacheWriter(boost::uint64_t contentHash, std::size_t contentSize);
+
+	// Starts a new entity, the following primitives are added to it
+	void addEntity(const KeyValues& keyValues);
+
+	void addBrush(const BrushDef3Faces& faces);
+
+	// Adds the given patch, the subdivisions are only stored for patchDef3
+	void addPatch(const IPatch& patch, bool patchDef3);
+
+	// Writes the cache file, returns false on failure
+	bool save(const std::string& filename);
+
+private:
+	boost::uint32_t getStringIndex(const std::string& str);
+	cache::PrimitiveRecord& addPrimitive(cache::PrimitiveType type);
+};
+
+} // namespace map
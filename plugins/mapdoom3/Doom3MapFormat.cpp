@@ -8,6 +8,9 @@
 #include "igame.h"
 #include "iregistry.h"
 #include "igroupnode.h"
+#include "iradiant.h"
+#include "icommandsystem.h"
+#include "ipreferencesystem.h"
 
 #include "parser/DefTokeniser.h"
 
@@ -20,6 +23,8 @@
 
 #include "Doom3MapReader.h"
 #include "Doom3MapWriter.h"
+#include "MapBenchmark.h"
+#include "BinaryMapCache.h"
 
 namespace map
 {
@@ -44,6 +49,9 @@ const StringSet& Doom3MapFormat::getDependencies() const
 		_dependencies.insert(MODULE_PATCH + DEF3);
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_MAPFORMATMANAGER);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
+		_dependencies.insert(MODULE_RADIANT);
+		_dependencies.insert(MODULE_PREFERENCESYSTEM);
 	}
 
 	return _dependencies;
@@ -60,6 +68,16 @@ void Doom3MapFormat::initialiseModule(const ApplicationContext& ctx)
 	// Register the map file extension in the FileTypeRegistry
 	GlobalFiletypes().registerPattern("map", FileTypePattern(_("Doom 3 map"), "map", "*.map"));
 	GlobalFiletypes().registerPattern("map", FileTypePattern(_("Doom 3 region"), "reg", "*.reg"));
+
+	GlobalCommandSystem().addCommand("BenchmarkMapLoad", benchmark::loadMapCmd,
+		cmd::ARGTYPE_INT | cmd::ARGTYPE_OPTIONAL);
+	GlobalCommandSystem().addCommand("BenchmarkMapSave", benchmark::saveMapCmd,
+		cmd::ARGTYPE_INT | cmd::ARGTYPE_OPTIONAL);
+	GlobalCommandSystem().addCommand("BenchmarkEntities", benchmark::entitiesCmd,
+		cmd::ARGTYPE_INT | cmd::ARGTYPE_OPTIONAL);
+
+	PreferencesPagePtr page = GlobalPreferenceSystem().getPage(_("Settings/Map Files"));
+	page->appendCheckBox("", _("Keep a binary cache next to map files for faster loading"), RKEY_MAP_USE_BINARY_CACHE);
 }
 
 void Doom3MapFormat::shutdownModule()
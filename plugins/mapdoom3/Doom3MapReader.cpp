@@ -1,14 +1,21 @@
 #include "Doom3MapReader.h"
 
 #include "itextstream.h"
+#include "ibrush.h"
+#include "iradiant.h"
+#include "ithread.h"
 #include "ieclass.h"
 #include "igame.h"
 #include "ientity.h"
+#include "ipatch.h"
 #include "string/string.h"
+#include "registry/registry.h"
 
 #include "Doom3MapFormat.h"
 
 #include "i18n.h"
+#include <iterator>
+#include <boost/bind.hpp>
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -19,6 +26,94 @@
 
 namespace map {
 
+namespace
+{
+	typedef std::pair<std::size_t, std::size_t> BracePositions;
+	typedef std::vector<BracePositions> BlockList;
+
+	/**
+	 * Scans the text range [begin, end) for brace blocks on the top level, skipping
+	 * quoted strings and comments the same way the DefTokeniser does. The positions
+	 * of the opening and matching closing brace of each block are added to the
+	 * given list. Throws a ParseException on unbalanced braces.
+	 */
+	void findBlocks(const std::string& text, std::size_t begin, std::size_t end,
+					BlockList& blocks)
+	{
+		std::size_t depth = 0;
+		std::size_t blockStart = 0;
+
+		for (std::size_t i = begin; i < end; ++i)
+		{
+			switch (text[i])
+			{
+			case '"':
+				// Skip over quoted content
+				i = text.find('"', i + 1);
+
+				if (i == std::string::npos || i >= end)
+				{
+					throw parser::ParseException("Missing closing quote");
+				}
+				break;
+
+			case '/':
+				if (i + 1 < end && text[i + 1] == '/')
+				{
+					// Skip to the end of the line
+					i = text.find('\n', i + 2);
+					i = (i == std::string::npos || i >= end) ? end : i;
+				}
+				else if (i + 1 < end && text[i + 1] == '*')
+				{
+					std::size_t commentEnd = text.find("*/", i + 2);
+					i = (commentEnd == std::string::npos || commentEnd >= end) ? end : commentEnd + 1;
+				}
+				break;
+
+			case '{':
+				if (depth++ == 0)
+				{
+					blockStart = i;
+				}
+				break;
+
+			case '}':
+				if (depth == 0)
+				{
+					throw parser::ParseException("Unexpected closing brace");
+				}
+
+				if (--depth == 0)
+				{
+					blocks.push_back(BracePositions(blockStart, i));
+				}
+				break;
+			}
+		}
+
+		if (depth > 0)
+		{
+			throw parser::ParseException("Missing closing brace");
+		}
+	}
+
+	// Throws a ParseException if there is anything but whitespace and comments in the given range
+	void assertNoTokens(const std::string& text, std::size_t begin, std::size_t end)
+	{
+		if (begin >= end) return;
+
+		std::string range = text.substr(begin, end - begin);
+		parser::BasicDefTokeniser<std::string> tok(range);
+
+		if (tok.hasMoreTokens())
+		{
+			throw parser::ParseException("DefTokeniser: Assertion failed: Required \"{\", found \"" +
+				tok.nextToken() + "\"");
+		}
+	}
+}
+
 Doom3MapReader::Doom3MapReader(IMapImportFilter& importFilter) : 
 	_importFilter(importFilter),
 	_entityCount(0),
@@ -26,37 +121,148 @@ Doom3MapReader::Doom3MapReader(IMapImportFilter& importFilter) :
 {}
 
 void Doom3MapReader::readFromStream(std::istream& stream)
+{
+	readFromFile(stream, std::string());
+}
+
+void Doom3MapReader::readFromFile(std::istream& stream, const std::string& filename)
 {
 	// Call the virtual method to initialise the primitve parser map (if not done yet)
 	initPrimitiveParsers();
 
-	// The tokeniser used to split the stream into pieces
-	parser::BasicDefTokeniser<std::istream> tok(stream);
+	// Read the whole map text, the blocks below are referring to it by position
+	std::string text((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+	bool useCache = !filename.empty() && registry::getValue<bool>(RKEY_MAP_USE_BINARY_CACHE);
+
+	std::string cacheFilename;
+	boost::uint64_t contentHash = 0;
+
+	if (useCache)
+	{
+		cacheFilename = BinaryMapCache::getFilename(filename);
+		contentHash = BinaryMapCache::getContentHash(text);
+
+		BinaryMapCache cache;
+
+		if (cache.load(cacheFilename, contentHash, text.size()))
+		{
+			rMessage() << "[mapdoom3] Loading map from cache file " << cacheFilename << std::endl;
+
+			MapNodes nodes;
+			createNodesFromCache(cache, nodes);
+			insertNodes(nodes);
+
+			return;
+		}
+	}
+
+	EntityBlocks entities;
+	parseText(text, entities);
+
+	// Create the nodes on this thread, in the order of the map file
+	MapNodes nodes;
+	nodes.primitives.resize(entities.size());
 
-	// Try to parse the map version (throws on failure)
-	parseMapVersion(tok);
+	std::string errorMessage;
 
-	// Read each entity in the map, until EOF is reached
-	while (tok.hasMoreTokens())
+	for (_entityCount = 0; _entityCount < entities.size(); ++_entityCount)
 	{
-		// Create an entity node by parsing from the stream. If there is an
-		// exception, display it and return
 		try
 		{
-			parseEntity(tok);
+			nodes.entities.push_back(createEntityNode(text, entities[_entityCount], 
+				nodes.primitives[_entityCount], nodes.brushes));
 		}
 		catch (FailureException& e)
 		{
-			std::string text = (boost::format(_("Failed parsing entity %d:\n%s")) % _entityCount % e.what()).str();
-
-			// Re-throw with more text
-			throw FailureException(text);
+			errorMessage = (boost::format(_("Failed parsing entity %d:\n%s")) % _entityCount % e.what()).str();
+			break;
 		}
+	}
+
+	insertNodes(nodes);
 
-		_entityCount++;
+	if (!errorMessage.empty())
+	{
+		throw FailureException(errorMessage);
 	}
 
 	// EOF reached, success
+	if (useCache)
+	{
+		writeCache(cacheFilename, contentHash, text.size(), entities, nodes);
+	}
+}
+
+void Doom3MapReader::parseText(const std::string& text, EntityBlocks& entities)
+{
+	// Locate the entity blocks on the top level
+	BlockList entityBraces;
+
+	try
+	{
+		findBlocks(text, 0, text.size(), entityBraces);
+	}
+	catch (parser::ParseException& e)
+	{
+		std::string message = (boost::format(_("Failed parsing entity %d:\n%s")) % entityBraces.size() % e.what()).str();
+		throw FailureException(message);
+	}
+
+	// The version tag precedes the first entity
+	{
+		std::string header = text.substr(0, entityBraces.empty() ? text.size() : entityBraces.front().first);
+		parser::BasicDefTokeniser<std::string> tok(header);
+
+		// Try to parse the map version (throws on failure)
+		parseMapVersion(tok);
+
+		if (tok.hasMoreTokens())
+		{
+			std::string message = (boost::format(_("Failed parsing entity %d:\n%s")) % 0 %
+				("DefTokeniser: Assertion failed: Required \"{\", found \"" + tok.nextToken() + "\"")).str();
+			throw FailureException(message);
+		}
+	}
+
+	// Split each entity into spawnargs and primitive blocks
+	entities.resize(entityBraces.size());
+	std::vector<PrimitiveBlock*> primitiveBlocks;
+
+	for (std::size_t i = 0; i < entityBraces.size(); ++i)
+	{
+		try
+		{
+			splitEntityBlock(text, entityBraces[i].first + 1, entityBraces[i].second, entities[i]);
+
+			// Nothing but whitespace is allowed up to the next entity
+			assertNoTokens(text, entityBraces[i].second + 1,
+				i + 1 < entityBraces.size() ? entityBraces[i + 1].first : text.size());
+		}
+		catch (parser::ParseException& e)
+		{
+			std::string message = (boost::format(_("Failed parsing entity %d:\n%s")) % i % e.what()).str();
+			throw FailureException(message);
+		}
+
+		for (PrimitiveBlocks::iterator p = entities[i].primitives.begin(); 
+			 p != entities[i].primitives.end(); ++p)
+		{
+			primitiveBlocks.push_back(&(*p));
+		}
+	}
+
+	// Parse the primitives in parallel, this doesn't create any nodes yet
+	try
+	{
+		GlobalRadiant().getThreadManager().executeInChunks(primitiveBlocks.size(),
+			boost::bind(&Doom3MapReader::parsePrimitiveBlocks, this, 
+						boost::cref(text), boost::cref(primitiveBlocks), _1, _2));
+	}
+	catch (std::runtime_error& e)
+	{
+		throw FailureException(e.what());
+	}
 }
 
 void Doom3MapReader::initPrimitiveParsers()
@@ -73,6 +279,14 @@ void Doom3MapReader::initPrimitiveParsers()
 void Doom3MapReader::addPrimitiveParser(const PrimitiveParserPtr& parser)
 {
 	_primitiveParsers.insert(PrimitiveParsers::value_type(parser->getKeyword(), parser));
+
+	// brushDef3 primitives can be parsed on worker threads
+	BrushDef3ParserPtr brushDef3Parser = boost::dynamic_pointer_cast<BrushDef3Parser>(parser);
+
+	if (brushDef3Parser)
+	{
+		_brushDef3Parser = brushDef3Parser;
+	}
 }
 
 void Doom3MapReader::parseMapVersion(parser::DefTokeniser& tok)
@@ -118,44 +332,6 @@ void Doom3MapReader::parseMapVersion(parser::DefTokeniser& tok)
 	// success
 }
 
-void Doom3MapReader::parsePrimitive(parser::DefTokeniser& tok, const scene::INodePtr& parentEntity)
-{
-    _primitiveCount++;
-
-	std::string primitiveKeyword = tok.nextToken();
-
-	// Get a parser for this keyword
-	PrimitiveParsers::const_iterator p = _primitiveParsers.find(primitiveKeyword);
-
-	if (p == _primitiveParsers.end())
-	{
-		throw FailureException("Unknown primitive type: " + primitiveKeyword);
-	}
-
-	const PrimitiveParserPtr& parser = p->second;
-
-	// Try to parse the primitive, throwing exception if failed
-	try
-	{
-		scene::INodePtr primitive = parser->parse(tok);
-
-		if (!primitive)
-		{
-			std::string text = (boost::format(_("Primitive #%d: parse error")) % _primitiveCount).str();
-			throw FailureException(text);
-		}
-
-		// Now add the primitive as a child of the entity
-		_importFilter.addPrimitiveToEntity(primitive, parentEntity); 
-	}
-	catch (parser::ParseException& e)
-	{
-		// Translate ParseExceptions to FailureExceptions
-		std::string text = (boost::format(_("Primitive #%d: parse exception %s")) % _primitiveCount % e.what()).str();
-		throw FailureException(text);
-	}
-}
-
 scene::INodePtr Doom3MapReader::createEntity(const EntityKeyValues& keyValues)
 {
     // Get the classname from the EntityKeyValues
@@ -192,70 +368,330 @@ scene::INodePtr Doom3MapReader::createEntity(const EntityKeyValues& keyValues)
     return node;
 }
 
-void Doom3MapReader::parseEntity(parser::DefTokeniser& tok)
+void Doom3MapReader::splitEntityBlock(const std::string& text, std::size_t begin, std::size_t end,
+										EntityBlock& block)
+{
+	BlockList primitiveBraces;
+	findBlocks(text, begin, end, primitiveBraces);
+
+	// The spawnargs are found between the primitive blocks
+	std::size_t keyValueStart = begin;
+
+	for (BlockList::const_iterator i = primitiveBraces.begin(); i != primitiveBraces.end(); ++i)
+	{
+		block.keyValueText.push_back(EntityBlock::TextRange(keyValueStart, i->first));
+
+		// The primitive parsers expect the closing brace to be part of the text
+		block.primitives.push_back(PrimitiveBlock(i->first + 1, i->second + 1));
+
+		keyValueStart = i->second + 1;
+	}
+
+	block.keyValueText.push_back(EntityBlock::TextRange(keyValueStart, end));
+}
+
+void Doom3MapReader::parsePrimitiveBlocks(const std::string& text,
+										  const std::vector<PrimitiveBlock*>& blocks,
+										  std::size_t first, std::size_t last)
+{
+	if (!_brushDef3Parser) return;
+
+	for (std::size_t i = first; i < last; ++i)
+	{
+		PrimitiveBlock& block = *blocks[i];
+
+		try
+		{
+			std::string primitiveText = text.substr(block.begin, block.end - block.begin);
+			parser::BasicDefTokeniser<std::string> tok(primitiveText);
+
+			block.keyword = tok.nextToken();
+
+			// Any other primitive type is left to the main thread
+			if (block.keyword == _brushDef3Parser->getKeyword())
+			{
+				_brushDef3Parser->parseFaces(tok, block.faces);
+				block.parsed = true;
+			}
+		}
+		catch (std::exception& e)
+		{
+			block.error = e.what();
+		}
+	}
+}
+
+scene::INodePtr Doom3MapReader::createEntityNode(const std::string& text, EntityBlock& block,
+												 std::vector<scene::INodePtr>& primitives,
+												 std::vector<IBrush*>& brushes)
 {
-    // Map of keyvalues for this entity
-    EntityKeyValues keyValues;
+	// Map of keyvalues for this entity
+	EntityKeyValues& keyValues = block.keyValues;
+
+	for (std::size_t i = 0; i < block.keyValueText.size(); ++i)
+	{
+		const EntityBlock::TextRange& range = block.keyValueText[i];
+
+		std::string keyValueText = text.substr(range.first, range.second - range.first);
+		parser::BasicDefTokeniser<std::string> tok(keyValueText);
+
+		while (tok.hasMoreTokens())
+		{
+			std::string key = tok.nextToken();
+
+			// Sanity check (invalid number of tokens will get us out of sync)
+			if (!tok.hasMoreTokens())
+			{
+				std::string value = i < block.primitives.size() ? "{" : "}";
+				std::string message = (boost::format(_("Parsed invalid value '%s' for key '%s'")) % value % key).str();
+				throw FailureException(message);
+			}
 
-    // The actual entity. This is initially null, and will be created when
-    // primitives start or the end of the entity is reached
-    scene::INodePtr entity;
+			std::string value = tok.nextToken();
 
-	// Start parsing, first token must be an open brace
-	tok.assertNextToken("{");
+			// Spawnargs following the first primitive don't make it into the entity
+			if (i == 0)
+			{
+				keyValues.insert(EntityKeyValues::value_type(key, value));
+			}
+		}
+	}
 
-	std::string token = tok.nextToken();
+	scene::INodePtr entity = createEntity(keyValues);
 
 	// Reset the primitive counter, we're starting a new entity
 	_primitiveCount = 0;
 
-	while (true)
+	for (PrimitiveBlocks::iterator i = block.primitives.begin(); i != block.primitives.end(); ++i)
+	{
+		_primitiveCount++;
+
+		scene::INodePtr primitive = createPrimitive(text, *i);
+		primitives.push_back(primitive);
+
+		if (i->parsed)
+		{
+			brushes.push_back(&boost::dynamic_pointer_cast<IBrushNode>(primitive)->getIBrush());
+		}
+	}
+
+	return entity;
+}
+
+scene::INodePtr Doom3MapReader::createPrimitive(const std::string& text, PrimitiveBlock& block)
+{
+	try
 	{
-	    // Token must be either a key, a "{" to indicate the start of a
-	    // primitive, or a "}" to indicate the end of the entity
+		if (!block.error.empty())
+		{
+			throw parser::ParseException(block.error);
+		}
 
-	    if (token == "{") // PRIMITIVE
-		{ 
-			// Create the entity right now, if not yet done
-			if (entity == NULL)
+		scene::INodePtr primitive;
+
+		if (block.parsed)
+		{
+			// The faces are kept around for the binary cache
+			primitive = BrushDef3Parser::createBrush(block.faces);
+		}
+		else
+		{
+			std::string primitiveText = text.substr(block.begin, block.end - block.begin);
+			parser::BasicDefTokeniser<std::string> tok(primitiveText);
+
+			block.keyword = tok.nextToken();
+
+			// Get a parser for this keyword
+			PrimitiveParsers::const_iterator p = _primitiveParsers.find(block.keyword);
+
+			if (p == _primitiveParsers.end())
 			{
-				entity = createEntity(keyValues);
+				throw FailureException("Unknown primitive type: " + block.keyword);
 			}
 
-			// Parse the primitive block, and pass the parent entity
-			parsePrimitive(tok, entity);
-	    }
-	    else if (token == "}") // END OF ENTITY
+			primitive = p->second->parse(tok);
+		}
+
+		if (!primitive)
+		{
+			std::string message = (boost::format(_("Primitive #%d: parse error")) % _primitiveCount).str();
+			throw FailureException(message);
+		}
+
+		return primitive;
+	}
+	catch (parser::ParseException& e)
+	{
+		// Translate ParseExceptions to FailureExceptions
+		std::string message = (boost::format(_("Primitive #%d: parse exception %s")) % _primitiveCount % e.what()).str();
+		throw FailureException(message);
+	}
+}
+
+void Doom3MapReader::evaluateBReps(const std::vector<IBrush*>& brushes)
+{
+	if (brushes.empty()) return;
+
+	try
+	{
+		GlobalBrushCreator().evaluateBReps(brushes);
+	}
+	catch (std::runtime_error& e)
+	{
+		throw FailureException(e.what());
+	}
+}
+
+void Doom3MapReader::insertNodes(const MapNodes& nodes)
+{
+	// Build the brush windings in parallel, before the import filter inserts 
+	// the nodes into the scene (which would evaluate them one by one)
+	evaluateBReps(nodes.brushes);
+
+	// Hand the nodes to the import filter
+	for (std::size_t i = 0; i < nodes.entities.size(); ++i)
+	{
+		const std::vector<scene::INodePtr>& primitives = nodes.primitives[i];
+
+		for (std::vector<scene::INodePtr>::const_iterator p = primitives.begin(); 
+			 p != primitives.end(); ++p)
+		{
+			_importFilter.addPrimitiveToEntity(*p, nodes.entities[i]);
+		}
+
+		_importFilter.addEntity(nodes.entities[i]);
+	}
+}
+
+void Doom3MapReader::createNodesFromCache(const BinaryMapCache& cache, MapNodes& nodes)
+{
+	nodes.primitives.resize(cache.getNumEntities());
+
+	BrushDef3Faces faces;
+
+	for (std::size_t e = 0; e < cache.getNumEntities(); ++e)
+	{
+		const cache::EntityRecord& entity = cache.getEntity(e);
+
+		EntityKeyValues keyValues;
+
+		for (std::size_t i = entity.firstKeyValue; i < entity.firstKeyValue + entity.numKeyValues; ++i)
 		{
-            // Create the entity if necessary and return it
-	        if (entity == NULL)
+			const cache::KeyValueRecord& keyValue = cache.getKeyValue(i);
+			keyValues.insert(EntityKeyValues::value_type(cache.getString(keyValue.key), cache.getString(keyValue.value)));
+		}
+
+		nodes.entities.push_back(createEntity(keyValues));
+
+		for (std::size_t p = entity.firstPrimitive; p < entity.firstPrimitive + entity.numPrimitives; ++p)
+		{
+			const cache::PrimitiveRecord& primitive = cache.getPrimitive(p);
+
+			if (primitive.type == cache::PRIMITIVE_BRUSHDEF3)
 			{
-	            entity = createEntity(keyValues);
-	        }
+				faces.resize(primitive.numItems);
 
-			break;
-	    }
-	    else // KEY
-		{ 
-	        std::string value = tok.nextToken();
+				for (std::size_t i = 0; i < primitive.numItems; ++i)
+				{
+					const cache::FaceRecord& record = cache.getFace(primitive.firstItem + i);
+					BrushDef3Face& face = faces[i];
+
+					face.plane = Plane3(record.plane[0], record.plane[1], record.plane[2], record.plane[3]);
+
+					face.texdef = Matrix4::getIdentity();
+					face.texdef.xx() = record.texdef[0];
+					face.texdef.yx() = record.texdef[1];
+					face.texdef.tx() = record.texdef[2];
+					face.texdef.xy() = record.texdef[3];
+					face.texdef.yy() = record.texdef[4];
+					face.texdef.ty() = record.texdef[5];
+
+					face.shader = cache.getString(record.shader);
+				}
 
-	        // Sanity check (invalid number of tokens will get us out of sync)
-	        if (value == "{" || value == "}")
+				scene::INodePtr node = BrushDef3Parser::createBrush(faces);
+
+				nodes.primitives[e].push_back(node);
+				nodes.brushes.push_back(Node_getIBrush(node));
+			}
+			else
+			{
+				bool patchDef3 = primitive.type == cache::PRIMITIVE_PATCHDEF3;
+
+				scene::INodePtr node = GlobalPatchCreator(patchDef3 ? DEF3 : DEF2).createPatch();
+				IPatch& patch = boost::dynamic_pointer_cast<IPatchNode>(node)->getPatch();
+
+				patch.setShader(cache.getString(primitive.shader));
+				patch.setDims(primitive.width, primitive.height);
+
+				if (patchDef3)
+				{
+					patch.setFixedSubdivisions(true, Subdivisions(primitive.subdivX, primitive.subdivY));
+				}
+
+				// Column-major, like in the map file
+				std::size_t i = primitive.firstItem;
+
+				for (std::size_t c = 0; c < primitive.width; ++c)
+				{
+					for (std::size_t r = 0; r < primitive.height; ++r, ++i)
+					{
+						const cache::PatchControlRecord& record = cache.getPatchControl(i);
+						PatchControl& ctrl = patch.ctrlAt(r, c);
+
+						ctrl.vertex = Vector3(record.vertex[0], record.vertex[1], record.vertex[2]);
+						ctrl.texcoord = Vector2(record.texcoord[0], record.texcoord[1]);
+					}
+				}
+
+				patch.controlPointsChanged();
+
+				nodes.primitives[e].push_back(node);
+			}
+		}
+	}
+}
+
+void Doom3MapReader::writeCache(const std::string& filename, boost::uint64_t contentHash, std::size_t contentSize,
+								const EntityBlocks& entities, const MapNodes& nodes)
+{
+	BinaryMapCacheWriter writer(contentHash, contentSize);
+
+	for (std::size_t e = 0; e < entities.size(); ++e)
+	{
+		writer.addEntity(entities[e].keyValues);
+
+		const PrimitiveBlocks& primitives = entities[e].primitives;
+
+		for (std::size_t p = 0; p < primitives.size(); ++p)
+		{
+			const PrimitiveBlock& block = primitives[p];
+
+			if (block.parsed)
 			{
-				std::string text = (boost::format(_("Parsed invalid value '%s' for key '%s'")) % value % token).str();
-	            throw FailureException(text);
-	        }
+				writer.addBrush(block.faces);
+				continue;
+			}
+
+			IPatchNodePtr patchNode = boost::dynamic_pointer_cast<IPatchNode>(nodes.primitives[e][p]);
 
-	        // Otherwise add the keyvalue pair to our map
-	        keyValues.insert(EntityKeyValues::value_type(token, value));
-	    }
+			if (patchNode && (block.keyword == "patchDef2" || block.keyword == "patchDef3"))
+			{
+				writer.addPatch(patchNode->getPatch(), block.keyword == "patchDef3");
+				continue;
+			}
 
-	    // Get the next token
-	    token = tok.nextToken();
+			// Other primitive types (like the old brushDef) are not supported by the cache
+			rMessage() << "[mapdoom3] Not writing map cache, unsupported primitive type " <<
+				block.keyword << std::endl;
+			return;
+		}
 	}
 
-	// Insert the entity
-	_importFilter.addEntity(entity);
+	if (writer.save(filename))
+	{
+		rMessage() << "[mapdoom3] Wrote map cache file " << filename << std::endl;
+	}
 }
 
 } // namespace map
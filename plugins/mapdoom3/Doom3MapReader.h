@@ -2,12 +2,27 @@
 #define NODE_IMPORTER_H_
 
 #include <map>
+#include <vector>
 #include "inode.h"
 #include "imapformat.h"
 #include "parser/DefTokeniser.h"
+#include "primitiveparsers/BrushDef3.h"
+#include "BinaryMapCache.h"
+
+class IBrush;
 
 namespace map {
 
+/**
+ * Map reader for the Doom 3 map format. The map text is read into memory
+ * and split into entity and primitive blocks by brace matching. The
+ * brushDef3 primitives (usually the vast majority) are then parsed on
+ * worker threads, and their B-Reps are built in parallel too - only the
+ * node creation and the import filter calls happen on the calling thread.
+ *
+ * When reading from a map file with the binary cache enabled, the parsed map is
+ * stored in a sidecar file, which replaces the text parsing on the next load.
+ */
 class Doom3MapReader :
 	public IMapReader
 {
@@ -27,11 +42,61 @@ protected:
 	typedef std::map<std::string, PrimitiveParserPtr> PrimitiveParsers;
 	PrimitiveParsers _primitiveParsers;
 
+	// The parser for the brushDef3 keyword, if it supports parsing on worker threads
+	BrushDef3ParserPtr _brushDef3Parser;
+
+	// A primitive block, the text range starts right after the opening
+	// brace and includes the closing brace (which the parsers expect)
+	struct PrimitiveBlock
+	{
+		std::size_t begin;
+		std::size_t end;
+
+		// The primitive keyword, e.g. "brushDef3"
+		std::string keyword;
+
+		// True if the faces have been parsed by a worker thread
+		bool parsed;
+		BrushDef3Faces faces;
+
+		// Non-empty if the worker failed to parse this primitive
+		std::string error;
+
+		PrimitiveBlock(std::size_t begin_, std::size_t end_) :
+			begin(begin_),
+			end(end_),
+			parsed(false)
+		{}
+	};
+	typedef std::vector<PrimitiveBlock> PrimitiveBlocks;
+
+	// An entity block: the spawnarg text ranges plus its primitives
+	struct EntityBlock
+	{
+		typedef std::pair<std::size_t, std::size_t> TextRange;
+		std::vector<TextRange> keyValueText;
+
+		// The spawnargs applied to the entity
+		EntityKeyValues keyValues;
+
+		PrimitiveBlocks primitives;
+	};
+	typedef std::vector<EntityBlock> EntityBlocks;
+
+	// The nodes created from a map, in the order of the map file
+	struct MapNodes
+	{
+		std::vector<scene::INodePtr> entities;
+		std::vector< std::vector<scene::INodePtr> > primitives;
+		std::vector<IBrush*> brushes;
+	};
+
 public:
 	Doom3MapReader(IMapImportFilter& importFilter);
 
 	// IMapReader implementation
 	virtual void readFromStream(std::istream& stream);
+	virtual void readFromFile(std::istream& stream, const std::string& filename);
 
 protected:
 	// Set up our set of primitive parsers
@@ -43,14 +108,42 @@ protected:
 	// Parse the version tag at the beginning, throws on failure
 	virtual void parseMapVersion(parser::DefTokeniser& tok);
 
-	// Parses an entity plus all child primitives, throws on failure
-	virtual void parseEntity(parser::DefTokeniser& tok);
-
-	// Parse the primitive block and insert the child into the given parent
-	virtual void parsePrimitive(parser::DefTokeniser& tok, const scene::INodePtr& parentEntity);
-
 	// Create an entity with the given properties and layers
 	scene::INodePtr createEntity(const EntityKeyValues& keyValues);
+
+private:
+	// Locates the entity and primitive blocks and parses the primitives, throws on failure
+	void parseText(const std::string& text, EntityBlocks& entities);
+
+	// Splits the given entity text range into spawnargs and primitive blocks, throws on failure
+	void splitEntityBlock(const std::string& text, std::size_t begin, std::size_t end,
+						  EntityBlock& block);
+
+	// Parses the brushDef3 primitive blocks in the given range (executed by the worker threads)
+	void parsePrimitiveBlocks(const std::string& text,
+							  const std::vector<PrimitiveBlock*>& blocks,
+							  std::size_t first, std::size_t last);
+
+	// Creates the entity node and its primitives, which are appended to the given list
+	scene::INodePtr createEntityNode(const std::string& text, EntityBlock& block,
+									 std::vector<scene::INodePtr>& primitives,
+									 std::vector<IBrush*>& brushes);
+
+	// Create a primitive node from the given block on the main thread
+	scene::INodePtr createPrimitive(const std::string& text, PrimitiveBlock& block);
+
+	// Builds the B-Reps of the given brushes, using the worker threads
+	void evaluateBReps(const std::vector<IBrush*>& brushes);
+
+	// Builds the B-Reps and passes the nodes to the import filter
+	void insertNodes(const MapNodes& nodes);
+
+	// Creates the nodes from the records of the given binary cache
+	void createNodesFromCache(const BinaryMapCache& cache, MapNodes& nodes);
+
+	// Writes the binary cache file for a successfully parsed map
+	void writeCache(const std::string& filename, boost::uint64_t contentHash, std::size_t contentSize,
+					const EntityBlocks& entities, const MapNodes& nodes);
 };
 
 } // namespace map
@@ -19,49 +19,59 @@ Doom3MapWriter::Doom3MapWriter() :
 void Doom3MapWriter::beginWriteMap(std::ostream& stream)
 {
 	// Write the version tag
-    stream << "Version " << MAP_VERSION_D3 << std::endl;
+	writeVersion(MAP_VERSION_D3, stream);
+}
+
+void Doom3MapWriter::writeVersion(float version, std::ostream& stream)
+{
+	_buffer.setPrecision(stream.precision());
+
+	_buffer << "Version " << static_cast<double>(version) << '\n';
 }
 
 void Doom3MapWriter::endWriteMap(std::ostream& stream)
 {
-	// nothing
+	// Pass the remaining text to the stream
+	_buffer.flush(stream);
 }
 
 void Doom3MapWriter::beginWriteEntity(const Entity& entity, std::ostream& stream)
 {
 	// Write out the entity number comment
-	stream << "// entity " << _entityCount++ << std::endl;
+	_buffer << "// entity " << _entityCount++ << '\n';
 
 	// Entity opening brace
-	stream << "{" << std::endl;
+	_buffer << "{\n";
 
 	// Entity key values
-	writeEntityKeyValues(entity, stream);
+	writeEntityKeyValues(entity);
+
+	_buffer.flushIfFull(stream);
 }
 
-void Doom3MapWriter::writeEntityKeyValues(const Entity& entity, std::ostream& stream)
+void Doom3MapWriter::writeEntityKeyValues(const Entity& entity)
 {
 	// Create a local Entity visitor class to export the keyvalues
-	// to the output stream
+	// to the output buffer
 	class WriteKeyValue : 
 		public Entity::Visitor
 	{
 	private:
-		// Stream to write to
-		std::ostream& _os;
+		// Buffer to write to
+		MapOutputBuffer& _buffer;
 	public:
 		// Constructor
-		WriteKeyValue(std::ostream& os) : 
-			_os(os)
+		WriteKeyValue(MapOutputBuffer& buffer) : 
+			_buffer(buffer)
 	    {}
 
 		// Required visit function
     	void visit(const std::string& key, const std::string& value)
 		{
-			_os << "\"" << key << "\" \"" << value << "\"" << std::endl;
+			_buffer << '"' << key << "\" \"" << value << "\"\n";
 		}
 
-	} visitor(stream);
+	} visitor(_buffer);
 
 	// Visit the entity
 	entity.forEachKeyValue(visitor);
@@ -70,7 +80,8 @@ void Doom3MapWriter::writeEntityKeyValues(const Entity& entity, std::ostream& st
 void Doom3MapWriter::endWriteEntity(const Entity& entity, std::ostream& stream)
 {
 	// Write the closing brace for the entity
-	stream << "}" << std::endl;
+	_buffer << "}\n";
+	_buffer.flushIfFull(stream);
 
 	// Reset the primitive count again
 	_primitiveCount = 0;
@@ -79,10 +90,11 @@ void Doom3MapWriter::endWriteEntity(const Entity& entity, std::ostream& stream)
 void Doom3MapWriter::beginWriteBrush(const IBrush& brush, std::ostream& stream)
 {
 	// Primitive count comment
-	stream << "// primitive " << _primitiveCount++ << std::endl;
+	_buffer << "// primitive " << _primitiveCount++ << '\n';
 
-	// Export brushDef3 definition to stream
-	BrushDef3Exporter::exportBrush(stream, brush);
+	// Export brushDef3 definition to the buffer
+	BrushDef3Exporter::exportBrush(_buffer, brush);
+	_buffer.flushIfFull(stream);
 }
 
 void Doom3MapWriter::endWriteBrush(const IBrush& brush, std::ostream& stream)
@@ -93,10 +105,11 @@ void Doom3MapWriter::endWriteBrush(const IBrush& brush, std::ostream& stream)
 void Doom3MapWriter::beginWritePatch(const IPatch& patch, std::ostream& stream)
 {
 	// Primitive count comment
-	stream << "// primitive " << _primitiveCount++ << std::endl;
+	_buffer << "// primitive " << _primitiveCount++ << '\n';
 
 	// Export patch here _mapStream
-	PatchDefExporter::exportPatch(stream, patch);
+	PatchDefExporter::exportPatch(_buffer, patch);
+	_buffer.flushIfFull(stream);
 }
 
 void Doom3MapWriter::endWritePatch(const IPatch& patch, std::ostream& stream)
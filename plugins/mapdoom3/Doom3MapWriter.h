@@ -1,6 +1,7 @@
 #pragma once
 
 #include "imapformat.h"
+#include "primitivewriters/MapOutputBuffer.h"
 
 namespace map
 {
@@ -9,6 +10,8 @@ namespace map
  * Standard implementation of a Doom 3 Map file writer (Map Version 2)
  *
  * Creates a plaintext file with brushDef3/patchDef2/patchDef3 primitives.
+ * The text is assembled in a buffer, which is passed to the stream in large
+ * chunks. The floating point precision is taken from the stream in beginWriteMap().
  */
 class Doom3MapWriter :
 	public IMapWriter
@@ -18,6 +21,9 @@ protected:
 	std::size_t _entityCount;
 	std::size_t _primitiveCount;
 
+	// The text buffer, holding the output not yet passed to the stream
+	MapOutputBuffer _buffer;
+
 public:
 	Doom3MapWriter();
 
@@ -37,7 +43,10 @@ public:
 	virtual void endWritePatch(const IPatch& patch, std::ostream& stream);
 
 protected:
-	void writeEntityKeyValues(const Entity& entity, std::ostream& stream);
+	void writeEntityKeyValues(const Entity& entity);
+
+	// Writes the version tag, using the stream's precision settings
+	void writeVersion(float version, std::ostream& stream);
 };
 
 } // namespace
@@ -0,0 +1,334 @@
+#include "MapBenchmark.h"
+
+#include "itextstream.h"
+#include "iradiant.h"
+#include "ithread.h"
+#include "ientity.h"
+#include "ieclass.h"
+#include "ibrush.h"
+#include "imapformat.h"
+#include "inode.h"
+
+#include "debugging/ScopedDebugTimer.h"
+#include <sstream>
+#include <algorithm>
+#include <vector>
+
+#include "Doom3MapReader.h"
+#include "Doom3MapWriter.h"
+
+namespace map
+{
+
+namespace benchmark
+{
+
+namespace
+{
+	const std::size_t DEFAULT_NUM_BRUSHES = 100000;
+	const std::size_t DEFAULT_NUM_ENTITIES = 10000;
+	const std::size_t BRUSHES_PER_ROW = 100;
+	const int BRUSH_SIZE = 64;
+
+	// The precision the game files are defining for map files
+	const std::streamsize FLOAT_PRECISION = 16;
+
+	// Import filter keeping the parsed nodes out of the scene
+	class NodeCollector :
+		public IMapImportFilter
+	{
+	public:
+		std::vector<scene::INodePtr> entities;
+
+		bool addEntity(const scene::INodePtr& entity)
+		{
+			entities.push_back(entity);
+			return true;
+		}
+
+		bool addPrimitiveToEntity(const scene::INodePtr& primitive, const scene::INodePtr& entity)
+		{
+			entity->addChildNode(primitive);
+			return true;
+		}
+	};
+
+	// Writes a worldspawn consisting of a grid of cuboid brushes
+	void generateMap(std::ostream& stream, std::size_t numBrushes)
+	{
+		stream << "Version 2\n";
+		stream << "// entity 0\n{\n\"classname\" \"worldspawn\"\n";
+
+		for (std::size_t i = 0; i < numBrushes; ++i)
+		{
+			int x = static_cast<int>(i % BRUSHES_PER_ROW) * BRUSH_SIZE * 2;
+			int y = static_cast<int>((i / BRUSHES_PER_ROW) % BRUSHES_PER_ROW) * BRUSH_SIZE * 2;
+			int z = static_cast<int>(i / (BRUSHES_PER_ROW * BRUSHES_PER_ROW)) * BRUSH_SIZE * 2;
+
+			stream << "// primitive " << i << "\n{\nbrushDef3\n{\n";
+
+			const char* texdef = " ( ( 0.015625 0 0 ) ( 0 0.015625 0 ) ) \"textures/common/caulk\" 0 0 0\n";
+
+			stream << "( 0 0 1 " << -(z + BRUSH_SIZE) << " )" << texdef;
+			stream << "( 0 0 -1 " << z << " )" << texdef;
+			stream << "( 0 1 0 " << -(y + BRUSH_SIZE) << " )" << texdef;
+			stream << "( 0 -1 0 " << y << " )" << texdef;
+			stream << "( 1 0 0 " << -(x + BRUSH_SIZE) << " )" << texdef;
+			stream << "( -1 0 0 " << x << " )" << texdef;
+
+			stream << "}\n}\n";
+		}
+
+		stream << "}\n";
+	}
+
+	// Writes a worldspawn and the given number of func_static entities with
+	// a typical set of spawnargs, the entities don't have any primitives
+	void generateEntityMap(std::ostream& stream, std::size_t numEntities)
+	{
+		stream << "Version 2\n";
+		stream << "// entity 0\n{\n\"classname\" \"worldspawn\"\n}\n";
+
+		for (std::size_t i = 0; i < numEntities; ++i)
+		{
+			int x = static_cast<int>(i % BRUSHES_PER_ROW) * BRUSH_SIZE;
+			int y = static_cast<int>(i / BRUSHES_PER_ROW) * BRUSH_SIZE;
+
+			stream << "// entity " << (i + 1) << "\n{\n";
+			stream << "\"classname\" \"func_static\"\n";
+			stream << "\"name\" \"func_static_" << i << "\"\n";
+			stream << "\"model\" \"models/mapobjects/chairs/chair" << (i % 8) << ".lwo\"\n";
+			stream << "\"origin\" \"" << x << " " << y << " 0\"\n";
+			stream << "\"rotation\" \"1 0 0 0 1 0 0 0 1\"\n";
+			stream << "\"skin\" \"skins/chair" << (i % 4) << "\"\n";
+			stream << "\"solid\" \"1\"\n";
+			stream << "\"noclipmodel\" \"0\"\n";
+			stream << "\"inline\" \"0\"\n";
+			stream << "\"hide\" \"0\"\n";
+			stream << "\"_color\" \"1 1 1\"\n";
+			stream << "\"shaderParm3\" \"1\"\n";
+			stream << "\"shaderParm4\" \"0\"\n";
+			stream << "\"shaderParm5\" \"0\"\n";
+			stream << "\"editor_comment\" \"benchmark entity " << i << "\"\n";
+			stream << "}\n";
+		}
+	}
+
+	// Mimics the entity inspector, which looks up the entity class
+	// attribute of every key reported on attachment
+	class InspectorObserver :
+		public Entity::Observer
+	{
+	private:
+		Entity& _entity;
+
+	public:
+		std::size_t numKeys;
+
+		InspectorObserver(Entity& entity) :
+			_entity(entity),
+			numKeys(0)
+		{}
+
+		void onKeyInsert(const std::string& key, EntityKeyValue& value)
+		{
+			_entity.getEntityClass()->getAttribute(key).getType();
+			++numKeys;
+		}
+	};
+
+	// Passes the primitives of an entity to the map writer
+	class PrimitiveWriter :
+		public scene::NodeVisitor
+	{
+	private:
+		IMapWriter& _writer;
+		std::ostream& _stream;
+
+	public:
+		PrimitiveWriter(IMapWriter& writer, std::ostream& stream) :
+			_writer(writer),
+			_stream(stream)
+		{}
+
+		bool pre(const scene::INodePtr& node)
+		{
+			IBrush* brush = Node_getIBrush(node);
+
+			if (brush != NULL)
+			{
+				_writer.beginWriteBrush(*brush, _stream);
+				_writer.endWriteBrush(*brush, _stream);
+			}
+
+			return false;
+		}
+	};
+
+	std::size_t getNumBrushes(const cmd::ArgumentList& args)
+	{
+		return args.empty() ? DEFAULT_NUM_BRUSHES :
+			static_cast<std::size_t>(std::max(args[0].getInt(), 1));
+	}
+
+	std::size_t getNumEntities(const cmd::ArgumentList& args)
+	{
+		return args.empty() ? DEFAULT_NUM_ENTITIES :
+			static_cast<std::size_t>(std::max(args[0].getInt(), 1));
+	}
+}
+
+void loadMapCmd(const cmd::ArgumentList& args)
+{
+	std::size_t numBrushes = getNumBrushes(args);
+
+	rMessage() << "Generating a map with " << numBrushes << " brushes..." << std::endl;
+
+	std::stringstream mapStream;
+	generateMap(mapStream, numBrushes);
+
+	NodeCollector collector;
+	Doom3MapReader reader(collector);
+
+	StopWatch stopWatch;
+
+	try
+	{
+		reader.readFromStream(mapStream);
+	}
+	catch (IMapReader::FailureException& ex)
+	{
+		rError() << "Map load benchmark failed: " << ex.what() << std::endl;
+		return;
+	}
+
+	double seconds = stopWatch.getSeconds();
+
+	rMessage() << "Parsed " << numBrushes << " brushes in " << seconds << " seconds ("
+		<< static_cast<std::size_t>(numBrushes / seconds) << " brushes per second, "
+		<< GlobalRadiant().getThreadManager().getNumWorkers() << " worker threads)" << std::endl;
+}
+
+void saveMapCmd(const cmd::ArgumentList& args)
+{
+	std::size_t numBrushes = getNumBrushes(args);
+
+	rMessage() << "Generating a map with " << numBrushes << " brushes..." << std::endl;
+
+	NodeCollector collector;
+
+	try
+	{
+		std::stringstream mapStream;
+		generateMap(mapStream, numBrushes);
+
+		Doom3MapReader reader(collector);
+		reader.readFromStream(mapStream);
+	}
+	catch (IMapReader::FailureException& ex)
+	{
+		rError() << "Map save benchmark failed: " << ex.what() << std::endl;
+		return;
+	}
+
+	std::ostringstream output;
+	output.precision(FLOAT_PRECISION);
+
+	Doom3MapWriter writer;
+
+	StopWatch stopWatch;
+
+	try
+	{
+		writer.beginWriteMap(output);
+
+		for (std::vector<scene::INodePtr>::const_iterator i = collector.entities.begin();
+			 i != collector.entities.end(); ++i)
+		{
+			Entity& entity = *Node_getEntity(*i);
+
+			writer.beginWriteEntity(entity, output);
+
+			PrimitiveWriter primitiveWriter(writer, output);
+			(*i)->traverse(primitiveWriter);
+
+			writer.endWriteEntity(entity, output);
+		}
+
+		writer.endWriteMap(output);
+	}
+	catch (IMapWriter::FailureException& ex)
+	{
+		rError() << "Map save benchmark failed: " << ex.what() << std::endl;
+		return;
+	}
+
+	double seconds = stopWatch.getSeconds();
+	double megabytes = output.str().size() / (1024.0 * 1024.0);
+
+	rMessage() << "Wrote " << numBrushes << " brushes in " << seconds << " seconds ("
+		<< static_cast<std::size_t>(numBrushes / seconds) << " brushes per second, "
+		<< megabytes / seconds << " MB per second)" << std::endl;
+}
+
+void entitiesCmd(const cmd::ArgumentList& args)
+{
+	std::size_t numEntities = getNumEntities(args);
+
+	rMessage() << "Generating a map with " << numEntities << " entities..." << std::endl;
+
+	std::stringstream mapStream;
+	generateEntityMap(mapStream, numEntities);
+
+	NodeCollector collector;
+	Doom3MapReader reader(collector);
+
+	StopWatch stopWatch;
+
+	try
+	{
+		reader.readFromStream(mapStream);
+	}
+	catch (IMapReader::FailureException& ex)
+	{
+		rError() << "Entity benchmark failed: " << ex.what() << std::endl;
+		return;
+	}
+
+	double loadSeconds = stopWatch.getSeconds();
+
+	// Select every entity in the inspector once
+	stopWatch.restart();
+
+	std::size_t numKeys = 0;
+
+	for (std::vector<scene::INodePtr>::const_iterator i = collector.entities.begin();
+		 i != collector.entities.end(); ++i)
+	{
+		Entity& entity = *Node_getEntity(*i);
+
+		// The inspector checks these on selection change
+		entity.getKeyValue("classname");
+		entity.getKeyValue("name");
+		entity.getKeyValue("model");
+
+		InspectorObserver observer(entity);
+
+		entity.attachObserver(&observer);
+		entity.detachObserver(&observer);
+
+		numKeys += observer.numKeys;
+	}
+
+	double refreshSeconds = stopWatch.getSeconds();
+
+	rMessage() << "Loaded " << numEntities << " entities in " << loadSeconds << " seconds ("
+		<< static_cast<std::size_t>(numEntities / loadSeconds) << " entities per second)" << std::endl;
+
+	rMessage() << "Refreshed the inspector for " << collector.entities.size() << " entities ("
+		<< numKeys << " keys) in " << refreshSeconds << " seconds" << std::endl;
+}
+
+} // namespace
+
+} // namespace
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "icommandsystem.h"
+
+namespace map
+{
+
+namespace benchmark
+{
+
+/**
+ * Console command generating a synthetic map with the given number of
+ * brushes (100k if omitted), which is then parsed using the Doom3MapReader.
+ * The nodes are not inserted into the scene. The timings are written
+ * to the console.
+ */
+void loadMapCmd(const cmd::ArgumentList& args);
+
+/**
+ * Console command generating and loading a synthetic map like loadMapCmd(),
+ * which is then written to a string stream using the Doom3MapWriter. The
+ * write timings are written to the console.
+ */
+void saveMapCmd(const cmd::ArgumentList& args);
+
+/**
+ * Console command generating a map with the given number of func_static
+ * entities (10k if omitted), each with a typical set of spawnargs. The
+ * timings for loading the map and for attaching an entity inspector-like
+ * observer to every entity are written to the console.
+ */
+void entitiesCmd(const cmd::ArgumentList& args);
+
+} // namespace
+
+} // namespace
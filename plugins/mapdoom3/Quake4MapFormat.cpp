@@ -8,6 +8,7 @@
 #include "igame.h"
 #include "iregistry.h"
 #include "igroupnode.h"
+#include "iradiant.h"
 
 #include "parser/DefTokeniser.h"
 
@@ -48,6 +49,7 @@ const StringSet& Quake4MapFormat::getDependencies() const
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_GAMEMANAGER);
 		_dependencies.insert(MODULE_MAPFORMATMANAGER);
+		_dependencies.insert(MODULE_RADIANT);
 	}
 
 	return _dependencies;
@@ -17,16 +17,17 @@ public:
 	virtual void beginWriteMap(std::ostream& stream)
 	{
 		// Write the version tag
-		stream << "Version " << MAP_VERSION_Q4 << std::endl;
+		writeVersion(MAP_VERSION_Q4, stream);
 	}
 
 	virtual void beginWriteBrush(const IBrush& brush, std::ostream& stream)
 	{
 		// Primitive count comment
-		stream << "// primitive " << _primitiveCount++ << std::endl;
+		_buffer << "// primitive " << _primitiveCount++ << '\n';
 
-		// Export brushDef3 definition to stream, but without contents flags
-		BrushDef3Exporter::exportBrush(stream, brush, false);
+		// Export brushDef3 definition to the buffer, but without contents flags
+		BrushDef3Exporter::exportBrush(_buffer, brush, false);
+		_buffer.flushIfFull(stream);
 	}
 };
 
@@ -36,25 +36,16 @@ brushDef3
 }
 */
 
-// greebo: switch off optimisations for this section - the symptom is that brushes don't get a 
-// valid d value assigned after the first call to addFace() - the callback triggers a series
-// of calls in the DarkRadiant main module (up to the Texture Tool), and after return the plane
-// gets wrong values assigned
-#if _MSC_VER >= 1600
-#pragma optimize( "", off )
-#endif
-
 scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 {
-	// Create a new brush
-	scene::INodePtr node = GlobalBrushCreator().createBrush();
-
-	// Cast the node, this must succeed
-	IBrushNodePtr brushNode = boost::dynamic_pointer_cast<IBrushNode>(node);
-	assert(brushNode != NULL);
+	BrushDef3Faces faces;
+	parseFaces(tok, faces);
 
-	IBrush& brush = brushNode->getIBrush();
+	return createBrush(faces);
+}
 
+void BrushDef3Parser::parseFaces(parser::DefTokeniser& tok, BrushDef3Faces& faces) const
+{
 	tok.assertNextToken("{");
 
 	// Parse face tokens until a closing brace is encountered
@@ -69,8 +60,11 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 		}
 		else if (token == "(") // FACE
 		{
+			faces.push_back(BrushDef3Face());
+			BrushDef3Face& face = faces.back();
+
 			// Construct a plane and parse its values
-			Plane3 plane;
+			Plane3& plane = face.plane;
 
 			plane.normal().x() = string::to_float(tok.nextToken());
 			plane.normal().y() = string::to_float(tok.nextToken());
@@ -80,7 +74,9 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 			tok.assertNextToken(")");
 
 			// Parse TexDef
-			Matrix4 texdef;
+			Matrix4& texdef = face.texdef;
+			texdef = Matrix4::getIdentity();
+
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
@@ -98,13 +94,10 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 			tok.assertNextToken(")");
 
 			// Parse Shader
-			std::string shader = tok.nextToken();
+			face.shader = tok.nextToken();
 
 			// Parse Contents Flags (and ignore them)
 			tok.skipTokens(3);
-
-			// Finally, add the new face to the brush
-			/*IFace& face = */brush.addFace(plane, texdef, shader);
 		}
 		else {
 			std::string text = (boost::format(_("BrushDef3Parser: invalid token '%s'")) % token).str();
@@ -114,21 +107,10 @@ scene::INodePtr BrushDef3Parser::parse(parser::DefTokeniser& tok) const
 
 	// Final outer "}"
 	tok.assertNextToken("}");
-
-	return node;
 }
 
-scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
+void BrushDef3ParserQuake4::parseFaces(parser::DefTokeniser& tok, BrushDef3Faces& faces) const
 {
-	// Create a new brush
-	scene::INodePtr node = GlobalBrushCreator().createBrush();
-
-	// Cast the node, this must succeed
-	IBrushNodePtr brushNode = boost::dynamic_pointer_cast<IBrushNode>(node);
-	assert(brushNode != NULL);
-
-	IBrush& brush = brushNode->getIBrush();
-
 	tok.assertNextToken("{");
 
 	// Parse face tokens until a closing brace is encountered
@@ -143,8 +125,11 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 		}
 		else if (token == "(") // FACE
 		{
+			faces.push_back(BrushDef3Face());
+			BrushDef3Face& face = faces.back();
+
 			// Construct a plane and parse its values
-			Plane3 plane;
+			Plane3& plane = face.plane;
 
 			plane.normal().x() = string::to_float(tok.nextToken());
 			plane.normal().y() = string::to_float(tok.nextToken());
@@ -154,7 +139,9 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 			tok.assertNextToken(")");
 
 			// Parse TexDef
-			Matrix4 texdef;
+			Matrix4& texdef = face.texdef;
+			texdef = Matrix4::getIdentity();
+
 			tok.assertNextToken("(");
 
 			tok.assertNextToken("(");
@@ -172,10 +159,7 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 			tok.assertNextToken(")");
 
 			// Parse Shader
-			std::string shader = tok.nextToken();
-
-			// Finally, add the new face to the brush
-			/*IFace& face = */brush.addFace(plane, texdef, shader);
+			face.shader = tok.nextToken();
 		}
 		else {
 			std::string text = (boost::format(_("BrushDef3ParserQuake4: invalid token '%s'")) % token).str();
@@ -185,6 +169,32 @@ scene::INodePtr BrushDef3ParserQuake4::parse(parser::DefTokeniser& tok) const
 
 	// Final outer "}"
 	tok.assertNextToken("}");
+}
+
+// greebo: switch off optimisations for this section - the symptom is that brushes don't get a 
+// valid d value assigned after the first call to addFace() - the callback triggers a series
+// of calls in the DarkRadiant main module (up to the Texture Tool), and after return the plane
+// gets wrong values assigned
+#if _MSC_VER >= 1600
+#pragma optimize( "", off )
+#endif
+
+scene::INodePtr BrushDef3Parser::createBrush(const BrushDef3Faces& faces)
+{
+	// Create a new brush
+	scene::INodePtr node = GlobalBrushCreator().createBrush();
+
+	// Cast the node, this must succeed
+	IBrushNodePtr brushNode = boost::dynamic_pointer_cast<IBrushNode>(node);
+	assert(brushNode != NULL);
+
+	IBrush& brush = brushNode->getIBrush();
+
+	for (BrushDef3Faces::const_iterator i = faces.begin(); i != faces.end(); ++i)
+	{
+		// Add the new face to the brush
+		/*IFace& face = */brush.addFace(i->plane, i->texdef, i->shader);
+	}
 
 	return node;
 }
@@ -2,10 +2,24 @@
 #define ParserBrushDef3_h__
 
 #include "imapformat.h"
+#include "math/Plane3.h"
+#include "math/Matrix4.h"
+#include <vector>
 
 namespace map
 {
 
+/**
+ * The plain data of a single brushDef3 face, as found in the map file.
+ */
+struct BrushDef3Face
+{
+	Plane3 plane;
+	Matrix4 texdef;
+	std::string shader;
+};
+typedef std::vector<BrushDef3Face> BrushDef3Faces;
+
 class BrushDef3Parser :
 	public PrimitiveParser
 {
@@ -13,6 +27,19 @@ public:
 	const std::string& getKeyword() const;
 
     virtual scene::INodePtr parse(parser::DefTokeniser& tok) const;
+
+	/**
+	 * Parses the brush faces into the given list, without creating any
+	 * scene nodes. Unlike parse() this doesn't touch any global state,
+	 * so it's safe to call this from a worker thread.
+	 */
+	virtual void parseFaces(parser::DefTokeniser& tok, BrushDef3Faces& faces) const;
+
+	/**
+	 * Creates a new brush node carrying the given faces. Must be called
+	 * from the main thread.
+	 */
+	static scene::INodePtr createBrush(const BrushDef3Faces& faces);
 };
 typedef boost::shared_ptr<BrushDef3Parser> BrushDef3ParserPtr;
 
@@ -21,7 +48,7 @@ class BrushDef3ParserQuake4 :
 	public BrushDef3Parser
 {
 public:
-    virtual scene::INodePtr parse(parser::DefTokeniser& tok) const;
+	virtual void parseFaces(parser::DefTokeniser& tok, BrushDef3Faces& faces) const;
 };
 typedef boost::shared_ptr<BrushDef3ParserQuake4> BrushDef3ParserQuake4Ptr;
 
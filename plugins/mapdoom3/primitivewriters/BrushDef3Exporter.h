@@ -4,59 +4,36 @@
 #include "ibrush.h"
 #include "math/Plane3.h"
 #include "math/Matrix4.h"
+#include "MapOutputBuffer.h"
 
 namespace map
 {
 
-namespace
-{
-	// Writes a double to the given stream and checks for NaN and infinity
-	inline void writeDoubleSafe(const double d, std::ostream& os)
-	{
-		if (isValid(d))
-		{
-			if (d == -0.0)
-			{
-				os << 0; // convert -0 to 0
-			}
-			else
-			{
-				os << d;
-			}
-		}
-		else
-		{
-			// Is infinity or NaN, write 0
-			os << "0";
-		}
-	}
-}
-
 class BrushDef3Exporter
 {
 public:
 
-	// Writes a brushDef3 definition from the given brush to the given stream
-	static void exportBrush(std::ostream& stream, const IBrush& brush, bool writeContentsFlags = true)
+	// Writes a brushDef3 definition from the given brush to the given buffer
+	static void exportBrush(MapOutputBuffer& buffer, const IBrush& brush, bool writeContentsFlags = true)
 	{
 		// Brush decl header
-		stream << "{" << std::endl;
-		stream << "brushDef3" << std::endl;
-		stream << "{" << std::endl;
+		buffer << "{\n";
+		buffer << "brushDef3\n";
+		buffer << "{\n";
 
 		// Iterate over each brush face, exporting the tokens from all faces
 		for (std::size_t i = 0; i < brush.getNumFaces(); ++i)
 		{
-			writeFace(stream, brush.getFace(i), writeContentsFlags);
+			writeFace(buffer, brush.getFace(i), writeContentsFlags);
 		}
 
 		// Close brush contents and header
-		stream << "}" << std::endl << "}" << std::endl;
+		buffer << "}\n}\n";
 	}
 
 private:
 
-	static void writeFace(std::ostream& stream, const IFace& face, bool writeContentsFlags)
+	static void writeFace(MapOutputBuffer& buffer, const IFace& face, bool writeContentsFlags)
 	{
 		// greebo: Don't export faces with degenerate or empty windings (they are "non-contributing")
 		if (face.getWinding().size() <= 2)
@@ -67,56 +44,56 @@ private:
 		// Write the plane equation
 		const Plane3& plane = face.getPlane3();
 
-		stream << "( ";
-		writeDoubleSafe(plane.normal().x(), stream);
-		stream << " ";
-		writeDoubleSafe(plane.normal().y(), stream);
-		stream << " ";
-		writeDoubleSafe(plane.normal().z(), stream);
-		stream << " ";
-		writeDoubleSafe(-plane.dist(), stream); // negate d
-		stream << " ";
-		stream << ") ";
+		buffer << "( ";
+		buffer.writeDoubleSafe(plane.normal().x());
+		buffer << " ";
+		buffer.writeDoubleSafe(plane.normal().y());
+		buffer << " ";
+		buffer.writeDoubleSafe(plane.normal().z());
+		buffer << " ";
+		buffer.writeDoubleSafe(-plane.dist()); // negate d
+		buffer << " ";
+		buffer << ") ";
 
 		// Write TexDef
 		Matrix4 texdef = face.getTexDefMatrix();
-		stream << "( ";
-
-		stream << "( ";
-		writeDoubleSafe(texdef.xx(), stream);
-		stream << " ";
-		writeDoubleSafe(texdef.yx(), stream);
-		stream << " ";
-		writeDoubleSafe(texdef.tx(), stream);
-		stream << " ) ";
-
-		stream << "( ";
-		writeDoubleSafe(texdef.xy(), stream);
-		stream << " ";
-		writeDoubleSafe(texdef.yy(), stream);
-		stream << " ";
-		writeDoubleSafe(texdef.ty(), stream);
-		stream << " ) ";
-
-		stream << ") ";
+		buffer << "( ";
+
+		buffer << "( ";
+		buffer.writeDoubleSafe(texdef.xx());
+		buffer << " ";
+		buffer.writeDoubleSafe(texdef.yx());
+		buffer << " ";
+		buffer.writeDoubleSafe(texdef.tx());
+		buffer << " ) ";
+
+		buffer << "( ";
+		buffer.writeDoubleSafe(texdef.xy());
+		buffer << " ";
+		buffer.writeDoubleSafe(texdef.yy());
+		buffer << " ";
+		buffer.writeDoubleSafe(texdef.ty());
+		buffer << " ) ";
+
+		buffer << ") ";
 
 		// Write Shader
 		const std::string& shaderName = face.getShader();
 
 		if (shaderName.empty()) {
-			stream << "\"_default\" ";
+			buffer << "\"_default\" ";
 		}
 		else {
-			stream << "\"" << shaderName << "\" ";
+			buffer << "\"" << shaderName << "\" ";
 		}
 
 		// Export (dummy) contents/flags
 		if (writeContentsFlags)
 		{
-			stream << "0 0 0";
+			buffer << "0 0 0";
 		}
 
-		stream << std::endl;
+		buffer << '\n';
 	}
 };
 
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <clocale>
+#include "math/FloatTools.h"
+
+namespace map
+{
+
+/**
+ * Text buffer used by the map writers. The map text is assembled in memory
+ * and passed to the output stream in large chunks, instead of pushing every
+ * token through the stream's formatting and locale machinery.
+ *
+ * Floating point values are formatted like std::ostream does in its default
+ * notation with the given precision (printf's %g), so the output is
+ * byte-for-byte the same as writing to a stream with that precision set.
+ */
+class MapOutputBuffer
+{
+private:
+	std::string _buffer;
+
+	int _precision;
+
+	// Integral values below this limit are written without going through printf
+	double _integerLimit;
+
+	// The buffer contents are passed to the stream when reaching this size
+	static const std::size_t CHUNK_SIZE = 1 << 20;
+
+public:
+	MapOutputBuffer()
+	{
+		_buffer.reserve(CHUNK_SIZE + CHUNK_SIZE / 4);
+		setPrecision(6);
+	}
+
+	// Set the number of significant digits used for floating point values
+	void setPrecision(std::streamsize precision)
+	{
+		// A precision of 0 is treated like 1 by %g, the upper bound keeps
+		// the formatted values within the sprintf buffer below
+		_precision = static_cast<int>(std::max<std::streamsize>(1, std::min<std::streamsize>(precision, 100)));
+
+		// With up to <precision> digits %g prints integers without exponent,
+		// stay well within the range of exactly representable integers
+		_integerLimit = std::pow(10.0, std::min(_precision, 15));
+	}
+
+	MapOutputBuffer& operator<<(const char* str)
+	{
+		_buffer.append(str);
+		return *this;
+	}
+
+	MapOutputBuffer& operator<<(const std::string& str)
+	{
+		_buffer.append(str);
+		return *this;
+	}
+
+	MapOutputBuffer& operator<<(char c)
+	{
+		_buffer.push_back(c);
+		return *this;
+	}
+
+	MapOutputBuffer& operator<<(std::size_t value)
+	{
+		char digits[24];
+		char* end = digits + sizeof(digits);
+		char* pos = end;
+
+		do
+		{
+			*--pos = static_cast<char>('0' + value % 10);
+			value /= 10;
+		}
+		while (value > 0);
+
+		_buffer.append(pos, end);
+		return *this;
+	}
+
+	MapOutputBuffer& operator<<(double value)
+	{
+		if (value == std::floor(value) && std::fabs(value) < _integerLimit)
+		{
+			if (value < 0)
+			{
+				_buffer.push_back('-');
+			}
+
+			return *this << static_cast<std::size_t>(std::fabs(value));
+		}
+
+		char str[128];
+		int length = sprintf(str, "%.*g", _precision, value);
+
+		// printf is using the C locale, which might have been changed by the application
+		char decimalPoint = *std::localeconv()->decimal_point;
+
+		if (decimalPoint != '.')
+		{
+			for (int i = 0; i < length; ++i)
+			{
+				if (str[i] == decimalPoint) str[i] = '.';
+			}
+		}
+
+		_buffer.append(str, length);
+		return *this;
+	}
+
+	/**
+	 * Writes a double, checking for NaN and infinity (these are written as 0).
+	 * Negative zero is written as 0 too.
+	 */
+	void writeDoubleSafe(double value)
+	{
+		if (isValid(value))
+		{
+			// -0 compares equal to 0, so it's written as plain 0 by the integer path
+			*this << value;
+		}
+		else
+		{
+			_buffer.push_back('0');
+		}
+	}
+
+	// Passes the buffer contents to the stream once a chunk is full
+	void flushIfFull(std::ostream& stream)
+	{
+		if (_buffer.size() >= CHUNK_SIZE)
+		{
+			flush(stream);
+		}
+	}
+
+	// Passes the whole buffer contents to the stream
+	void flush(std::ostream& stream)
+	{
+		stream.write(_buffer.data(), _buffer.size());
+		_buffer.clear();
+	}
+};
+
+} // namespace
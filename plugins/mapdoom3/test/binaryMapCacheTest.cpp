@@ -0,0 +1,329 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE binaryMapCacheTest
+#include <boost/test/unit_test.hpp>
+
+#include "../BinaryMapCache.h"
+#include "ipatch.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace map;
+
+namespace
+{
+
+const char* const CACHE_FILE = "binaryMapCacheTest.mapcache";
+
+const boost::uint64_t CONTENT_HASH = 0x0123456789abcdefULL;
+const std::size_t CONTENT_SIZE = 4711;
+
+// A patch only holding what the cache writer is asking for
+class TestPatch :
+	public IPatch
+{
+	std::size_t _width;
+	std::size_t _height;
+	std::vector<PatchControl> _ctrl;
+	std::string _shader;
+	Subdivisions _subdivisions;
+
+public:
+	TestPatch(std::size_t width, std::size_t height, const std::string& shader) :
+		_width(width),
+		_height(height),
+		_ctrl(width * height),
+		_shader(shader),
+		_subdivisions(4, 6)
+	{
+		for (std::size_t i = 0; i < _ctrl.size(); ++i)
+		{
+			_ctrl[i].vertex = Vector3(i, i * 2.0, i * 0.5);
+			_ctrl[i].texcoord = Vector2(i * 0.25, 1 - i * 0.125);
+		}
+	}
+
+	void attachObserver(Observer* observer) {}
+	void detachObserver(Observer* observer) {}
+	void setDims(std::size_t width, std::size_t height) {}
+	std::size_t getWidth() const { return _width; }
+	std::size_t getHeight() const { return _height; }
+	PatchControl& ctrlAt(std::size_t row, std::size_t col) { return _ctrl[row * _width + col]; }
+	const PatchControl& ctrlAt(std::size_t row, std::size_t col) const { return _ctrl[row * _width + col]; }
+	PatchMesh getTesselatedPatchMesh() const { return PatchMesh(); }
+	void insertColumns(std::size_t colIndex) {}
+	void insertRows(std::size_t rowIndex) {}
+	void removePoints(bool columns, std::size_t index) {}
+	void appendPoints(bool columns, bool beginning) {}
+	void controlPointsChanged() {}
+	bool isValid() const { return true; }
+	bool isDegenerate() const { return false; }
+	const std::string& getShader() const { return _shader; }
+	void setShader(const std::string& name) { _shader = name; }
+	bool hasVisibleMaterial() const { return true; }
+	bool subdivionsFixed() const { return true; }
+	Subdivisions getSubdivisions() const { return _subdivisions; }
+	void setFixedSubdivisions(bool isFixed, const Subdivisions& divisions) {}
+};
+
+BrushDef3Face createFace(double offset, const std::string& shader)
+{
+	BrushDef3Face face;
+
+	face.plane = Plane3(0, 0, 1, 64 + offset);
+	face.texdef = Matrix4::getIdentity();
+	face.texdef.xx() = 0.5 + offset;
+	face.texdef.ty() = 0.25;
+	face.shader = shader;
+
+	return face;
+}
+
+// Writes a cache with two entities, the second one carrying a brush and a patch
+void writeTestCache(const TestPatch& patch)
+{
+	BinaryMapCacheWriter writer(CONTENT_HASH, CONTENT_SIZE);
+
+	BinaryMapCacheWriter::KeyValues worldspawn;
+	worldspawn["classname"] = "worldspawn";
+	worldspawn["name"] = "world";
+	writer.addEntity(worldspawn);
+
+	BinaryMapCacheWriter::KeyValues funcStatic;
+	funcStatic["classname"] = "func_static";
+	funcStatic["name"] = "world"; // shared string
+	writer.addEntity(funcStatic);
+
+	BrushDef3Faces faces;
+	faces.push_back(createFace(0, "textures/common/caulk"));
+	faces.push_back(createFace(8, "textures/darkmod/stone/brick"));
+	writer.addBrush(faces);
+
+	writer.addPatch(patch, true);
+
+	BOOST_REQUIRE(writer.save(CACHE_FILE));
+}
+
+std::vector<char> readCacheFile()
+{
+	std::ifstream file(CACHE_FILE, std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeCacheFile(const std::vector<char>& data)
+{
+	std::ofstream file(CACHE_FILE, std::ios::binary | std::ios::trunc);
+	file.write(&data[0], data.size());
+}
+
+bool loadCache(BinaryMapCache& cache)
+{
+	return cache.load(CACHE_FILE, CONTENT_HASH, CONTENT_SIZE);
+}
+
+// Returns the byte offset of the given section in the cache file
+std::size_t getEntitiesOffset(const cache::Header& header)
+{
+	return sizeof(cache::Header) + header.numStrings * sizeof(boost::uint32_t) + header.stringDataSize;
+}
+
+std::size_t getKeyValuesOffset(const cache::Header& header)
+{
+	return getEntitiesOffset(header) + header.numEntities * sizeof(cache::EntityRecord);
+}
+
+std::size_t getPrimitivesOffset(const cache::Header& header)
+{
+	return getKeyValuesOffset(header) + header.numKeyValues * sizeof(cache::KeyValueRecord);
+}
+
+std::size_t getFacesOffset(const cache::Header& header)
+{
+	return getPrimitivesOffset(header) + header.numPrimitives * sizeof(cache::PrimitiveRecord);
+}
+
+// Gives access to a record of the given type at the given offset of the file data
+template<typename RecordType>
+RecordType& getRecord(std::vector<char>& data, std::size_t offset)
+{
+	return *reinterpret_cast<RecordType*>(&data[offset]);
+}
+
+struct CacheFileFixture
+{
+	TestPatch patch;
+	std::vector<char> data;
+
+	CacheFileFixture() :
+		patch(3, 5, "textures/darkmod/wood/planks")
+	{
+		writeTestCache(patch);
+		data = readCacheFile();
+	}
+
+	~CacheFileFixture()
+	{
+		std::remove(CACHE_FILE);
+	}
+
+	cache::Header& header()
+	{
+		return getRecord<cache::Header>(data, 0);
+	}
+};
+
+}
+
+BOOST_FIXTURE_TEST_CASE(roundTrip, CacheFileFixture)
+{
+	BinaryMapCache cache;
+	BOOST_REQUIRE(loadCache(cache));
+
+	BOOST_REQUIRE_EQUAL(cache.getNumEntities(), 2);
+
+	// Entities
+	const cache::EntityRecord& worldspawn = cache.getEntity(0);
+	BOOST_CHECK_EQUAL(worldspawn.numKeyValues, 2);
+	BOOST_CHECK_EQUAL(worldspawn.numPrimitives, 0);
+
+	const cache::EntityRecord& funcStatic = cache.getEntity(1);
+	BOOST_CHECK_EQUAL(funcStatic.firstKeyValue, 2);
+	BOOST_CHECK_EQUAL(funcStatic.numKeyValues, 2);
+	BOOST_CHECK_EQUAL(funcStatic.firstPrimitive, 0);
+	BOOST_REQUIRE_EQUAL(funcStatic.numPrimitives, 2);
+
+	// Keyvalues are written in map order
+	const cache::KeyValueRecord& classname = cache.getKeyValue(funcStatic.firstKeyValue);
+	BOOST_CHECK_EQUAL(cache.getString(classname.key), "classname");
+	BOOST_CHECK_EQUAL(cache.getString(classname.value), "func_static");
+
+	const cache::KeyValueRecord& name = cache.getKeyValue(funcStatic.firstKeyValue + 1);
+	BOOST_CHECK_EQUAL(cache.getString(name.key), "name");
+	BOOST_CHECK_EQUAL(cache.getString(name.value), "world");
+
+	// Identical strings are stored once
+	BOOST_CHECK_EQUAL(name.value, cache.getKeyValue(worldspawn.firstKeyValue + 1).value);
+
+	// Brush
+	const cache::PrimitiveRecord& brush = cache.getPrimitive(0);
+	BOOST_CHECK_EQUAL(brush.type, cache::PRIMITIVE_BRUSHDEF3);
+	BOOST_REQUIRE_EQUAL(brush.numItems, 2);
+
+	const cache::FaceRecord& face = cache.getFace(brush.firstItem + 1);
+	BOOST_CHECK_EQUAL(face.plane[2], 1.0f);
+	BOOST_CHECK_EQUAL(face.plane[3], 72.0f);
+	BOOST_CHECK_EQUAL(face.texdef[0], 8.5f);
+	BOOST_CHECK_EQUAL(face.texdef[5], 0.25f);
+	BOOST_CHECK_EQUAL(cache.getString(face.shader), "textures/darkmod/stone/brick");
+
+	// Patch
+	const cache::PrimitiveRecord& patchRecord = cache.getPrimitive(1);
+	BOOST_CHECK_EQUAL(patchRecord.type, cache::PRIMITIVE_PATCHDEF3);
+	BOOST_CHECK_EQUAL(cache.getString(patchRecord.shader), patch.getShader());
+	BOOST_CHECK_EQUAL(patchRecord.width, 3);
+	BOOST_CHECK_EQUAL(patchRecord.height, 5);
+	BOOST_CHECK_EQUAL(patchRecord.subdivX, 4);
+	BOOST_CHECK_EQUAL(patchRecord.subdivY, 6);
+	BOOST_REQUIRE_EQUAL(patchRecord.numItems, 15);
+
+	// Control points are stored column-major
+	for (std::size_t c = 0; c < patch.getWidth(); ++c)
+	{
+		for (std::size_t r = 0; r < patch.getHeight(); ++r)
+		{
+			const cache::PatchControlRecord& ctrl =
+				cache.getPatchControl(patchRecord.firstItem + c * patch.getHeight() + r);
+
+			BOOST_CHECK_EQUAL(ctrl.vertex[1], static_cast<float>(patch.ctrlAt(r, c).vertex[1]));
+			BOOST_CHECK_EQUAL(ctrl.texcoord[0], static_cast<float>(patch.ctrlAt(r, c).texcoord[0]));
+		}
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(rejectMismatchingMap, CacheFileFixture)
+{
+	BinaryMapCache cache;
+
+	BOOST_CHECK(!cache.load(CACHE_FILE, CONTENT_HASH + 1, CONTENT_SIZE));
+	BOOST_CHECK(!cache.load(CACHE_FILE, CONTENT_HASH, CONTENT_SIZE + 1));
+	BOOST_CHECK(!cache.load("nonexistent.mapcache", CONTENT_HASH, CONTENT_SIZE));
+}
+
+BOOST_FIXTURE_TEST_CASE(rejectTruncatedFile, CacheFileFixture)
+{
+	BinaryMapCache cache;
+
+	// Missing the last patch control
+	std::vector<char> truncated(data.begin(), data.end() - sizeof(cache::PatchControlRecord));
+	writeCacheFile(truncated);
+	BOOST_CHECK(!loadCache(cache));
+
+	// Not even a complete header
+	truncated.resize(sizeof(cache::Header) / 2);
+	writeCacheFile(truncated);
+	BOOST_CHECK(!loadCache(cache));
+
+	// Header claiming one face less than there are
+	header().numFaces--;
+	data.resize(data.size() - sizeof(cache::FaceRecord));
+	writeCacheFile(data);
+	BOOST_CHECK(!loadCache(cache));
+}
+
+BOOST_FIXTURE_TEST_CASE(rejectOutOfRangeStringIndex, CacheFileFixture)
+{
+	std::size_t faceOffset = getFacesOffset(header());
+
+	getRecord<cache::FaceRecord>(data, faceOffset).shader = header().numStrings;
+	writeCacheFile(data);
+
+	BinaryMapCache cache;
+	BOOST_CHECK(!loadCache(cache));
+}
+
+BOOST_FIXTURE_TEST_CASE(rejectOutOfRangeKeyValue, CacheFileFixture)
+{
+	getRecord<cache::KeyValueRecord>(data, getKeyValuesOffset(header())).value = 0xFFFF;
+	writeCacheFile(data);
+
+	BinaryMapCache cache;
+	BOOST_CHECK(!loadCache(cache));
+}
+
+BOOST_FIXTURE_TEST_CASE(rejectOutOfRangeStringOffset, CacheFileFixture)
+{
+	getRecord<boost::uint32_t>(data, sizeof(cache::Header)) = header().stringDataSize;
+	writeCacheFile(data);
+
+	BinaryMapCache cache;
+	BOOST_CHECK(!loadCache(cache));
+}
+
+BOOST_FIXTURE_TEST_CASE(rejectInconsistentRanges, CacheFileFixture)
+{
+	BinaryMapCache cache;
+
+	// The entity claims more primitives than there are
+	std::vector<char> original(data);
+	getRecord<cache::EntityRecord>(data, getEntitiesOffset(header()) + sizeof(cache::EntityRecord)).numPrimitives++;
+	writeCacheFile(data);
+	BOOST_CHECK(!loadCache(cache));
+
+	// Patch dimensions not matching the number of control points
+	data = original;
+	getRecord<cache::PrimitiveRecord>(data, getPrimitivesOffset(header()) + sizeof(cache::PrimitiveRecord)).width++;
+	writeCacheFile(data);
+	BOOST_CHECK(!loadCache(cache));
+
+	// Unknown primitive type
+	data = original;
+	getRecord<cache::PrimitiveRecord>(data, getPrimitivesOffset(header())).type = 17;
+	writeCacheFile(data);
+	BOOST_CHECK(!loadCache(cache));
+
+	// The unmodified file is still fine
+	writeCacheFile(original);
+	BOOST_CHECK(loadCache(cache));
+}
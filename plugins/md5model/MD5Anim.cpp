@@ -133,6 +133,47 @@ void MD5Anim::parseFrame(std::size_t frame, parser::DefTokeniser& tok)
 	tok.assertNextToken("}");
 }
 
+void MD5Anim::decodeFrames()
+{
+	_frameKeys.resize(_frames.size() * _joints.size());
+
+	Keys::iterator frameKey = _frameKeys.begin();
+
+	for (std::size_t f = 0; f < _frames.size(); ++f)
+	{
+		const FrameKeys& values = _frames[f];
+
+		for (std::size_t i = 0; i < _joints.size(); ++i, ++frameKey)
+		{
+			const Joint& joint = _joints[i];
+
+			// Start with the base frame, the components are overwritten by the frame values
+			*frameKey = _baseFrame[i];
+
+			// The joint.firstKey member holds the offset into the frame data array
+			std::size_t key = joint.firstKey;
+
+			Vector3& origin = frameKey->origin;
+			Quaternion& orientation = frameKey->orientation;
+
+			if (joint.animComponents & Joint::X)		origin.x() = values[key++];
+			if (joint.animComponents & Joint::Y)		origin.y() = values[key++];
+			if (joint.animComponents & Joint::Z)		origin.z() = values[key++];
+			if (joint.animComponents & Joint::YAW)		orientation.x() = values[key++];
+			if (joint.animComponents & Joint::PITCH)	orientation.y() = values[key++];
+			if (joint.animComponents & Joint::ROLL)		orientation.z() = values[key++];
+
+			if (joint.animComponents & (Joint::YAW | Joint::PITCH | Joint::ROLL))
+			{
+				// Calculate the fourth component of the quaternion
+				float w = -sqrt(1.0f - static_cast<float>(orientation.getVector3().getLengthSquared()));
+
+				orientation.w() = isNaN(w) ? 0 : w;
+			}
+		}
+	}
+}
+
 void MD5Anim::parseFromStream(std::istream& stream)
 {
 	parser::BasicDefTokeniser<std::istream> tokeniser(stream);
@@ -188,6 +229,8 @@ void MD5Anim::parseFromTokens(parser::DefTokeniser& tok)
 		{
 			parseFrame(i, tok);
 		}
+
+		decodeFrames();
 	}
 	catch (parser::ParseException& ex)
 	{
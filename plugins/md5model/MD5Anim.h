@@ -34,6 +34,9 @@ private:
 	// Each frame has <numAnimatedComponents> float values
 	std::vector<FrameKeys> _frames;
 
+	// The joint keys of all frames (numFrames * numJoints), decoded after parsing
+	Keys _frameKeys;
+
 public:
 	MD5Anim();
 
@@ -72,6 +75,11 @@ public:
 		return _frames[index];
 	}
 
+	const Key& getFrameKey(std::size_t frame, std::size_t jointNum) const
+	{
+		return _frameKeys[frame * _joints.size() + jointNum];
+	}
+
 	void parseFromStream(std::istream& stream);
 
 private:
@@ -80,6 +88,9 @@ private:
 	void parseFrameBounds(parser::DefTokeniser& tok);
 	void parseBaseFrame(parser::DefTokeniser& tok);
 	void parseFrame(std::size_t frame, parser::DefTokeniser& tok);
+
+	// Applies the frame values to the base frame, fills in the _frameKeys
+	void decodeFrames();
 };
 typedef boost::shared_ptr<MD5Anim> MD5AnimPtr;
 
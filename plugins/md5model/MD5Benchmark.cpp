@@ -0,0 +1,167 @@
+#include "MD5Benchmark.h"
+
+#include "itextstream.h"
+#include "imd5anim.h"
+
+#include "debugging/ScopedDebugTimer.h"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+
+#include "MD5ModelLoader.h"
+#include "MD5Model.h"
+#include "MD5Skeleton.h"
+
+namespace md5
+{
+
+namespace benchmark
+{
+
+namespace
+{
+	const std::size_t DEFAULT_NUM_INSTANCES = 32;
+
+	// The time between two sampled frames in msec
+	const std::size_t TIME_STEP = 16;
+
+	typedef std::vector<MD5SurfacePtr> Surfaces;
+
+	// The skinning as it was done before the float kernel, used as reference
+	void skinReference(const MD5Mesh& mesh, const MD5Skeleton& skeleton, std::vector<Vector3>& vertices)
+	{
+		vertices.resize(mesh.vertices.size());
+
+		for (std::size_t j = 0; j < mesh.vertices.size(); ++j)
+		{
+			const MD5Vert& vert = mesh.vertices[j];
+
+			Vector3 skinned(0, 0, 0);
+
+			for (std::size_t k = 0; k != vert.weight_count; ++k)
+			{
+				const MD5Weight& weight = mesh.weights[vert.weight_index + k];
+				const IMD5Anim::Key& key = skeleton.getKey(weight.joint);
+
+				Vector3 rotatedPoint = key.orientation.transformPoint(weight.v);
+				skinned += (rotatedPoint + key.origin) * weight.t;
+			}
+
+			vertices[j] = skinned;
+		}
+	}
+}
+
+void skinningCmd(const cmd::ArgumentList& args)
+{
+	if (args.size() < 2)
+	{
+		rError() << "Usage: BenchmarkMD5Skinning <md5mesh path> <md5anim path> [instances]" << std::endl;
+		return;
+	}
+
+	MD5ModelLoader loader;
+	MD5ModelPtr model = boost::dynamic_pointer_cast<MD5Model>(loader.loadModelFromPath(args[0].getString()));
+
+	if (!model)
+	{
+		rError() << "Could not load the model " << args[0].getString() << std::endl;
+		return;
+	}
+
+	IMD5AnimPtr anim = GlobalAnimationCache().getAnim(args[1].getString());
+
+	if (!anim || anim->getNumFrames() == 0 || anim->getFrameRate() <= 0)
+	{
+		rError() << "Could not load the animation " << args[1].getString() << std::endl;
+		return;
+	}
+
+	std::size_t numInstances = args.size() > 2 ?
+		static_cast<std::size_t>(std::max(args[2].getInt(), 1)) : DEFAULT_NUM_INSTANCES;
+
+	// Each instance has its own skeleton and surfaces, the meshes are shared
+	std::vector<MD5Skeleton> skeletons(numInstances);
+	Surfaces surfaces;
+
+	for (std::size_t i = 0; i < numInstances; ++i)
+	{
+		for (MD5Model::const_iterator s = model->begin(); s != model->end(); ++s)
+		{
+			surfaces.push_back(MD5SurfacePtr(new MD5Surface(*s->surface)));
+		}
+	}
+
+	std::size_t numSurfaces = model->size();
+	std::size_t duration = 1000 * anim->getNumFrames() / anim->getFrameRate();
+	std::size_t numSteps = std::max(duration / TIME_STEP, static_cast<std::size_t>(1));
+
+	rMessage() << "Playing " << numSteps << " steps of " << args[1].getString()
+		<< " on " << numInstances << " instances of " << args[0].getString()
+		<< " (" << model->getVertexCount() << " vertices)..." << std::endl;
+
+	double samplingTime = 0;
+	double skinningTime = 0;
+	double referenceTime = 0;
+	double maxDeviation = 0;
+
+	std::vector<Vector3> reference;
+
+	for (std::size_t step = 0; step < numSteps; ++step)
+	{
+		std::size_t time = step * TIME_STEP;
+
+		StopWatch stopWatch;
+
+		for (std::size_t i = 0; i < numInstances; ++i)
+		{
+			skeletons[i].update(anim, time);
+		}
+
+		samplingTime += stopWatch.getSeconds();
+		stopWatch.restart();
+
+		for (std::size_t i = 0; i < numInstances; ++i)
+		{
+			for (std::size_t s = 0; s < numSurfaces; ++s)
+			{
+				surfaces[i * numSurfaces + s]->skinVertices(skeletons[i].getJointMatrices());
+			}
+		}
+
+		skinningTime += stopWatch.getSeconds();
+		stopWatch.restart();
+
+		for (std::size_t i = 0; i < numInstances; ++i)
+		{
+			for (std::size_t s = 0; s < numSurfaces; ++s)
+			{
+				skinReference(surfaces[i * numSurfaces + s]->getMesh(), skeletons[i], reference);
+			}
+		}
+
+		referenceTime += stopWatch.getSeconds();
+
+		// Compare the last surface of the last instance
+		const MD5Surface& surface = *surfaces.back();
+
+		for (std::size_t v = 0; v < reference.size(); ++v)
+		{
+			Vector3 delta = surface.getVertex(static_cast<int>(v)).vertex - reference[v];
+
+			maxDeviation = std::max(maxDeviation, std::max(std::fabs(delta.x()),
+				std::max(std::fabs(delta.y()), std::fabs(delta.z()))));
+		}
+	}
+
+	std::size_t numSkinnedVertices = numSteps * numInstances * model->getVertexCount();
+
+	rMessage() << "Sampled the skeletons in " << samplingTime << " seconds." << std::endl;
+	rMessage() << "Skinned " << numSkinnedVertices << " vertices in " << skinningTime
+		<< " seconds (reference: " << referenceTime << " seconds)." << std::endl;
+	rMessage() << "Largest deviation from the reference: " << maxDeviation << std::endl;
+}
+
+} // namespace
+
+} // namespace
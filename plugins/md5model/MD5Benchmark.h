@@ -0,0 +1,24 @@
+#pragma once
+
+#include "icommandsystem.h"
+
+namespace md5
+{
+
+namespace benchmark
+{
+
+/**
+ * Console command playing back the given MD5 animation on a number of
+ * instances (32 if omitted) of the given MD5 mesh, sampled at 60 fps. The
+ * timings for sampling the skeletons and for skinning the surfaces are
+ * written to the console, along with the timing and the deviation of a
+ * double precision reference implementation.
+ *
+ * Usage: BenchmarkMD5Skinning <md5mesh path> <md5anim path> [instances]
+ */
+void skinningCmd(const cmd::ArgumentList& args);
+
+} // namespace
+
+} // namespace
@@ -77,6 +77,76 @@ struct MD5Weight
 
 typedef std::vector<MD5Weight> MD5Weights;
 
+/**
+ * A joint's orientation and position as 3x4 float matrix (row-major, the
+ * translation in the fourth column), as used by the skinning code.
+ */
+struct MD5JointMatrix
+{
+	float m[12];
+
+	MD5JointMatrix()
+	{}
+
+	MD5JointMatrix(const Quaternion& q, const Vector3& origin)
+	{
+		// Same as Quaternion::transformPoint, which doesn't require q to be normalised
+		double xx = q.x() * q.x();
+		double yy = q.y() * q.y();
+		double zz = q.z() * q.z();
+		double ww = q.w() * q.w();
+
+		double xy2 = q.x() * q.y() * 2;
+		double xz2 = q.x() * q.z() * 2;
+		double xw2 = q.x() * q.w() * 2;
+		double yz2 = q.y() * q.z() * 2;
+		double yw2 = q.y() * q.w() * 2;
+		double zw2 = q.z() * q.w() * 2;
+
+		m[0] = static_cast<float>(ww + xx - yy - zz);
+		m[1] = static_cast<float>(xy2 - zw2);
+		m[2] = static_cast<float>(xz2 + yw2);
+		m[3] = static_cast<float>(origin.x());
+
+		m[4] = static_cast<float>(xy2 + zw2);
+		m[5] = static_cast<float>(ww - xx + yy - zz);
+		m[6] = static_cast<float>(yz2 - xw2);
+		m[7] = static_cast<float>(origin.y());
+
+		m[8] = static_cast<float>(xz2 - yw2);
+		m[9] = static_cast<float>(yz2 + xw2);
+		m[10] = static_cast<float>(ww - xx - yy + zz);
+		m[11] = static_cast<float>(origin.z());
+	}
+};
+typedef std::vector<MD5JointMatrix> MD5JointMatrices;
+
+/**
+ * The weights of a mesh in a flat float layout, one array per component,
+ * for a tight skinning loop. The weight positions are pre-multiplied with
+ * their strength, which is applied to the joint translation instead.
+ */
+struct MD5SkinningWeights
+{
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+	std::vector<float> t;
+	std::vector<unsigned int> joint;
+
+	// The number of joints referenced by the weights (highest index + 1)
+	std::size_t numJoints;
+
+	MD5SkinningWeights() :
+		numJoints(0)
+	{}
+
+	std::size_t size() const
+	{
+		return t.size();
+	}
+};
+
 // The combination of vertices, triangles and weighting information
 // represents our MD5 mesh - using this info it's possible to create
 // the actual rendered geometry (position, normals, etc.)
@@ -85,6 +155,9 @@ struct MD5Mesh
 	MD5Verts	vertices;
 	MD5Tris		triangles;
 	MD5Weights	weights;
+
+	// The weights prepared for skinning, built after parsing
+	MD5SkinningWeights skinningWeights;
 };
 typedef boost::shared_ptr<MD5Mesh> MD5MeshPtr;
 
@@ -26,20 +26,32 @@ MD5Model::MD5Model(const MD5Model& other) :
 	_modelPath(other._modelPath),
 	_renderableSkeleton(_skeleton)
 {
-	// Copy-construct the other model's surfaces, but not its shaders, revert to default
+	// Share the other model's surfaces, but not its shaders, revert to default
+	// The surfaces are copied as soon as this model is getting animated.
 	for (std::size_t i = 0; i < other._surfaces.size(); ++i)
 	{
-		_surfaces[i].surface.reset(new MD5Surface(*other._surfaces[i].surface));
+		_surfaces[i].surface = other._surfaces[i].surface;
 		_surfaces[i].activeMaterial = _surfaces[i].surface->getDefaultMaterial();
-
-		// Build the index array - this has to happen at least once
-		_surfaces[i].surface->buildIndexArray();
-		_surfaces[i].surface->updateToDefaultPose(_joints);
 	}
 
 	updateMaterialList();
 }
 
+void MD5Model::ensureUniqueSurfaces()
+{
+	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
+	{
+		if (!i->surface.unique())
+		{
+			// Another model is using this surface, get our own copy before changing it
+			i->surface.reset(new MD5Surface(*i->surface));
+
+			// Build the index array - this has to happen at least once
+			i->surface->buildIndexArray();
+		}
+	}
+}
+
 MD5Model::const_iterator MD5Model::begin() const {
 	return _surfaces.begin();
 }
@@ -333,7 +345,11 @@ void MD5Model::setAnim(const IMD5AnimPtr& anim)
 	{
 		for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
 		{
-			i->surface->updateToDefaultPose(_joints);
+			// Shared surfaces are never animated, they're still in the default pose
+			if (i->surface.unique())
+			{
+				i->surface->updateToDefaultPose(_joints);
+			}
 		}
 	}
 }
@@ -350,6 +366,8 @@ void MD5Model::updateAnim(std::size_t time)
 	// Update our joint hierarchy first
 	_skeleton.update(_anim, time);
 
+	ensureUniqueSurfaces();
+
 	for (SurfaceList::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i)
 	{
 		i->surface->updateToSkeleton(_skeleton);
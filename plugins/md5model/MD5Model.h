@@ -15,8 +15,9 @@ namespace md5
 /**
  * A geometry/anim/shader/skin managing object for MD5 models which
  * is embedded into an MD5ModelNode. Each MD5Model object references
- * one or more MD5Surface objects, which are not shared across MD5Models
- * since they are animated.
+ * one or more MD5Surface objects. Copies of an MD5Model share the
+ * surfaces of the original until they get animated, at which point
+ * the surfaces are copied.
  */
 class MD5Model :
 	public IMD5Model,
@@ -78,7 +79,7 @@ public:
 	MD5Model();
 
 	// Copy constructor - re-uses the MD5ModelDef from <other>,
-	// Surfaces are copied and assigned their default material
+	// Surfaces are shared and assigned their default material
 	MD5Model(const MD5Model& other);
 
 	typedef SurfaceList::const_iterator const_iterator;
@@ -157,6 +158,9 @@ private:
 	// Creates a new MD5Surface, adds it to the local list and returns the reference
 	MD5Surface& createNewSurface();
 
+	// Replaces the surfaces shared with other models by own copies
+	void ensureUniqueSurfaces();
+
 	// Re-populates the list of active shader names
 	void updateMaterialList();
 
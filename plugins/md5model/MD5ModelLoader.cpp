@@ -9,6 +9,7 @@
 #include "os/path.h"
 
 #include "MD5ModelNode.h"
+#include "MD5Benchmark.h"
 
 namespace md5
  {
@@ -101,6 +102,13 @@ model::IModelPtr MD5ModelLoader::loadModelFromPath(const std::string& name)
 	}
 }
 
+model::ModelPreloadPtr MD5ModelLoader::preloadModelFromPath(const std::string& name)
+{
+	// The surfaces create their display lists while being parsed,
+	// MD5 models are always loaded on the main thread
+	return model::ModelPreloadPtr();
+}
+
 // RegisterableModule implementation
 const std::string& MD5ModelLoader::getName() const
 {
@@ -116,6 +124,7 @@ const StringSet& MD5ModelLoader::getDependencies() const
 		_dependencies.insert(MODULE_VIRTUALFILESYSTEM);
 		_dependencies.insert(MODULE_FILETYPES);
 		_dependencies.insert(MODULE_RENDERSYSTEM);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
 	}
 
 	return _dependencies;
@@ -131,6 +140,9 @@ void MD5ModelLoader::initialiseModule(const ApplicationContext& ctx)
 	// Register the model file extension in the FileTypRegistry
 	GlobalFiletypes().registerPattern("model", FileTypePattern("MD5 Meshes", extLower, filter));
 	GlobalFiletypes().registerModule("model", extLower, getName());
+
+	GlobalCommandSystem().addCommand("BenchmarkMD5Skinning", benchmark::skinningCmd,
+		cmd::Signature(cmd::ARGTYPE_STRING, cmd::ARGTYPE_STRING, cmd::ARGTYPE_INT | cmd::ARGTYPE_OPTIONAL));
 }
 
 } // namespace md5
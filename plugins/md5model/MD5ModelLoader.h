@@ -19,6 +19,9 @@ public:
 	// Documentation: See imodel.h
 	model::IModelPtr loadModelFromPath(const std::string& name);
 
+	// Documentation: See imodel.h
+	model::ModelPreloadPtr preloadModelFromPath(const std::string& name);
+
 	// RegisterableModule implementation
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
@@ -67,7 +67,14 @@ namespace
 
 void MD5Skeleton::update(const IMD5AnimPtr& anim, std::size_t time)
 {
+	// Several models might be updated to the same time, or the time didn't change
+	if (anim == _anim && time == _time && _matrices.size() == _skeleton.size())
+	{
+		return;
+	}
+
 	_anim = anim;
+	_time = time;
 
 	// Update the joint positions, recursively, starting from the first
 	// Only root nodes need to be processed, the children are reached through them
@@ -91,82 +98,29 @@ void MD5Skeleton::update(const IMD5AnimPtr& anim, std::size_t time)
 	std::size_t curFrame = static_cast<std::size_t>(std::floor(frameTime)) % _anim->getNumFrames();
 	std::size_t nextFrame = curFrame == _anim->getNumFrames() -1 ? curFrame : (curFrame + 1) % _anim->getNumFrames();
 
-	// Apply the current frame keys to the base frame
+	// Interpolate between the decoded keys of the two frames, these are shared
+	// by all the models playing this animation
 	for (std::size_t i = 0; i < numJoints; ++i)
 	{
 		const Joint& joint = _anim->getJoint(i);
-		const IMD5Anim::Key& baseKey = _anim->getBaseFrameKey(joint.id);
-
-		// Apply base frame
-		_skeleton[i].origin = baseKey.origin;
-		_skeleton[i].orientation = baseKey.orientation;
-		
-		// Apply actual frame data
-		const IMD5Anim::FrameKeys& cur = _anim->getFrameKeys(curFrame);
-		const IMD5Anim::FrameKeys& next = _anim->getFrameKeys(nextFrame);
-
-		// The joint.firstKey member holds the offset into the frame data array
-		std::size_t key = joint.firstKey;
-
-		// Shortcuts for handling the rotations
-		Quaternion& orientation = _skeleton[i].orientation;
-		Quaternion nextOrientation = baseKey.orientation;
-
-		// Animate each vector component, interpolating values in between frames
-
-		if (joint.animComponents & Joint::X)
-		{
-			_skeleton[i].origin.x() = cur[key]*curFrameFrac + next[key]*nextFrameFrac;
-			key++;
-		}
+		const IMD5Anim::Key& cur = _anim->getFrameKey(curFrame, i);
 
-		if (joint.animComponents & Joint::Y)
-		{
-			_skeleton[i].origin.y() = cur[key]*curFrameFrac + next[key]*nextFrameFrac;
-			key++;
-		}
+		bool rotates = (joint.animComponents & (Joint::YAW | Joint::PITCH | Joint::ROLL)) != 0;
 
-		if (joint.animComponents & Joint::Z)
+		if (nextFrame == curFrame || nextFrameFrac == 0)
 		{
-			_skeleton[i].origin.z() = cur[key]*curFrameFrac + next[key]*nextFrameFrac;
-			key++;
+			// No blending necessary
+			_skeleton[i].origin = cur.origin;
+			_skeleton[i].orientation = rotates ? cur.orientation.getNormalised() : cur.orientation;
+			continue;
 		}
 
-		if (joint.animComponents & Joint::YAW)
-		{
-			orientation.x() = cur[key];
-			nextOrientation.x() = next[key];
-			key++;
-		}
+		const IMD5Anim::Key& next = _anim->getFrameKey(nextFrame, i);
 
-		if (joint.animComponents & Joint::PITCH)
-		{
-			orientation.y() = cur[key];
-			nextOrientation.y() = next[key];
-			key++;
-		}
-
-		if (joint.animComponents & Joint::ROLL)
-		{
-			orientation.z() = cur[key];
-			nextOrientation.z() = next[key];
-			key++;
-		}
-
-		if (joint.animComponents & (Joint::YAW | Joint::PITCH | Joint::ROLL))
-		{
-			float lSq = orientation.getVector3().getLengthSquared();
-			float w = -sqrt(1.0f - lSq);
-
-			orientation.w() = isNaN(w) ? 0 : w;
-
-			lSq = nextOrientation.getVector3().getLengthSquared();
-			w = -sqrt(1.0f - lSq);
-
-			nextOrientation.w() = isNaN(w) ? 0 : w;
-
-			orientation = slerp(orientation, nextOrientation, nextFrameFrac).getNormalised();
-		}
+		_skeleton[i].origin = cur.origin*curFrameFrac + next.origin*nextFrameFrac;
+		_skeleton[i].orientation = rotates ?
+			slerp(cur.orientation, next.orientation, nextFrameFrac).getNormalised() :
+			cur.orientation;
 	}
 
 	for (std::size_t i = 0; i < numJoints; ++i)
@@ -178,6 +132,13 @@ void MD5Skeleton::update(const IMD5AnimPtr& anim, std::size_t time)
 			updateJointRecursively(i);
 		}
 	}
+
+	_matrices.resize(numJoints);
+
+	for (std::size_t i = 0; i < numJoints; ++i)
+	{
+		_matrices[i] = MD5JointMatrix(_skeleton[i].orientation, _skeleton[i].origin);
+	}
 }
 
 void MD5Skeleton::updateJointRecursively(std::size_t jointId)
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "imd5anim.h"
+#include "MD5DataStructures.h"
 
 namespace md5
 {
@@ -20,7 +21,17 @@ protected:
 	// The current animation, needed to get joint information etc.
 	IMD5AnimPtr _anim;
 
+	// The time of the last update, the skeleton is not recalculated for the same time
+	std::size_t _time;
+
+	// The joints as matrices, ready for skinning
+	MD5JointMatrices _matrices;
+
 public:
+	MD5Skeleton() :
+		_time(0)
+	{}
+
 	// Update the skeleton to match the given animation at the given time
 	void update(const IMD5AnimPtr& anim, std::size_t time);
 
@@ -34,6 +45,11 @@ public:
 		return _skeleton[jointIndex];
 	}
 
+	const MD5JointMatrices& getJointMatrices() const
+	{
+		return _matrices;
+	}
+
 	const Joint& getJoint(std::size_t index) const
 	{
 		return _anim->getJoint(index);
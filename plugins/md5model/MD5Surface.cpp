@@ -4,6 +4,7 @@
 #include "GLProgramAttributes.h"
 #include "string/convert.h"
 #include "MD5Model.h"
+#include <algorithm>
 
 namespace md5
 {
@@ -202,6 +203,11 @@ model::ModelPolygon MD5Surface::getPolygon(int polygonIndex) const
 	return poly;
 }
 
+const MD5Mesh& MD5Surface::getMesh() const
+{
+	return *_mesh;
+}
+
 const std::string& MD5Surface::getDefaultMaterial() const
 {
 	return _originalShaderName;
@@ -209,68 +215,81 @@ const std::string& MD5Surface::getDefaultMaterial() const
 
 void MD5Surface::updateToDefaultPose(const MD5Joints& joints)
 {
-	if (_vertices.size() != _mesh->vertices.size())
+	MD5JointMatrices matrices;
+	matrices.reserve(joints.size());
+
+	for (MD5Joints::const_iterator i = joints.begin(); i != joints.end(); ++i)
 	{
-		_vertices.resize(_mesh->vertices.size());
+		matrices.push_back(MD5JointMatrix(i->rotation, i->position));
 	}
 
-	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
-	{
-		MD5Vert& vert = _mesh->vertices[j];
+	skinVertices(matrices);
 
-		Vector3 skinned(0, 0, 0);
+	updateGeometry();
+}
 
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
-		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const MD5Joint& joint = joints[weight.joint];
+void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
+{
+	skinVertices(skeleton.getJointMatrices());
 
-			Vector3 rotatedPoint = joint.rotation.transformPoint(weight.v);
-			skinned += (rotatedPoint + joint.position) * weight.t;
-		}
+	updateGeometry();
+}
 
-		_vertices[j].vertex = skinned;
-		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
-		_vertices[j].normal = Normal3f(0,0,0);
+void MD5Surface::skinVertices(const MD5JointMatrices& joints)
+{
+	const MD5SkinningWeights& weights = _mesh->skinningWeights;
+	std::size_t numWeights = weights.size();
+
+	// Ensure we have all vertices allocated
+	if (_vertices.size() != _mesh->vertices.size())
+	{
+		_vertices.resize(_mesh->vertices.size());
 	}
 
-	// Ensure the index array is ok
-	if (_indices.empty())
+	// An animation not matching this mesh, leave the vertices alone
+	if (joints.size() < weights.numJoints || numWeights == 0)
 	{
-		buildIndexArray();
+		return;
 	}
 
-	buildVertexNormals();
+	// Transform all the weights in one go, the loop is free of branches
+	// and works on the flat float arrays only
+	_weightPositions.resize(numWeights * 3);
 
-	updateGeometry();
-}
+	float* px = &_weightPositions[0];
+	float* py = px + numWeights;
+	float* pz = py + numWeights;
 
-void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
-{
-	// Ensure we have all vertices allocated
-	if (_vertices.size() != _mesh->vertices.size())
+	const float* wx = &weights.x[0];
+	const float* wy = &weights.y[0];
+	const float* wz = &weights.z[0];
+	const float* wt = &weights.t[0];
+	const unsigned int* wj = &weights.joint[0];
+
+	for (std::size_t i = 0; i < numWeights; ++i)
 	{
-		_vertices.resize(_mesh->vertices.size());
+		const float* m = joints[wj[i]].m;
+
+		px[i] = m[0] * wx[i] + m[1] * wy[i] + m[2] * wz[i] + m[3] * wt[i];
+		py[i] = m[4] * wx[i] + m[5] * wy[i] + m[6] * wz[i] + m[7] * wt[i];
+		pz[i] = m[8] * wx[i] + m[9] * wy[i] + m[10] * wz[i] + m[11] * wt[i];
 	}
 
-	// Deform vertices to fit the skeleton
+	// Each vertex is the sum of its weights, which are stored contiguously
 	for (std::size_t j = 0; j < _mesh->vertices.size(); ++j)
 	{
-		MD5Vert& vert = _mesh->vertices[j];
+		const MD5Vert& vert = _mesh->vertices[j];
 
-		Vector3 skinned(0, 0, 0);
+		float x = 0, y = 0, z = 0;
 
-		for (std::size_t k = 0; k != vert.weight_count; ++k)
+		for (std::size_t k = vert.weight_index; k < vert.weight_index + vert.weight_count; ++k)
 		{
-			MD5Weight& weight = _mesh->weights[vert.weight_index + k];
-			const IMD5Anim::Key& key = skeleton.getKey(weight.joint);
-			//const Joint& joint = skeleton.getJoint(weight.joint);
-
-			Vector3 rotatedPoint = key.orientation.transformPoint(weight.v);
-			skinned += (rotatedPoint + key.origin) * weight.t;
+			x += px[k];
+			y += py[k];
+			z += pz[k];
 		}
 
-		_vertices[j].vertex = skinned;
+		_vertices[j].vertex = Vertex3f(x, y, z);
 		_vertices[j].texcoord = TexCoord2f(vert.u, vert.v);
 		_vertices[j].normal = Normal3f(0,0,0);
 	}
@@ -282,8 +301,6 @@ void MD5Surface::updateToSkeleton(const MD5Skeleton& skeleton)
 	}
 
 	buildVertexNormals();
-
-	updateGeometry();
 }
 
 void MD5Surface::buildVertexNormals()
@@ -417,6 +434,34 @@ void MD5Surface::parseFromTokens(parser::DefTokeniser& tok)
 	// ----- END OF MESH DECL -----
 
 	tok.assertNextToken("}");
+
+	buildSkinningWeights();
+}
+
+void MD5Surface::buildSkinningWeights()
+{
+	const MD5Weights& weights = _mesh->weights;
+	MD5SkinningWeights& skinning = _mesh->skinningWeights;
+
+	skinning.x.resize(weights.size());
+	skinning.y.resize(weights.size());
+	skinning.z.resize(weights.size());
+	skinning.t.resize(weights.size());
+	skinning.joint.resize(weights.size());
+	skinning.numJoints = 0;
+
+	for (std::size_t i = 0; i < weights.size(); ++i)
+	{
+		const MD5Weight& weight = weights[i];
+
+		skinning.x[i] = static_cast<float>(weight.v.x() * weight.t);
+		skinning.y[i] = static_cast<float>(weight.v.y() * weight.t);
+		skinning.z[i] = static_cast<float>(weight.v.z() * weight.t);
+		skinning.t[i] = weight.t;
+		skinning.joint[i] = static_cast<unsigned int>(weight.joint);
+
+		skinning.numJoints = std::max(skinning.numJoints, weight.joint + 1);
+	}
 }
 
 } // namespace md5
@@ -43,6 +43,9 @@ private:
 	GLuint _normalList;
 	GLuint _lightingList;
 
+	// Scratch space for the skinning, the transformed weight positions
+	std::vector<float> _weightPositions;
+
 private:
 
 	// Create the display lists
@@ -51,6 +54,9 @@ private:
 	// Re-calculate the normal vectors
 	void buildVertexNormals();
 
+	// Fills in the flat weight arrays of the mesh, needed for skinning
+	void buildSkinningWeights();
+
 public:
 
 	/**
@@ -83,6 +89,10 @@ public:
 	// Updates this mesh to the state of the given skeleton
 	void updateToSkeleton(const MD5Skeleton& skeleton);
 
+	// Calculates the vertex positions and normals for the given joints,
+	// without updating the bounds and the GL display lists
+	void skinVertices(const MD5JointMatrices& joints);
+
 	// Applies the given Skin to this surface.
 	void applySkin(const ModelSkin& skin);
 
@@ -106,6 +116,9 @@ public:
 	const ArbitraryMeshVertex& getVertex(int vertexIndex) const;
 	model::ModelPolygon getPolygon(int polygonIndex) const;
 
+	// The mesh definition shared by the copies of this surface
+	const MD5Mesh& getMesh() const;
+
 	const std::string& getDefaultMaterial() const;
 	const std::string& getActiveMaterial() const;
 	void setActiveMaterial(const std::string& activeMaterial);
@@ -0,0 +1,368 @@
+#include "BinaryModelCache.h"
+
+#include "itextstream.h"
+#include "os/dir.h"
+#include "RenderablePicoSurface.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace model
+{
+
+namespace
+{
+	const char* const CACHE_FILE_EXTENSION = ".meshcache";
+	const char MAGIC[4] = { 'D', 'R', 'M', 'M' };
+
+	const boost::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+	const boost::uint64_t FNV_PRIME = 1099511628211ULL;
+
+	// 64 bit FNV-1a
+	boost::uint64_t getHash(const unsigned char* data, std::size_t size)
+	{
+		boost::uint64_t hash = FNV_OFFSET_BASIS;
+
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= data[i];
+			hash *= FNV_PRIME;
+		}
+
+		return hash;
+	}
+
+	// Returns the number of bytes occupied by an array of the given records
+	template<typename RecordType>
+	std::size_t getArraySize(boost::uint32_t count)
+	{
+		return static_cast<std::size_t>(count) * sizeof(RecordType);
+	}
+
+	template<typename RecordType>
+	void writeArray(std::ostream& stream, const std::vector<RecordType>& records)
+	{
+		if (!records.empty())
+		{
+			stream.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(RecordType));
+		}
+	}
+
+	void copyVector(float* dest, const Vector3& src)
+	{
+		dest[0] = static_cast<float>(src.x());
+		dest[1] = static_cast<float>(src.y());
+		dest[2] = static_cast<float>(src.z());
+	}
+}
+
+BinaryModelCache::BinaryModelCache() :
+	_header(NULL),
+	_surfaces(NULL),
+	_vertices(NULL),
+	_indices(NULL)
+{}
+
+std::string BinaryModelCache::getFilename(const std::string& cachePath, const std::string& modelPath)
+{
+	std::ostringstream filename;
+	filename << cachePath << std::hex << std::setw(16) << std::setfill('0')
+		<< getHash(reinterpret_cast<const unsigned char*>(modelPath.data()), modelPath.size())
+		<< CACHE_FILE_EXTENSION;
+
+	return filename.str();
+}
+
+boost::uint64_t BinaryModelCache::getContentHash(const std::vector<unsigned char>& data)
+{
+	return data.empty() ? FNV_OFFSET_BASIS : getHash(&data[0], data.size());
+}
+
+bool BinaryModelCache::load(const std::string& filename, const std::string& modelPath,
+							boost::uint64_t contentHash, std::size_t contentSize)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	cache::Header header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+		header.version != cache::VERSION ||
+		header.contentHash != contentHash ||
+		header.contentSize != contentSize)
+	{
+		return false;
+	}
+
+	std::size_t size = sizeof(cache::Header) +
+		getArraySize<boost::uint32_t>(header.numStrings) +
+		header.stringDataSize +
+		getArraySize<cache::SurfaceRecord>(header.numSurfaces) +
+		getArraySize<cache::VertexRecord>(header.numVertices) +
+		getArraySize<boost::uint32_t>(header.numIndices);
+
+	// The section sizes must add up to the file size
+	file.seekg(0, std::ios::end);
+
+	if (static_cast<std::size_t>(file.tellg()) != size)
+	{
+		return false;
+	}
+
+	// Read the whole file in one go, the records are accessed in place
+	_buffer.resize(size);
+	std::memcpy(&_buffer[0], &header, sizeof(header));
+
+	file.seekg(sizeof(header), std::ios::beg);
+
+	if (!file.read(&_buffer[sizeof(header)], size - sizeof(header)))
+	{
+		return false;
+	}
+
+	const char* pos = &_buffer[0];
+
+	_header = reinterpret_cast<const cache::Header*>(pos);
+	pos += sizeof(cache::Header);
+
+	const boost::uint32_t* stringOffsets = reinterpret_cast<const boost::uint32_t*>(pos);
+	pos += getArraySize<boost::uint32_t>(header.numStrings);
+
+	const char* stringData = pos;
+	pos += header.stringDataSize;
+
+	_surfaces = reinterpret_cast<const cache::SurfaceRecord*>(pos);
+	pos += getArraySize<cache::SurfaceRecord>(header.numSurfaces);
+
+	_vertices = reinterpret_cast<const cache::VertexRecord*>(pos);
+	pos += getArraySize<cache::VertexRecord>(header.numVertices);
+
+	_indices = reinterpret_cast<const boost::uint32_t*>(pos);
+
+	// Convert the string table, each string is null-terminated
+	_strings.clear();
+	_strings.reserve(header.numStrings);
+
+	for (std::size_t i = 0; i < header.numStrings; ++i)
+	{
+		if (stringOffsets[i] >= header.stringDataSize ||
+			std::memchr(stringData + stringOffsets[i], '\0', header.stringDataSize - stringOffsets[i]) == NULL)
+		{
+			return false;
+		}
+
+		_strings.push_back(std::string(stringData + stringOffsets[i]));
+	}
+
+	// Different models might end up in the same cache file
+	if (header.modelPath >= _strings.size() || _strings[header.modelPath] != modelPath)
+	{
+		return false;
+	}
+
+	return validate();
+}
+
+bool BinaryModelCache::validate() const
+{
+	std::size_t nextVertex = 0;
+	std::size_t nextIndex = 0;
+
+	// The surfaces are referring to consecutive ranges of vertices and indices
+	for (std::size_t i = 0; i < _header->numSurfaces; ++i)
+	{
+		const cache::SurfaceRecord& surface = _surfaces[i];
+
+		if (surface.firstVertex != nextVertex || surface.firstIndex != nextIndex ||
+			surface.numIndices % 3 != 0 ||
+			surface.shader >= _strings.size() ||
+			(surface.fallbackShader != cache::NO_STRING && surface.fallbackShader >= _strings.size()))
+		{
+			return false;
+		}
+
+		nextVertex += surface.numVertices;
+		nextIndex += surface.numIndices;
+
+		if (nextIndex > _header->numIndices)
+		{
+			return false;
+		}
+
+		for (std::size_t index = surface.firstIndex; index < nextIndex; ++index)
+		{
+			if (_indices[index] >= surface.numVertices)
+			{
+				return false;
+			}
+		}
+	}
+
+	return nextVertex == _header->numVertices && nextIndex == _header->numIndices;
+}
+
+std::size_t BinaryModelCache::getNumSurfaces() const
+{
+	return _header != NULL ? _header->numSurfaces : 0;
+}
+
+const cache::SurfaceRecord& BinaryModelCache::getSurface(std::size_t index) const
+{
+	return _surfaces[index];
+}
+
+const std::string& BinaryModelCache::getString(std::size_t index) const
+{
+	return _strings[index];
+}
+
+void BinaryModelCache::getSurfaceGeometry(std::size_t index,
+	std::vector<ArbitraryMeshVertex>& vertices, std::vector<unsigned int>& indices, AABB& localAABB) const
+{
+	const cache::SurfaceRecord& surface = _surfaces[index];
+
+	vertices.resize(surface.numVertices);
+
+	for (std::size_t i = 0; i < surface.numVertices; ++i)
+	{
+		const cache::VertexRecord& record = _vertices[surface.firstVertex + i];
+		ArbitraryMeshVertex& vertex = vertices[i];
+
+		vertex.texcoord = TexCoord2f(record.texcoord[0], record.texcoord[1]);
+		vertex.normal = Normal3f(record.normal[0], record.normal[1], record.normal[2]);
+		vertex.vertex = Vertex3f(record.vertex[0], record.vertex[1], record.vertex[2]);
+		vertex.tangent = Normal3f(record.tangent[0], record.tangent[1], record.tangent[2]);
+		vertex.bitangent = Normal3f(record.bitangent[0], record.bitangent[1], record.bitangent[2]);
+		vertex.colour = Vector3(record.colour[0], record.colour[1], record.colour[2]);
+	}
+
+	indices.assign(_indices + surface.firstIndex, _indices + surface.firstIndex + surface.numIndices);
+
+	localAABB = AABB(
+		Vector3(surface.origin[0], surface.origin[1], surface.origin[2]),
+		Vector3(surface.extents[0], surface.extents[1], surface.extents[2])
+	);
+}
+
+BinaryModelCacheWriter::BinaryModelCacheWriter(const std::string& modelPath,
+	boost::uint64_t contentHash, std::size_t contentSize)
+{
+	std::memset(&_header, 0, sizeof(_header));
+	std::memcpy(_header.magic, MAGIC, sizeof(MAGIC));
+
+	_header.version = cache::VERSION;
+	_header.contentHash = contentHash;
+	_header.contentSize = contentSize;
+	_header.modelPath = getStringIndex(modelPath);
+}
+
+void BinaryModelCacheWriter::addSurface(const RenderablePicoSurface& surface)
+{
+	cache::SurfaceRecord record;
+
+	record.shader = getStringIndex(surface.getPreferredShaderName());
+	record.fallbackShader = surface.getFallbackShaderName().empty() ?
+		cache::NO_STRING : getStringIndex(surface.getFallbackShaderName());
+
+	const std::vector<ArbitraryMeshVertex>& vertices = surface.getVertices();
+	const std::vector<unsigned int>& indices = surface.getIndices();
+
+	record.firstVertex = static_cast<boost::uint32_t>(_vertices.size());
+	record.numVertices = static_cast<boost::uint32_t>(vertices.size());
+	record.firstIndex = static_cast<boost::uint32_t>(_indices.size());
+	record.numIndices = static_cast<boost::uint32_t>(indices.size());
+
+	copyVector(record.origin, surface.getAABB().getOrigin());
+	copyVector(record.extents, surface.getAABB().getExtents());
+
+	_surfaces.push_back(record);
+
+	for (std::vector<ArbitraryMeshVertex>::const_iterator i = vertices.begin(); i != vertices.end(); ++i)
+	{
+		cache::VertexRecord vertex;
+
+		vertex.texcoord[0] = static_cast<float>(i->texcoord.x());
+		vertex.texcoord[1] = static_cast<float>(i->texcoord.y());
+		copyVector(vertex.normal, i->normal);
+		copyVector(vertex.vertex, i->vertex);
+		copyVector(vertex.tangent, i->tangent);
+		copyVector(vertex.bitangent, i->bitangent);
+		copyVector(vertex.colour, i->colour);
+
+		_vertices.push_back(vertex);
+	}
+
+	_indices.insert(_indices.end(), indices.begin(), indices.end());
+}
+
+boost::uint32_t BinaryModelCacheWriter::getStringIndex(const std::string& str)
+{
+	StringIndexMap::const_iterator found = _stringIndices.find(str);
+
+	if (found != _stringIndices.end())
+	{
+		return found->second;
+	}
+
+	boost::uint32_t index = static_cast<boost::uint32_t>(_stringOffsets.size());
+
+	_stringIndices.insert(StringIndexMap::value_type(str, index));
+	_stringOffsets.push_back(static_cast<boost::uint32_t>(_stringData.size()));
+
+	_stringData.append(str.c_str(), str.size() + 1);
+
+	return index;
+}
+
+bool BinaryModelCacheWriter::save(const std::string& filename)
+{
+	// Create the cache folder on first use (fails silently if it exists)
+	os::makeDirectory(filename.substr(0, filename.rfind('/')));
+
+	// Keep the following records 4-byte aligned
+	_stringData.resize((_stringData.size() + 3) & ~static_cast<std::size_t>(3), '\0');
+
+	_header.numStrings = static_cast<boost::uint32_t>(_stringOffsets.size());
+	_header.stringDataSize = static_cast<boost::uint32_t>(_stringData.size());
+	_header.numSurfaces = static_cast<boost::uint32_t>(_surfaces.size());
+	_header.numVertices = static_cast<boost::uint32_t>(_vertices.size());
+	_header.numIndices = static_cast<boost::uint32_t>(_indices.size());
+
+	std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		rError() << "[model] Could not open model cache file for writing: " << filename << std::endl;
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+	writeArray(file, _stringOffsets);
+	file.write(_stringData.data(), _stringData.size());
+	writeArray(file, _surfaces);
+	writeArray(file, _vertices);
+	writeArray(file, _indices);
+
+	if (!file)
+	{
+		file.close();
+
+		// Don't leave a truncated cache file behind
+		std::remove(filename.c_str());
+
+		rError() << "[model] Failed to write model cache file: " << filename << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+} // namespace model
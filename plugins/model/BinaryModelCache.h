@@ -0,0 +1,152 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "render/ArbitraryMeshVertex.h"
+#include "math/AABB.h"
+
+namespace model
+{
+
+class RenderablePicoSurface;
+
+/**
+ * The binary model cache keeps the preprocessed geometry of the picomodel
+ * formats in the user's settings folder (one file per model), so the text
+ * parsing and the tangent calculation can be skipped the next time the
+ * model is loaded: the final vertex and index arrays of each surface, its
+ * bounds and the cleaned up material names.
+ *
+ * The file consists of a header followed by arrays of fixed-size, 4-byte
+ * aligned records, which are accessed in place after loading the file.
+ * The cache is keyed by the VFS path of the model and a hash of its
+ * contents, a cache file not matching the model file is ignored.
+ */
+namespace cache
+{
+
+const boost::uint32_t VERSION = 1;
+
+// Marks a string index as unused
+const boost::uint32_t NO_STRING = 0xFFFFFFFF;
+
+struct Header
+{
+	char magic[4];
+	boost::uint32_t version;
+	boost::uint64_t contentHash;
+	boost::uint64_t contentSize;
+
+	boost::uint32_t numStrings;
+	boost::uint32_t stringDataSize;	// padded to a multiple of 4
+	boost::uint32_t numSurfaces;
+	boost::uint32_t numVertices;
+	boost::uint32_t numIndices;
+	boost::uint32_t modelPath;		// string index
+};
+
+struct SurfaceRecord
+{
+	boost::uint32_t shader;			// string index
+	boost::uint32_t fallbackShader;	// string index or NO_STRING
+	boost::uint32_t firstVertex;
+	boost::uint32_t numVertices;
+	boost::uint32_t firstIndex;
+	boost::uint32_t numIndices;
+	float origin[3];				// bounds
+	float extents[3];
+};
+
+struct VertexRecord
+{
+	float texcoord[2];
+	float normal[3];
+	float vertex[3];
+	float tangent[3];
+	float bitangent[3];
+	float colour[3];
+};
+
+} // namespace cache
+
+/**
+ * Read access to a loaded model cache file.
+ */
+class BinaryModelCache
+{
+private:
+	std::vector<char> _buffer;
+
+	const cache::Header* _header;
+	const cache::SurfaceRecord* _surfaces;
+	const cache::VertexRecord* _vertices;
+	const boost::uint32_t* _indices;
+
+	// The string table, converted once on load
+	std::vector<std::string> _strings;
+
+public:
+	BinaryModelCache();
+
+	// Returns the name of the cache file for the given VFS path in the given folder
+	static std::string getFilename(const std::string& cachePath, const std::string& modelPath);
+
+	// Returns the hash value the cache is keyed with
+	static boost::uint64_t getContentHash(const std::vector<unsigned char>& data);
+
+	/**
+	 * Loads the given cache file. Returns false if the file doesn't exist,
+	 * is damaged or doesn't belong to the model with the given path, hash and size.
+	 * All record indices are range-checked here, so the accessors can trust them.
+	 */
+	bool load(const std::string& filename, const std::string& modelPath,
+			  boost::uint64_t contentHash, std::size_t contentSize);
+
+	std::size_t getNumSurfaces() const;
+
+	const cache::SurfaceRecord& getSurface(std::size_t index) const;
+	const std::string& getString(std::size_t index) const;
+
+	// Converts the geometry of the given surface
+	void getSurfaceGeometry(std::size_t index, std::vector<ArbitraryMeshVertex>& vertices,
+							std::vector<unsigned int>& indices, AABB& localAABB) const;
+
+private:
+	bool validate() const;
+};
+
+/**
+ * Collects the surfaces of a loaded model and writes them to a cache file.
+ */
+class BinaryModelCacheWriter
+{
+private:
+	cache::Header _header;
+
+	std::vector<cache::SurfaceRecord> _surfaces;
+	std::vector<cache::VertexRecord> _vertices;
+	std::vector<boost::uint32_t> _indices;
+
+	// String interning, strings are stored in order of appearance
+	typedef std::map<std::string, boost::uint32_t> StringIndexMap;
+	StringIndexMap _stringIndices;
+	std::vector<boost::uint32_t> _stringOffsets;
+	std::string _stringData;
+
+public:
+	BinaryModelCacheWriter(const std::string& modelPath, boost::uint64_t contentHash,
+						   std::size_t contentSize);
+
+	void addSurface(const RenderablePicoSurface& surface);
+
+	// Writes the cache file, the folder is created if necessary. Returns false on failure.
+	bool save(const std::string& filename);
+
+private:
+	boost::uint32_t getStringIndex(const std::string& str);
+};
+
+} // namespace model
@@ -9,9 +9,14 @@
 
 #include "os/path.h"
 
+#include "plugin.h"
 #include "PicoModelNode.h"
+#include "RenderablePicoSurface.h"
+#include "BinaryModelCache.h"
 
 #include "idatastream.h"
+#include <algorithm>
+#include <glibmm/thread.h>
 #include <boost/algorithm/string/case_conv.hpp>
 
 namespace model {
@@ -27,8 +32,239 @@ namespace {
 	size_t picoInputStreamReam(void* inputStream, unsigned char* buffer, size_t length) {
 		return reinterpret_cast<InputStream*>(inputStream)->read(buffer, length);
 	}
+
+	// Reads the file contents which have already been loaded into memory
+	class MemoryInputStream :
+		public InputStream
+	{
+		const byte_type* _pos;
+		const byte_type* _end;
+	public:
+		MemoryInputStream(const std::vector<unsigned char>& data) :
+			_pos(data.empty() ? NULL : &data[0]),
+			_end(_pos + data.size())
+		{}
+
+		std::size_t read(byte_type* buffer, std::size_t length)
+		{
+			length = std::min(length, static_cast<std::size_t>(_end - _pos));
+
+			std::copy(_pos, _pos + length, buffer);
+			_pos += length;
+
+			return length;
+		}
+	};
+
+	// The LWO reader keeps the chunk length in a global variable,
+	// only one LWO file can be parsed at a time
+	Glib::Mutex& getLwoMutex()
+	{
+		static Glib::Mutex _mutex;
+		return _mutex;
+	}
 } // namespace
 
+// Model load split up into parsing the file (worker thread)
+// and creating the RenderablePicoModel (main thread)
+class PicoModelPreload :
+	public ModelPreload
+{
+	const picoModule_t* _module;
+	std::string _name;
+	ArchiveFilePtr _file;
+
+	// Lowercase file extension (ase, lwo, ...)
+	std::string _fExt;
+
+	// The binary cache file of this model, empty if the cache is not used
+	std::string _cacheFilename;
+
+	// The file contents and their hash, the cache is keyed with these
+	std::vector<unsigned char> _data;
+	boost::uint64_t _contentHash;
+	std::size_t _contentSize;
+
+	picoModel_t* _model;
+
+	// The surfaces found in the binary cache
+	struct CachedSurface
+	{
+		std::string shader;
+		std::string fallbackShader;
+		std::vector<ArbitraryMeshVertex> vertices;
+		std::vector<unsigned int> indices;
+		AABB localAABB;
+	};
+	std::vector<CachedSurface> _cachedSurfaces;
+
+	// The picomodel messages of parse(), logged by finish()
+	PicoMessageBuffer _messages;
+
+public:
+	PicoModelPreload(const picoModule_t* module, const std::string& name,
+					 const ArchiveFilePtr& file, const std::string& cacheFilename) :
+		_module(module),
+		_name(name),
+		_file(file),
+		_cacheFilename(cacheFilename),
+		_contentHash(0),
+		_contentSize(0),
+		_model(NULL)
+	{
+		// Determine the file extension (ASE or LWO) to pass down to the PicoModel
+		std::string fName = _file->getName();
+		boost::algorithm::to_lower(fName);
+		_fExt = fName.substr(fName.size() - 3, 3);
+	}
+
+	~PicoModelPreload()
+	{
+		if (_model != NULL)
+		{
+			PicoFreeModel(_model);
+		}
+	}
+
+	void parse()
+	{
+		// Read the whole file, the cache is keyed by a hash of the contents
+		_data.resize(_file->size());
+
+		InputStream& stream = _file->getInputStream();
+		std::size_t size = 0;
+
+		while (size < _data.size())
+		{
+			std::size_t read = stream.read(&_data[size], _data.size() - size);
+
+			if (read == 0) break;
+
+			size += read;
+		}
+
+		_data.resize(size);
+		_contentSize = size;
+		_contentHash = BinaryModelCache::getContentHash(_data);
+
+		if (!_cacheFilename.empty() && loadFromCache())
+		{
+			return;
+		}
+
+		Glib::Mutex::Lock lock(getLwoMutex(), Glib::NOT_LOCK);
+
+		if (_fExt == "lwo")
+		{
+			lock.acquire();
+		}
+
+		MemoryInputStream dataStream(_data);
+
+		_messages.capture();
+
+		_model = PicoModuleLoadModelStream(
+			_module,
+			&dataStream,
+			picoInputStreamReam,
+			_data.size(),
+			0
+		);
+
+		_messages.release();
+	}
+
+	IModelPtr finish()
+	{
+		_messages.flush();
+
+		RenderablePicoModelPtr modelObj;
+
+		if (!_cachedSurfaces.empty())
+		{
+			std::vector<RenderablePicoSurfacePtr> surfaces;
+
+			for (std::vector<CachedSurface>::iterator i = _cachedSurfaces.begin();
+				 i != _cachedSurfaces.end(); ++i)
+			{
+				surfaces.push_back(RenderablePicoSurfacePtr(new RenderablePicoSurface(
+					i->shader, i->fallbackShader, i->vertices, i->indices, i->localAABB)));
+			}
+
+			_cachedSurfaces.clear();
+
+			modelObj.reset(new RenderablePicoModel(surfaces));
+		}
+		else
+		{
+			// greebo: Check if the model load was successful
+			if (_model == NULL || _model->numSurfaces == 0) {
+				// Model is either NULL or has no surfaces, this must've failed
+				return IModelPtr();
+			}
+
+			modelObj.reset(new RenderablePicoModel(_model, _fExt));
+
+			PicoFreeModel(_model);
+			_model = NULL;
+
+			if (!_cacheFilename.empty())
+			{
+				saveToCache(*modelObj);
+			}
+		}
+
+		// Set the filename
+		modelObj->setFilename(os::getFilename(_file->getName()));
+		modelObj->setModelPath(_name);
+
+		return modelObj;
+	}
+
+private:
+	bool loadFromCache()
+	{
+		BinaryModelCache cache;
+
+		if (!cache.load(_cacheFilename, _name, _contentHash, _contentSize) ||
+			cache.getNumSurfaces() == 0)
+		{
+			return false;
+		}
+
+		_cachedSurfaces.resize(cache.getNumSurfaces());
+
+		for (std::size_t i = 0; i < cache.getNumSurfaces(); ++i)
+		{
+			const cache::SurfaceRecord& record = cache.getSurface(i);
+			CachedSurface& surface = _cachedSurfaces[i];
+
+			surface.shader = cache.getString(record.shader);
+
+			if (record.fallbackShader != cache::NO_STRING)
+			{
+				surface.fallbackShader = cache.getString(record.fallbackShader);
+			}
+
+			cache.getSurfaceGeometry(i, surface.vertices, surface.indices, surface.localAABB);
+		}
+
+		return true;
+	}
+
+	void saveToCache(const RenderablePicoModel& model)
+	{
+		BinaryModelCacheWriter writer(_name, _contentHash, _contentSize);
+
+		for (int i = 0; i < model.getSurfaceCount(); ++i)
+		{
+			writer.addSurface(static_cast<const RenderablePicoSurface&>(model.getSurface(i)));
+		}
+
+		writer.save(_cacheFilename);
+	}
+};
+
 PicoModelLoader::PicoModelLoader(const picoModule_t* module, const std::string& extension) :
 	_module(module),
 	_extension(extension),
@@ -72,43 +308,43 @@ scene::INodePtr PicoModelLoader::loadModel(const std::string& modelName) {
 // Load the given model from the VFS path
 IModelPtr PicoModelLoader::loadModelFromPath(const std::string& name)
 {
-	// Open an ArchiveFile to load
-	ArchiveFilePtr file = GlobalFileSystem().openFile(name);
+	PicoModelPreloadPtr preload = createPreload(name);
 
-	if (file == NULL)
+	if (preload == NULL)
 	{
-		rError() << "Failed to load model " << name << std::endl;
 		return IModelPtr();
 	}
 
-	// Determine the file extension (ASE or LWO) to pass down to the PicoModel
-	std::string fName = file->getName();
-	boost::algorithm::to_lower(fName);
-	std::string fExt = fName.substr(fName.size() - 3, 3);
+	preload->parse();
 
-	picoModel_t* model = PicoModuleLoadModelStream(
-		_module,
-		&file->getInputStream(),
-		picoInputStreamReam,
-		file->size(),
-		0
-	);
+	return preload->finish();
+}
 
-	// greebo: Check if the model load was successful
-	if (model == NULL || model->numSurfaces == 0) {
-		// Model is either NULL or has no surfaces, this must've failed
-		return IModelPtr();
+ModelPreloadPtr PicoModelLoader::preloadModelFromPath(const std::string& name)
+{
+	// Other formats (like OBJ) load additional files through the VFS while
+	// being parsed, which can't be done from a worker thread
+	if (_extension != "ASE" && _extension != "LWO")
+	{
+		return ModelPreloadPtr();
 	}
 
-	RenderablePicoModelPtr modelObj(
-		new RenderablePicoModel(model, fExt)
-	);
-	// Set the filename
-	modelObj->setFilename(os::getFilename(file->getName()));
-	modelObj->setModelPath(name);
+	return createPreload(name);
+}
 
-	PicoFreeModel(model);
-	return modelObj;
+PicoModelPreloadPtr PicoModelLoader::createPreload(const std::string& name)
+{
+	// Open an ArchiveFile to load
+	ArchiveFilePtr file = GlobalFileSystem().openFile(name);
+
+	if (file == NULL)
+	{
+		rError() << "Failed to load model " << name << std::endl;
+		return PicoModelPreloadPtr();
+	}
+
+	return PicoModelPreloadPtr(new PicoModelPreload(_module, name, file,
+		BinaryModelCache::getFilename(_cachePath, name)));
 }
 
 // RegisterableModule implementation
@@ -135,6 +371,8 @@ void PicoModelLoader::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << "PicoModelLoader: " << getName() << " initialised." << std::endl;
 
+	_cachePath = ctx.getSettingsPath() + "modelcache/";
+
 	std::string extLower = boost::to_lower_copy(_extension);
 	std::string filter("*." + extLower);
 
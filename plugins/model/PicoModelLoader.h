@@ -7,6 +7,9 @@ typedef struct picoModule_s picoModule_t;
 
 namespace model {
 
+class PicoModelPreload;
+typedef boost::shared_ptr<PicoModelPreload> PicoModelPreloadPtr;
+
 class PicoModelLoader :
 	public ModelLoader
 {
@@ -17,6 +20,9 @@ class PicoModelLoader :
 
 	// The resulting name of the module (ModelLoaderASE, for instance)
 	std::string _moduleName;
+
+	// The folder the binary model cache is written to
+	std::string _cachePath;
 public:
 	PicoModelLoader(const picoModule_t* module, const std::string& extension);
 
@@ -26,6 +32,14 @@ public:
   	// Load the given model from the VFS path
 	IModelPtr loadModelFromPath(const std::string& name);
 
+	// Opens the given model file for parsing on a worker thread (ASE and LWO only)
+	ModelPreloadPtr preloadModelFromPath(const std::string& name);
+
+private:
+	// Opens the given file, returns NULL if it doesn't exist
+	PicoModelPreloadPtr createPreload(const std::string& name);
+
+public:
 	// RegisterableModule implementation
   	virtual const std::string& getName() const;
   	virtual const StringSet& getDependencies() const;
@@ -42,6 +42,18 @@ RenderablePicoModel::RenderablePicoModel(picoModel_t* mod,
 	}
 }
 
+RenderablePicoModel::RenderablePicoModel(const std::vector<RenderablePicoSurfacePtr>& surfaces)
+{
+	for (std::vector<RenderablePicoSurfacePtr>::const_iterator i = surfaces.begin();
+		 i != surfaces.end(); ++i)
+	{
+		_surfVec.push_back(Surface(*i));
+
+		// Extend the model AABB to include the surface's AABB
+		_localAABB.includeAABB((*i)->getAABB());
+	}
+}
+
 RenderablePicoModel::RenderablePicoModel(const RenderablePicoModel& other) :
 	_surfVec(other._surfVec.size()),
 	_localAABB(other._localAABB),
@@ -94,6 +94,12 @@ public:
 	 */
 	RenderablePicoModel(picoModel_t* mod, const std::string& fExt);
 
+	/**
+	 * Constructor used by the binary model cache, the model is made up of
+	 * the given surfaces.
+	 */
+	RenderablePicoModel(const std::vector<RenderablePicoSurfacePtr>& surfaces);
+
 	/**
 	 * Copy constructor: re-use the surfaces from the other model
 	 * but make it possible to assign custom skins to the surfaces.
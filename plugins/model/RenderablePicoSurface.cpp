@@ -27,25 +27,23 @@ RenderablePicoSurface::RenderablePicoSurface(picoSurface_t* surf,
 	{
 		if (fExt == "lwo")
 		{
-			_shaderName = PicoGetShaderName(shader);
+			_preferredShaderName = PicoGetShaderName(shader);
 		}
 		else if (fExt == "ase")
 		{
 			rawName = PicoGetShaderName(shader);
 			std::string rawMapName = PicoGetShaderMapName(shader);
-			_shaderName = cleanupShaderName(rawMapName);
+			_preferredShaderName = cleanupShaderName(rawMapName);
 		}
 	}
 
-	// If shader not found, fallback to alternative if available
-	// _shaderName is empty if the ase material has no BITMAP
-	// materialIsValid is false if _shaderName is not an existing shader
-	if ((_shaderName.empty() || !GlobalMaterialManager().materialExists(_shaderName)) &&
-		!rawName.empty())
+	if (!rawName.empty())
 	{
-		_shaderName = cleanupShaderName(rawName);
+		_fallbackShaderName = cleanupShaderName(rawName);
 	}
 
+	chooseShaderName();
+
 	// Capturing the shader happens later on when we have a RenderSystem reference
 
     // Get the number of vertices and indices, and reserve capacity in our
@@ -84,6 +82,42 @@ RenderablePicoSurface::RenderablePicoSurface(picoSurface_t* surf,
 	createDisplayLists();
 }
 
+RenderablePicoSurface::RenderablePicoSurface(const std::string& preferredShaderName,
+											 const std::string& fallbackShaderName,
+											 std::vector<ArbitraryMeshVertex>& vertices,
+											 std::vector<unsigned int>& indices,
+											 const AABB& localAABB) :
+	_preferredShaderName(preferredShaderName),
+	_fallbackShaderName(fallbackShaderName),
+	_localAABB(localAABB),
+	_dlRegular(0),
+	_dlProgramVcol(0),
+	_dlProgramNoVCol(0)
+{
+	chooseShaderName();
+
+	_vertices.swap(vertices);
+	_indices.swap(indices);
+	_nIndices = static_cast<unsigned int>(_indices.size());
+
+	// The tangents have been calculated already, construct the DLs
+	createDisplayLists();
+}
+
+void RenderablePicoSurface::chooseShaderName()
+{
+	_shaderName = _preferredShaderName;
+
+	// If shader not found, fallback to alternative if available
+	// _shaderName is empty if the ase material has no BITMAP
+	// materialIsValid is false if _shaderName is not an existing shader
+	if ((_shaderName.empty() || !GlobalMaterialManager().materialExists(_shaderName)) &&
+		!_fallbackShaderName.empty())
+	{
+		_shaderName = _fallbackShaderName;
+	}
+}
+
 std::string RenderablePicoSurface::cleanupShaderName(const std::string& inName)
 {
 	const std::string baseFolder = "base";	//FIXME: should be from game.xml
@@ -337,4 +371,24 @@ void RenderablePicoSurface::setDefaultMaterial(const std::string& defaultMateria
 	_shaderName = defaultMaterial;
 }
 
+const std::vector<ArbitraryMeshVertex>& RenderablePicoSurface::getVertices() const
+{
+	return _vertices;
+}
+
+const std::vector<unsigned int>& RenderablePicoSurface::getIndices() const
+{
+	return _indices;
+}
+
+const std::string& RenderablePicoSurface::getPreferredShaderName() const
+{
+	return _preferredShaderName;
+}
+
+const std::string& RenderablePicoSurface::getFallbackShaderName() const
+{
+	return _fallbackShaderName;
+}
+
 } // namespace model
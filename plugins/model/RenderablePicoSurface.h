@@ -30,6 +30,11 @@ class RenderablePicoSurface :
 	// Name of the material this surface is using
 	std::string _shaderName;
 
+	// The material names given by the model file: the preferred one and the
+	// one to use if the former doesn't exist (may be empty)
+	std::string _preferredShaderName;
+	std::string _fallbackShaderName;
+
 	// Vector of ArbitraryMeshVertex structures, containing the coordinates,
 	// normals, tangents and texture coordinates of the component vertices
 	typedef std::vector<ArbitraryMeshVertex> VertexVector;
@@ -66,6 +71,9 @@ private:
 
 	std::string cleanupShaderName(const std::string& mapName);
 
+	// Picks _shaderName from the preferred and the fallback name
+	void chooseShaderName();
+
 public:
 	/**
 	 * Constructor. Accepts a picoSurface_t struct and the file extension to determine
@@ -73,6 +81,16 @@ public:
 	 */
 	RenderablePicoSurface(picoSurface_t* surf, const std::string& fExt);
 
+	/**
+	 * Constructor used by the binary model cache, taking the preprocessed
+	 * geometry. The contents of the given vectors are moved into the surface.
+	 */
+	RenderablePicoSurface(const std::string& preferredShaderName,
+						  const std::string& fallbackShaderName,
+						  std::vector<ArbitraryMeshVertex>& vertices,
+						  std::vector<unsigned int>& indices,
+						  const AABB& localAABB);
+
 	/**
 	 * Destructor.
 	 */
@@ -126,6 +144,12 @@ public:
 	const std::string& getDefaultMaterial() const;
 	void setDefaultMaterial(const std::string& defaultMaterial);
 
+	// Accessors used by the binary model cache
+	const std::vector<ArbitraryMeshVertex>& getVertices() const;
+	const std::vector<unsigned int>& getIndices() const;
+	const std::string& getPreferredShaderName() const;
+	const std::string& getFallbackShaderName() const;
+
 private:
 	void captureShader();
 };
@@ -24,19 +24,58 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #include "itextstream.h"
 #include "ifilesystem.h"
 #include <stdio.h>
+#include <glib.h>
 #include "picomodel.h"
 #include "debugging/debugging.h"
 typedef unsigned char byte;
 #include <boost/algorithm/string/case_conv.hpp>
 
+namespace
+{
+	// The PicoMessageBuffer capturing the messages of the current thread
+	GPrivate _threadMessageBuffer = G_PRIVATE_INIT(NULL);
+}
+
+void PicoMessageBuffer::capture()
+{
+	g_private_set(&_threadMessageBuffer, this);
+}
+
+void PicoMessageBuffer::release()
+{
+	g_private_set(&_threadMessageBuffer, NULL);
+}
+
+void PicoMessageBuffer::flush()
+{
+	if (!_messages.str().empty())
+	{
+		rMessage() << _messages.str();
+	}
+
+	if (!_errors.str().empty())
+	{
+		rError() << _errors.str();
+	}
+
+	_messages.str(std::string());
+	_errors.str(std::string());
+}
+
 void PicoPrintFunc( int level, const char *str )
 {
 	if( str == 0 )
 		return;
+
+	PicoMessageBuffer* buffer = static_cast<PicoMessageBuffer*>(g_private_get(&_threadMessageBuffer));
+
+	std::ostream& messageStream = buffer != NULL ? buffer->getMessageStream() : rMessage();
+	std::ostream& errorStream = buffer != NULL ? buffer->getErrorStream() : rError();
+
 	switch( level )
 	{
 		case PICO_NORMAL:
-			rMessage() << str << "\n";
+			messageStream << str << "\n";
 			break;
 
 		case PICO_VERBOSE:
@@ -44,15 +83,15 @@ void PicoPrintFunc( int level, const char *str )
 			break;
 
 		case PICO_WARNING:
-			rError() << "PICO_WARNING: " << str << "\n";
+			errorStream << "PICO_WARNING: " << str << "\n";
 			break;
 
 		case PICO_ERROR:
-			rError() << "PICO_ERROR: " << str << "\n";
+			errorStream << "PICO_ERROR: " << str << "\n";
 			break;
 
 		case PICO_FATAL:
-			rError() << "PICO_FATAL: " << str << "\n";
+			errorStream << "PICO_FATAL: " << str << "\n";
 			break;
 	}
 }
@@ -22,4 +22,37 @@ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 #if !defined(INCLUDED_PLUGIN_H)
 #define INCLUDED_PLUGIN_H
 
+#include <sstream>
+
+/**
+ * Collects the messages of the picomodel library while a model is parsed on
+ * a worker thread, the console must only be written to from the main thread.
+ * The messages are written to the log by flush().
+ */
+class PicoMessageBuffer
+{
+	std::ostringstream _messages;
+	std::ostringstream _errors;
+
+public:
+	// Redirects the picomodel messages of the calling thread into this buffer
+	void capture();
+
+	// Stops redirecting the messages of the calling thread
+	void release();
+
+	// Writes the collected messages to the log and clears the buffer
+	void flush();
+
+	std::ostream& getMessageStream()
+	{
+		return _messages;
+	}
+
+	std::ostream& getErrorStream()
+	{
+		return _errors;
+	}
+};
+
 #endif
@@ -1,6 +1,12 @@
 #ifndef _PARTICLE_QUAD_H_
 #define _PARTICLE_QUAD_H_
 
+#include "math/Vector2.h"
+#include "math/Vector3.h"
+#include "math/Vector4.h"
+#include "math/Matrix4.h"
+#include "math/pi.h"
+
 namespace particles
 {
 
@@ -8,27 +14,30 @@ namespace particles
  * Each particle stage consists of a bunch of quads.
  * A quad in turn consists of 4 vertices, each of them carrying
  * 3D coordinates, a normal vector, texture coords and a vertex colour.
+ *
+ * The vertices are stored in single precision, such that the quad
+ * array can be passed to OpenGL as it is.
  */
 struct ParticleQuad
 {
 	struct Vertex
 	{
-		Vector3 vertex;			// The 3D coordinates of the point
-		Vector2 texcoord;		// The UV coordinates
-		Vector3 normal;			// The normals
-		Vector4 colour;		// vertex colour
+		Vector3f vertex;		// The 3D coordinates of the point
+		Vector2f texcoord;		// The UV coordinates
+		Vector3f normal;		// The normals
+		Vector4f colour;		// vertex colour
 
 		Vertex()
 		{}
 
-		Vertex(const Vector3& vertex_, const Vector2& texcoord_) :
+		Vertex(const Vector3f& vertex_, const Vector2f& texcoord_) :
 			vertex(vertex_),
 			texcoord(texcoord_),
 			normal(0,0,1),
 			colour(1,1,1,1)
 		{}
 
-		Vertex(const Vector3& vertex_, const Vector2& texcoord_, const Vector4& colour_, const Vector3& normal_) :
+		Vertex(const Vector3f& vertex_, const Vector2f& texcoord_, const Vector4f& colour_, const Vector3f& normal_) :
 			vertex(vertex_),
 			texcoord(texcoord_),
 			normal(normal_),
@@ -43,10 +52,10 @@ struct ParticleQuad
 
 	ParticleQuad(float size)
 	{
-		verts[0] = Vertex(Vector3(-size, +size, 0), Vector2(0,0));
-		verts[1] = Vertex(Vector3(+size, +size, 0), Vector2(1,0));
-		verts[2] = Vertex(Vector3(+size, -size, 0), Vector2(1,1));
-		verts[3] = Vertex(Vector3(-size, -size, 0), Vector2(0,1));
+		verts[0] = Vertex(Vector3f(-size, +size, 0), Vector2f(0,0));
+		verts[1] = Vertex(Vector3f(+size, +size, 0), Vector2f(1,0));
+		verts[2] = Vertex(Vector3f(+size, -size, 0), Vector2f(1,1));
+		verts[3] = Vertex(Vector3f(-size, -size, 0), Vector2f(0,1));
 	}
 
 	/**
@@ -59,25 +68,30 @@ struct ParticleQuad
 	 * @s0: defines the horizontal frame start coordinate in texture space (s).
 	 * @sWidth: defines the width of this frame in texture space.
 	 */
-	ParticleQuad(float size, float aspect, float angle, const Vector4& colour = Vector4(1,1,1,1),
-				 const Vector3& normal = Vector3(0,0,1),
+	ParticleQuad(float size, float aspect, float angle, const Vector4f& colour = Vector4f(1,1,1,1),
+				 const Vector3f& normal = Vector3f(0,0,1),
 				 float s0 = 0.0f, float sWidth = 1.0f, float t0 = 0.0f, float tWidth = 1.0f)
 	{
-		double cosPhi = cos(degrees_to_radians(angle));
-		double sinPhi = sin(degrees_to_radians(angle));
-		Matrix4 rotation = Matrix4::byColumns(
-			cosPhi, -sinPhi, 0, 0,
-			sinPhi, cosPhi, 0, 0,
-			0, 0, 1, 0,
-			0, 0, 0, 1);
-
-		verts[0] = Vertex(rotation.transformPoint(Vector3(-size*aspect, +size, 0)), Vector2(s0,t0), colour, normal);
-		verts[1] = Vertex(rotation.transformPoint(Vector3(+size*aspect, +size, 0)), Vector2(s0 + sWidth,t0), colour, normal);
-		verts[2] = Vertex(rotation.transformPoint(Vector3(+size*aspect, -size, 0)), Vector2(s0 + sWidth,t0 + tWidth), colour, normal);
-		verts[3] = Vertex(rotation.transformPoint(Vector3(-size*aspect, -size, 0)), Vector2(s0,t0 + tWidth), colour, normal);
+		float angleRad = angle * static_cast<float>(c_pi) / 180.0f;
+		float cosPhi = cos(angleRad);
+		float sinPhi = sin(angleRad);
+
+		// Corner coordinates rotated around the z axis
+		float x = size * aspect;
+		float y = size;
+
+		float xCos = x * cosPhi;
+		float xSin = x * sinPhi;
+		float yCos = y * cosPhi;
+		float ySin = y * sinPhi;
+
+		verts[0] = Vertex(Vector3f(-xCos + ySin, xSin + yCos, 0), Vector2f(s0,t0), colour, normal);
+		verts[1] = Vertex(Vector3f(xCos + ySin, -xSin + yCos, 0), Vector2f(s0 + sWidth,t0), colour, normal);
+		verts[2] = Vertex(Vector3f(xCos - ySin, -xSin - yCos, 0), Vector2f(s0 + sWidth,t0 + tWidth), colour, normal);
+		verts[3] = Vertex(Vector3f(-xCos - ySin, xSin - yCos, 0), Vector2f(s0,t0 + tWidth), colour, normal);
 	}
 
-	void translate(const Vector3& offset)
+	void translate(const Vector3f& offset)
 	{
 		verts[0].vertex += offset;
 		verts[1].vertex += offset;
@@ -93,7 +107,7 @@ struct ParticleQuad
 		verts[3].vertex = mat.transformPoint(verts[3].vertex);
 	}
 
-	void assignColour(const Vector4& colour)
+	void assignColour(const Vector4f& colour)
 	{
 		verts[0].colour = colour;
 		verts[1].colour = colour;
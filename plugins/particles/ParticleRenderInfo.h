@@ -2,6 +2,7 @@
 
 #include "math/Vector3.h"
 #include "math/Vector4.h"
+#include <vector>
 #include <boost/random/linear_congruential.hpp>
 
 // greebo: Thanks for nothing to the boost.random developers who changed the class layout completely 
@@ -30,8 +31,8 @@ struct ParticleRenderInfo
 	float timeSecs;		// time in seconds
 	float timeFraction;	// time fraction within particle lifetime
 
-	Vector3 origin;
-	Vector4 colour;		// resulting colour
+	Vector3f origin;
+	Vector4f colour;	// resulting colour
 
 	float angle;		// the angle of the quad
 	float size;			// the desired size (might be overridden when aimed)
@@ -47,8 +48,8 @@ struct ParticleRenderInfo
 	std::size_t curFrame;	// animation: current frame
 	std::size_t nextFrame;	// animation: next frame
 
-	Vector4 curColour;
-	Vector4 nextColour;
+	Vector4f curColour;
+	Vector4f nextColour;
 
 	ParticleRenderInfo() :
 		index(0),
@@ -77,4 +78,53 @@ struct ParticleRenderInfo
 	}
 };
 
+/**
+ * The input and output of the origin calculation of a whole bunch of particles,
+ * in structure-of-arrays layout: each entry is a particle at a given time, using
+ * the random numbers of that particle. This way the path integration runs in a
+ * tight loop per path type over plain float arrays.
+ */
+struct ParticleOriginBatch
+{
+	std::vector<float> timeSecs;
+	std::vector<float> rand[5];
+
+	// The resulting origins
+	std::vector<float> x;
+	std::vector<float> y;
+	std::vector<float> z;
+
+	std::size_t size() const
+	{
+		return timeSecs.size();
+	}
+
+	// Removes all entries, keeping the allocated memory
+	void clear()
+	{
+		timeSecs.clear();
+
+		for (std::size_t i = 0; i < 5; ++i)
+		{
+			rand[i].clear();
+		}
+	}
+
+	// Adds an entry for the given particle, at the given time (in seconds)
+	void add(const ParticleRenderInfo& particle, float time)
+	{
+		timeSecs.push_back(time);
+
+		for (std::size_t i = 0; i < 5; ++i)
+		{
+			rand[i].push_back(particle.rand[i]);
+		}
+	}
+
+	Vector3f getOrigin(std::size_t index) const
+	{
+		return Vector3f(x[index], y[index], z[index]);
+	}
+};
+
 } // namespace
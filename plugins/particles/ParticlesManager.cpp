@@ -10,6 +10,7 @@
 #include "ieventmanager.h"
 #include "ifilesystem.h"
 #include "igame.h"
+#include "iradiant.h"
 #include "i18n.h"
 
 #include "parser/DefTokeniser.h"
@@ -197,6 +198,7 @@ const StringSet& ParticlesManager::getDependencies() const
 		_dependencies.insert(MODULE_VIRTUALFILESYSTEM);
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
 		_dependencies.insert(MODULE_EVENTMANAGER);
+		_dependencies.insert(MODULE_RADIANT);
 	}
 
 	return _dependencies;
@@ -1,15 +1,36 @@
 #include "RenderableParticle.h"
 
+#include "iradiant.h"
+#include "ithread.h"
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 
 namespace particles
 {
 
+namespace
+{
+	// Particle systems with fewer particles are updated in the calling thread
+	const std::size_t MIN_PARTICLES_FOR_THREADED_UPDATE = 1024;
+
+	typedef std::vector<RenderableParticleStagePtr> StageList;
+
+	void updateStageRange(const StageList& stages, std::size_t time, const Matrix4& viewRotation,
+						  std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; ++i)
+		{
+			stages[i]->update(time, viewRotation);
+		}
+	}
+}
+
 RenderableParticle::RenderableParticle(const IParticleDefPtr& particleDef) :
 	_particleDef(), // don't initialise the ptr yet
 	_random(rand()), // use a random seed
 	_direction(0,0,1), // default direction
-	_entityColour(1,1,1) // default entity colour
+	_entityColour(1,1,1), // default entity colour
+	_numParticles(0)
 {
 	// Use this method, for observer handling
 	setParticleDef(particleDef);
@@ -40,14 +61,17 @@ void RenderableParticle::update(const Matrix4& viewRotation)
 	// the camera rotation.
 	Matrix4 invViewRotation = viewRotation.getInverse();
 
-	// Traverse the stages and call update
-	for (ShaderMap::const_iterator i = _shaderMap.begin(); i != _shaderMap.end(); ++i)
+	// The stages are independent of each other, for larger particle systems
+	// they're handed to the thread manager's persistent workers
+	if (_stages.size() > 1 && _numParticles >= MIN_PARTICLES_FOR_THREADED_UPDATE &&
+		GlobalRadiant().getThreadManager().getNumWorkers() > 1)
 	{
-		for (RenderableParticleStageList::const_iterator stage = i->second.stages.begin();
-			 stage != i->second.stages.end(); ++stage)
-		{
-			(*stage)->update(time, invViewRotation);
-		}
+		GlobalRadiant().getThreadManager().executeInChunks(_stages.size(),
+			boost::bind(&updateStageRange, boost::cref(_stages), time, boost::cref(invViewRotation), _1, _2));
+	}
+	else
+	{
+		updateStageRange(_stages, time, invViewRotation, 0, _stages.size());
 	}
 }
 
@@ -173,6 +197,8 @@ void RenderableParticle::calculateBounds()
 void RenderableParticle::setupStages()
 {
 	_shaderMap.clear();
+	_stages.clear();
+	_numParticles = 0;
 
 	if (_particleDef == NULL) return; // nothing to do.
 
@@ -190,6 +216,9 @@ void RenderableParticle::setupStages()
 		// Create a new renderable stage and add it to the shader
 		RenderableParticleStagePtr renderableStage(new RenderableParticleStage(stage, _random, _direction, _entityColour));
 		_shaderMap[materialName].stages.push_back(renderableStage);
+
+		_stages.push_back(renderableStage);
+		_numParticles += static_cast<std::size_t>(stage.getCount());
 	}
 }
 
@@ -37,6 +37,12 @@ class RenderableParticle : public IRenderableParticle,
 	typedef std::map<std::string, ParticleStageGroup> ShaderMap;
 	ShaderMap _shaderMap;
 
+	// All stages of the above groups, in one list for the parallel update
+	RenderableParticleStageList _stages;
+
+	// The summed up particle counts of all stages
+	std::size_t _numParticles;
+
 	// The random number generator, this is used to generate "constant"
 	// starting values for each bunch of particles. This enables us
 	// to go back in time when rendering the particle stage.
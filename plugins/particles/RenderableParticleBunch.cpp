@@ -5,9 +5,30 @@
 
 #include "string/string.h"
 
+#include <algorithm>
+
 namespace particles
 {
 
+namespace
+{
+	inline Vector3f toVector3f(const Vector3& v)
+	{
+		return Vector3f(static_cast<float>(v.x()), static_cast<float>(v.y()), static_cast<float>(v.z()));
+	}
+
+	inline Vector4f toVector4f(const Vector4& v)
+	{
+		return Vector4f(static_cast<float>(v.x()), static_cast<float>(v.y()),
+						static_cast<float>(v.z()), static_cast<float>(v.w()));
+	}
+
+	inline Vector3 toVector3(const Vector3f& v)
+	{
+		return Vector3(v.x(), v.y(), v.z());
+	}
+}
+
 RenderableParticleBunch::RenderableParticleBunch(std::size_t index,
     int randSeed, const IStageDef& stage, const Matrix4& viewRotation,
     const Vector3& direction, const Vector3& entityColour) :
@@ -28,6 +49,8 @@ void RenderableParticleBunch::update(std::size_t time)
 {
     _bounds = AABB();
     _quads.clear();
+    _particles.clear();
+    _origins.clear();
 
     // Length of one cycle (duration + deadtime)
     std::size_t cycleMsec = static_cast<std::size_t>(_stage.getCycleMsec());
@@ -56,8 +79,30 @@ void RenderableParticleBunch::update(std::size_t time)
     // This is the spacing between each particle
     std::size_t spawnSpacingMsec = static_cast<std::size_t>(spawnSpacing);
 
-    // Generate all particle quads, regardless of their visibility
-    // Visibility is considered by not rendering particles that haven't been spawned yet
+    // Aimed particles are drawn as a trail of quads, each of them needs an origin
+    bool aimed = _stage.getOrientationType() == IStageDef::ORIENTATION_AIMED;
+
+    int trails = static_cast<int>(_stage.getOrientationParm(0)); // trails
+    float aimedTime = _stage.getOrientationParm(1); // time
+
+    if (trails < 0)
+    {
+        trails = 0;
+    }
+
+    // The time parameter defaults to 0.5 if not specified
+    if (aimedTime == 0.0f)
+    {
+        aimedTime = 0.5f;
+    }
+
+    int numAimedQuads = trails + 1;
+
+    // The time delta between the trailing quads
+    float aimedTimeStep = aimedTime / numAimedQuads;
+
+    // First pass: spawn the visible particles. This has to run in order,
+    // as all particles draw their random numbers from the same generator
     for (std::size_t i = 0; i < static_cast<std::size_t>(_stage.getCount()); ++i)
     {
         // Consider bunching parameter
@@ -83,9 +128,6 @@ void RenderableParticleBunch::update(std::size_t time)
         // We need the particle time in seconds for the location/angle integrations
         particle.timeSecs = MS2SEC(particleTime);
 
-        // Calculate particle origin at time t
-        calculateOrigin(particle);
-
         // Get the initial angle value
         particle.angle = _stage.getInitialAngle();
 
@@ -106,9 +148,36 @@ void RenderableParticleBunch::update(std::size_t time)
             continue; // particle has expired
         }
 
+        _particles.push_back(particle);
+
+        // Request the origin at the particle time, plus the ones of the trailing quads
+        _origins.add(particle, particle.timeSecs);
+
+        if (aimed)
+        {
+            for (int q = 1; q <= numAimedQuads; ++q)
+            {
+                _origins.add(particle, particle.timeSecs - aimedTimeStep * q);
+            }
+        }
+    }
+
+    // Second pass: integrate the paths of all particles in one go
+    calculateOrigins(_origins);
+
+    std::size_t originsPerParticle = aimed ? numAimedQuads + 1 : 1;
+
+    // Third pass: evaluate the remaining parameters and generate the quads
+    for (std::size_t p = 0; p < _particles.size(); ++p)
+    {
+        ParticleRenderInfo& particle = _particles[p];
+
+        std::size_t firstOrigin = p * originsPerParticle;
+        particle.origin = _origins.getOrigin(firstOrigin);
+
         // Calculate the time-dependent angle
         // according to docs, half the quads have negative rotation speed
-        int rotFactor = i % 2 == 0 ? -1 : 1;
+        int rotFactor = particle.index % 2 == 0 ? -1 : 1;
         particle.angle += rotFactor * integrate(_stage.getRotationSpeed(), particle.timeSecs);
 
         // Calculate render colour for this particle
@@ -130,9 +199,9 @@ void RenderableParticleBunch::update(std::size_t time)
         }
 
         // For aimed orientation, we need to override particle height and aspect
-        if (_stage.getOrientationType() == IStageDef::ORIENTATION_AIMED)
+        if (aimed)
         {
-            pushAimedParticles(particle, stageDurationMsec);
+            pushAimedParticles(particle, _origins, firstOrigin, numAimedQuads);
         }
         else
         {
@@ -158,10 +227,10 @@ void RenderableParticleBunch::render(const RenderInfo& info) const
     glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     glEnableClientState(GL_COLOR_ARRAY);
 
-    glVertexPointer(3, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].vertex));
-    glTexCoordPointer(2, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].texcoord));
-    glNormalPointer(GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].normal));
-    glColorPointer(4, GL_DOUBLE, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].colour));
+    glVertexPointer(3, GL_FLOAT, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].vertex));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].texcoord));
+    glNormalPointer(GL_FLOAT, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].normal));
+    glColorPointer(4, GL_FLOAT, sizeof(ParticleQuad::Vertex), &(_quads.front().verts[0].colour));
 
     glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(_quads.size())*4);
 }
@@ -243,8 +312,10 @@ void RenderableParticleBunch::calculateAnim(ParticleRenderInfo& particle)
 
 void RenderableParticleBunch::calculateColour(ParticleRenderInfo& particle)
 {
-    Vector4 mainColour = !_stage.getUseEntityColour() ? 
-        _stage.getColour() : Vector4(_entityColour.x(), _entityColour.y(), _entityColour.z(), 1);
+    Vector4f mainColour = toVector4f(!_stage.getUseEntityColour() ?
+        _stage.getColour() : Vector4(_entityColour.x(), _entityColour.y(), _entityColour.z(), 1));
+
+    Vector4f fadeColour = toVector4f(_stage.getFadeColour());
 
     // We start with the stage's standard colour
     particle.colour = mainColour;
@@ -270,7 +341,7 @@ void RenderableParticleBunch::calculateColour(ParticleRenderInfo& particle)
         // those particles with time >= fadeIndexFraction get faded.
         if (frac > 0)
         {
-            particle.colour = lerpColour(particle.colour, _stage.getFadeColour(), frac);
+            particle.colour = lerpColour(particle.colour, fadeColour, frac);
         }
     }
 
@@ -278,7 +349,7 @@ void RenderableParticleBunch::calculateColour(ParticleRenderInfo& particle)
 
     if (fadeInFraction > 0 && particle.timeFraction <= fadeInFraction)
     {
-        particle.colour = lerpColour(_stage.getFadeColour(), mainColour, particle.timeFraction / fadeInFraction);
+        particle.colour = lerpColour(fadeColour, mainColour, particle.timeFraction / fadeInFraction);
     }
 
     float fadeOutFraction = _stage.getFadeOutFraction();
@@ -286,12 +357,20 @@ void RenderableParticleBunch::calculateColour(ParticleRenderInfo& particle)
 
     if (fadeOutFraction > 0 && particle.timeFraction >= fadeOutFractionInverse)
     {
-        particle.colour = lerpColour(mainColour, _stage.getFadeColour(), (particle.timeFraction - fadeOutFractionInverse) / fadeOutFraction);
+        particle.colour = lerpColour(mainColour, fadeColour, (particle.timeFraction - fadeOutFractionInverse) / fadeOutFraction);
     }
 }
 
-void RenderableParticleBunch::calculateOrigin(ParticleRenderInfo& particle)
+void RenderableParticleBunch::calculateOrigins(ParticleOriginBatch& batch)
 {
+    std::size_t count = batch.size();
+
+    batch.x.resize(count);
+    batch.y.resize(count);
+    batch.z.resize(count);
+
+    if (count == 0) return;
+
     // Check if the main direction is different to the z axis
     Vector3 dir = _direction.getNormalised();
     Vector3 z(0,0,1);
@@ -301,92 +380,24 @@ void RenderableParticleBunch::calculateOrigin(ParticleRenderInfo& particle)
     Matrix4 rotation = deviation != 0 ? Matrix4::getRotation(z, dir) : Matrix4::getIdentity();
 
     // Consider offset as starting point
-    particle.origin = rotation.transformPoint(_offset);
+    Vector3f start = toVector3f(rotation.transformPoint(_offset));
+
+    std::fill(batch.x.begin(), batch.x.end(), start.x());
+    std::fill(batch.y.begin(), batch.y.end(), start.y());
+    std::fill(batch.z.begin(), batch.z.end(), start.z());
 
     switch (_stage.getCustomPathType())
     {
     case IStageDef::PATH_STANDARD: // Standard path calculation
-        {
-            // Consider particle distribution
-            Vector3 distributionOffset = getDistributionOffset(particle, _distributeParticlesRandomly);
-
-            // Add this to the origin
-            particle.origin += distributionOffset;
-
-            // Calculate particle direction, pass distribution offset (this is needed for DIRECTION_OUTWARD)
-            Vector3 particleDirection = getDirection(particle, rotation, distributionOffset);
-
-            // Consider speed
-            particle.origin += particleDirection * integrate(_stage.getSpeed(), particle.timeSecs);
-        }
+        integrateStandardPath(batch, rotation);
         break;
 
     case IStageDef::PATH_FLIES:
-        {
-            // greebo: "Flies" particles are moving on the surface of a sphere of radius <size>
-            // The radial and axial speeds are chosen at random (but never 0) and are constant
-            // during the lifetime of a particle. Starting position appears to be random,
-            // but different to the "distribution sphere" type (i.e. it is not evenly distributed,
-            // instead the particles seem to bunch themselves at the poles).
-
-            // Sphere radius
-            float radius = _stage.getCustomPathParm(2);
-
-            // Generate starting conditions speed (+/-50%)
-            float rand = 2 * particle.rand[0] - 1.0f;
-            float radialSpeedFactor = 1.0f + 0.5f * rand * rand;
-
-            // greebo: factor 0.4 is empirical, I measured a few D3 particles for their circulation times
-            float radialSpeed = _stage.getCustomPathParm(0) * radialSpeedFactor * 0.4f;
-
-            rand = 2 * particle.rand[1] - 1.0f;
-            float axialSpeedFactor = 1.0f + 0.5f * rand * rand;
-            float axialSpeed = _stage.getCustomPathParm(1) * axialSpeedFactor * 0.4f;
-
-            float phi0 = 2 * static_cast<float>(c_pi) * particle.rand[2];
-            float theta0 = static_cast<float>(c_pi) * particle.rand[3];
-
-            // Calculate angles at the given particleTime
-            float phi = phi0 + axialSpeed * particle.timeSecs;
-            float theta = theta0 + radialSpeed * particle.timeSecs;
-
-            // Pre-calculate the sin/cos values
-            float cosPhi = cos(phi);
-            float sinPhi = sin(phi);
-            float cosTheta = cos(theta);
-            float sinTheta = sin(theta);
-
-            // Move the particle origin
-            particle.origin += Vector3(radius * cosTheta * sinPhi, radius * sinTheta * sinPhi, radius * cosPhi);
-        }
+        integrateFliesPath(batch);
         break;
 
     case IStageDef::PATH_HELIX:
-        {
-            // greebo: Helical movement is describing an elliptic cylinder, its shape is determined by
-            // sizeX, sizeY and sizeZ. Particles are spawned randomly on that cylinder surface,
-            // their velocities (radial and axial) are also random (both negative and positive
-            // velocities are allowed).
-
-            float sizeX = _stage.getCustomPathParm(0);
-            float sizeY = _stage.getCustomPathParm(1);
-            float sizeZ = _stage.getCustomPathParm(2);
-
-            float radialSpeed = _stage.getCustomPathParm(3) * (2 * particle.rand[0] - 1.0f);
-            float axialSpeed = _stage.getCustomPathParm(4) * (2 * particle.rand[1] - 1.0f);
-
-            float phi0 = 2 * static_cast<float>(c_pi) * particle.rand[2];
-            float z0 = sizeZ * (2 * particle.rand[3] - 1.0f);
-
-            float sinPhi = sin(phi0 + radialSpeed * particle.timeSecs);
-            float cosPhi = cos(phi0 + radialSpeed * particle.timeSecs);
-
-            float x = sizeX * cosPhi;
-            float y = sizeY * sinPhi;
-            float z = z0 + axialSpeed * particle.timeSecs;
-
-            particle.origin += Vector3(x, y, z);
-        }
+        integrateHelixPath(batch);
         break;
 
     case IStageDef::PATH_ORBIT:
@@ -402,78 +413,220 @@ void RenderableParticleBunch::calculateOrigin(ParticleRenderInfo& particle)
 
     // Consider gravity
     // if "world" is set, use -z as gravity direction, otherwise use the reverse emitter direction
-    Vector3 gravity = _stage.getWorldGravityFlag() ? Vector3(0,0,-1) : -_direction.getNormalised();
+    Vector3 gravityDir = _stage.getWorldGravityFlag() ? Vector3(0,0,-1) : -_direction.getNormalised();
+
+    Vector3f gravity = toVector3f(gravityDir * _stage.getGravity() * 0.5f);
 
-    particle.origin += gravity * _stage.getGravity() * particle.timeSecs * particle.timeSecs * 0.5f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float timeSquared = batch.timeSecs[i] * batch.timeSecs[i];
+
+        batch.x[i] += gravity.x() * timeSquared;
+        batch.y[i] += gravity.y() * timeSquared;
+        batch.z[i] += gravity.z() * timeSquared;
+    }
 }
 
-Vector3 RenderableParticleBunch::getDirection(ParticleRenderInfo& particle, const Matrix4& rotation, const Vector3& distributionOffset)
+void RenderableParticleBunch::integrateStandardPath(ParticleOriginBatch& batch, const Matrix4& rotation)
 {
+    std::size_t count = batch.size();
+
+    // Consider particle distribution
+    calculateDistributionOffsets(batch, _offsetX, _offsetY, _offsetZ);
+
+    // The speed integral is a*t^2 + b*t, see integrate()
+    const IParticleParameter& speed = _stage.getSpeed();
+
+    float speedA = (speed.getTo() - speed.getFrom()) / _stage.getDuration() * 0.5f;
+    float speedB = speed.getFrom();
+
+    // Calculate particle direction and move the particle along it
     switch (_stage.getDirectionType())
     {
     case IStageDef::DIRECTION_CONE:
         {
             // Find a random vector on the sphere surface defined by the cone with apex 2*angle
-            float u = particle.rand[3];
-
             // Scale the variable v such that it takes uniform values in the interval [(1+cos(angle))/2 .. 1]
             float angleRad = _stage.getDirectionParm(0) * static_cast<float>(c_pi) / 180.0f;
             float v0 = (1 + cos(angleRad)) * 0.5f;
             float v1 = 1;
 
-            float v = v0 + particle.rand[4] * (v1 - v0);
+            // The rotation into the particle's main direction
+            float xx = static_cast<float>(rotation.xx());
+            float xy = static_cast<float>(rotation.xy());
+            float xz = static_cast<float>(rotation.xz());
+            float yx = static_cast<float>(rotation.yx());
+            float yy = static_cast<float>(rotation.yy());
+            float yz = static_cast<float>(rotation.yz());
+            float zx = static_cast<float>(rotation.zx());
+            float zy = static_cast<float>(rotation.zy());
+            float zz = static_cast<float>(rotation.zz());
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float v = v0 + batch.rand[4][i] * (v1 - v0);
+
+                float theta = 2 * static_cast<float>(c_pi) * batch.rand[3][i];
+                float phi = acos(2*v - 1);
 
-            float theta = 2 * static_cast<float>(c_pi) * u;
-            float phi = acos(2*v - 1);
+                float sinPhi = sin(phi);
 
-            Vector3 endPoint(cos(theta) * sin(phi), sin(theta) * sin(phi), cos(phi));
+                float dx = cos(theta) * sinPhi;
+                float dy = sin(theta) * sinPhi;
+                float dz = cos(phi);
 
-            // Rotate the vector into the particle's main direction
-            endPoint = rotation.transformPoint(endPoint);
+                float t = batch.timeSecs[i];
+                float distance = speedA * t * t + speedB * t;
 
-            return endPoint.getNormalised();
+                // The rotated vector is normalised already
+                batch.x[i] += _offsetX[i] + (xx * dx + yx * dy + zx * dz) * distance;
+                batch.y[i] += _offsetY[i] + (xy * dx + yy * dy + zy * dz) * distance;
+                batch.z[i] += _offsetZ[i] + (xz * dx + yz * dy + zz * dz) * distance;
+            }
         }
+        break;
+
     case IStageDef::DIRECTION_OUTWARD:
         {
-            // This heavily relies on particles being distributed randomly within the spawn area
-            Vector3 direction = distributionOffset.getNormalised();
+            // Upwards bias
+            float bias = _stage.getDirectionParm(0);
 
-            // Consider upwards bias
-            direction.z() += _stage.getDirectionParm(0);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                // This heavily relies on particles being distributed randomly within the spawn area
+                float length = sqrt(_offsetX[i] * _offsetX[i] + _offsetY[i] * _offsetY[i] + _offsetZ[i] * _offsetZ[i]);
 
-            return direction; // CHECKME: Use .getNormalised() ?
+                float t = batch.timeSecs[i];
+                float distance = speedA * t * t + speedB * t;
+
+                // CHECKME: Normalise the biased direction?
+                batch.x[i] += _offsetX[i] + _offsetX[i] / length * distance;
+                batch.y[i] += _offsetY[i] + _offsetY[i] / length * distance;
+                batch.z[i] += _offsetZ[i] + (_offsetZ[i] / length + bias) * distance;
+            }
         }
+        break;
+
     default:
-        return Vector3(0,0,1);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            float t = batch.timeSecs[i];
+
+            batch.x[i] += _offsetX[i];
+            batch.y[i] += _offsetY[i];
+            batch.z[i] += _offsetZ[i] + speedA * t * t + speedB * t;
+        }
+        break;
     };
 }
 
-Vector3 RenderableParticleBunch::getDistributionOffset(ParticleRenderInfo& particle, bool distributeParticlesRandomly)
+void RenderableParticleBunch::integrateFliesPath(ParticleOriginBatch& batch)
+{
+    // greebo: "Flies" particles are moving on the surface of a sphere of radius <size>
+    // The radial and axial speeds are chosen at random (but never 0) and are constant
+    // during the lifetime of a particle. Starting position appears to be random,
+    // but different to the "distribution sphere" type (i.e. it is not evenly distributed,
+    // instead the particles seem to bunch themselves at the poles).
+
+    // Sphere radius
+    float radius = _stage.getCustomPathParm(2);
+
+    // greebo: factor 0.4 is empirical, I measured a few D3 particles for their circulation times
+    float radialSpeedBase = _stage.getCustomPathParm(0) * 0.4f;
+    float axialSpeedBase = _stage.getCustomPathParm(1) * 0.4f;
+
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        // Generate starting conditions speed (+/-50%)
+        float rand = 2 * batch.rand[0][i] - 1.0f;
+        float radialSpeed = radialSpeedBase * (1.0f + 0.5f * rand * rand);
+
+        rand = 2 * batch.rand[1][i] - 1.0f;
+        float axialSpeed = axialSpeedBase * (1.0f + 0.5f * rand * rand);
+
+        float phi0 = 2 * static_cast<float>(c_pi) * batch.rand[2][i];
+        float theta0 = static_cast<float>(c_pi) * batch.rand[3][i];
+
+        // Calculate angles at the given particleTime
+        float phi = phi0 + axialSpeed * batch.timeSecs[i];
+        float theta = theta0 + radialSpeed * batch.timeSecs[i];
+
+        float sinPhi = sin(phi);
+
+        // Move the particle origin
+        batch.x[i] += radius * cos(theta) * sinPhi;
+        batch.y[i] += radius * sin(theta) * sinPhi;
+        batch.z[i] += radius * cos(phi);
+    }
+}
+
+void RenderableParticleBunch::integrateHelixPath(ParticleOriginBatch& batch)
 {
+    // greebo: Helical movement is describing an elliptic cylinder, its shape is determined by
+    // sizeX, sizeY and sizeZ. Particles are spawned randomly on that cylinder surface,
+    // their velocities (radial and axial) are also random (both negative and positive
+    // velocities are allowed).
+
+    float sizeX = _stage.getCustomPathParm(0);
+    float sizeY = _stage.getCustomPathParm(1);
+    float sizeZ = _stage.getCustomPathParm(2);
+
+    float radialSpeedBase = _stage.getCustomPathParm(3);
+    float axialSpeedBase = _stage.getCustomPathParm(4);
+
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        float radialSpeed = radialSpeedBase * (2 * batch.rand[0][i] - 1.0f);
+        float axialSpeed = axialSpeedBase * (2 * batch.rand[1][i] - 1.0f);
+
+        float phi0 = 2 * static_cast<float>(c_pi) * batch.rand[2][i];
+        float z0 = sizeZ * (2 * batch.rand[3][i] - 1.0f);
+
+        float phi = phi0 + radialSpeed * batch.timeSecs[i];
+
+        batch.x[i] += sizeX * cos(phi);
+        batch.y[i] += sizeY * sin(phi);
+        batch.z[i] += z0 + axialSpeed * batch.timeSecs[i];
+    }
+}
+
+void RenderableParticleBunch::calculateDistributionOffsets(const ParticleOriginBatch& batch,
+    std::vector<float>& x, std::vector<float>& y, std::vector<float>& z)
+{
+    std::size_t count = batch.size();
+
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+
     switch (_stage.getDistributionType())
     {
         // Rectangular distribution
         case IStageDef::DISTRIBUTION_RECT:
         {
-            // Factors to use for the random distribution
-            float randX = 1.0f;
-            float randY = 1.0f;
-            float randZ = 1.0f;
+            float sizeX = _stage.getDistributionParm(0);
+            float sizeY = _stage.getDistributionParm(1);
+            float sizeZ = _stage.getDistributionParm(2);
 
-            if (distributeParticlesRandomly)
+            if (_distributeParticlesRandomly)
             {
                 // Rectangular spawn zone
-                randX = 2 * particle.rand[0] - 1.0f;
-                randY = 2 * particle.rand[1] - 1.0f;
-                randZ = 2 * particle.rand[2] - 1.0f;
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    x[i] = (2 * batch.rand[0][i] - 1.0f) * sizeX;
+                    y[i] = (2 * batch.rand[1][i] - 1.0f) * sizeY;
+                    z[i] = (2 * batch.rand[2][i] - 1.0f) * sizeZ;
+                }
+            }
+            else
+            {
+                // If random distribution is off, particles get spawned at <sizex, sizey, sizez>
+                std::fill(x.begin(), x.end(), sizeX);
+                std::fill(y.begin(), y.end(), sizeY);
+                std::fill(z.begin(), z.end(), sizeZ);
             }
-
-            // If random distribution is off, particles get spawned at <sizex, sizey, sizez>
-
-            return Vector3(randX * _stage.getDistributionParm(0),
-                           randY * _stage.getDistributionParm(1),
-                           randZ * _stage.getDistributionParm(2));
         }
+        break;
 
         case IStageDef::DISTRIBUTION_CYLINDER:
         {
@@ -494,23 +647,27 @@ Vector3 RenderableParticleBunch::getDistributionOffset(ParticleRenderInfo& parti
                 sizeY *= ringFrac;
             }
 
-            if (distributeParticlesRandomly)
+            if (_distributeParticlesRandomly)
             {
-                // Get a random angle in [0..2pi]
-                float angle = static_cast<float>(2*c_pi) * particle.rand[0];
-
-                float xPos = cos(angle) * sizeX;
-                float yPos = sin(angle) * sizeY;
-                float zPos = sizeZ * (2 * particle.rand[1] - 1.0f);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    // Get a random angle in [0..2pi]
+                    float angle = static_cast<float>(2*c_pi) * batch.rand[0][i];
 
-                return Vector3(xPos, yPos, zPos);
+                    x[i] = cos(angle) * sizeX;
+                    y[i] = sin(angle) * sizeY;
+                    z[i] = sizeZ * (2 * batch.rand[1][i] - 1.0f);
+                }
             }
             else
             {
                 // Random distribution is off, particles get spawned at <sizex, sizey, sizez>
-                return Vector3(sizeX, sizeY, sizeZ);
+                std::fill(x.begin(), x.end(), sizeX);
+                std::fill(y.begin(), y.end(), sizeY);
+                std::fill(z.begin(), z.end(), sizeZ);
             }
         }
+        break;
 
         case IStageDef::DISTRIBUTION_SPHERE:
         {
@@ -524,124 +681,105 @@ Vector3 RenderableParticleBunch::getDistributionOffset(ParticleRenderInfo& parti
             float minY = maxY * ringFrac;
             float minZ = maxZ * ringFrac;
 
-            if (distributeParticlesRandomly)
+            if (_distributeParticlesRandomly)
             {
-                // The following is modeled after http://mathworld.wolfram.com/SpherePointPicking.html
-                float u = particle.rand[0];
-                float v = particle.rand[1];
-
-                float theta = 2 * static_cast<float>(c_pi) * u;
-                float phi = acos(2*v - 1);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    // The following is modeled after http://mathworld.wolfram.com/SpherePointPicking.html
+                    float theta = 2 * static_cast<float>(c_pi) * batch.rand[0][i];
+                    float phi = acos(2 * batch.rand[1][i] - 1);
 
-                // Take the sqrt(radius) to correct bunching at the center of the sphere
-                float r = sqrt(particle.rand[2]);
+                    // Take the sqrt(radius) to correct bunching at the center of the sphere
+                    float r = sqrt(batch.rand[2][i]);
 
-                float x = (minX + (maxX - minX) * r) * cos(theta) * sin(phi);
-                float y = (minY + (maxY - minY) * r) * sin(theta) * sin(phi);
-                float z = (minZ + (maxZ - minZ) * r) * cos(phi);
+                    float sinPhi = sin(phi);
 
-                return Vector3(x,y,z);
+                    x[i] = (minX + (maxX - minX) * r) * cos(theta) * sinPhi;
+                    y[i] = (minY + (maxY - minY) * r) * sin(theta) * sinPhi;
+                    z[i] = (minZ + (maxZ - minZ) * r) * cos(phi);
+                }
             }
             else
             {
                 // Random distribution is off, particles get spawned at <sizex, sizey, sizez>
-                return Vector3(maxX, maxY, maxZ);
+                std::fill(x.begin(), x.end(), maxX);
+                std::fill(y.begin(), y.end(), maxY);
+                std::fill(z.begin(), z.end(), maxZ);
             }
         }
+        break;
 
         // Default case, should not be reachable
         default:
-            return Vector3(0,0,0);
+            std::fill(x.begin(), x.end(), 0.0f);
+            std::fill(y.begin(), y.end(), 0.0f);
+            std::fill(z.begin(), z.end(), 0.0f);
+            break;
     };
 }
 
-void RenderableParticleBunch::pushQuad(ParticleRenderInfo& particle, const Vector4& colour, float s0, float sWidth)
+void RenderableParticleBunch::pushQuad(ParticleRenderInfo& particle, const Vector4f& colour, float s0, float sWidth)
 {
     // greebo: Create a (rotated) quad facing the z axis
     // then rotate it to fit the requested orientation
     // finally translate it to its position.
-    const Vector3& normal = _viewRotation.z().getVector3();
+    Vector3f normal = toVector3f(_viewRotation.z().getVector3());
 
     _quads.push_back(ParticleQuad(particle.size, particle.aspect, particle.angle, colour, normal, s0, sWidth));
     _quads.back().transform(_viewRotation);
     _quads.back().translate(particle.origin);
 }
 
-void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, std::size_t stageDurationMsec)
+void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, const ParticleOriginBatch& batch,
+                                                 std::size_t firstOrigin, int numQuads)
 {
-    int trails = static_cast<int>(_stage.getOrientationParm(0)); // trails
-    float aimedTime = _stage.getOrientationParm(1); // time
-
-    if (trails < 0)
-    {
-        trails = 0;
-    }
-
-    // The time parameter defaults to 0.5 if not specified
-    if (aimedTime == 0.0f)
-    {
-        aimedTime = 0.5f;
-    }
-
-    // The time delta to step into the past
-    int numQuads = trails + 1;
+    Vector3f lastOrigin = batch.getOrigin(firstOrigin);
 
-    // The time delta between quads
-    float timeStep = aimedTime / numQuads;
-
-    Vector3 lastOrigin = particle.origin;
+    // The vertical texture space occupied by each quad
+    float tWidth = 1.0f / static_cast<float>(numQuads);
 
     for (int i = 1; i <= numQuads; ++i)
     {
-        // Copy over the info of the incoming particle (contains anim info, colour, etc.)
-        ParticleRenderInfo aimedParticle = particle;
-
-        // Get the time of the i-th particle in seconds, plus the fraction
-        aimedParticle.timeSecs = particle.timeSecs - timeStep * i;
-        aimedParticle.timeFraction = SEC2MS(aimedParticle.timeSecs) / stageDurationMsec;
-
-        // Get origin and velocity at that time
-        calculateOrigin(aimedParticle);
+        // The origin of the i-th quad, stepping into the past
+        Vector3f origin = batch.getOrigin(firstOrigin + i);
 
         // Gotcha: don't bother calculating the actual velocity at the given time, just use the
         // difference vector of the two origins, this is enough to receive the "aimed" direction
-        Vector3 velocity = lastOrigin - aimedParticle.origin;
+        Vector3f velocity = lastOrigin - origin;
 
-        float height = static_cast<float>(velocity.getLength());
+        float height = velocity.getLength();
 
-        aimedParticle.aspect = 2 * aimedParticle.size / height;
-        aimedParticle.size = height * 0.5f;
+        float aspect = 2 * particle.size / height;
+        float size = height * 0.5f;
 
         // Calculate the vertical texture coordinates
-        aimedParticle.tWidth = 1.0f / static_cast<float>(numQuads);
-        aimedParticle.t0 = (i - 1) * aimedParticle.tWidth;
+        float t0 = (i - 1) * tWidth;
 
         // The matrix is special for each particle. For helix and other path types
         // it's necessary to apply the same matrix to each vertex sharing the same 3D location.
 
         // Calculate the matrix to orient it towards the viewer
-        Matrix4 local2aimed = getAimedMatrix(velocity);
+        Matrix4 local2aimed = getAimedMatrix(toVector3(velocity));
 
         {
-            const Vector3& normal = local2aimed.z().getVector3();
+            Vector3f normal = toVector3f(local2aimed.z().getVector3());
 
             // Ignore the angle for aimed orientation
-            ParticleQuad curQuad(aimedParticle.size, aimedParticle.aspect, 0,
-                                 aimedParticle.colour, normal, 0, 1, aimedParticle.t0, aimedParticle.tWidth);
+            ParticleQuad curQuad(size, aspect, 0, particle.colour, normal, 0, 1, t0, tWidth);
 
             // Apply a slight origin correction before rotating them, particles are not centered around 0,0,0 here
-            curQuad.translate(Vector3(0, -height*0.5f, 0));
+            curQuad.translate(Vector3f(0, -height*0.5f, 0));
             curQuad.transform(local2aimed);
             curQuad.translate(lastOrigin);
 
             // Push two quads for animated particles
-            if (aimedParticle.animFrames > 0)
+            if (particle.animFrames > 0)
             {
                 // "Current" quad
-                curQuad.assignColour(aimedParticle.curColour);
+                curQuad.assignColour(particle.curColour);
 
                 // Set the hoirzontal texcoord for the current frame
-                curQuad.setHorizTexCoords(aimedParticle.sWidth * aimedParticle.curFrame, aimedParticle.sWidth);
+                curQuad.setHorizTexCoords(particle.sWidth * particle.curFrame, particle.sWidth);
 
                 // Glue the first row of vertices to the last quad, if applicable
                 if (i > 1)
@@ -652,10 +790,10 @@ void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, s
                 _quads.push_back(curQuad);
 
                 // "Next" quad, re-use the curQuad structure
-                curQuad.assignColour(aimedParticle.nextColour);
+                curQuad.assignColour(particle.nextColour);
 
                 // Set the hoirzontal texcoord for the next frame
-                curQuad.setHorizTexCoords(aimedParticle.sWidth * aimedParticle.nextFrame, aimedParticle.sWidth);
+                curQuad.setHorizTexCoords(particle.sWidth * particle.nextFrame, particle.sWidth);
 
                 if (i > 1)
                 {
@@ -676,7 +814,7 @@ void RenderableParticleBunch::pushAimedParticles(ParticleRenderInfo& particle, s
             }
         }
 
-        lastOrigin = aimedParticle.origin;
+        lastOrigin = origin;
     }
 }
 
@@ -702,10 +840,10 @@ void RenderableParticleBunch::calculateBounds()
 {
     for (Quads::const_iterator i = _quads.begin(); i != _quads.end(); ++i)
     {
-        _bounds.includePoint(i->verts[0].vertex);
-        _bounds.includePoint(i->verts[1].vertex);
-        _bounds.includePoint(i->verts[2].vertex);
-        _bounds.includePoint(i->verts[3].vertex);
+        _bounds.includePoint(toVector3(i->verts[0].vertex));
+        _bounds.includePoint(toVector3(i->verts[1].vertex));
+        _bounds.includePoint(toVector3(i->verts[2].vertex));
+        _bounds.includePoint(toVector3(i->verts[3].vertex));
     }
 }
 
@@ -58,6 +58,13 @@ class RenderableParticleBunch : public OpenGLRenderable
 	// The entity colour (instance owned by RenderableParticle)
 	const Vector3& _entityColour;
 
+	// The working set of update(), kept around to re-use the allocated memory
+	std::vector<ParticleRenderInfo> _particles;
+	ParticleOriginBatch _origins;
+	std::vector<float> _offsetX;
+	std::vector<float> _offsetY;
+	std::vector<float> _offsetZ;
+
 public:
 	// Each bunch has a defined zero-based index
 	RenderableParticleBunch(std::size_t index,
@@ -87,33 +94,39 @@ private:
 		return (param.getTo() - param.getFrom()) / _stage.getDuration() * time*time * 0.5f + param.getFrom() * time;
 	}
 
-	Vector4 lerpColour(const Vector4& startColour, const Vector4& endColour, float fraction)
+	Vector4f lerpColour(const Vector4f& startColour, const Vector4f& endColour, float fraction)
 	{
 		return startColour * (1.0f - fraction) + endColour * fraction;
 	}
 
 	void calculateColour(ParticleRenderInfo& particle);
 
-	// Calculates origin at the given time, write result back to the given struct
-	void calculateOrigin(ParticleRenderInfo& particle);
+	// Calculates the origins of all entries in the given batch
+	void calculateOrigins(ParticleOriginBatch& batch);
 
-	// Handles animFrame stuff, may only be called if animFrames > 0
-	void calculateAnim(ParticleRenderInfo& particle);
+	// The path integration kernels, adding the path offset to the origins in the batch
+	void integrateStandardPath(ParticleOriginBatch& batch, const Matrix4& rotation);
+	void integrateFliesPath(ParticleOriginBatch& batch);
+	void integrateHelixPath(ParticleOriginBatch& batch);
 
-	// The rotation is used to deviate the offsets should be normalised and not degenerate
-	Vector3 getDirection(ParticleRenderInfo& particle, const Matrix4& rotation, const Vector3& distributionOffset);
+	// Writes the spawn offsets of the standard path into the given arrays
+	void calculateDistributionOffsets(const ParticleOriginBatch& batch,
+		std::vector<float>& x, std::vector<float>& y, std::vector<float>& z);
 
-	Vector3 getDistributionOffset(ParticleRenderInfo& particle, bool distributeParticlesRandomly);
+	// Handles animFrame stuff, may only be called if animFrames > 0
+	void calculateAnim(ParticleRenderInfo& particle);
 
 	// Calculates the matrix which rotates faces towards the viewer (used for "aimed" orientation)
 	Matrix4 getAimedMatrix(const Vector3& particleVelocity);
 
-	// Handles aimed particles
-	void pushAimedParticles(ParticleRenderInfo& particle, std::size_t stageDurationMsec);
+	// Handles aimed particles, the origins of the trailing quads are
+	// found in the batch, starting at the given entry
+	void pushAimedParticles(ParticleRenderInfo& particle, const ParticleOriginBatch& batch,
+							std::size_t firstOrigin, int numQuads);
 
 	// Generates a new quad using the given struct as data source.
 	// colour, s0 and sWidth override the values in info
-	void pushQuad(ParticleRenderInfo& particle, const Vector4& colour, float s0 = 0.0f, float sWidth = 1.0f);
+	void pushQuad(ParticleRenderInfo& particle, const Vector4f& colour, float s0 = 0.0f, float sWidth = 1.0f);
 
 	// Makes the quad transition seamless by snapping the adjacent vertices at the midpoint
 	void snapQuads(ParticleQuad& curQuad, ParticleQuad& prevQuad);
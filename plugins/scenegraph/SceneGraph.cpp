@@ -138,6 +138,14 @@ void SceneGraph::nodeBoundsChanged(const scene::INodePtr& node)
 	}
 }
 
+void SceneGraph::nodeLayersChanged(const scene::INodePtr& node, const LayerMask& previousLayers)
+{
+	for (ObserverList::iterator i = _sceneObservers.begin(); i != _sceneObservers.end(); ++i)
+	{
+		(*i)->onSceneNodeLayersChanged(node, previousLayers);
+	}
+}
+
 void SceneGraph::foreachNodeInVolume(const VolumeTest& volume, const NodeVisitorFunc& functor)
 {
 	foreachNodeInVolume(volume, functor, true); // visit hidden
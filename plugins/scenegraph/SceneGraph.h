@@ -66,6 +66,7 @@ public:
 	void erase(const INodePtr& node);
 
 	void nodeBoundsChanged(const scene::INodePtr& node);
+	void nodeLayersChanged(const scene::INodePtr& node, const LayerMask& previousLayers);
 
 	// Walker variants
 	void foreachNodeInVolume(const VolumeTest& volume, Walker& walker);
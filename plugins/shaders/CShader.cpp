@@ -7,6 +7,7 @@
 #include "parser/DefTokeniser.h"
 
 #include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 
 /* CONSTANTS */
 namespace {
@@ -26,7 +27,8 @@ CShader::CShader(const std::string& name, const ShaderDefinition& definition) :
 	_fileName(definition.filename),
 	_name(name),
 	m_bInUse(false),
-	_visible(true)
+	_visible(true),
+	_lastUsed(0)
 {
 	// Realise the shader
 	realise();
@@ -51,12 +53,17 @@ TexturePtr CShader::getEditorImage()
 {
     if (!_editorTexture)
     {
+        // Make room for the new texture first
+        GetShaderSystem()->checkTextureBudget();
+
         // Pass the call to the GLTextureManager to realise this image
         _editorTexture = GetTextureManager().getBinding(
             _template->getEditorTexture()
         );
     }
 
+    _lastUsed = GetTextureManager().getUseStamp();
+
     return _editorTexture;
 }
 
@@ -77,6 +84,7 @@ TexturePtr CShader::lightFalloffImage() {
 
 	// Construct the texture if necessary
 	if (!_texLightFalloff) {
+		GetShaderSystem()->checkTextureBudget();
 
 		// Create image. If there is no falloff image defined, use the
 		// default.
@@ -98,6 +106,9 @@ TexturePtr CShader::lightFalloffImage() {
 		}
 
 	}
+
+	_lastUsed = GetTextureManager().getUseStamp();
+
 	// Return the texture
 	return _texLightFalloff;
 }
@@ -214,6 +225,72 @@ void CShader::unrealiseLighting()
 	_layers.clear();
 }
 
+void CShader::setDefinition(const ShaderDefinition& definition)
+{
+	unrealise();
+
+	_template = definition.shaderTemplate;
+	_fileName = definition.filename;
+
+	_editorTexture.reset();
+	_texLightFalloff.reset();
+	_lastUsed = 0;
+
+	realise();
+}
+
+bool CShader::usesImages(const StringSet& imageNames) const
+{
+	// Collect the identifiers of the textures, generated textures contain
+	// the identifiers of the images they are made of
+	std::vector<std::string> identifiers;
+
+	if (_template->getEditorTexture())
+	{
+		identifiers.push_back(_template->getEditorTexture()->getIdentifier());
+	}
+
+	if (_template->getLightFalloff())
+	{
+		identifiers.push_back(_template->getLightFalloff()->getIdentifier());
+	}
+
+	for (ShaderTemplate::Layers::const_iterator i = _template->getLayers().begin();
+		 i != _template->getLayers().end(); ++i)
+	{
+		if ((*i)->getBindableTexture())
+		{
+			identifiers.push_back((*i)->getBindableTexture()->getIdentifier());
+		}
+	}
+
+	for (std::vector<std::string>::const_iterator i = identifiers.begin(); i != identifiers.end(); ++i)
+	{
+		for (StringSet::const_iterator name = imageNames.begin(); name != imageNames.end(); ++name)
+		{
+			if (boost::algorithm::icontains(*i, *name))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void CShader::releaseTextures()
+{
+	_editorTexture.reset();
+	_texLightFalloff.reset();
+	_lastUsed = 0;
+
+	for (ShaderTemplate::Layers::const_iterator i = _template->getLayers().begin();
+		 i != _template->getLayers().end(); ++i)
+	{
+		(*i)->releaseTexture();
+	}
+}
+
 /*
  * Set name of shader.
  */
@@ -30,6 +30,9 @@ private:
 
 	bool _visible;
 
+	// Usage stamp of the last texture request, 0 if no textures are loaded
+	std::size_t _lastUsed;
+
     // Vector of shader layers
 	ShaderLayerVector _layers;
 
@@ -113,6 +116,23 @@ public:
 	void realiseLighting();
 	void unrealiseLighting();
 
+	// Switches this shader to the given (re-parsed) definition
+	void setDefinition(const ShaderDefinition& definition);
+
+	// Returns true if one of the textures of this shader is generated from
+	// one of the given images (VFS paths without extension)
+	bool usesImages(const StringSet& imageNames) const;
+
+	// Releases the textures bound so far, they are loaded again on next use
+	void releaseTextures();
+
+	// Returns the usage stamp of the last texture request (see
+	// GLTextureManager::getUseStamp()), 0 if no textures are loaded
+	std::size_t getLastUsed() const
+	{
+		return _lastUsed;
+	}
+
 	/*
 	 * Set name of shader.
 	 */
@@ -1,5 +1,7 @@
 #include "Doom3ShaderLayer.h"
 #include "Doom3ShaderSystem.h"
+#include "ShaderExpression.h"
+#include "itextstream.h"
 
 namespace shaders
 {
@@ -81,6 +83,7 @@ const IShaderExpressionPtr Doom3ShaderLayer::NULL_EXPRESSION;
 Doom3ShaderLayer::Doom3ShaderLayer(ShaderTemplate& material, ShaderLayer::Type type, const NamedBindablePtr& btex)
 :	_material(material),
 	_registers(NUM_RESERVED_REGISTERS),
+	_programState(PROGRAM_OUTDATED),
 	_condition(REG_ONE),
 	_bindableTex(btex),
 	_type(type),
@@ -153,9 +156,7 @@ Colour4 Doom3ShaderLayer::getColour() const
 void Doom3ShaderLayer::setColourExpression(ColourComponentSelector comp, const IShaderExpressionPtr& expr)
 {
 	// Store the expression and link it to our registers
-	_expressions.push_back(expr);
-
-	std::size_t index = expr->linkToRegister(_registers);
+	std::size_t index = addExpression(expr);
 
 	// Now assign the index to our colour components
 	switch (comp)
@@ -230,5 +231,67 @@ TexturePtr Doom3ShaderLayer::getFragmentMap(int index)
 	return GetTextureManager().getBinding(_fragmentMaps[index]);
 }
 
+std::size_t Doom3ShaderLayer::addExpression(const IShaderExpressionPtr& expr)
+{
+	std::size_t index = expr->linkToRegister(_registers);
+
+	_expressions.push_back(expr);
+	_expressionRegisters.push_back(index);
+
+	// Compile again on next evaluation
+	_programState = PROGRAM_OUTDATED;
+
+	return index;
+}
+
+void Doom3ShaderLayer::evaluateExpressions(std::size_t time, const IRenderEntity* entity)
+{
+	if (_programState == PROGRAM_OUTDATED)
+	{
+		compileExpressions();
+	}
+
+	if (_programState == PROGRAM_COMPILED)
+	{
+		_program.execute(_registers, time, entity);
+		return;
+	}
+
+	for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
+	{
+		if (entity != NULL)
+		{
+			(*i)->evaluate(time, *entity);
+		}
+		else
+		{
+			(*i)->evaluate(time);
+		}
+	}
+}
+
+void Doom3ShaderLayer::compileExpressions()
+{
+	_program.clear();
+	_programState = PROGRAM_COMPILED;
+
+	for (std::size_t i = 0; i < _expressions.size(); ++i)
+	{
+		ExpressionProgram::Operand result;
+
+		if (!ShaderExpression::compileExpression(_expressions[i], _program, result))
+		{
+			rWarning() << "[shaders] Cannot compile the expressions of a stage in "
+				<< _material.getName() << std::endl;
+
+			_program.clear();
+			_programState = PROGRAM_UNSUPPORTED;
+			return;
+		}
+
+		_program.addOutput(result, _expressionRegisters[i]);
+	}
+}
+
 }
 
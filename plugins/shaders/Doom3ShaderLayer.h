@@ -5,6 +5,7 @@
 
 #include "math/Vector4.h"
 #include "NamedBindable.h"
+#include "ExpressionProgram.h"
 
 namespace shaders
 {
@@ -43,6 +44,20 @@ private:
     typedef std::vector<IShaderExpressionPtr> Expressions;
     Expressions _expressions;
 
+    // The register index of each expression in _expressions
+    std::vector<std::size_t> _expressionRegisters;
+
+    // The expressions compiled into a single program, which is
+    // done on first evaluation after the expressions changed
+    enum ProgramState
+    {
+        PROGRAM_OUTDATED,
+        PROGRAM_COMPILED,
+        PROGRAM_UNSUPPORTED,  // evaluate the expressions one by one
+    };
+    ProgramState _programState;
+    ExpressionProgram _program;
+
     static const IShaderExpressionPtr NULL_EXPRESSION;
 
     // The condition register for this stage. Points to a register to be interpreted as bool.
@@ -133,27 +148,18 @@ public:
 
     void setCondition(const IShaderExpressionPtr& conditionExpr)
     {
-        // Store the expression in our list
-        _expressions.push_back(conditionExpr);
-
-        // Link the result to our local registers
-        _condition = conditionExpr->linkToRegister(_registers);
+        // Store the expression in our list and link the result to our local registers
+        _condition = addExpression(conditionExpr);
     }
 
     void evaluateExpressions(std::size_t time) 
     {
-        for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
-        {
-            (*i)->evaluate(time);
-        }
+        evaluateExpressions(time, NULL);
     }
 
     void evaluateExpressions(std::size_t time, const IRenderEntity& entity)
     {
-        for (Expressions::iterator i = _expressions.begin(); i != _expressions.end(); ++i)
-        {
-            (*i)->evaluate(time, entity);
-        }
+        evaluateExpressions(time, &entity);
     }
 
     /**
@@ -174,6 +180,16 @@ public:
         return _bindableTex;
     }
 
+    /**
+     * \brief
+     * Release the Texture object, it is created again by the next call to
+     * getTexture().
+     */
+    void releaseTexture()
+    {
+        _texture.reset();
+    }
+
     /**
      * \brief
      * Set the layer type.
@@ -296,11 +312,8 @@ public:
      */
     void setScale(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _scale[0] = xExpr->linkToRegister(_registers);
-        _scale[1] = yExpr->linkToRegister(_registers);
+        _scale[0] = addExpression(xExpr);
+        _scale[1] = addExpression(yExpr);
     }
 
     Vector2 getTranslation() 
@@ -313,11 +326,8 @@ public:
      */
     void setTranslation(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _translation[0] = xExpr->linkToRegister(_registers);
-        _translation[1] = yExpr->linkToRegister(_registers);
+        _translation[0] = addExpression(xExpr);
+        _translation[1] = addExpression(yExpr);
     }
 
     float getRotation() 
@@ -330,9 +340,7 @@ public:
      */
     void setRotation(const IShaderExpressionPtr& expr)
     {
-        _expressions.push_back(expr);
-
-        _rotation = expr->linkToRegister(_registers);
+        _rotation = addExpression(expr);
     }
 
     Vector2 getShear() 
@@ -345,11 +353,8 @@ public:
      */
     void setShear(const IShaderExpressionPtr& xExpr, const IShaderExpressionPtr& yExpr)
     {
-        _expressions.push_back(xExpr);
-        _expressions.push_back(yExpr);
-
-        _shear[0] = xExpr->linkToRegister(_registers);
-        _shear[1] = yExpr->linkToRegister(_registers);
+        _shear[0] = addExpression(xExpr);
+        _shear[1] = addExpression(yExpr);
     }
 
     /**
@@ -367,8 +372,7 @@ public:
      */
     void setAlphaTest(const IShaderExpressionPtr& expr)
     {
-        _expressions.push_back(expr);
-        _alphaTest = expr->linkToRegister(_registers);
+        _alphaTest = addExpression(expr);
     }
 
     // Returns the value of the given register
@@ -382,6 +386,9 @@ public:
     {
         assert(index < _registers.size());
         _registers[index] = value;
+
+        // Make sure expressions writing this register are evaluated again
+        _program.invalidate();
     }
 
     // Allocates a new register, initialised with the given value
@@ -422,25 +429,21 @@ public:
     {
         assert(parm0);
 
-        _expressions.push_back(parm0);
-        std::size_t parm0Reg = parm0->linkToRegister(_registers);
+        std::size_t parm0Reg = addExpression(parm0);
 
         _vertexParms.push_back(parm0Reg);
 
         if (parm1)
         {
-            _expressions.push_back(parm1);
-            _vertexParms.push_back(parm1->linkToRegister(_registers));
+            _vertexParms.push_back(addExpression(parm1));
 
             if (parm2)
             {
-                _expressions.push_back(parm2);
-                _vertexParms.push_back(parm2->linkToRegister(_registers));
+                _vertexParms.push_back(addExpression(parm2));
 
                 if (parm3)
                 {
-                    _expressions.push_back(parm3);
-                    _vertexParms.push_back(parm3->linkToRegister(_registers));
+                    _vertexParms.push_back(addExpression(parm3));
                 }
                 else
                 {
@@ -504,6 +507,15 @@ public:
     {
         _privatePolygonOffset = value;
     }
+
+private:
+    // Stores the expression and links it to a new register, returns the register index
+    std::size_t addExpression(const IShaderExpressionPtr& expr);
+
+    // Evaluates the expressions, the entity may be NULL
+    void evaluateExpressions(std::size_t time, const IRenderEntity* entity);
+
+    void compileExpressions();
 };
 
 /**
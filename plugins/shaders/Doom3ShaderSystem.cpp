@@ -4,6 +4,7 @@
 #include "iregistry.h"
 #include "ifilesystem.h"
 #include "ipreferencesystem.h"
+#include "registry/registry.h"
 
 #include "xmlutil/Node.h"
 #include "xmlutil/MissingXMLNodeException.h"
@@ -11,10 +12,14 @@
 #include "ShaderDefinition.h"
 #include "ShaderFileLoader.h"
 #include "ShaderExpression.h"
+#include "MapExpression.h"
+#include "textures/ImageFileLoader.h"
 
 #include "debugging/ScopedDebugTimer.h"
 
+#include <algorithm>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/bind.hpp>
 
 namespace {
 	const char* TEXTURE_PREFIX = "textures/";
@@ -30,6 +35,13 @@ in game descriptor";
 	const std::string IMAGE_FLAT = "_flat.bmp";
 	const std::string IMAGE_BLACK = "_black.bmp";
 
+	// Texture memory budget in MB, 0 for no limit
+	const std::string RKEY_TEXTURE_MEMORY_BUDGET = "user/ui/textures/memoryBudget";
+
+	// The fraction of the budget to free up once it is exhausted, so
+	// that the next few textures can be loaded without releasing others
+	const std::size_t BUDGET_RELEASE_PERCENT = 25;
+
 }
 
 namespace shaders {
@@ -38,12 +50,14 @@ namespace shaders {
 Doom3ShaderSystem::Doom3ShaderSystem() :
 	_enableActiveUpdates(true),
 	_realised(false),
-	_observers(getName())
+	_observers(getName()),
+	_numReleasedShaders(0)
 {}
 
 void Doom3ShaderSystem::construct() {
 	_library = ShaderLibraryPtr(new ShaderLibrary());
 	_textureManager = GLTextureManagerPtr(new GLTextureManager());
+	updateTextureBudget();
 
 	// Register this class as VFS observer
 	GlobalFileSystem().addObserver(*this);
@@ -82,13 +96,23 @@ void Doom3ShaderSystem::loadMaterialFiles()
 
 	std::string extension = nlShaderExt[0].getContent();
 
+	// Remember the location for reloading single files
+	_materialPath = sPath;
+	_materialExtension = extension;
+
+	// Files which didn't change since the last session are not read,
+	// their materials are loaded on demand
+	_materialIndex.load(_materialIndexFile);
+
 	// Load each file from the global filesystem
-	ShaderFileLoader loader(sPath);
+	ShaderFileLoader loader(sPath, false, &_materialIndex);
 	{
 		ScopedDebugTimer timer("ShaderFiles parsed: ");
 		GlobalFileSystem().forEachFile(sPath, extension, loader, 0);
 	}
 
+	_materialIndex.save();
+
 	rMessage() << _library->getNumShaders() << " shaders found." << std::endl;
 }
 
@@ -119,8 +143,116 @@ void Doom3ShaderSystem::onFileSystemShutdown() {
 	unrealise();
 }
 
+void Doom3ShaderSystem::onFilesChanged(const StringSet& filenames)
+{
+	if (!_realised) return;
+
+	StringSet changedShaders;
+	StringSet imageNames;
+
+	for (StringSet::const_iterator i = filenames.begin(); i != filenames.end(); ++i)
+	{
+		if (boost::algorithm::istarts_with(*i, _materialPath) &&
+			boost::algorithm::iends_with(*i, "." + _materialExtension))
+		{
+			reloadMaterialFile(*i, changedShaders);
+			continue;
+		}
+
+		std::string imageName = ImageFileLoader::getImageNameForFile(*i);
+
+		if (!imageName.empty())
+		{
+			imageNames.insert(imageName);
+		}
+	}
+
+	if (!imageNames.empty())
+	{
+		reloadImages(imageNames, changedShaders);
+	}
+
+	if (!changedShaders.empty())
+	{
+		rMessage() << "[shaders] " << changedShaders.size() << " shader(s) reloaded" << std::endl;
+
+		// The map expressions of the replaced definitions might be unused now
+		MapExpression::releaseUnusedExpressions();
+
+		_materialsReloadedSignal.emit(changedShaders);
+		activeShadersChangedNotify();
+	}
+}
+
+void Doom3ShaderSystem::reloadMaterialFile(const std::string& filename, StringSet& changedShaders)
+{
+	// The definitions are referring to the file using the configured base path
+	std::string relativeName = filename.substr(_materialPath.length());
+	std::string fullPath = _materialPath + relativeName;
+
+	rMessage() << "[shaders] Reloading material file " << fullPath << std::endl;
+
+	// The names defined in the file before and after the change
+	StringSet names;
+	_library->removeDefinitions(fullPath, names);
+
+	try
+	{
+		ShaderFileLoader loader(_materialPath, true, &_materialIndex);
+		loader.visit(relativeName);
+
+		_materialIndex.save();
+	}
+	catch (std::runtime_error& e)
+	{
+		// The file has been removed or is shadowed now
+		rWarning() << "[shaders] " << e.what() << std::endl;
+	}
+
+	_library->getDefinitionNames(fullPath, names);
+
+	_library->updateShaders(names, changedShaders);
+}
+
+void Doom3ShaderSystem::reloadImages(const StringSet& imageNames, StringSet& changedShaders)
+{
+	_library->releaseTextures(imageNames, changedShaders);
+
+	// Textures still in use by the renderer are released once it rebuilt the shaders
+	_textureManager->removeBindings(imageNames);
+}
+
+void Doom3ShaderSystem::checkTextureBudget()
+{
+	if (!_textureManager->isOverBudget()) return;
+
+	std::size_t budget = _textureManager->getMemoryBudget();
+	std::size_t target = budget - budget / 100 * BUDGET_RELEASE_PERCENT;
+
+	_numReleasedShaders += _library->releaseUnusedTextures(target);
+}
+
+void Doom3ShaderSystem::updateTextureBudget()
+{
+	std::size_t budgetMB = static_cast<std::size_t>(
+		std::max(registry::getValue<int>(RKEY_TEXTURE_MEMORY_BUDGET), 0));
+
+	_textureManager->setMemoryBudget(budgetMB * 1024 * 1024);
+}
+
+void Doom3ShaderSystem::printTextureStats(const cmd::ArgumentList& args)
+{
+	_textureManager->printStats();
+
+	rMessage() << "Shaders with released textures so far: " << _numReleasedShaders << std::endl;
+}
+
 void Doom3ShaderSystem::freeShaders() {
 	_library->clear();
+
+	// The map expressions of the cleared materials are gone now
+	MapExpression::releaseUnusedExpressions();
+
 	_textureManager->checkBindings();
 	activeShadersChangedNotify();
 }
@@ -135,6 +267,11 @@ bool Doom3ShaderSystem::isRealised() {
 	return _realised;
 }
 
+sigc::signal<void, const StringSet&> Doom3ShaderSystem::signal_materialsReloaded() const
+{
+	return _materialsReloadedSignal;
+}
+
 // Return a shader by name
 MaterialPtr Doom3ShaderSystem::getMaterialForName(const std::string& name)
 {
@@ -147,6 +284,11 @@ bool Doom3ShaderSystem::materialExists(const std::string& name)
 	return _library->definitionExists(name);
 }
 
+void Doom3ShaderSystem::preloadMaterials(const StringSet& names)
+{
+	_library->parseDefinitions(names);
+}
+
 void Doom3ShaderSystem::foreachShaderName(const ShaderNameCallback& callback) {
 	// Pass the call to the Library
 	_library->foreachShaderName(callback);
@@ -282,6 +424,11 @@ bool Doom3ShaderSystem::addTableDefinition(const TableDefinitionPtr& def)
 	return result.second;
 }
 
+void Doom3ShaderSystem::replaceTableDefinition(const TableDefinitionPtr& def)
+{
+	_tables[def->getName()] = def;
+}
+
 const std::string& Doom3ShaderSystem::getName() const {
 	static std::string _name(MODULE_SHADERSYSTEM);
 	return _name;
@@ -294,6 +441,7 @@ const StringSet& Doom3ShaderSystem::getDependencies() const {
 		_dependencies.insert(MODULE_VIRTUALFILESYSTEM);
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_COMMANDSYSTEM);
 	}
 
 	return _dependencies;
@@ -303,9 +451,22 @@ void Doom3ShaderSystem::initialiseModule(const ApplicationContext& ctx)
 {
 	rMessage() << getName() << "::initialiseModule called" << std::endl;
 
+	_materialIndexFile = ctx.getSettingsPath() + "materials.index";
+
 	construct();
 	realise();
 
+	GlobalRegistry().signalForKey(RKEY_TEXTURE_MEMORY_BUDGET).connect(
+		sigc::mem_fun(this, &Doom3ShaderSystem::updateTextureBudget)
+	);
+
+	PreferencesPagePtr page = GlobalPreferenceSystem().getPage("Settings/Textures");
+	page->appendSpinner("Texture Memory Budget (MB, 0 = no limit)",
+		RKEY_TEXTURE_MEMORY_BUDGET, 0, 65536, 0);
+
+	GlobalCommandSystem().addCommand("TextureStats",
+		boost::bind(&Doom3ShaderSystem::printTextureStats, this, _1));
+
 #ifdef _DEBUG
 	testShaderExpressionParsing();
 #endif
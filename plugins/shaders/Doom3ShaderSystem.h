@@ -2,6 +2,7 @@
 
 #include "ishaders.h"
 #include "ifilesystem.h"
+#include "icommandsystem.h"
 #include "moduleobserver.h"
 
 #include <boost/function.hpp>
@@ -9,6 +10,7 @@
 
 #include "ShaderLibrary.h"
 #include "TableDefinition.h"
+#include "MaterialIndex.h"
 #include "textures/GLTextureManager.h"
 
 namespace shaders {
@@ -46,6 +48,20 @@ class Doom3ShaderSystem
 	// notified upon realisation of this class.
 	ModuleObservers _observers;
 
+	sigc::signal<void, const StringSet&> _materialsReloadedSignal;
+
+	// The VFS folder and extension of the material files
+	std::string _materialPath;
+	std::string _materialExtension;
+
+	// The material names of each file, stored in the user's settings folder
+	MaterialIndex _materialIndex;
+	std::string _materialIndexFile;
+
+	// The number of shaders whose textures were released to stay within
+	// the texture memory budget
+	std::size_t _numReleasedShaders;
+
 public:
 
 	// Constructor, allocates the library
@@ -61,6 +77,9 @@ public:
 	// Gets called on shutdown
 	virtual void onFileSystemShutdown();
 
+	// Reloads the changed material files and images
+	virtual void onFilesChanged(const StringSet& filenames);
+
 	// greebo: This parses the material files and calls realise() on any
 	// attached moduleobservers
 	void realise();
@@ -74,11 +93,15 @@ public:
 	// Is the shader system realised
 	bool isRealised();
 
+	sigc::signal<void, const StringSet&> signal_materialsReloaded() const;
+
 	// Return a shader by name
 	MaterialPtr getMaterialForName(const std::string& name);
 
 	bool materialExists(const std::string& name);
 
+	void preloadMaterials(const StringSet& names);
+
 	void foreachShaderName(const ShaderNameCallback& callback);
 
 	void activeShadersChangedNotify();
@@ -120,6 +143,13 @@ public:
 	// Method for adding tables, returns FALSE if a def with the same name already exists
 	bool addTableDefinition(const TableDefinitionPtr& def);
 
+	// Adds the table, replacing an existing def with the same name
+	void replaceTableDefinition(const TableDefinitionPtr& def);
+
+	// Releases the textures of unused shaders if the texture memory budget
+	// is exhausted, called before new textures are loaded
+	void checkTextureBudget();
+
 public:
 
 	/** Load the shader definitions from the MTR files
@@ -140,6 +170,18 @@ public:
 
 private:
 	void testShaderExpressionParsing();
+
+	// Re-parses the given material file (VFS path), updating the affected shaders
+	void reloadMaterialFile(const std::string& filename, StringSet& changedShaders);
+
+	// Releases the textures made of the given images, updating the affected shaders
+	void reloadImages(const StringSet& imageNames, StringSet& changedShaders);
+
+	// Reads the texture memory budget from the registry
+	void updateTextureBudget();
+
+	// Command target for TextureStats
+	void printTextureStats(const cmd::ArgumentList& args);
 }; // class Doom3ShaderSystem
 
 typedef boost::shared_ptr<Doom3ShaderSystem> Doom3ShaderSystemPtr;
@@ -0,0 +1,180 @@
+#include "ExpressionProgram.h"
+
+#include "irender.h"
+#include <cmath>
+
+namespace shaders
+{
+
+ExpressionProgram::ExpressionProgram() :
+	_usesTime(false),
+	_usesParms(false),
+	_evaluated(false),
+	_lastTime(0)
+{}
+
+void ExpressionProgram::clear()
+{
+	_instructions.clear();
+	_temps.clear();
+	_outputs.clear();
+	_tables.clear();
+
+	_usesTime = false;
+	_usesParms = false;
+	_evaluated = false;
+}
+
+ExpressionProgram::Operand ExpressionProgram::allocateTemp(float value, bool isConstant)
+{
+	_temps.push_back(value);
+
+	Operand operand;
+	operand.temp = _temps.size() - 1;
+	operand.isConstant = isConstant;
+
+	return operand;
+}
+
+ExpressionProgram::Operand ExpressionProgram::addConstant(float value)
+{
+	return allocateTemp(value, true);
+}
+
+ExpressionProgram::Operand ExpressionProgram::addTime()
+{
+	Operand result = allocateTemp(0, false);
+
+	Instruction instr = { OP_TIME, result.temp, 0, 0, 0, NULL };
+	_instructions.push_back(instr);
+
+	_usesTime = true;
+
+	return result;
+}
+
+ExpressionProgram::Operand ExpressionProgram::addParm(int parmNum)
+{
+	Operand result = allocateTemp(0, false);
+
+	Instruction instr = { OP_PARM, result.temp, 0, 0, parmNum, NULL };
+	_instructions.push_back(instr);
+
+	_usesParms = true;
+
+	return result;
+}
+
+ExpressionProgram::Operand ExpressionProgram::addTableLookup(const TableDefinitionPtr& table,
+															 const Operand& lookup)
+{
+	if (lookup.isConstant)
+	{
+		return addConstant(table->getValue(_temps[lookup.temp]));
+	}
+
+	Operand result = allocateTemp(0, false);
+
+	Instruction instr = { OP_TABLE, result.temp, lookup.temp, 0, 0, table.get() };
+	_instructions.push_back(instr);
+
+	_tables.push_back(table);
+
+	return result;
+}
+
+ExpressionProgram::Operand ExpressionProgram::addOperation(OpCode op, const Operand& a,
+														   const Operand& b)
+{
+	if (a.isConstant && b.isConstant)
+	{
+		return addConstant(apply(op, _temps[a.temp], _temps[b.temp]));
+	}
+
+	Operand result = allocateTemp(0, false);
+
+	Instruction instr = { op, result.temp, a.temp, b.temp, 0, NULL };
+	_instructions.push_back(instr);
+
+	return result;
+}
+
+void ExpressionProgram::addOutput(const Operand& operand, std::size_t reg)
+{
+	_outputs.push_back(Output(operand.temp, reg));
+}
+
+void ExpressionProgram::execute(Registers& registers, std::size_t time, const IRenderEntity* entity)
+{
+	// Without parms the results only change with the time
+	if (_evaluated && !_usesParms && (!_usesTime || time == _lastTime))
+	{
+		return;
+	}
+
+	float* temps = _temps.empty() ? NULL : &_temps[0];
+
+	for (Instructions::const_iterator i = _instructions.begin(); i != _instructions.end(); ++i)
+	{
+		switch (i->op)
+		{
+		case OP_TIME:
+			temps[i->dest] = time / 1000.0f; // convert msecs to secs
+			break;
+		case OP_PARM:
+			temps[i->dest] = entity != NULL ? entity->getShaderParm(i->parm) : 0.0f;
+			break;
+		case OP_TABLE:
+			temps[i->dest] = i->table->getValue(temps[i->a]);
+			break;
+		default:
+			temps[i->dest] = apply(i->op, temps[i->a], temps[i->b]);
+			break;
+		};
+	}
+
+	for (Outputs::const_iterator i = _outputs.begin(); i != _outputs.end(); ++i)
+	{
+		registers[i->second] = temps[i->first];
+	}
+
+	_evaluated = true;
+	_lastTime = time;
+}
+
+float ExpressionProgram::apply(OpCode op, float a, float b)
+{
+	switch (op)
+	{
+	case OP_ADD:
+		return a + b;
+	case OP_SUBTRACT:
+		return a - b;
+	case OP_MULTIPLY:
+		return a * b;
+	case OP_DIVIDE:
+		return a / b;
+	case OP_MODULO:
+		return fmod(a, b);
+	case OP_LESSER:
+		return a < b ? 1.0f : 0;
+	case OP_LESSER_OR_EQUAL:
+		return a <= b ? 1.0f : 0;
+	case OP_GREATER:
+		return a > b ? 1.0f : 0;
+	case OP_GREATER_OR_EQUAL:
+		return a >= b ? 1.0f : 0;
+	case OP_EQUAL:
+		return a == b ? 1.0f : 0;
+	case OP_NOT_EQUAL:
+		return a != b ? 1.0f : 0;
+	case OP_AND:
+		return (a != 0 && b != 0) ? 1.0f : 0;
+	case OP_OR:
+		return (a != 0 || b != 0) ? 1.0f : 0;
+	default:
+		return 0;
+	};
+}
+
+}
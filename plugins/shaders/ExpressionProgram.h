@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include "ishaderexpression.h"
+#include "TableDefinition.h"
+
+class IRenderEntity;
+
+namespace shaders
+{
+
+/**
+ * The shader expressions of a stage, compiled into a flat list of
+ * instructions working on temporary registers. This saves walking the
+ * expression trees through virtual calls every time the stage is evaluated.
+ *
+ * Operations on constant operands are folded at compile time, so the program
+ * only contains the instructions depending on the time or the entity parms.
+ * A program which doesn't read any entity parms evaluates to the same results
+ * for all entities, it is skipped if the time didn't change since the last run.
+ */
+class ExpressionProgram
+{
+public:
+	enum OpCode
+	{
+		OP_TIME,			// time in seconds
+		OP_PARM,			// entity shader parm, 0 without entity
+		OP_TABLE,			// table lookup
+		OP_ADD,
+		OP_SUBTRACT,
+		OP_MULTIPLY,
+		OP_DIVIDE,
+		OP_MODULO,
+		OP_LESSER,
+		OP_LESSER_OR_EQUAL,
+		OP_GREATER,
+		OP_GREATER_OR_EQUAL,
+		OP_EQUAL,
+		OP_NOT_EQUAL,
+		OP_AND,
+		OP_OR,
+	};
+
+	// An operand is a temporary register, constants are stored in
+	// temporaries of their own which are never written to
+	struct Operand
+	{
+		std::size_t temp;
+		bool isConstant;
+
+		Operand() :
+			temp(0),
+			isConstant(true)
+		{}
+	};
+
+private:
+	struct Instruction
+	{
+		OpCode op;
+		std::size_t dest;
+		std::size_t a;
+		std::size_t b;
+
+		// The parm number of OP_PARM
+		int parm;
+
+		// The table of OP_TABLE, owned by _tables
+		TableDefinition* table;
+	};
+	typedef std::vector<Instruction> Instructions;
+	Instructions _instructions;
+
+	// The temporaries, initialised with the constant values
+	std::vector<float> _temps;
+
+	// The temporaries to copy into the stage registers after a run
+	typedef std::pair<std::size_t, std::size_t> Output;
+	typedef std::vector<Output> Outputs;
+	Outputs _outputs;
+
+	std::vector<TableDefinitionPtr> _tables;
+
+	bool _usesTime;
+	bool _usesParms;
+
+	// The time of the last run, to skip programs not depending on the entity
+	bool _evaluated;
+	std::size_t _lastTime;
+
+public:
+	ExpressionProgram();
+
+	// Removes all instructions
+	void clear();
+
+	// Compiling, these return the operand holding the result
+	Operand addConstant(float value);
+	Operand addTime();
+	Operand addParm(int parmNum);
+	Operand addTableLookup(const TableDefinitionPtr& table, const Operand& lookup);
+	Operand addOperation(OpCode op, const Operand& a, const Operand& b);
+
+	// Copies the given operand into the stage register after each run
+	void addOutput(const Operand& operand, std::size_t reg);
+
+	// Runs the program, the entity may be NULL
+	void execute(Registers& registers, std::size_t time, const IRenderEntity* entity);
+
+	// Forces the next execute() to run, call this if the stage registers
+	// have been changed in between
+	void invalidate()
+	{
+		_evaluated = false;
+	}
+
+	// Applies the operator of a binary operation to the given values
+	static float apply(OpCode op, float a, float b);
+
+private:
+	Operand allocateTemp(float value, bool isConstant);
+};
+
+}
@@ -3,7 +3,10 @@
 #include <ifilesystem.h>
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/weak_ptr.hpp>
+#include <glibmm/thread.h>
 #include <iostream>
+#include <map>
 
 #include "os/path.h"
 #include "string/convert.h"
@@ -37,7 +40,69 @@ namespace {
 
 namespace shaders {
 
+namespace
+{
+	// The map expressions in use by identifier, identical expressions of
+	// different materials share a single instance. Materials may be parsed
+	// on worker threads, hence the mutex.
+	typedef std::map<std::string, boost::weak_ptr<MapExpression> > SharedExpressions;
+
+	SharedExpressions& getSharedExpressions()
+	{
+		static SharedExpressions _expressions;
+		return _expressions;
+	}
+
+	Glib::Mutex& getSharedExpressionsMutex()
+	{
+		static Glib::Mutex _mutex;
+		return _mutex;
+	}
+
+	// Returns the shared instance of the given expression
+	MapExpressionPtr getSharedExpression(const MapExpressionPtr& expr)
+	{
+		Glib::Mutex::Lock lock(getSharedExpressionsMutex());
+
+		boost::weak_ptr<MapExpression>& shared = getSharedExpressions()[expr->getIdentifier()];
+
+		MapExpressionPtr existing = shared.lock();
+
+		if (existing)
+		{
+			return existing;
+		}
+
+		shared = expr;
+
+		return expr;
+	}
+}
+
 MapExpressionPtr MapExpression::createForToken(DefTokeniser& token) {
+	return getSharedExpression(createNewForToken(token));
+}
+
+void MapExpression::releaseUnusedExpressions()
+{
+	Glib::Mutex::Lock lock(getSharedExpressionsMutex());
+
+	SharedExpressions& expressions = getSharedExpressions();
+
+	for (SharedExpressions::iterator i = expressions.begin(); i != expressions.end(); /* in-loop increment */)
+	{
+		if (i->second.expired())
+		{
+			expressions.erase(i++);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+MapExpressionPtr MapExpression::createNewForToken(DefTokeniser& token) {
 	// Switch on the first keyword, to determine what kind of expression this
 	// is.
 	// Tr3B: don't convert image names to lower because Unix filesystems are case sensitive
@@ -62,11 +62,18 @@ public:
 public: /* STATIC CONSTRUCTION METHODS */
 
 	/** Creates the a MapExpression out of the given token. Nested mapexpressions
-	 * 	are recursively passed to child classes.
+	 * 	are recursively passed to child classes. Identical expressions (having
+	 * 	the same identifier) share a single instance.
 	 */
 	static MapExpressionPtr createForToken(DefTokeniser& token);
 	static MapExpressionPtr createForString(std::string str);
 
+	/// Forgets about the shared expressions no longer used by any material
+	static void releaseUnusedExpressions();
+
+private:
+	static MapExpressionPtr createNewForToken(DefTokeniser& token);
+
 protected:
 
 	/** greebo: Assures that the image is matching the desired dimensions.
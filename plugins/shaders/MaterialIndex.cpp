@@ -0,0 +1,152 @@
+#include "MaterialIndex.h"
+
+#include "itextstream.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+namespace shaders
+{
+
+namespace
+{
+	const std::string HEADER = "DarkRadiant material index 1";
+
+	// Line format: file <vfs path> <source> <modification time> <has tables> <number of materials>
+	// followed by one line per material name
+	const std::string FILE_TAG = "file";
+	const std::size_t NUM_FILE_FIELDS = 6;
+
+	typedef std::vector<std::string> StringParts;
+}
+
+MaterialIndex::MaterialIndex() :
+	_changed(false)
+{}
+
+void MaterialIndex::load(const std::string& filename)
+{
+	_filename = filename;
+	_loaded.clear();
+	_current.clear();
+	_changed = false;
+
+	std::ifstream file(filename.c_str());
+
+	if (!file.is_open()) return;
+
+	std::string line;
+
+	if (!std::getline(file, line) || line != HEADER)
+	{
+		rWarning() << "[shaders] Ignoring outdated material index " << filename << std::endl;
+		return;
+	}
+
+	try
+	{
+		while (std::getline(file, line))
+		{
+			StringParts parts;
+			boost::algorithm::split(parts, line, boost::algorithm::is_any_of("\t"));
+
+			if (parts.size() != NUM_FILE_FIELDS || parts[0] != FILE_TAG)
+			{
+				throw std::runtime_error("invalid file entry");
+			}
+
+			FileEntry& entry = _loaded[parts[1]];
+
+			entry.source = parts[2];
+			entry.modified = boost::lexical_cast<FileTime>(parts[3]);
+			entry.hasTables = parts[4] == "1";
+
+			std::size_t numMaterials = boost::lexical_cast<std::size_t>(parts[5]);
+			entry.materials.reserve(numMaterials);
+
+			for (std::size_t i = 0; i < numMaterials; ++i)
+			{
+				if (!std::getline(file, line))
+				{
+					throw std::runtime_error("unexpected end of file");
+				}
+
+				entry.materials.push_back(line);
+			}
+		}
+	}
+	catch (std::exception& e)
+	{
+		// Start over, the materials are parsed the usual way
+		rWarning() << "[shaders] Ignoring damaged material index " << filename
+			<< ": " << e.what() << std::endl;
+
+		_loaded.clear();
+	}
+}
+
+void MaterialIndex::save()
+{
+	// Entries of files which are gone need to be dropped too
+	if (_filename.empty() || (!_changed && _current.size() == _loaded.size()))
+	{
+		return;
+	}
+
+	std::ofstream file(_filename.c_str(), std::ios::trunc);
+
+	if (!file.is_open())
+	{
+		rError() << "[shaders] Could not write material index " << _filename << std::endl;
+		return;
+	}
+
+	file << HEADER << "\n";
+
+	for (FileEntries::const_iterator i = _current.begin(); i != _current.end(); ++i)
+	{
+		const FileEntry& entry = i->second;
+
+		file << FILE_TAG << "\t" << i->first << "\t" << entry.source << "\t"
+			<< entry.modified << "\t" << (entry.hasTables ? "1" : "0") << "\t"
+			<< entry.materials.size() << "\n";
+
+		for (std::vector<std::string>::const_iterator m = entry.materials.begin();
+			 m != entry.materials.end(); ++m)
+		{
+			file << *m << "\n";
+		}
+	}
+
+	_loaded = _current;
+	_changed = false;
+}
+
+const MaterialIndex::FileEntry* MaterialIndex::findEntry(const std::string& filename,
+	const std::string& source, FileTime modified)
+{
+	FileEntries::const_iterator found = _loaded.find(filename);
+
+	if (found == _loaded.end() || found->second.source != source ||
+		found->second.modified != modified || modified == c_invalidFileTime)
+	{
+		return NULL;
+	}
+
+	// Keep the entry on the next save
+	FileEntry& entry = _current[filename];
+	entry = found->second;
+
+	return &entry;
+}
+
+void MaterialIndex::setEntry(const std::string& filename, const FileEntry& entry)
+{
+	_current[filename] = entry;
+	_changed = true;
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include "os/file.h"
+
+namespace shaders
+{
+
+/**
+ * The material index remembers the names of the materials defined in each
+ * material file, so the files don't need to be read at startup. It is stored
+ * in the user's settings folder. The material blocks are read on demand, when
+ * a material is used for the first time.
+ *
+ * An entry is valid as long as the VFS file is provided by the same file on
+ * disk (the loose file or the pak containing it) with the same modification
+ * time.
+ */
+class MaterialIndex
+{
+public:
+	struct FileEntry
+	{
+		// The loose file or pak file the material file was read from
+		std::string source;
+		FileTime modified;
+
+		// Files defining tables are always parsed, the tables are needed
+		// by the materials of other files too
+		bool hasTables;
+
+		// The material names in order of definition
+		std::vector<std::string> materials;
+
+		FileEntry() :
+			modified(c_invalidFileTime),
+			hasTables(false)
+		{}
+	};
+
+private:
+	// The index file on disk
+	std::string _filename;
+
+	typedef std::map<std::string, FileEntry> FileEntries;
+
+	// The entries loaded from disk and the ones used during this session,
+	// only the latter are written back
+	FileEntries _loaded;
+	FileEntries _current;
+
+	bool _changed;
+
+public:
+	MaterialIndex();
+
+	// Reads the given index file, a missing or damaged file yields an empty index
+	void load(const std::string& filename);
+
+	// Writes the entries used since load() back to disk, if anything changed
+	void save();
+
+	// Returns the entry of the given VFS path, if it is up to date, or NULL
+	const FileEntry* findEntry(const std::string& filename, const std::string& source,
+							   FileTime modified);
+
+	// Stores the entry of a freshly parsed material file
+	void setEntry(const std::string& filename, const FileEntry& entry);
+};
+
+}
@@ -416,6 +416,12 @@ private:
 } // namespace expressions
 
 IShaderExpressionPtr ShaderExpression::createFromTokens(parser::DefTokeniser& tokeniser)
+{
+	return createFromTokens(tokeniser, rWarning());
+}
+
+IShaderExpressionPtr ShaderExpression::createFromTokens(parser::DefTokeniser& tokeniser,
+														std::ostream& warnings)
 {
 	// Create an adapter which takes care of splitting the tokens into finer grains
 	// The incoming DefTokeniser is not splitting up expressions like "3*4" without any whitespace in them
@@ -428,15 +434,21 @@ IShaderExpressionPtr ShaderExpression::createFromTokens(parser::DefTokeniser& to
 	}
 	catch (parser::ParseException& ex)
 	{
-		rWarning() << "[shaders] " << ex.what() << std::endl;
+		warnings << "[shaders] " << ex.what() << std::endl;
 		return IShaderExpressionPtr();
 	}
 }
 
 IShaderExpressionPtr ShaderExpression::createFromString(const std::string& exprStr)
+{
+	return createFromString(exprStr, rWarning());
+}
+
+IShaderExpressionPtr ShaderExpression::createFromString(const std::string& exprStr,
+														std::ostream& warnings)
 {
 	parser::BasicDefTokeniser<std::string> tokeniser(exprStr, parser::WHITESPACE, "{}(),");
-	return createFromTokens(tokeniser);
+	return createFromTokens(tokeniser, warnings);
 }
 
 } // namespace
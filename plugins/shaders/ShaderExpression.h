@@ -4,6 +4,7 @@
 #include "irender.h"
 #include "parser/DefTokeniser.h"
 #include "TableDefinition.h"
+#include "ExpressionProgram.h"
 
 namespace shaders
 {
@@ -64,9 +65,27 @@ public:
 		return _index;
 	}
 
+	// Appends the instructions calculating this expression to the given program,
+	// returns false if the expression cannot be compiled
+	virtual bool compile(ExpressionProgram& program, ExpressionProgram::Operand& result) const = 0;
+
+	// Compiles the given expression, which needs to be a ShaderExpression
+	static bool compileExpression(const IShaderExpressionPtr& expr, ExpressionProgram& program,
+								  ExpressionProgram::Operand& result)
+	{
+		const ShaderExpression* shaderExpr = dynamic_cast<const ShaderExpression*>(expr.get());
+
+		return shaderExpr != NULL && shaderExpr->compile(program, result);
+	}
+
 	static IShaderExpressionPtr createFromString(const std::string& exprStr);
 
 	static IShaderExpressionPtr createFromTokens(parser::DefTokeniser& tokeniser);
+
+	// Variants writing parse errors to the given stream instead of the log
+	static IShaderExpressionPtr createFromString(const std::string& exprStr, std::ostream& warnings);
+
+	static IShaderExpressionPtr createFromTokens(parser::DefTokeniser& tokeniser, std::ostream& warnings);
 };
 
 // Detail namespace
@@ -97,6 +116,12 @@ public:
 	{
 		return entity.getShaderParm(_parmNum);
 	}
+
+	virtual bool compile(ExpressionProgram& program, ExpressionProgram::Operand& result) const
+	{
+		result = program.addParm(_parmNum);
+		return true;
+	}
 };
 
 class GlobalShaderParmExpression :
@@ -121,6 +146,12 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual bool compile(ExpressionProgram& program, ExpressionProgram::Operand& result) const
+	{
+		result = program.addConstant(0.0f);
+		return true;
+	}
 };
 
 // An expression returning the current (game) time as result
@@ -141,6 +172,12 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual bool compile(ExpressionProgram& program, ExpressionProgram::Operand& result) const
+	{
+		result = program.addTime();
+		return true;
+	}
 };
 
 // An expression representing a constant floating point number
@@ -165,6 +202,12 @@ public:
 	{
 		return getValue(time);
 	}
+
+	virtual bool compile(ExpressionProgram& program, ExpressionProgram::Operand& result) const
+	{
+		result = program.addConstant(_value);
+		return true;
+	}
 };
 
 // An expression looking up a value in a table def
@@ -198,6 +241,19 @@ public:
 		float lookupVal = _lookupExpr->getValue(time, entity);
 		return _tableDef->getValue(lookupVal);
 	}
+
+	virtual bool compile(ExpressionProgram& program, ExpressionProgram::Operand& result) const
+	{
+		ExpressionProgram::Operand lookup;
+
+		if (!compileExpression(_lookupExpr, program, lookup))
+		{
+			return false;
+		}
+
+		result = program.addTableLookup(_tableDef, lookup);
+		return true;
+	}
 };
 
 // Abstract base class for an expression taking two sub-expression as arguments
@@ -225,14 +281,19 @@ protected:
 	IShaderExpressionPtr _b;
 	Precedence _precedence;
 
+	// The instruction performing this operation in compiled programs
+	ExpressionProgram::OpCode _opCode;
+
 public:
 	BinaryExpression(Precedence precedence,
+					 ExpressionProgram::OpCode opCode,
 					 const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 				     const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
 		ShaderExpression(),
 		_a(a),
 		_b(b),
-		_precedence(precedence)
+		_precedence(precedence),
+		_opCode(opCode)
 	{}
 
 	Precedence getPrecedence() const
@@ -249,6 +310,20 @@ public:
 	{
 		_b = b;
 	}
+
+	virtual bool compile(ExpressionProgram& program, ExpressionProgram::Operand& result) const
+	{
+		ExpressionProgram::Operand a;
+		ExpressionProgram::Operand b;
+
+		if (!compileExpression(_a, program, a) || !compileExpression(_b, program, b))
+		{
+			return false;
+		}
+
+		result = program.addOperation(_opCode, a, b);
+		return true;
+	}
 };
 typedef boost::shared_ptr<BinaryExpression> BinaryExpressionPtr;
 
@@ -259,7 +334,7 @@ class AddExpression :
 public:
 	AddExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 				  const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(ADDITION, a, b)
+		BinaryExpression(ADDITION, ExpressionProgram::OP_ADD, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -280,7 +355,7 @@ class SubtractExpression :
 public:
 	SubtractExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					   const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(SUBTRACTION, a, b)
+		BinaryExpression(SUBTRACTION, ExpressionProgram::OP_SUBTRACT, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -301,7 +376,7 @@ class MultiplyExpression :
 public:
 	MultiplyExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					   const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(MULTIPLICATION, a, b)
+		BinaryExpression(MULTIPLICATION, ExpressionProgram::OP_MULTIPLY, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -322,7 +397,7 @@ class DivideExpression :
 public:
 	DivideExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					 const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(DIVISION, a, b)
+		BinaryExpression(DIVISION, ExpressionProgram::OP_DIVIDE, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -343,7 +418,7 @@ class ModuloExpression :
 public:
 	ModuloExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					 const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(MODULO, a, b)
+		BinaryExpression(MODULO, ExpressionProgram::OP_MODULO, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -364,7 +439,7 @@ class LesserThanExpression :
 public:
 	LesserThanExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 						 const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(RELATIONAL_COMPARISON, a, b)
+		BinaryExpression(RELATIONAL_COMPARISON, ExpressionProgram::OP_LESSER, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -385,7 +460,7 @@ class LesserThanOrEqualExpression :
 public:
 	LesserThanOrEqualExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 								const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(RELATIONAL_COMPARISON, a, b)
+		BinaryExpression(RELATIONAL_COMPARISON, ExpressionProgram::OP_LESSER_OR_EQUAL, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -406,7 +481,7 @@ class GreaterThanExpression :
 public:
 	GreaterThanExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 						  const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(RELATIONAL_COMPARISON, a, b)
+		BinaryExpression(RELATIONAL_COMPARISON, ExpressionProgram::OP_GREATER, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -427,7 +502,7 @@ class GreaterThanOrEqualExpression :
 public:
 	GreaterThanOrEqualExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 								 const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(RELATIONAL_COMPARISON, a, b)
+		BinaryExpression(RELATIONAL_COMPARISON, ExpressionProgram::OP_GREATER_OR_EQUAL, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -448,7 +523,7 @@ class EqualityExpression :
 public:
 	EqualityExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					   const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(EQUALITY_COMPARISON, a, b)
+		BinaryExpression(EQUALITY_COMPARISON, ExpressionProgram::OP_EQUAL, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -469,7 +544,7 @@ class InequalityExpression :
 public:
 	InequalityExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					     const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(EQUALITY_COMPARISON, a, b)
+		BinaryExpression(EQUALITY_COMPARISON, ExpressionProgram::OP_NOT_EQUAL, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -490,7 +565,7 @@ class LogicalAndExpression :
 public:
 	LogicalAndExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					     const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(LOGICAL_AND, a, b)
+		BinaryExpression(LOGICAL_AND, ExpressionProgram::OP_AND, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -511,7 +586,7 @@ class LogicalOrExpression :
 public:
 	LogicalOrExpression(const IShaderExpressionPtr& a = IShaderExpressionPtr(), 
 					    const IShaderExpressionPtr& b = IShaderExpressionPtr()) :
-		BinaryExpression(LOGICAL_OR, a, b)
+		BinaryExpression(LOGICAL_OR, ExpressionProgram::OP_OR, a, b)
 	{}
 
 	virtual float getValue(std::size_t time)
@@ -16,11 +16,21 @@
 
 namespace shaders {
 
+namespace
+{
+	// Skins and particles are defined in material files too, they are parsed elsewhere
+	bool isForeignDecl(const std::string& blockName)
+	{
+		return blockName.substr(0, 5) == "skin " || blockName.substr(0, 9) == "particle ";
+	}
+}
+
 /* Parses through the shader file and processes the tokens delivered by
  * DefTokeniser.
  */
 void ShaderFileLoader::parseShaderFile(std::istream& inStr,
-									   const std::string& filename)
+									   const std::string& filename,
+									   MaterialIndex::FileEntry& entry)
 {
 	// Parse the file with a blocktokeniser, the actual block contents
 	// will be parsed separately.
@@ -44,7 +54,13 @@ void ShaderFileLoader::parseShaderFile(std::istream& inStr,
 
 			TableDefinitionPtr table(new TableDefinition(tableName, block.contents));
 
-			if (!GetShaderSystem()->addTableDefinition(table))
+			entry.hasTables = true;
+
+			if (_reload)
+			{
+				GetShaderSystem()->replaceTableDefinition(table);
+			}
+			else if (!GetShaderSystem()->addTableDefinition(table))
 			{
 				rError() << "[shaders] " << filename
 					<< ": table " << tableName << " already defined." << std::endl;
@@ -52,17 +68,15 @@ void ShaderFileLoader::parseShaderFile(std::istream& inStr,
 
 			continue;
 		}
-		else if (block.name.substr(0, 5) == "skin ")
-		{
-			continue; // skip skin definition
-		}
-		else if (block.name.substr(0, 9) == "particle ")
+		else if (isForeignDecl(block.name))
 		{
-			continue; // skip particle definition
+			continue; // skip skin and particle definitions
 		}
 
 		boost::algorithm::replace_all(block.name, "\\", "/"); // use forward slashes
 
+		entry.materials.push_back(block.name);
+
 		ShaderTemplatePtr shaderTemplate(new ShaderTemplate(block.name, block.contents));
 
 		// Construct the ShaderDefinition wrapper class
@@ -77,22 +91,100 @@ void ShaderFileLoader::parseShaderFile(std::istream& inStr,
 	}
 }
 
+void ShaderFileLoader::addDeferredDefinitions(const std::string& filename,
+											  const MaterialIndex::FileEntry& entry)
+{
+	for (std::vector<std::string>::const_iterator i = entry.materials.begin();
+		 i != entry.materials.end(); ++i)
+	{
+		ShaderTemplatePtr shaderTemplate(new ShaderTemplate(*i, ""));
+		shaderTemplate->setDeferredFile(filename);
+
+		if (!GetShaderLibrary().addDefinition(*i, ShaderDefinition(shaderTemplate, filename)))
+		{
+			rError() << "[shaders] " << filename
+				<< ": shader " << *i << " already defined." << std::endl;
+		}
+	}
+}
+
 void ShaderFileLoader::visit(const std::string& filename)
 {
 	// Construct the full VFS path
 	std::string fullPath = _basePath + filename;
 
+	MaterialIndex::FileEntry entry;
+
+	if (_index != NULL)
+	{
+		// The index entries are keyed by the file on disk providing the material file
+		entry.source = GlobalFileSystem().findPhysicalFile(fullPath);
+		entry.modified = file_modified(entry.source.c_str());
+
+		const MaterialIndex::FileEntry* indexed = _index->findEntry(fullPath, entry.source, entry.modified);
+
+		if (!_reload && indexed != NULL && !indexed->hasTables)
+		{
+			addDeferredDefinitions(fullPath, *indexed);
+			return;
+		}
+	}
+
 	// Open the file
 	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(fullPath);
 
 	if (file != NULL) {
 		std::istream is(&(file->getInputStream()));
-		parseShaderFile(is, fullPath);
+		parseShaderFile(is, fullPath, entry);
 	}
 	else
 	{
 		throw std::runtime_error("Unable to read shaderfile: " + fullPath);
 	}
+
+	if (_index != NULL && entry.modified != c_invalidFileTime)
+	{
+		_index->setEntry(fullPath, entry);
+	}
+}
+
+void ShaderFileLoader::loadDeferredBlocks(const std::string& filename)
+{
+	ArchiveTextFilePtr file = GlobalFileSystem().openTextFile(filename);
+
+	if (file == NULL)
+	{
+		rError() << "[shaders] Unable to read shaderfile: " << filename << std::endl;
+		return;
+	}
+
+	std::istream is(&(file->getInputStream()));
+	parser::BasicDefBlockTokeniser<std::istream> tokeniser(is);
+
+	while (tokeniser.hasMoreBlocks())
+	{
+		parser::BlockTokeniser::Block block = tokeniser.nextBlock();
+
+		if (block.name.substr(0, 5) == "table" || isForeignDecl(block.name))
+		{
+			continue;
+		}
+
+		boost::algorithm::replace_all(block.name, "\\", "/"); // use forward slashes
+
+		if (!GetShaderLibrary().definitionExists(block.name))
+		{
+			continue;
+		}
+
+		ShaderDefinition& def = GetShaderLibrary().getDefinition(block.name);
+
+		// Only the first definition in this file has been added to the library
+		if (def.filename == filename && def.shaderTemplate->isDeferred())
+		{
+			def.shaderTemplate->setBlockContents(block.contents);
+		}
+	}
 }
 
 } // namespace shaders
@@ -2,6 +2,7 @@
 
 #include "ifilesystem.h"
 #include "ShaderTemplate.h"
+#include "MaterialIndex.h"
 
 #include "parser/DefTokeniser.h"
 
@@ -20,19 +21,40 @@ private:
 	// The base path for the shaders (e.g. "materials/")
 	std::string _basePath;
 
+	// True if a single file is parsed again, its tables replace the existing ones
+	bool _reload;
+
+	// The index of the material names in each file (optional)
+	MaterialIndex* _index;
+
 private:
 
-	// Parse a shader file with the given contents and filename
-	void parseShaderFile(std::istream& inStr, const std::string& filename);
+	// Parse a shader file with the given contents and filename, the names
+	// of the materials are added to the given index entry
+	void parseShaderFile(std::istream& inStr, const std::string& filename,
+						 MaterialIndex::FileEntry& entry);
+
+	// Adds the materials listed in the index entry, without reading the file
+	void addDeferredDefinitions(const std::string& filename,
+								const MaterialIndex::FileEntry& entry);
 
 public:
 	// Constructor. Set the basepath to prepend onto shader filenames.
-	ShaderFileLoader(const std::string& path)
-	: _basePath(path)
+	// Files whose index entry is up to date are not read, the index entries
+	// of the parsed files are updated.
+	ShaderFileLoader(const std::string& path, bool reload = false,
+					 MaterialIndex* index = NULL)
+	: _basePath(path),
+	  _reload(reload),
+	  _index(index)
 	{}
 
 	// FileVisitor implementation
 	void visit(const std::string& filename);
+
+	// Reads the block contents of the deferred templates defined in the
+	// given material file (full VFS path)
+	static void loadDeferredBlocks(const std::string& filename);
 };
 
 }
@@ -3,13 +3,46 @@
 #include <iostream>
 #include <utility>
 #include "itextstream.h"
+#include "iradiant.h"
+#include "ithread.h"
 #include "ShaderTemplate.h"
 #include "Doom3ShaderSystem.h"
 #include "textures/ImageFileLoader.h"
 #include "parser/DefTokeniser.h"
 
+#include <sstream>
+#include <algorithm>
+#include <boost/bind.hpp>
+
 namespace shaders {
 
+namespace
+{
+	typedef std::vector<ShaderTemplatePtr> ShaderTemplates;
+
+	// The number of shaders released between two checks of the texture memory
+	const std::size_t RELEASE_BATCH_SIZE = 16;
+
+	// Sorts shaders by their last texture use, oldest first
+	bool isUsedEarlier(const CShaderPtr& a, const CShaderPtr& b)
+	{
+		return a->getLastUsed() < b->getLastUsed();
+	}
+
+	// Parses the templates in the given range, collecting the warnings of
+	// each one, the log must not be written to from the worker threads
+	void parseTemplates(const ShaderTemplates& templates, std::vector<std::string>& warnings,
+						std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; ++i)
+		{
+			std::ostringstream log;
+			templates[i]->parseWithLog(log);
+			warnings[i] = log.str();
+		}
+	}
+}
+
 // Insert into the definitions map, if not already present
 bool ShaderLibrary::addDefinition(const std::string& name,
 								  const ShaderDefinition& def)
@@ -109,6 +142,131 @@ void ShaderLibrary::clear() {
 	_definitions.clear();
 }
 
+void ShaderLibrary::removeDefinitions(const std::string& filename, StringSet& names)
+{
+	for (ShaderDefinitionMap::iterator i = _definitions.begin(); i != _definitions.end(); /* in-loop increment */)
+	{
+		if (i->second.filename == filename)
+		{
+			names.insert(i->first);
+			_definitions.erase(i++);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void ShaderLibrary::getDefinitionNames(const std::string& filename, StringSet& names) const
+{
+	for (ShaderDefinitionMap::const_iterator i = _definitions.begin(); i != _definitions.end(); ++i)
+	{
+		if (i->second.filename == filename)
+		{
+			names.insert(i->first);
+		}
+	}
+}
+
+void ShaderLibrary::updateShaders(const StringSet& names, StringSet& updatedShaders)
+{
+	for (StringSet::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		ShaderMap::iterator found = _shaders.find(*i);
+
+		if (found == _shaders.end()) continue;
+
+		// Removed definitions are replaced by the usual fallbacks
+		found->second->setDefinition(getDefinition(*i));
+
+		updatedShaders.insert(found->first);
+	}
+}
+
+void ShaderLibrary::releaseTextures(const StringSet& imageNames, StringSet& affectedShaders)
+{
+	for (ShaderMap::const_iterator i = _shaders.begin(); i != _shaders.end(); ++i)
+	{
+		if (i->second->usesImages(imageNames))
+		{
+			i->second->releaseTextures();
+			affectedShaders.insert(i->first);
+		}
+	}
+}
+
+void ShaderLibrary::parseDefinitions(const StringSet& names)
+{
+	ShaderTemplates templates;
+
+	for (StringSet::const_iterator i = names.begin(); i != names.end(); ++i)
+	{
+		ShaderDefinitionMap::const_iterator found = _definitions.find(*i);
+
+		// Unknown materials are taken care of once they are requested
+		if (found == _definitions.end() || found->second.shaderTemplate->isParsed())
+		{
+			continue;
+		}
+
+		// Deferred blocks are read from the VFS, this needs to happen here
+		found->second.shaderTemplate->getBlockContents();
+
+		templates.push_back(found->second.shaderTemplate);
+	}
+
+	if (templates.empty()) return;
+
+	std::vector<std::string> warnings(templates.size());
+
+	try
+	{
+		GlobalRadiant().getThreadManager().executeInChunks(templates.size(),
+			boost::bind(&parseTemplates, boost::cref(templates), boost::ref(warnings), _1, _2));
+	}
+	catch (std::runtime_error& e)
+	{
+		rError() << "[shaders] Error while parsing materials: " << e.what() << std::endl;
+	}
+
+	for (std::vector<std::string>::const_iterator i = warnings.begin(); i != warnings.end(); ++i)
+	{
+		rWarning() << *i;
+	}
+}
+
+std::size_t ShaderLibrary::releaseUnusedTextures(std::size_t targetBytes)
+{
+	std::vector<CShaderPtr> candidates;
+
+	for (ShaderMap::const_iterator i = _shaders.begin(); i != _shaders.end(); ++i)
+	{
+		if (i->second.unique() && !i->second->IsInUse() && i->second->getLastUsed() > 0)
+		{
+			candidates.push_back(i->second);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), isUsedEarlier);
+
+	GLTextureManager& textureManager = GetTextureManager();
+	std::vector<CShaderPtr>::const_iterator next = candidates.begin();
+
+	while (next != candidates.end() && textureManager.getResidentBytes() > targetBytes)
+	{
+		for (std::size_t n = 0; n < RELEASE_BATCH_SIZE && next != candidates.end(); ++n, ++next)
+		{
+			(*next)->releaseTextures();
+		}
+
+		// Textures shared with other shaders stay loaded
+		textureManager.checkBindings();
+	}
+
+	return next - candidates.begin();
+}
+
 std::size_t ShaderLibrary::getNumShaders() {
 	return _definitions.size();
 }
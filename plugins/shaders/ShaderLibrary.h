@@ -37,6 +37,40 @@ public:
 	 */
 	void clear();
 
+	/* Removes the definitions parsed from the given file (VFS path) and
+	 * adds their names to the given set.
+	 */
+	void removeDefinitions(const std::string& filename, StringSet& names);
+
+	/* Adds the names of the definitions parsed from the given file to the given set.
+	 */
+	void getDefinitionNames(const std::string& filename, StringSet& names) const;
+
+	/* Switches the active shaders with the given names to their current
+	 * definitions, after these have been re-parsed. The names of the updated
+	 * shaders are added to the second set.
+	 */
+	void updateShaders(const StringSet& names, StringSet& updatedShaders);
+
+	/* Releases the textures of the active shaders using one of the given
+	 * images (VFS paths without extension). The names of the affected
+	 * shaders are added to the second set.
+	 */
+	void releaseTextures(const StringSet& imageNames, StringSet& affectedShaders);
+
+	/* Releases the textures of the least recently used shaders until the
+	 * texture manager holds no more than the given amount of memory. Only
+	 * shaders nobody else refers to are considered, the renderer might hold
+	 * on to the GL texture numbers otherwise. Returns the number of shaders
+	 * whose textures have been released.
+	 */
+	std::size_t releaseUnusedTextures(std::size_t targetBytes);
+
+	/* Parses the definitions with the given names which haven't been
+	 * parsed yet, using the worker threads.
+	 */
+	void parseDefinitions(const StringSet& names);
+
 	// Get the number of known shaders
 	std::size_t getNumShaders();
 
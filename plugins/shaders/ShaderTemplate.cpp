@@ -14,6 +14,7 @@
 #include <iostream>
 
 #include "ShaderExpression.h"
+#include "ShaderFileLoader.h"
 
 namespace shaders
 {
@@ -50,12 +51,12 @@ IShaderExpressionPtr ShaderTemplate::parseSingleExpressionTerm(parser::DefTokeni
 			}
 		}
 
-		return ShaderExpression::createFromString(expr);
+		return ShaderExpression::createFromString(expr, warningStream());
 	}
 	else
 	{
 		// No parenthesis, parse this token alone
-		return ShaderExpression::createFromString(token);
+		return ShaderExpression::createFromString(token, warningStream());
 	}
 }
 
@@ -368,7 +369,7 @@ bool ShaderTemplate::parseLightKeywords(parser::DefTokeniser& tokeniser, const s
 		}
 		catch (boost::bad_lexical_cast& e)
 		{
-			rWarning() << "Expect integer number as spectrum value, found " << 
+			warningStream() << "Expect integer number as spectrum value, found " << 
 				value << ": " << e.what() << std::endl;
 		}
 	}
@@ -539,7 +540,7 @@ bool ShaderTemplate::parseBlendMaps(parser::DefTokeniser& tokeniser, const std::
 		}
 		catch (boost::bad_lexical_cast& e)
 		{
-			rWarning() << "Error parsing remoteRenderMap. Expected two integers: " 
+			warningStream() << "Error parsing remoteRenderMap. Expected two integers: " 
 				<< e.what() << std::endl;
 		}
 	}
@@ -552,7 +553,7 @@ bool ShaderTemplate::parseBlendMaps(parser::DefTokeniser& tokeniser, const std::
 		}
 		catch (boost::bad_lexical_cast& e)
 		{
-			rWarning() << "Error parsing mirrorRenderMap. Expected two integers: "
+			warningStream() << "Error parsing mirrorRenderMap. Expected two integers: "
 				<< e.what() << std::endl;
 		}
 	}
@@ -581,7 +582,7 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
     }
 	else if (token == "red")
 	{
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		
 		if (expr)
 		{
@@ -589,12 +590,12 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse red expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse red expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "green")
 	{
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (expr)
 		{
@@ -602,12 +603,12 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse green expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse green expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "blue")
 	{
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		
 		if (expr)
 		{
@@ -615,12 +616,12 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse blue expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse blue expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "alpha")
 	{
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		
 		if (expr)
 		{
@@ -628,19 +629,19 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse alpha expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse alpha expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "color")
 	{
 		// color <exp0>, <exp1>, <exp2>, <exp3>
-		IShaderExpressionPtr red = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr red = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		tokeniser.assertNextToken(",");
-		IShaderExpressionPtr green = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr green = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		tokeniser.assertNextToken(",");
-		IShaderExpressionPtr blue = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr blue = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		tokeniser.assertNextToken(",");
-		IShaderExpressionPtr alpha = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr alpha = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (red && green && blue && alpha)
 		{
@@ -651,13 +652,13 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse color expressions in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse color expressions in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "rgb")
 	{
 		// Get the colour value
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (expr)
 		{
@@ -665,12 +666,12 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse rgb expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse rgb expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "rgba")
 	{
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (expr)
 		{
@@ -678,7 +679,7 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse rgba expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse rgba expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "fragmentprogram")
@@ -700,25 +701,25 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		// vertexParm		<parmNum>		<parm1> [,<parm2>] [,<parm3>] [,<parm4>]
 		int parmNum = string::convert<int>(tokeniser.nextToken());
 
-		IShaderExpressionPtr parm0 = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr parm0 = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (tokeniser.peek() == ",")
 		{
 			tokeniser.nextToken();
 
-			IShaderExpressionPtr parm1 = ShaderExpression::createFromTokens(tokeniser);
+			IShaderExpressionPtr parm1 = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 			if (tokeniser.peek() == ",")
 			{
 				tokeniser.nextToken();
 
-				IShaderExpressionPtr parm2 = ShaderExpression::createFromTokens(tokeniser);
+				IShaderExpressionPtr parm2 = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 				if (tokeniser.peek() == ",")
 				{
 					tokeniser.nextToken();
 
-					IShaderExpressionPtr parm3 = ShaderExpression::createFromTokens(tokeniser);
+					IShaderExpressionPtr parm3 = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 					// All 4 layers specified
 					_currentLayer->setVertexParm(parmNum, parm0, parm1, parm2, parm3);
@@ -767,7 +768,7 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
     else if (token == "alphatest")
     {
 		// Get the alphatest expression
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		   
 		if (expr)
 		{
@@ -775,16 +776,16 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse alphatest expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse alphatest expression in shader: " << getName() << std::endl;
 		}
 
 		_coverage = Material::MC_PERFORATED;
     }
 	else if (token == "scale")
 	{
-		IShaderExpressionPtr xScaleExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr xScaleExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		tokeniser.assertNextToken(",");
-		IShaderExpressionPtr yScaleExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr yScaleExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (xScaleExpr && yScaleExpr)
 		{
@@ -792,14 +793,14 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse scale expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse scale expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "centerscale")
 	{
-		IShaderExpressionPtr xScaleExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr xScaleExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		tokeniser.assertNextToken(",");
-		IShaderExpressionPtr yScaleExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr yScaleExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (xScaleExpr && yScaleExpr)
 		{
@@ -808,14 +809,14 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse centerScale expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse centerScale expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "translate" || token == "scroll")
 	{
-		IShaderExpressionPtr xTranslateExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr xTranslateExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		tokeniser.assertNextToken(",");
-		IShaderExpressionPtr yTranslateExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr yTranslateExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (xTranslateExpr && yTranslateExpr)
 		{
@@ -823,14 +824,14 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse " << token << " expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse " << token << " expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "shear")
 	{
-		IShaderExpressionPtr xShearExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr xShearExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		tokeniser.assertNextToken(",");
-		IShaderExpressionPtr yShearExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr yShearExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (xShearExpr && yShearExpr)
 		{
@@ -838,12 +839,12 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse " << token << " expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse " << token << " expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "rotate")
 	{
-		IShaderExpressionPtr rotExpr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr rotExpr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 
 		if (rotExpr)
 		{
@@ -851,7 +852,7 @@ bool ShaderTemplate::parseStageModifiers(parser::DefTokeniser& tokeniser,
 		}
 		else
 		{
-			rWarning() << "Could not parse " << token << " expression in shader: " << getName() << std::endl;
+			warningStream() << "Could not parse " << token << " expression in shader: " << getName() << std::endl;
 		}
 	}
 	else if (token == "ignorealphatest")
@@ -1113,7 +1114,7 @@ bool ShaderTemplate::parseCondition(parser::DefTokeniser& tokeniser, const std::
 	if (token == "if")
 	{
 		// Parse condition
-		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser);
+		IShaderExpressionPtr expr = ShaderExpression::createFromTokens(tokeniser, warningStream());
 		
 		_currentLayer->setCondition(expr);
 
@@ -1146,6 +1147,11 @@ bool ShaderTemplate::saveLayer()
  */
 void ShaderTemplate::parseDefinition()
 {
+    if (isDeferred())
+    {
+        loadBlockContents();
+    }
+
     // Construct a local deftokeniser to parse the unparsed block
     parser::BasicDefTokeniser<std::string> tokeniser(
         _blockContents,
@@ -1186,7 +1192,7 @@ void ShaderTemplate::parseDefinition()
                         if (parseBlendShortcuts(tokeniser, token)) continue;
 						if (parseSurfaceFlags(tokeniser, token)) continue;
 
-						rWarning() << "Material keyword not recognised: " << token << std::endl;
+						warningStream() << "Material keyword not recognised: " << token << std::endl;
 
                         break;
                     case 2: // stage level
@@ -1195,7 +1201,7 @@ void ShaderTemplate::parseDefinition()
                         if (parseBlendMaps(tokeniser, token)) continue;
                         if (parseStageModifiers(tokeniser, token)) continue;
 
-						rWarning() << "Stage keyword not recognised: " << token << std::endl;
+						warningStream() << "Stage keyword not recognised: " << token << std::endl;
 
                         break;
                 }
@@ -1204,7 +1210,7 @@ void ShaderTemplate::parseDefinition()
     }
     catch (parser::ParseException& p)
 	{
-        rError() << "Error while parsing shader " << _name << ": "
+        errorStream() << "Error while parsing shader " << _name << ": "
             << p.what() << std::endl;
     }
 
@@ -1302,6 +1308,29 @@ void ShaderTemplate::addLayer(ShaderLayer::Type type, const MapExpressionPtr& ma
 	addLayer(Doom3ShaderLayerPtr(new Doom3ShaderLayer(*this, type, mapExpr)));
 }
 
+void ShaderTemplate::loadBlockContents()
+{
+    ShaderFileLoader::loadDeferredBlocks(_deferredFile);
+
+    if (isDeferred())
+    {
+        // The file has changed in a way the watcher didn't notice
+        rWarning() << "[shaders] Cannot find the definition of " << _name
+            << " in " << _deferredFile << std::endl;
+
+        _deferredFile.clear();
+    }
+}
+
+void ShaderTemplate::parseWithLog(std::ostream& log)
+{
+    _log = &log;
+
+    parseDefinition();
+
+    _log = NULL;
+}
+
 bool ShaderTemplate::hasDiffusemap()
 {
 	if (!_parsed) parseDefinition();
@@ -4,6 +4,7 @@
 #include "Doom3ShaderLayer.h"
 
 #include "ishaders.h"
+#include "itextstream.h"
 #include "parser/DefTokeniser.h"
 #include "math/Vector3.h"
 
@@ -86,9 +87,16 @@ private:
 	// Raw material declaration
 	std::string _blockContents;
 
+	// The material file (VFS path) to read the declaration from on demand,
+	// empty if the block contents have been passed in
+	std::string _deferredFile;
+
 	// Whether the block has been parsed
 	bool _parsed;
 
+	// Receives the parse warnings instead of the log, if set
+	std::ostream* _log;
+
 public:
 
     /**
@@ -112,7 +120,8 @@ public:
       _polygonOffset(0.0f),
 	  _coverage(Material::MC_UNDETERMINED),
 	  _blockContents(blockContents),
-	  _parsed(false)
+	  _parsed(false),
+	  _log(NULL)
 	{
 		_decalInfo.stayMilliSeconds = 0;
 		_decalInfo.fadeMilliSeconds = 0;
@@ -236,13 +245,40 @@ public:
 	void setBlockContents(const std::string& blockContents)
 	{
 		_blockContents = blockContents;
+		_deferredFile.clear();
+	}
+
+	// Defers reading the block contents until they are needed, they are
+	// read from the given material file together with the other deferred
+	// templates of that file.
+	void setDeferredFile(const std::string& filename)
+	{
+		_deferredFile = filename;
 	}
 
-	const std::string& getBlockContents() const
+	bool isDeferred() const
 	{
+		return !_deferredFile.empty();
+	}
+
+	const std::string& getBlockContents()
+	{
+		if (isDeferred()) loadBlockContents();
 		return _blockContents;
 	}
 
+	bool isParsed() const
+	{
+		return _parsed;
+	}
+
+	/**
+	 * Parses the definition right away, writing any warnings to the given
+	 * stream instead of the log. This may be called on a worker thread, as
+	 * long as the block contents have been read (see getBlockContents()).
+	 */
+	void parseWithLog(std::ostream& log);
+
     /**
      * \brief
      * Return the named bindable corresponding to the editor preview texture
@@ -267,6 +303,9 @@ private:
 	// Add the given layer and assigns editor preview layer if applicable
 	void addLayer(const Doom3ShaderLayerPtr& layer);
 
+	// Reads the deferred block contents from the material file
+	void loadBlockContents();
+
 	/**
 	 * Parse a Doom 3 material decl. This is the master parse function, it
 	 * returns no value but exceptions may be thrown at any stage of the
@@ -274,6 +313,17 @@ private:
 	 */
 	void parseDefinition();
 
+	// The streams the parse warnings and errors are written to
+	std::ostream& warningStream()
+	{
+		return _log != NULL ? *_log : rWarning();
+	}
+
+	std::ostream& errorStream()
+	{
+		return _log != NULL ? *_log : rError();
+	}
+
     // Parse helpers. These scan for possible matches, this is not a
     // recursive-descent parser. Each of these helpers return true 
 	// if the token was recognised and parsed
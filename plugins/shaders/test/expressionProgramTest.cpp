@@ -0,0 +1,209 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE expressionProgramTest
+#include <boost/test/unit_test.hpp>
+
+#include "../ShaderExpression.h"
+
+using namespace shaders;
+using namespace shaders::expressions;
+
+namespace
+{
+    const float EPSILON = 0.00001f;
+
+    const std::size_t TIMES[] = { 0, 16, 250, 1000, 1337, 59999, 3600000 };
+    const std::size_t NUM_TIMES = sizeof(TIMES) / sizeof(TIMES[0]);
+
+    class TestEntity :
+        public IRenderEntity
+    {
+        float _parms[12];
+        Vector3 _direction;
+        ShaderPtr _wireShader;
+
+    public:
+        TestEntity(float offset)
+        {
+            for (int i = 0; i < 12; ++i)
+            {
+                _parms[i] = offset + i * 0.75f;
+            }
+        }
+
+        float getShaderParm(int parmNum) const
+        {
+            return _parms[parmNum];
+        }
+
+        const Vector3& getDirection() const
+        {
+            return _direction;
+        }
+
+        const ShaderPtr& getWireShader() const
+        {
+            return _wireShader;
+        }
+    };
+
+    IShaderExpressionPtr constant(float value)
+    {
+        return IShaderExpressionPtr(new ConstantExpression(value));
+    }
+
+    IShaderExpressionPtr time()
+    {
+        return IShaderExpressionPtr(new TimeExpression);
+    }
+
+    IShaderExpressionPtr parm(int parmNum)
+    {
+        return IShaderExpressionPtr(new ShaderParmExpression(parmNum));
+    }
+
+    IShaderExpressionPtr table(const std::string& contents, const IShaderExpressionPtr& lookup)
+    {
+        TableDefinitionPtr tableDef(new TableDefinition("testTable", contents));
+        return IShaderExpressionPtr(new TableLookupExpression(tableDef, lookup));
+    }
+
+    // Compiles the expression into a program writing register 0
+    void compile(const IShaderExpressionPtr& expr, ExpressionProgram& program)
+    {
+        ExpressionProgram::Operand result;
+
+        BOOST_REQUIRE(ShaderExpression::compileExpression(expr, program, result));
+
+        program.addOutput(result, 0);
+    }
+
+    // Checks the compiled program against the interpreted expression at
+    // all test times, with and without entity
+    void checkProgram(const IShaderExpressionPtr& expr)
+    {
+        ExpressionProgram program;
+        compile(expr, program);
+
+        Registers registers(1);
+        TestEntity first(0.5f);
+        TestEntity second(-3.25f);
+
+        for (std::size_t i = 0; i < NUM_TIMES; ++i)
+        {
+            std::size_t time = TIMES[i];
+
+            program.execute(registers, time, NULL);
+            BOOST_CHECK_SMALL(registers[0] - expr->getValue(time), EPSILON);
+
+            program.execute(registers, time, &first);
+            BOOST_CHECK_SMALL(registers[0] - expr->getValue(time, first), EPSILON);
+
+            program.execute(registers, time, &second);
+            BOOST_CHECK_SMALL(registers[0] - expr->getValue(time, second), EPSILON);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(foldConstants)
+{
+    // (2 + 3) * 4 - 10 / 4
+    checkProgram(IShaderExpressionPtr(new SubtractExpression(
+        IShaderExpressionPtr(new MultiplyExpression(
+            IShaderExpressionPtr(new AddExpression(constant(2), constant(3))),
+            constant(4))),
+        IShaderExpressionPtr(new DivideExpression(constant(10), constant(4)))
+    )));
+
+    checkProgram(IShaderExpressionPtr(new LogicalOrExpression(
+        IShaderExpressionPtr(new LesserThanExpression(constant(1), constant(0))),
+        IShaderExpressionPtr(new InequalityExpression(constant(2), constant(3)))
+    )));
+}
+
+BOOST_AUTO_TEST_CASE(foldConstantTableLookups)
+{
+    checkProgram(table("{ 0, 1, 0, -1 }", constant(0.25f)));
+    checkProgram(table("{ 0, 1, 0, -1 }", constant(0.6f)));
+    checkProgram(table("snap { 0, 1, 2, 3 }", constant(0.4f)));
+    checkProgram(table("clamp { 0, 1 }", constant(1.5f)));
+
+    // Nested lookups of constants are folded as well
+    checkProgram(table("{ 0, 0.5, 1 }", table("{ 0.25, 0.75 }", constant(0.75f))));
+}
+
+BOOST_AUTO_TEST_CASE(timeDependentTableLookups)
+{
+    // The usual way of animating with tables: table[time * speed]
+    IShaderExpressionPtr scaledTime(new MultiplyExpression(time(), constant(0.3f)));
+
+    checkProgram(table("{ 0, 1, 0, -1 }", scaledTime));
+    checkProgram(table("snap { 0, 1, 2, 3 }", scaledTime));
+    checkProgram(table("clamp { 0, 0.5, 1 }", scaledTime));
+    checkProgram(table("{ 0.5 }", scaledTime));
+    checkProgram(table("{ }", scaledTime));
+}
+
+BOOST_AUTO_TEST_CASE(timeDependentParms)
+{
+    // parm0 * time + parm3 % 2
+    checkProgram(IShaderExpressionPtr(new AddExpression(
+        IShaderExpressionPtr(new MultiplyExpression(parm(0), time())),
+        IShaderExpressionPtr(new ModuloExpression(parm(3), constant(2)))
+    )));
+
+    // table[time * parm4 + parm5], the lookup depends on both
+    checkProgram(table("{ 0, 1, 0, -1 }", IShaderExpressionPtr(new AddExpression(
+        IShaderExpressionPtr(new MultiplyExpression(time(), parm(4))),
+        parm(5)
+    ))));
+
+    // (time > parm2) && (parm1 >= 1)
+    checkProgram(IShaderExpressionPtr(new LogicalAndExpression(
+        IShaderExpressionPtr(new GreaterThanExpression(time(), parm(2))),
+        IShaderExpressionPtr(new GreaterThanOrEqualExpression(parm(1), constant(1)))
+    )));
+}
+
+BOOST_AUTO_TEST_CASE(skipRunsWithoutParmsAtSameTime)
+{
+    ExpressionProgram program;
+    compile(table("{ 0, 1 }", IShaderExpressionPtr(new MultiplyExpression(time(), constant(0.5f)))),
+            program);
+
+    Registers registers(1);
+
+    program.execute(registers, 500, NULL);
+    BOOST_CHECK_SMALL(registers[0] - 0.5f, EPSILON);
+
+    // The results don't change at the same time, the run is skipped
+    registers[0] = 42;
+    program.execute(registers, 500, NULL);
+    BOOST_CHECK_EQUAL(registers[0], 42);
+
+    program.invalidate();
+    program.execute(registers, 500, NULL);
+    BOOST_CHECK_SMALL(registers[0] - 0.5f, EPSILON);
+
+    registers[0] = 42;
+    program.execute(registers, 1000, NULL);
+    BOOST_CHECK_SMALL(registers[0] - 1.0f, EPSILON);
+}
+
+BOOST_AUTO_TEST_CASE(runProgramsWithParmsForEachEntity)
+{
+    ExpressionProgram program;
+    compile(parm(0), program);
+
+    Registers registers(1);
+    TestEntity first(0.5f);
+    TestEntity second(-3.25f);
+
+    program.execute(registers, 500, &first);
+    BOOST_CHECK_EQUAL(registers[0], 0.5f);
+
+    program.execute(registers, 500, &second);
+    BOOST_CHECK_EQUAL(registers[0], -3.25f);
+
+    program.execute(registers, 500, NULL);
+    BOOST_CHECK_EQUAL(registers[0], 0.0f);
+}
@@ -9,14 +9,54 @@
 #include "TextureManipulator.h"
 #include "parser/DefTokeniser.h"
 
+#include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
+#include <vector>
+
 namespace {
     const int MAX_TEXTURE_QUALITY = 3;
 
     const std::string SHADER_NOT_FOUND = "notex.bmp";
+
+    // The number of textures listed by printStats()
+    const std::size_t NUM_LARGEST_TEXTURES = 10;
+
+    // Estimates the video memory of the given texture, RGBA plus a third
+    // for the mipmaps. Textures without size (cube maps) are not counted.
+    std::size_t getTextureBytes(const TexturePtr& texture)
+    {
+        return texture->getWidth() * texture->getHeight() * 4 * 4 / 3;
+    }
+
+    typedef std::pair<std::size_t, std::string> SizeAndName;
 }
 
 namespace shaders {
 
+GLTextureManager::GLTextureManager() :
+    _residentBytes(0),
+    _memoryBudget(0),
+    _useCounter(0)
+{}
+
+void GLTextureManager::insertTexture(const std::string& identifier, const TexturePtr& texture)
+{
+    TextureEntry& entry = _textures[identifier];
+
+    _residentBytes -= entry.bytes;
+
+    entry.texture = texture;
+    entry.bytes = getTextureBytes(texture);
+
+    _residentBytes += entry.bytes;
+}
+
+void GLTextureManager::eraseTexture(TextureMap::iterator i)
+{
+    _residentBytes -= i->second.bytes;
+    _textures.erase(i);
+}
+
 void GLTextureManager::checkBindings() {
     // Check the TextureMap for unique pointers and release them
     // as they aren't used by anyone else than this class.
@@ -25,10 +65,31 @@ void GLTextureManager::checkBindings() {
          /* in-loop increment */)
     {
         // If the boost::shared_ptr is unique (i.e. refcount==1), remove it
-        if (i->second.unique()) {
+        if (i->second.texture.unique()) {
             // Be sure to increment the iterator with a postfix ++,
             // so that the iterator is incremented right before deletion
-            _textures.erase(i++);
+            eraseTexture(i++);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+void GLTextureManager::removeBindings(const StringSet& imageNames)
+{
+    for (TextureMap::iterator i = _textures.begin(); i != _textures.end(); /* in-loop increment */)
+    {
+        // Identifiers of generated textures are containing the source image names
+        bool found = false;
+
+        for (StringSet::const_iterator name = imageNames.begin(); name != imageNames.end() && !found; ++name)
+        {
+            found = boost::algorithm::icontains(i->first, *name);
+        }
+
+        if (found) {
+            eraseTexture(i++);
         }
         else {
             ++i;
@@ -51,7 +112,7 @@ TexturePtr GLTextureManager::getBinding(NamedBindablePtr bindable)
     if (i != _textures.end())
     {
         // Found, return
-        return i->second;
+        return i->second.texture;
     }
     else
     {
@@ -59,7 +120,7 @@ TexturePtr GLTextureManager::getBinding(NamedBindablePtr bindable)
         TexturePtr texture = bindable->bindTexture(identifier);
         if (texture)
         {
-            _textures.insert(TextureMap::value_type(identifier, texture));
+            insertTexture(identifier, texture);
             return texture;
         }
         else
@@ -86,7 +147,7 @@ TexturePtr GLTextureManager::getBinding(const std::string& fullPath,
         {
             // Constructor returned a valid image, now create the texture object
             TexturePtr texture = img->bindTexture(fullPath);
-            _textures[fullPath] = texture;
+            insertTexture(fullPath, texture);
         }
         else
         {
@@ -98,7 +159,39 @@ TexturePtr GLTextureManager::getBinding(const std::string& fullPath,
     }
 
     // Cast should succeed since all single image textures will be Texture2D
-    return _textures[fullPath];
+    return _textures[fullPath].texture;
+}
+
+void GLTextureManager::printStats() const
+{
+    std::vector<SizeAndName> sizes;
+    sizes.reserve(_textures.size());
+
+    for (TextureMap::const_iterator i = _textures.begin(); i != _textures.end(); ++i)
+    {
+        sizes.push_back(SizeAndName(i->second.bytes, i->first));
+    }
+
+    std::size_t numListed = std::min(sizes.size(), NUM_LARGEST_TEXTURES);
+    std::partial_sort(sizes.begin(), sizes.begin() + numListed, sizes.end(),
+                      std::greater<SizeAndName>());
+
+    rMessage() << "Texture statistics: " << _textures.size() << " textures, "
+        << (_residentBytes / (1024 * 1024)) << " MB (estimated), budget: ";
+
+    if (_memoryBudget > 0)
+    {
+        rMessage() << (_memoryBudget / (1024 * 1024)) << " MB" << std::endl;
+    }
+    else
+    {
+        rMessage() << "unlimited" << std::endl;
+    }
+
+    for (std::size_t i = 0; i < numListed; ++i)
+    {
+        rMessage() << "  " << sizes[i].second << ": " << (sizes[i].first / 1024) << " kB" << std::endl;
+    }
 }
 
 // Return the shader-not-found texture, loading if necessary
@@ -11,19 +11,44 @@ namespace shaders
 
 class GLTextureManager
 {
+	// A texture and the (estimated) video memory it occupies
+	struct TextureEntry
+	{
+		TexturePtr texture;
+		std::size_t bytes;
+
+		TextureEntry() :
+			bytes(0)
+		{}
+	};
+
 	// The mapping between texturekeys and Texture instances
-	typedef std::map<std::string, TexturePtr> TextureMap;
+	typedef std::map<std::string, TextureEntry> TextureMap;
 	TextureMap _textures;
 
 	// The fallback textures in case a texture is empty or broken
 	TexturePtr _shaderNotFound;
 
+	// The sum of the texture sizes in _textures
+	std::size_t _residentBytes;
+
+	// The memory the textures may take before unused ones are released,
+	// 0 means no limit
+	std::size_t _memoryBudget;
+
+	// Incremented on every texture use, to tell the least recently used ones
+	std::size_t _useCounter;
+
 private:
 
 	// Constructs the fallback textures like "Shader Image Missing"
 	TexturePtr loadStandardTexture(const std::string& filename);
 
+	void insertTexture(const std::string& identifier, const TexturePtr& texture);
+	void eraseTexture(TextureMap::iterator i);
+
 public:
+	GLTextureManager();
 
     /**
      * \brief
@@ -53,6 +78,49 @@ public:
 	 */
 	void checkBindings();
 
+	/* Removes the textures generated from one of the given images (VFS
+	 * paths without extension), so that they are loaded afresh on the next
+	 * request. Textures still held by others stay alive until released.
+	 */
+	void removeBindings(const StringSet& imageNames);
+
+	// The video memory taken by the textures held by this manager (estimated)
+	std::size_t getResidentBytes() const
+	{
+		return _residentBytes;
+	}
+
+	std::size_t getNumTextures() const
+	{
+		return _textures.size();
+	}
+
+	std::size_t getMemoryBudget() const
+	{
+		return _memoryBudget;
+	}
+
+	void setMemoryBudget(std::size_t bytes)
+	{
+		_memoryBudget = bytes;
+	}
+
+	// True if loading more textures would exceed the memory budget
+	bool isOverBudget() const
+	{
+		return _memoryBudget > 0 && _residentBytes >= _memoryBudget;
+	}
+
+	// Returns a new usage stamp, later uses get higher stamps
+	std::size_t getUseStamp()
+	{
+		return ++_useCounter;
+	}
+
+	// Writes the number and memory of the textures to the log,
+	// along with the largest ones
+	void printStats() const;
+
 };
 
 typedef boost::shared_ptr<GLTextureManager> GLTextureManagerPtr;
@@ -7,6 +7,7 @@
 #include "igame.h"
 
 #include <boost/algorithm/string/case_conv.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
 
@@ -49,6 +50,27 @@ ImageFileLoader::getGameFileImageLoaders()
 	return _imageLoaders;
 }
 
+std::string ImageFileLoader::getImageNameForFile(const std::string& filename)
+{
+	const ImageLoaderList& loaders = getGameFileImageLoaders();
+
+	for (ImageLoaderList::const_iterator i = loaders.begin(); i != loaders.end(); ++i)
+	{
+		std::string prefix = (*i)->getPrefix();
+		std::string extension = "." + (*i)->getExtension();
+
+		if (filename.length() > prefix.length() + extension.length() &&
+			boost::algorithm::istarts_with(filename, prefix) &&
+			boost::algorithm::iends_with(filename, extension))
+		{
+			return filename.substr(prefix.length(),
+				filename.length() - prefix.length() - extension.length());
+		}
+	}
+
+	return "";
+}
+
 // Load image from VFS
 ImagePtr ImageFileLoader::imageFromVFS(const std::string& name)
 {
@@ -31,6 +31,14 @@ public:
      */
     static ImagePtr imageFromVFS(const std::string& vfsPath);
 
+    /**
+     * \brief
+     * Return the name under which imageFromVFS() would load the given file,
+     * i.e. without the loader prefix and the file extension. Returns an empty
+     * string if the file is not an image of one of the game's formats.
+     */
+    static std::string getImageNameForFile(const std::string& filename);
+
 	/**
      * \brief
      * Load an image from a filesystem path.
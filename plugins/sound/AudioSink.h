@@ -0,0 +1,97 @@
+#pragma once
+
+#include "SoundDecoder.h"
+
+namespace sound
+{
+
+/**
+ * The output the SoundPlayer is sending the decoded PCM data to. The data
+ * is passed in chunks, the sink holds a limited number of them at a time.
+ */
+class AudioSink
+{
+public:
+	virtual ~AudioSink() {}
+
+	// Prepares the playback of data in the given format, returns false on failure
+	virtual bool open(const SoundFormat& format) = 0;
+
+	// Returns the number of chunks which can be queued right now
+	virtual std::size_t getNumFreeBuffers() = 0;
+
+	// Queues the given chunk for playback, playback starts with the first chunk
+	virtual void queue(const char* data, std::size_t size) = 0;
+
+	// Returns true as long as queued data is waiting to be played
+	virtual bool isPlaying() = 0;
+
+	// Stops the playback and drops the queued data
+	virtual void close() = 0;
+};
+typedef boost::shared_ptr<AudioSink> AudioSinkPtr;
+
+/**
+ * A sink discarding all data, which is "played" as soon as it is queued.
+ * This allows running the sound playback without an audio device.
+ */
+class NullAudioSink :
+	public AudioSink
+{
+	SoundFormat _format;
+
+	// Statistics of the current playback
+	std::size_t _numChunks;
+	std::size_t _numBytes;
+
+public:
+	NullAudioSink() :
+		_numChunks(0),
+		_numBytes(0)
+	{}
+
+	bool open(const SoundFormat& format)
+	{
+		_format = format;
+		_numChunks = 0;
+		_numBytes = 0;
+
+		return true;
+	}
+
+	std::size_t getNumFreeBuffers()
+	{
+		return 1;
+	}
+
+	void queue(const char* data, std::size_t size)
+	{
+		++_numChunks;
+		_numBytes += size;
+	}
+
+	bool isPlaying()
+	{
+		return false;
+	}
+
+	void close()
+	{}
+
+	const SoundFormat& getFormat() const
+	{
+		return _format;
+	}
+
+	std::size_t getNumChunks() const
+	{
+		return _numChunks;
+	}
+
+	std::size_t getNumBytes() const
+	{
+		return _numBytes;
+	}
+};
+
+} // namespace sound
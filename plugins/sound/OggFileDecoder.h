@@ -0,0 +1,119 @@
+#pragma once
+
+#include "SoundDecoder.h"
+#include "OggFileStream.h"
+
+#include "iarchive.h"
+#include "itextstream.h"
+#include <stdexcept>
+#include <vorbis/vorbisfile.h>
+
+namespace sound
+{
+
+/**
+ * Decoder for OGG Vorbis files, reading the compressed data from
+ * the archive file as the decoding progresses.
+ */
+class OggFileDecoder :
+	public SoundDecoder
+{
+	// Keep the file alive while decoding
+	ArchiveFilePtr _file;
+
+	OggFileStream _stream;
+
+	OggVorbis_File _oggFile;
+
+	SoundFormat _format;
+
+	// Set after a decoding error
+	bool _failed;
+
+public:
+	/**
+	 * Opens the given OGG file.
+	 *
+	 * @throws: std::runtime_error if the file is not a valid OGG Vorbis file.
+	 */
+	OggFileDecoder(const ArchiveFilePtr& file) :
+		_file(file),
+		_stream(_file->getInputStream()),
+		_failed(false)
+	{
+		// Setup the callbacks and point them to the helper class
+		ov_callbacks callbacks;
+		callbacks.read_func = OggFileStream::oggReadFunc;
+		callbacks.seek_func = NULL;
+		callbacks.close_func = OggFileStream::oggCloseFunc;
+		callbacks.tell_func = NULL;
+
+		// Open the OGG data stream using the custom callbacks
+		if (ov_open_callbacks(static_cast<void*>(&_stream), &_oggFile, NULL, 0, callbacks) != 0)
+		{
+			throw std::runtime_error("Error opening OGG file.");
+		}
+
+		// Get some information about the OGG file, it's decoded to 16 bit samples
+		vorbis_info* vorbisInfo = ov_info(&_oggFile, -1);
+
+		_format.channels = vorbisInfo->channels;
+		_format.bitsPerSample = 16;
+		_format.sampleRate = vorbisInfo->rate;
+
+		if (_format.channels != 1 && _format.channels != 2)
+		{
+			ov_clear(&_oggFile);
+			throw std::runtime_error("Unsupported number of channels.");
+		}
+	}
+
+	~OggFileDecoder()
+	{
+		// Clean up the OGG routines
+		ov_clear(&_oggFile);
+	}
+
+	const SoundFormat& getFormat() const
+	{
+		return _format;
+	}
+
+	std::size_t read(char* buffer, std::size_t size)
+	{
+		std::size_t total = 0;
+
+		// ov_read returns less than requested most of the time, fill the whole buffer
+		while (!_failed && total < size)
+		{
+			int bitStream;
+			long bytes = ov_read(&_oggFile, buffer + total, static_cast<int>(size - total),
+								 0, 2, 1, &bitStream);
+
+			if (bytes == 0)
+			{
+				break; // end of file
+			}
+			else if (bytes == OV_HOLE) {
+				rError() << "SoundPlayer: Error decoding OGG: OV_HOLE.\n";
+				_failed = true;
+			}
+			else if (bytes == OV_EBADLINK) {
+				rError() << "SoundPlayer: Error decoding OGG: OV_EBADLINK.\n";
+				_failed = true;
+			}
+			else if (bytes < 0) {
+				rError() << "SoundPlayer: Error decoding OGG.\n";
+				_failed = true;
+			}
+			else
+			{
+				total += bytes;
+			}
+		}
+
+		return total;
+	}
+};
+
+} // namespace sound
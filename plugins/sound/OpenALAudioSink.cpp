@@ -0,0 +1,190 @@
+#include "OpenALAudioSink.h"
+
+#include "itextstream.h"
+
+namespace sound
+{
+
+namespace
+{
+	// The number of buffers in the ring
+	const std::size_t NUM_BUFFERS = 4;
+}
+
+OpenALAudioSink::OpenALAudioSink() :
+	_initialised(false),
+	_context(NULL),
+	_source(0),
+	_format(0),
+	_sampleRate(0)
+{}
+
+bool OpenALAudioSink::initialise() {
+	if (_initialised) {
+		return _context != NULL;
+	}
+
+	_initialised = true;
+
+	// Create device
+	ALCdevice* device = alcOpenDevice(NULL);
+
+	if (device != NULL) {
+		// Create context
+		_context = alcCreateContext(device, NULL);
+
+		if (_context != NULL) {
+			// Make context current
+			if (!alcMakeContextCurrent(_context)) {
+				alcDestroyContext(_context);
+				alcCloseDevice(device);
+				_context = NULL;
+
+				rError() << "Could not make ALC context current." << std::endl;
+				return false;
+			}
+
+			// Success
+			rMessage() << "SoundPlayer: OpenAL context successfully set up." << std::endl;
+		}
+		else {
+			alcCloseDevice(device);
+			rError() << "Could not create ALC context." << std::endl;
+		}
+	}
+	else {
+		rError() << "Could not open ALC device." << std::endl;
+	}
+
+	return _context != NULL;
+}
+
+OpenALAudioSink::~OpenALAudioSink() {
+	close();
+
+	if (!_initialised) {
+		return;
+	}
+
+	// Unset the context
+	if (alcMakeContextCurrent(NULL)) {
+		// Destroy the context and close device if appropriate
+		if (_context != NULL) {
+			ALCdevice* device = alcGetContextsDevice(_context);
+			alcDestroyContext(_context);
+
+			if (alcGetError(device) != ALC_NO_ERROR) {
+				rError() << "Could not destroy ALC context." << std::endl;
+			}
+
+			if (!alcCloseDevice(device)) {
+				rError() << "Could not close ALC device." << std::endl;
+			}
+		}
+	}
+	else {
+		rError() << "Could not reset ALC context." << std::endl;
+	}
+}
+
+bool OpenALAudioSink::open(const SoundFormat& format)
+{
+	// If we're not initialised yet, do it now
+	if (!initialise()) {
+		return false;
+	}
+
+	close();
+
+	if (format.channels == 1) {
+		_format = format.bitsPerSample == 8 ? AL_FORMAT_MONO8 : AL_FORMAT_MONO16;
+	}
+	else {
+		_format = format.bitsPerSample == 8 ? AL_FORMAT_STEREO8 : AL_FORMAT_STEREO16;
+	}
+
+	_sampleRate = static_cast<ALsizei>(format.sampleRate);
+
+	alGenSources(1, &_source);
+
+	_buffers.resize(NUM_BUFFERS);
+	alGenBuffers(static_cast<ALsizei>(_buffers.size()), &_buffers[0]);
+
+	_freeBuffers = _buffers;
+
+	return true;
+}
+
+std::size_t OpenALAudioSink::getNumFreeBuffers()
+{
+	if (_source == 0) {
+		return 0;
+	}
+
+	// Take back the buffers which have been played
+	ALint processed = 0;
+	alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+
+	if (processed > 0) {
+		std::size_t numFree = _freeBuffers.size();
+
+		_freeBuffers.resize(numFree + processed);
+		alSourceUnqueueBuffers(_source, processed, &_freeBuffers[numFree]);
+	}
+
+	return _freeBuffers.size();
+}
+
+void OpenALAudioSink::queue(const char* data, std::size_t size)
+{
+	if (_freeBuffers.empty()) {
+		return;
+	}
+
+	ALuint buffer = _freeBuffers.back();
+	_freeBuffers.pop_back();
+
+	// Upload sound data to buffer and append it to the source
+	alBufferData(buffer, _format, data, static_cast<ALsizei>(size), _sampleRate);
+	alSourceQueueBuffers(_source, 1, &buffer);
+
+	// Start the source, or restart it if it ran out of data
+	if (!isPlaying()) {
+		alSourcePlay(_source);
+	}
+}
+
+bool OpenALAudioSink::isPlaying()
+{
+	if (_source == 0) {
+		return false;
+	}
+
+	ALint state;
+	// Query the state of the source
+	alGetSourcei(_source, AL_SOURCE_STATE, &state);
+
+	return state == AL_PLAYING;
+}
+
+void OpenALAudioSink::close()
+{
+	// Check if there is an active source
+	if (_source != 0) {
+		// Stop playing and detach the buffers
+		alSourceStop(_source);
+		alSourcei(_source, AL_BUFFER, 0);
+		alDeleteSources(1, &_source);
+		_source = 0;
+	}
+
+	if (!_buffers.empty()) {
+		// Free the buffers
+		alDeleteBuffers(static_cast<ALsizei>(_buffers.size()), &_buffers[0]);
+		_buffers.clear();
+	}
+
+	_freeBuffers.clear();
+}
+
+} // namespace sound
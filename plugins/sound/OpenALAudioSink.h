@@ -0,0 +1,57 @@
+#pragma once
+
+#include "AudioSink.h"
+
+#include <vector>
+#include <AL/al.h>
+#include <AL/alc.h>
+
+namespace sound
+{
+
+/**
+ * Plays the data through OpenAL, the chunks are queued to a single source
+ * using a small ring of buffers, which are refilled as soon as they have
+ * been played.
+ */
+class OpenALAudioSink :
+	public AudioSink
+{
+	// Are we set up yet? The first open() initialises on demand.
+	bool _initialised;
+
+	ALCcontext* _context;
+
+	// The source playing the buffers
+	ALuint _source;
+
+	// All buffers, and the ones not queued to the source
+	std::vector<ALuint> _buffers;
+	std::vector<ALuint> _freeBuffers;
+
+	ALenum _format;
+	ALsizei _sampleRate;
+
+public:
+	OpenALAudioSink();
+
+	/**
+	 * greebo: Destroys the alut context
+	 */
+	~OpenALAudioSink();
+
+	// AudioSink implementation
+	bool open(const SoundFormat& format);
+	std::size_t getNumFreeBuffers();
+	void queue(const char* data, std::size_t size);
+	bool isPlaying();
+	void close();
+
+	/**
+	 * Opens the audio device and sets up the AL context, if not done yet.
+	 * Returns false if no device is available.
+	 */
+	bool initialise();
+};
+
+} // namespace sound
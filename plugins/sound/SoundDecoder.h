@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <boost/shared_ptr.hpp>
+
+namespace sound
+{
+
+/// The PCM format of decoded sound data
+struct SoundFormat
+{
+	unsigned int channels;
+	unsigned int bitsPerSample;
+	unsigned int sampleRate;
+
+	SoundFormat() :
+		channels(0),
+		bitsPerSample(0),
+		sampleRate(0)
+	{}
+
+	// The size of a single sample frame (all channels) in bytes
+	std::size_t getFrameSize() const
+	{
+		return channels * bitsPerSample / 8;
+	}
+};
+
+/**
+ * A SoundDecoder delivers the PCM data of a sound file piece by piece,
+ * such that the file can be played while it is still being decoded.
+ */
+class SoundDecoder
+{
+public:
+	virtual ~SoundDecoder() {}
+
+	virtual const SoundFormat& getFormat() const = 0;
+
+	/**
+	 * Decodes the next piece of the file into the given buffer. Returns the
+	 * number of bytes written (a multiple of the frame size), 0 at the end
+	 * of the file.
+	 *
+	 * @throws: std::runtime_error if the data can't be decoded.
+	 */
+	virtual std::size_t read(char* buffer, std::size_t size) = 0;
+};
+typedef boost::shared_ptr<SoundDecoder> SoundDecoderPtr;
+
+} // namespace sound
@@ -1,5 +1,6 @@
 #include "SoundManager.h"
 #include "SoundFileLoader.h"
+#include "OpenALAudioSink.h"
 
 #include "ifilesystem.h"
 #include "archivelib.h"
@@ -42,7 +43,7 @@ bool SoundManager::playSound(const std::string& fileName)
 	if (file != NULL) {
 		// File found, play it
 		std::cout << "Found file: " << name << std::endl;
-		if (_soundPlayer) _soundPlayer->play(*file);
+		if (_soundPlayer) _soundPlayer->play(file);
 		return true;
 	}
 
@@ -58,7 +59,7 @@ bool SoundManager::playSound(const std::string& fileName)
 	file = GlobalFileSystem().openFile(name);
 	if (file != NULL) {
 		std::cout << "Found file: " << name << std::endl;
-		if (_soundPlayer) _soundPlayer->play(*file);
+		if (_soundPlayer) _soundPlayer->play(file);
 		return true;
 	}
 
@@ -68,7 +69,7 @@ bool SoundManager::playSound(const std::string& fileName)
 	file = GlobalFileSystem().openFile(name);
 	if (file != NULL) {
 		std::cout << "Found file: " << name << std::endl;
-		if (_soundPlayer) _soundPlayer->play(*file);
+		if (_soundPlayer) _soundPlayer->play(file);
 		return true;
 	}
 
@@ -141,7 +142,19 @@ void SoundManager::initialiseModule(const ApplicationContext& ctx)
     {
         rMessage() << "SoundManager: initialising sound playback"
                              << std::endl;
-        _soundPlayer = boost::shared_ptr<SoundPlayer>(new SoundPlayer);
+
+        boost::shared_ptr<OpenALAudioSink> openAL(new OpenALAudioSink);
+        AudioSinkPtr sink = openAL;
+
+        // Without an audio device the sounds are decoded but not played
+        if (!openAL->initialise())
+        {
+            rWarning() << "SoundManager: no audio device available, "
+                       << "using the null audio sink" << std::endl;
+            sink.reset(new NullAudioSink);
+        }
+
+        _soundPlayer = boost::shared_ptr<SoundPlayer>(new SoundPlayer(sink));
     }
     else
     {
@@ -1,261 +1,109 @@
 #include "SoundPlayer.h"
 
-#include <vorbis/vorbisfile.h>
-#include <iostream>
-#include <vector>
-#include <boost/algorithm/string/case_conv.hpp>
-
-#include "stream/textfilestream.h"
-#include "archivelib.h"
+#include "itextstream.h"
 #include "os/path.h"
-#include "imagelib.h" // for ScopedArchiveBuffer
-#include <boost/shared_ptr.hpp>
-
-// We need the usleep() command. Be sure to include the windows.h
-// header after the local textfilestream.h because there are definition conflicts otherwise.
-#ifdef WIN32
-#include <windows.h>
-#define usleep(x) Sleep((x)/1000)
-#else
-#include <unistd.h>
-#endif
+#include <stdexcept>
+#include <boost/algorithm/string/case_conv.hpp>
 
-#include "OggFileStream.h"
-#include "WavFileLoader.h"
+#include "OggFileDecoder.h"
+#include "WavFileDecoder.h"
 
 namespace sound {
 
-	namespace {
-		typedef std::vector<char> DecodeBuffer;
-		typedef boost::shared_ptr<DecodeBuffer> DecodeBufferPtr;
-	}
+namespace {
+	// Interval of the timer feeding the sink in msecs, the sink holds about a second of audio
+	const unsigned long UPDATE_INTERVAL = 100;
+}
 
 // Constructor
-SoundPlayer::SoundPlayer() :
-	_initialised(false),
-	_context(NULL),
-	_buffer(0),
-	_source(0),
-	_timer(200, checkBuffer, this)
+SoundPlayer::SoundPlayer(const AudioSinkPtr& sink) :
+	_sink(sink),
+	_timer(UPDATE_INTERVAL, checkBuffer, this)
 {
 	// Disable the timer, to make sure
 	_timer.disable();
 }
 
-void SoundPlayer::initialise() {
-	// Create device
-	ALCdevice* device = alcOpenDevice(NULL);
-
-	if (device != NULL) {
-		// Create context
-		_context = alcCreateContext(device, NULL);
-
-		if (_context != NULL) {
-			// Make context current
-			if (!alcMakeContextCurrent(_context)) {
-				alcDestroyContext(_context);
-				alcCloseDevice(device);
-				_context = NULL;
-
-				rError() << "Could not make ALC context current." << std::endl;
-			}
-
-			// Success
-			_initialised = true;
-			rMessage() << "SoundPlayer: OpenAL context successfully set up." << std::endl;
-		}
-		else {
-			alcCloseDevice(device);
-			rError() << "Could not create ALC context." << std::endl;
-		}
-	}
-	else {
-		rError() << "Could not open ALC device." << std::endl;
-    }
-}
-
 SoundPlayer::~SoundPlayer() {
-	clearBuffer();
-
-	// Unset the context
-	if (alcMakeContextCurrent(NULL)) {
-		// Destroy the context and close device if appropriate
-		if (_context != NULL) {
-			ALCdevice* device = alcGetContextsDevice(_context);
-			alcDestroyContext(_context);
-
-			if (alcGetError(device) != ALC_NO_ERROR) {
-				rError() << "Could not destroy ALC context." << std::endl;
-			}
-
-			if (!alcCloseDevice(device)) {
-				rError() << "Could not close ALC device." << std::endl;
-			}
-		}
-	}
-	else {
-		rError() << "Could not reset ALC context." << std::endl;
-    }
+	stop();
 }
 
 gboolean SoundPlayer::checkBuffer(gpointer data) {
 	// Cast the passed pointer onto self
 	SoundPlayer* self = reinterpret_cast<SoundPlayer*>(data);
 
-	// Check for active source and buffer
-	if (self->_source != 0 && self->_buffer != 0) {
-		ALint state;
-		// Query the state of the source
-		alGetSourcei(self->_source, AL_SOURCE_STATE, &state);
-		if (state == AL_STOPPED) {
-			// Erase the buffer
-			self->clearBuffer();
+	// Return true, so that the timer gets called again
+	return self->update() ? TRUE : FALSE;
+}
 
-			// Disable the timer to stop calling this function
-			self->_timer.disable();
-			return false;
-		}
+bool SoundPlayer::update() {
+	if (!_stream) {
+		return false;
 	}
 
-	// Return true, so that the timer gets called again
-	return true;
-}
+	// Fill up the buffers of the sink
+	while (_sink->getNumFreeBuffers() > 0 && _stream->popChunk(_chunk)) {
+		_sink->queue(&_chunk[0], _chunk.size());
+	}
 
-void SoundPlayer::clearBuffer() {
-	// Check if there is an active buffer
-	if (_source != 0) {
-		// Stop playing
-		alSourceStop(_source);
-		alDeleteSources(1, &_source);
-		_source = 0;
+	// The stream doesn't log by itself, it is running on a worker thread
+	std::string error = _stream->popError();
 
-		if (_buffer != 0) {
-			// Free the buffer
-			alDeleteBuffers(1, &_buffer);
-			_buffer = 0;
-		}
+	if (!error.empty()) {
+		rError() << "SoundPlayer: Error decoding sound file: " << error << std::endl;
 	}
 
-	_timer.disable();
+	if (_stream->isFinished() && !_sink->isPlaying()) {
+		// Everything has been played
+		stop();
+		return false;
+	}
+
+	return true;
 }
 
 void SoundPlayer::stop() {
-	clearBuffer();
-}
+	_timer.disable();
 
-void SoundPlayer::play(ArchiveFile& file) {
-	// If we're not initialised yet, do it now
-	if (!_initialised) {
-		initialise();
-    }
+	// Stop the decoding thread
+	_stream.reset();
 
+	_sink->close();
+}
+
+void SoundPlayer::play(const ArchiveFilePtr& file) {
 	// Stop any previous playback operations, that might be still active
-	clearBuffer();
+	stop();
 
 	// Retrieve the extension
-	std::string ext = os::getExtension(file.getName());
-
-	if (boost::algorithm::to_lower_copy(ext) == "ogg") {
-		// Convert the file into a buffer, self-destructs at end of scope
-		ScopedArchiveBuffer buffer(file);
-
-		// This is an OGG Vorbis file, decode it
-		vorbis_info* vorbisInfo;
-  		OggVorbis_File oggFile;
-
-  		// Initialise the wrapper class
-  		OggFileStream stream(buffer);
-
-  		// Setup the callbacks and point them to the helper class
-  		ov_callbacks callbacks;
-  		callbacks.read_func = OggFileStream::oggReadFunc;
-  		callbacks.seek_func = OggFileStream::oggSeekFunc;
-  		callbacks.close_func = OggFileStream::oggCloseFunc;
-  		callbacks.tell_func = OggFileStream::oggTellFunc;
-
-  		// Open the OGG data stream using the custom callbacks
-  		int res = ov_open_callbacks(static_cast<void*>(&stream), &oggFile,
-									NULL, 0, callbacks);
+	std::string ext = os::getExtension(file->getName());
 
-  		if (res == 0) {
-  			// Open successful
+	SoundDecoderPtr decoder;
 
-  			// Get some information about the OGG file
-			vorbisInfo = ov_info(&oggFile, -1);
-
-			// Check the number of channels
-			ALenum format = (vorbisInfo->channels == 1) ? AL_FORMAT_MONO16
-														: AL_FORMAT_STEREO16;
-
-			// Get the sample Rate
-			ALsizei freq = (vorbisInfo->rate);
-			//std::cout << "Sample rate is " << freq << "\n";
-
-			long bytes;
-			char smallBuffer[4096];
-			DecodeBufferPtr largeBuffer(new DecodeBuffer());
-			do {
-				int bitStream;
-				// Read a chunk of decoded data from the vorbis file
-				bytes = ov_read(&oggFile, smallBuffer, sizeof(smallBuffer),
-								0, 2, 1, &bitStream);
-
-				if (bytes == OV_HOLE) {
-					rError() << "SoundPlayer: Error decoding OGG: OV_HOLE.\n";
-				}
-				else if (bytes == OV_EBADLINK) {
-					rError() << "SoundPlayer: Error decoding OGG: OV_EBADLINK.\n";
-				}
-				else {
-					// Stuff this into the variable-sized buffer
-					largeBuffer->insert(largeBuffer->end(), smallBuffer, smallBuffer + bytes);
-				}
-			} while (bytes > 0);
-
-			// Allocate a new buffer
-			alGenBuffers(1, &_buffer);
-
-			DecodeBuffer& bufferRef = *largeBuffer;
-
-			// Upload sound data to buffer
-			alBufferData(_buffer,
-						 format,
-						 &bufferRef[0],
-						 static_cast<ALsizei>(bufferRef.size()),
-						 freq);
-
-			// Clean up the OGG routines
-  			ov_clear(&oggFile);
-  		}
-  		else {
-  			rError() << "SoundPlayer: Error opening OGG file.\n";
-  		}
-	}
-	else {
-		// Must be a wave file
-		try {
-			// Create an AL sound buffer directly from the buffer in memory
-			_buffer = WavFileLoader::LoadFromStream(file.getInputStream());
+	try {
+		if (boost::algorithm::to_lower_copy(ext) == "ogg") {
+			// This is an OGG Vorbis file
+			decoder.reset(new OggFileDecoder(file));
 		}
-		catch (std::runtime_error& e) {
-			rError() << "SoundPlayer: Error opening WAV file: " << e.what() << std::endl;
-			_buffer = 0;
+		else {
+			// Must be a wave file
+			decoder.reset(new WavFileDecoder(file));
 		}
 	}
+	catch (std::runtime_error& e) {
+		rError() << "SoundPlayer: Error opening " << file->getName() << ": " << e.what() << std::endl;
+		return;
+	}
 
-	if (_buffer != 0) {
-		alGenSources(1, &_source);
-		// Assign the buffer to the source and play it
-		alSourcei(_source, AL_BUFFER, _buffer);
-
-		// greebo: Wait 10 msec. to fix a problem with buffers not being played
-		// maybe the AL needs time to push the data?
-		usleep(10000);
+	if (!_sink->open(decoder->getFormat())) {
+		return;
+	}
 
-		alSourcePlay(_source);
+	_stream.reset(new SoundStream(decoder));
+	_stream->start();
 
-		// Enable the periodic buffer check, this destructs the buffer
-		// as soon as the playback has finished
+	// Pass the first chunk right away, the rest follows periodically
+	if (update()) {
 		_timer.enable();
 	}
 }
@@ -2,58 +2,58 @@
 #define SOUNDPLAYER_H_
 
 #include <string>
-#include <AL/al.h>
-#include <AL/alc.h>
+#include <vector>
+#include "iarchive.h"
 #include "gtkutil/Timer.h"
 
-class ArchiveFile;
+#include "AudioSink.h"
+#include "SoundStream.h"
 
 namespace sound {
 
+/**
+ * greebo: Plays sound files through the given AudioSink. The files are
+ * decoded on a background thread while playing, the decoded chunks are
+ * passed on to the sink periodically.
+ */
 class SoundPlayer
 {
 protected:
-	// Are we set up yet? Defer initialisation until we play something.
-	bool _initialised;
+	// The output, OpenAL or a null sink
+	AudioSinkPtr _sink;
 
-	ALCcontext* _context;
+	// The stream decoding the currently played file, NULL if idle
+	SoundStreamPtr _stream;
 
-	// The buffer containing the currently played audio data
-	ALuint _buffer;
+	// The chunk on its way from the stream to the sink
+	std::vector<char> _chunk;
 
-	// The source playing the buffer
-	ALuint _source;
-
-	// The timer object to check whether the sound is done playing
-	// to destroy the buffer afterwards
+	// The timer object feeding the sink during playback
 	gtkutil::Timer _timer;
 
 public:
 	// Constructor
-	SoundPlayer();
+	SoundPlayer(const AudioSinkPtr& sink);
 
-	/**
-	 * greebo: Destroys the alut context
-	 */
 	virtual ~SoundPlayer();
 
 	/** greebo: Call this with the ArchiveFile object containing
 	 * 			the file to be played.
 	 */
-	virtual void play(ArchiveFile& file);
+	virtual void play(const ArchiveFilePtr& file);
 
 	/** greebo: Stops the playback immediately.
 	 */
 	virtual void stop();
 
-protected:
-	// Initialises the AL context
-	void initialise();
-
-	// Clears the buffer, stops playing
-	void clearBuffer();
+	/**
+	 * Passes the decoded chunks to the sink, this is called periodically
+	 * while playing. Returns false as soon as the playback has finished.
+	 */
+	bool update();
 
-	// This is called periodically to check whether the buffer can be cleared
+protected:
+	// This is called periodically to feed the sink
 	static gboolean checkBuffer(gpointer data);
 };
 
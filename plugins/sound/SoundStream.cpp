@@ -0,0 +1,168 @@
+#include "SoundStream.h"
+
+#include <stdexcept>
+#include <sigc++/functors/mem_fun.h>
+
+namespace sound
+{
+
+namespace
+{
+	// The number of decoded chunks kept ahead of the playback
+	const std::size_t NUM_CHUNKS = 4;
+}
+
+SoundStream::SoundStream(const SoundDecoderPtr& decoder) :
+	_decoder(decoder),
+	_chunkSize(0),
+	_chunks(NUM_CHUNKS),
+	_first(0),
+	_numReady(0),
+	_decoderFinished(false),
+	_cancelled(false),
+	_thread(NULL)
+{
+	const SoundFormat& format = _decoder->getFormat();
+
+	// A quarter second, in whole sample frames
+	std::size_t frameSize = format.getFrameSize();
+
+	_chunkSize = (format.sampleRate / 4) * frameSize;
+
+	if (_chunkSize == 0)
+	{
+		_chunkSize = frameSize > 0 ? frameSize : 1;
+	}
+}
+
+SoundStream::~SoundStream()
+{
+	{
+		Glib::Mutex::Lock lock(_mutex);
+
+		_cancelled = true;
+		_chunkTaken.signal();
+	}
+
+	if (_thread != NULL)
+	{
+		_thread->join();
+	}
+}
+
+const SoundFormat& SoundStream::getFormat() const
+{
+	return _decoder->getFormat();
+}
+
+void SoundStream::start()
+{
+	// No other thread is running yet
+	if (decodeChunk(_chunks[0]))
+	{
+		_numReady = 1;
+	}
+	else
+	{
+		_decoderFinished = true;
+		return;
+	}
+
+	_thread = Glib::Thread::create(sigc::mem_fun(*this, &SoundStream::run), true);
+}
+
+bool SoundStream::popChunk(std::vector<char>& chunk)
+{
+	Glib::Mutex::Lock lock(_mutex);
+
+	if (_numReady == 0)
+	{
+		return false;
+	}
+
+	chunk.swap(_chunks[_first]);
+
+	_first = (_first + 1) % _chunks.size();
+	--_numReady;
+
+	_chunkTaken.signal();
+
+	return true;
+}
+
+bool SoundStream::isFinished()
+{
+	Glib::Mutex::Lock lock(_mutex);
+
+	return _decoderFinished && _numReady == 0;
+}
+
+std::string SoundStream::popError()
+{
+	Glib::Mutex::Lock lock(_mutex);
+
+	std::string error;
+	error.swap(_error);
+
+	return error;
+}
+
+void SoundStream::run()
+{
+	while (true)
+	{
+		std::size_t slot;
+
+		{
+			Glib::Mutex::Lock lock(_mutex);
+
+			// Wait for a free slot in the ring
+			while (_numReady == _chunks.size() && !_cancelled)
+			{
+				_chunkTaken.wait(_mutex);
+			}
+
+			if (_cancelled)
+			{
+				return;
+			}
+
+			slot = (_first + _numReady) % _chunks.size();
+		}
+
+		// The free slot is not touched by popChunk(), decode without holding the lock
+		bool decoded = decodeChunk(_chunks[slot]);
+
+		Glib::Mutex::Lock lock(_mutex);
+
+		if (!decoded)
+		{
+			_decoderFinished = true;
+			return;
+		}
+
+		++_numReady;
+	}
+}
+
+bool SoundStream::decodeChunk(std::vector<char>& chunk)
+{
+	chunk.resize(_chunkSize);
+
+	try
+	{
+		chunk.resize(_decoder->read(&chunk[0], chunk.size()));
+	}
+	catch (std::runtime_error& e)
+	{
+		Glib::Mutex::Lock lock(_mutex);
+
+		// Keep it for the player, the stream ends here
+		_error = e.what();
+		chunk.clear();
+	}
+
+	return !chunk.empty();
+}
+
+} // namespace sound
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "SoundDecoder.h"
+
+#include <string>
+#include <vector>
+#include <glibmm/thread.h>
+
+namespace sound
+{
+
+/**
+ * Decodes a sound file on a background thread, a few chunks ahead of the
+ * playback. The decoded chunks are kept in a fixed ring, so the memory
+ * used is bounded regardless of the length of the file.
+ */
+class SoundStream
+{
+	SoundDecoderPtr _decoder;
+
+	// The size of a chunk in bytes, a quarter second of audio
+	std::size_t _chunkSize;
+
+	// The ring of chunks, _numReady chunks are waiting, starting at _first
+	std::vector< std::vector<char> > _chunks;
+	std::size_t _first;
+	std::size_t _numReady;
+
+	// Set when the decoder reached the end of the file (or failed)
+	bool _decoderFinished;
+
+	// Set to stop the worker thread
+	bool _cancelled;
+
+	// The message of a decoding error, not yet reported by the player
+	std::string _error;
+
+	Glib::Mutex _mutex;
+
+	// Signalled when a chunk has been taken or the stream is cancelled
+	Glib::Cond _chunkTaken;
+
+	Glib::Thread* _thread;
+
+public:
+	SoundStream(const SoundDecoderPtr& decoder);
+
+	// Stops the decoding thread
+	~SoundStream();
+
+	const SoundFormat& getFormat() const;
+
+	// Decodes the first chunk in the calling thread, such that the
+	// playback can start immediately, then starts the worker thread.
+	void start();
+
+	/**
+	 * Moves the next decoded chunk into the given vector, the previous
+	 * contents of the vector are recycled. Returns false if no chunk is
+	 * ready at the moment.
+	 */
+	bool popChunk(std::vector<char>& chunk);
+
+	// Returns true if the whole file has been decoded and taken
+	bool isFinished();
+
+	/**
+	 * Returns the message of the decoding error which stopped the stream,
+	 * or an empty string. The error is cleared, such that it is reported
+	 * only once. The worker can't log it itself, since the log output
+	 * ends up in the GTK console.
+	 */
+	std::string popError();
+
+private:
+	void run();
+
+	// Decodes the next chunk into the given vector, returns false at the end
+	bool decodeChunk(std::vector<char>& chunk);
+};
+typedef boost::shared_ptr<SoundStream> SoundStreamPtr;
+
+} // namespace sound
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "SoundDecoder.h"
+
+#include "iarchive.h"
+#include "idatastream.h"
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+namespace sound
+{
+
+/**
+ * greebo: Decoder for uncompressed PCM WAV files. The header is parsed
+ * on construction, the sample data is read from the file on demand.
+ *
+ * Modeled after the one used by the Ogre3D people, found it posted
+ * somewhere on the net.
+ */
+class WavFileDecoder :
+	public SoundDecoder
+{
+	typedef StreamBase::byte_type byte;
+
+	// Keep the file alive while decoding
+	ArchiveFilePtr _file;
+
+	InputStream& _stream;
+
+	SoundFormat _format;
+
+	// The number of sample bytes not read yet
+	std::size_t _remainingSize;
+
+public:
+	/**
+	 * greebo: Opens the given WAV file and parses its header.
+	 *
+	 * @throws: std::runtime_error if an error occurs.
+	 */
+	WavFileDecoder(const ArchiveFilePtr& file) :
+		_file(file),
+		_stream(_file->getInputStream()),
+		_remainingSize(0)
+	{
+		// buffers
+		char magic[5];
+		magic[4] = '\0';
+
+		byte temp[256];
+
+		// check magic
+		_stream.read(reinterpret_cast<byte*>(magic), 4);
+
+		if (std::string(magic) != "RIFF") {
+			throw std::runtime_error("No wav file");
+		}
+
+		// The next 4 bytes are the file size, we can skip this since we get the size from the DataStream
+		unsigned int size;
+		_stream.read(reinterpret_cast<byte*>(&size), 4);
+
+		// check file format
+		_stream.read(reinterpret_cast<byte*>(magic), 4);
+		if (std::string(magic) != "WAVE") {
+			throw std::runtime_error("Wrong wav file format");
+		}
+
+		// check 'fmt ' sub chunk (1)
+		_stream.read(reinterpret_cast<byte*>(magic), 4);
+		if (std::string(magic) != "fmt ") {
+			throw std::runtime_error("No 'fmt ' subchunk.");
+		}
+
+		// read (1)'s size
+		unsigned int subChunk1Size(0);
+		_stream.read(reinterpret_cast<byte*>(&subChunk1Size), 4);
+
+		if (subChunk1Size < 16) {
+			throw std::runtime_error("'fmt ' chunk too small.");
+		}
+
+		// check PCM audio format
+		unsigned short audioFormat(0);
+		_stream.read(reinterpret_cast<byte*>(&audioFormat), 2);
+
+		if (audioFormat != 1) {
+			throw std::runtime_error("Audio format is not PCM.");
+		}
+
+		// read number of channels
+		unsigned short channels(0);
+		_stream.read(reinterpret_cast<byte*>(&channels), 2);
+
+		// read frequency (sample rate)
+		unsigned int freq = 0;
+		_stream.read(reinterpret_cast<byte*>(&freq), 4);
+
+		// skip 6 bytes (Byte rate (4), Block align (2))
+		_stream.read(temp, 6);
+
+		// read bits per sample
+		unsigned short bps = 0;
+		_stream.read(reinterpret_cast<byte*>(&bps), 2);
+
+		if ((channels != 1 && channels != 2) || (bps != 8 && bps != 16)) {
+			throw std::runtime_error("Unsupported sample format.");
+		}
+
+		_format.channels = channels;
+		_format.bitsPerSample = bps;
+		_format.sampleRate = freq;
+
+		// skip the extension of the 'fmt ' chunk, if any
+		for (std::size_t extraSize = subChunk1Size - 16; extraSize > 0; )
+		{
+			std::size_t skipped = _stream.read(temp, std::min(extraSize, sizeof(temp)));
+
+			if (skipped == 0) {
+				throw std::runtime_error("'fmt ' chunk truncated.");
+			}
+
+			extraSize -= skipped;
+		}
+
+		// check 'data' sub chunk (2)
+		_stream.read(reinterpret_cast<byte*>(magic), 4);
+		if (std::string(magic) != "data" && std::string(magic) != "fact") {
+			throw std::runtime_error("No 'data' subchunk.");
+		}
+
+		// fact is an option section we don't need to worry about
+		if (std::string(magic) == "fact")
+		{
+			_stream.read(temp, 8);
+
+			// Now we should hit the data chunk
+			_stream.read(reinterpret_cast<byte*>(magic), 4);
+			if (std::string(magic) != "data") {
+				throw std::runtime_error("No 'data' subchunk.");
+			}
+		}
+
+		// The next four bytes are the size remaing of the file
+		unsigned int remainingSize = 0;
+		_stream.read(reinterpret_cast<byte*>(&remainingSize), 4);
+
+		_remainingSize = remainingSize;
+	}
+
+	const SoundFormat& getFormat() const
+	{
+		return _format;
+	}
+
+	std::size_t read(char* buffer, std::size_t size)
+	{
+		// Only pass whole sample frames
+		std::size_t frameSize = _format.getFrameSize();
+
+		size = std::min(size, _remainingSize);
+		size -= size % frameSize;
+
+		std::size_t total = 0;
+
+		while (total < size)
+		{
+			std::size_t bytes = _stream.read(reinterpret_cast<byte*>(buffer + total), size - total);
+
+			if (bytes == 0)
+			{
+				break; // file is shorter than announced
+			}
+
+			total += bytes;
+		}
+
+		total -= total % frameSize;
+		_remainingSize = total < size ? 0 : _remainingSize - total;
+
+		return total;
+	}
+};
+
+} // namespace sound
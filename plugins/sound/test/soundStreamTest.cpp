@@ -0,0 +1,249 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE soundStreamTest
+#include <boost/test/unit_test.hpp>
+
+#include "../AudioSink.h"
+#include "../SoundStream.h"
+#include "../WavFileDecoder.h"
+
+#include <cstring>
+
+using namespace sound;
+
+namespace
+{
+
+// An ArchiveFile reading from memory
+class MemoryArchiveFile :
+	public ArchiveFile,
+	public InputStream
+{
+	std::string _name;
+	std::vector<char> _data;
+	std::size_t _pos;
+
+public:
+	MemoryArchiveFile(const std::string& name, const std::vector<char>& data) :
+		_name(name),
+		_data(data),
+		_pos(0)
+	{}
+
+	std::size_t size() const
+	{
+		return _data.size();
+	}
+
+	const std::string& getName() const
+	{
+		return _name;
+	}
+
+	InputStream& getInputStream()
+	{
+		return *this;
+	}
+
+	size_type read(byte_type* buffer, size_type length)
+	{
+		length = std::min(length, _data.size() - _pos);
+
+		if (length > 0)
+		{
+			std::memcpy(buffer, &_data[_pos], length);
+			_pos += length;
+		}
+
+		return length;
+	}
+};
+
+void append(std::vector<char>& data, const char* bytes)
+{
+	data.insert(data.end(), bytes, bytes + 4);
+}
+
+void append(std::vector<char>& data, unsigned int value, std::size_t size)
+{
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		data.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+	}
+}
+
+const unsigned int SAMPLE_RATE = 8000;
+
+// A mono 16 bit WAV file, each sample holds its frame number
+ArchiveFilePtr createWavFile(unsigned int numFrames)
+{
+	std::vector<char> data;
+
+	append(data, "RIFF");
+	append(data, 36 + numFrames * 2, 4);
+	append(data, "WAVE");
+
+	append(data, "fmt ");
+	append(data, 16, 4);
+	append(data, 1, 2); // PCM
+	append(data, 1, 2); // channels
+	append(data, SAMPLE_RATE, 4);
+	append(data, SAMPLE_RATE * 2, 4); // byte rate
+	append(data, 2, 2); // block align
+	append(data, 16, 2); // bits per sample
+
+	append(data, "data");
+	append(data, numFrames * 2, 4);
+
+	for (unsigned int i = 0; i < numFrames; ++i)
+	{
+		append(data, i, 2);
+	}
+
+	return ArchiveFilePtr(new MemoryArchiveFile("test.wav", data));
+}
+
+// Delivers one valid chunk, then fails
+class FailingDecoder :
+	public SoundDecoder
+{
+	SoundFormat _format;
+	bool _failed;
+
+public:
+	FailingDecoder() :
+		_failed(false)
+	{
+		_format.channels = 1;
+		_format.bitsPerSample = 8;
+		_format.sampleRate = SAMPLE_RATE;
+	}
+
+	const SoundFormat& getFormat() const
+	{
+		return _format;
+	}
+
+	std::size_t read(char* buffer, std::size_t size)
+	{
+		if (_failed)
+		{
+			throw std::runtime_error("Corrupt sound data");
+		}
+
+		_failed = true;
+		std::memset(buffer, 0, size);
+
+		return size;
+	}
+};
+
+// Passes the stream to the sink the way SoundPlayer::update() does,
+// returns the sizes of the passed chunks
+std::vector<std::size_t> playStream(SoundStream& stream, NullAudioSink& sink,
+									unsigned int& nextFrame)
+{
+	std::vector<std::size_t> chunkSizes;
+	std::vector<char> chunk;
+
+	BOOST_REQUIRE(sink.open(stream.getFormat()));
+
+	stream.start();
+
+	while (!stream.isFinished())
+	{
+		if (sink.getNumFreeBuffers() == 0 || !stream.popChunk(chunk))
+		{
+			continue; // wait for the decoding thread
+		}
+
+		// The samples must arrive in order
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&chunk[0]);
+
+		for (std::size_t i = 0; i + 1 < chunk.size(); i += 2, ++nextFrame)
+		{
+			BOOST_REQUIRE_EQUAL(bytes[i] | (bytes[i + 1] << 8), nextFrame & 0xffff);
+		}
+
+		chunkSizes.push_back(chunk.size());
+		sink.queue(&chunk[0], chunk.size());
+	}
+
+	return chunkSizes;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(streamWavFileThroughNullSink)
+{
+	// Four full chunks of a quarter second and a partial one
+	const unsigned int numFrames = SAMPLE_RATE + 500;
+
+	SoundDecoderPtr decoder(new WavFileDecoder(createWavFile(numFrames)));
+	SoundStream stream(decoder);
+	NullAudioSink sink;
+
+	unsigned int nextFrame = 0;
+	std::vector<std::size_t> chunkSizes = playStream(stream, sink, nextFrame);
+
+	BOOST_REQUIRE_EQUAL(chunkSizes.size(), 5);
+
+	for (std::size_t i = 0; i < 4; ++i)
+	{
+		BOOST_CHECK_EQUAL(chunkSizes[i], SAMPLE_RATE / 4 * 2);
+	}
+
+	BOOST_CHECK_EQUAL(chunkSizes[4], 500 * 2);
+	BOOST_CHECK_EQUAL(nextFrame, numFrames);
+
+	BOOST_CHECK_EQUAL(sink.getFormat().sampleRate, SAMPLE_RATE);
+	BOOST_CHECK_EQUAL(sink.getNumChunks(), 5);
+	BOOST_CHECK_EQUAL(sink.getNumBytes(), numFrames * 2);
+	BOOST_CHECK(!sink.isPlaying());
+
+	// End of stream
+	std::vector<char> chunk;
+	BOOST_CHECK(stream.isFinished());
+	BOOST_CHECK(!stream.popChunk(chunk));
+	BOOST_CHECK(stream.popError().empty());
+}
+
+BOOST_AUTO_TEST_CASE(streamEmptyWavFile)
+{
+	SoundDecoderPtr decoder(new WavFileDecoder(createWavFile(0)));
+	SoundStream stream(decoder);
+	NullAudioSink sink;
+
+	unsigned int nextFrame = 0;
+	std::vector<std::size_t> chunkSizes = playStream(stream, sink, nextFrame);
+
+	BOOST_CHECK(chunkSizes.empty());
+	BOOST_CHECK_EQUAL(sink.getNumChunks(), 0);
+	BOOST_CHECK(stream.isFinished());
+}
+
+BOOST_AUTO_TEST_CASE(streamDecodingError)
+{
+	SoundStream stream(SoundDecoderPtr(new FailingDecoder));
+	NullAudioSink sink;
+
+	BOOST_REQUIRE(sink.open(stream.getFormat()));
+
+	stream.start();
+
+	std::vector<char> chunk;
+	std::size_t numChunks = 0;
+
+	while (!stream.isFinished())
+	{
+		if (stream.popChunk(chunk))
+		{
+			sink.queue(&chunk[0], chunk.size());
+			++numChunks;
+		}
+	}
+
+	// The stream ends at the error, which is reported once
+	BOOST_CHECK_EQUAL(numChunks, 1);
+	BOOST_CHECK_EQUAL(stream.popError(), "Corrupt sound data");
+	BOOST_CHECK(stream.popError().empty());
+}
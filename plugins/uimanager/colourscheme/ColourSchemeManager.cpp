@@ -91,23 +91,23 @@ void ColourSchemeManager::saveScheme(const std::string& name) {
 	std::string basePath = "user/ui/colourschemes";
 
 	// Re-create the schemeNode
-	xml::Node schemeNode = GlobalRegistry().createKeyWithName(basePath, "colourscheme", name);
+	GlobalRegistry().createKeyWithName(basePath, "colourscheme", name);
 
-	schemeNode.setAttributeValue("version", COLOURSCHEME_VERSION);
+	// This will be the path where all the <colour> nodes are added to
+	std::string schemePath = basePath + "/colourscheme[@name='" + name + "']";
+
+	GlobalRegistry().setAttribute(schemePath, "version", COLOURSCHEME_VERSION);
 
 	// Set the readonly attribute if necessary
 	if (_colourSchemes[name].isReadOnly()) {
-		schemeNode.setAttributeValue("readonly", "1");
+		GlobalRegistry().setAttribute(schemePath, "readonly", "1");
 	}
 
 	// Set the active attribute, if this is the active scheme
 	if (name == _activeScheme) {
-		schemeNode.setAttributeValue("active", "1");
+		GlobalRegistry().setAttribute(schemePath, "active", "1");
 	}
 
-	// This will be the path where all the <colour> nodes are added to
-	std::string schemePath = basePath + "/colourscheme[@name='" + name + "']";
-
 	// Retrieve the list with all the ColourItems of this scheme
 	ColourItemMap& colourMap = _colourSchemes[name].getColourMap();
 
@@ -119,8 +119,8 @@ void ColourSchemeManager::saveScheme(const std::string& name) {
 		// Cast the ColourItem onto a std::string
 		std::string colour = string::to_string(it->second);
 
-		xml::Node colourNode = GlobalRegistry().createKeyWithName(schemePath, "colour", name);
-		colourNode.setAttributeValue("value", colour);
+		GlobalRegistry().createKeyWithName(schemePath, "colour", name);
+		GlobalRegistry().setAttribute(schemePath + "/colour[@name='" + name + "']", "value", colour);
 	}
 }
 
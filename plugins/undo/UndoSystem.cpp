@@ -77,10 +77,16 @@ class RadiantUndoSystem : public UndoSystem
 	typedef std::set<UndoTracker*> Trackers;
 	Trackers _trackers;
 
+	// True between start() and finish()/cancel()
+	bool _operationStarted;
+
+	sigc::signal<void> _sigOperationFinished;
+
 public:
 	// Constructor
 	RadiantUndoSystem() :
-		_undoLevels(64)
+		_undoLevels(64),
+		_operationStarted(false)
 	{}
 
 	virtual ~RadiantUndoSystem() {
@@ -154,6 +160,8 @@ public:
 		}
 		startUndo();
 		trackersBegin();
+
+		_operationStarted = true;
 	}
 
 	// greebo: This finishes the current operation and
@@ -164,12 +172,24 @@ public:
 			// Instantly remove the added operation
 			_undoStack.pop_back();
 		}
+
+		operationFinished();
 	}
 
 	void finish(const std::string& command) {
 		if (finishUndo(command)) {
 			rMessage() << command << std::endl;
 		}
+
+		operationFinished();
+	}
+
+	bool operationStarted() const {
+		return _operationStarted;
+	}
+
+	sigc::signal<void> signal_operationFinished() const {
+		return _sigOperationFinished;
 	}
 
 	void undo() {
@@ -355,6 +375,14 @@ public:
 
 private:
 
+	// Notifies the listeners after the undoables have been detached from the stack
+	void operationFinished() {
+		if (_operationStarted) {
+			_operationStarted = false;
+			_sigOperationFinished.emit();
+		}
+	}
+
 	// Assigns the given stack to all of the Undoables listed in the map
 	void mark_undoables(UndoStack* stack) {
 		for (UndoablesMap::iterator i = _undoables.begin(); i != _undoables.end(); ++i) {
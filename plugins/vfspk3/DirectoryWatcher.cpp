@@ -0,0 +1,254 @@
+#include "DirectoryWatcher.h"
+
+#include "itextstream.h"
+#include "os/fs.h"
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace
+{
+	// Milliseconds to wait for further changes before passing them on
+	const guint CHANGE_DELAY = 300;
+
+#if defined(__linux__)
+	const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+								IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+}
+
+DirectoryWatcher::DirectoryWatcher(const ChangeCallback& callback) :
+	_callback(callback),
+	_fd(-1),
+	_ioSource(0),
+	_timeoutSource(0),
+	_complete(false),
+	_reportIncomplete(false)
+{
+#if defined(__linux__)
+	_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (_fd == -1)
+	{
+		rWarning() << "[vfs] Cannot watch the VFS directories for changes: "
+			<< std::strerror(errno) << std::endl;
+		return;
+	}
+
+	// The main loop source keeps a reference to the channel
+	GIOChannel* channel = g_io_channel_unix_new(_fd);
+	_ioSource = g_io_add_watch(channel, G_IO_IN, onEvents, this);
+	g_io_channel_unref(channel);
+
+	_complete = true;
+#endif
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+	if (_timeoutSource != 0)
+	{
+		g_source_remove(_timeoutSource);
+	}
+
+	if (_ioSource != 0)
+	{
+		g_source_remove(_ioSource);
+	}
+
+#if defined(__linux__)
+	if (_fd != -1)
+	{
+		close(_fd);
+	}
+#endif
+}
+
+void DirectoryWatcher::addRoot(const std::string& root)
+{
+	if (_fd == -1) return;
+
+	addDirectory(root, "", false);
+}
+
+bool DirectoryWatcher::isComplete() const
+{
+	return _complete;
+}
+
+void DirectoryWatcher::setIncomplete()
+{
+	if (_complete)
+	{
+		_complete = false;
+		_reportIncomplete = true;
+	}
+}
+
+void DirectoryWatcher::addDirectory(const std::string& root, const std::string& path,
+								   bool queueFiles)
+{
+#if defined(__linux__)
+	std::string fullPath = root + path;
+
+	int wd = inotify_add_watch(_fd, fullPath.c_str(), WATCH_MASK);
+
+	if (wd == -1)
+	{
+		// Most likely the per-user limit of watches has been reached
+		rWarning() << "[vfs] Cannot watch directory " << fullPath << ": "
+			<< std::strerror(errno) << std::endl;
+		setIncomplete();
+		return;
+	}
+
+	WatchedDirectory& dir = _watches[wd];
+	dir.root = root;
+	dir.path = path;
+
+	try
+	{
+		for (fs::directory_iterator i(fullPath); i != fs::directory_iterator(); ++i)
+		{
+			std::string name = path + os::filename_from_path(i->path());
+
+			if (fs::is_directory(i->status()))
+			{
+				addDirectory(root, name + "/", queueFiles);
+			}
+			else if (queueFiles)
+			{
+				_changedFiles.insert(name);
+			}
+		}
+	}
+	catch (fs::filesystem_error& e)
+	{
+		rWarning() << "[vfs] Cannot list directory " << fullPath << ": " << e.what() << std::endl;
+		setIncomplete();
+	}
+#endif
+}
+
+void DirectoryWatcher::removeDirectory(const std::string& root, const std::string& path)
+{
+#if defined(__linux__)
+	for (Watches::iterator i = _watches.begin(); i != _watches.end();)
+	{
+		if (i->second.root == root && i->second.path.compare(0, path.length(), path) == 0)
+		{
+			inotify_rm_watch(_fd, i->first);
+			_watches.erase(i++);
+		}
+		else
+		{
+			++i;
+		}
+	}
+#endif
+}
+
+void DirectoryWatcher::readEvents()
+{
+#if defined(__linux__)
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+
+	ssize_t length;
+
+	while ((length = read(_fd, buffer, sizeof(buffer))) > 0)
+	{
+		for (char* pos = buffer; pos < buffer + length;
+			 pos += sizeof(struct inotify_event) + reinterpret_cast<struct inotify_event*>(pos)->len)
+		{
+			const struct inotify_event* event = reinterpret_cast<struct inotify_event*>(pos);
+
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				rWarning() << "[vfs] Too many changes on disk, some of them have been missed" << std::endl;
+				setIncomplete();
+				continue;
+			}
+
+			Watches::iterator found = _watches.find(event->wd);
+
+			if (found == _watches.end()) continue;
+
+			if (event->mask & IN_IGNORED)
+			{
+				// The directory has been removed
+				_watches.erase(found);
+				continue;
+			}
+
+			if (event->len == 0) continue;
+
+			std::string name = found->second.path + event->name;
+
+			if (event->mask & IN_ISDIR)
+			{
+				// Files in removed directories are reported on their own. Files
+				// copied into a new directory before its watch was added are not,
+				// these are picked up while adding the watch.
+				if (event->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					addDirectory(found->second.root, name + "/", true);
+				}
+				else if (event->mask & IN_MOVED_FROM)
+				{
+					// The files of a directory moved away are not reported. Its
+					// watches would keep reporting changes under the old path.
+					_changedFiles.insert(name + "/");
+					removeDirectory(found->second.root, name + "/");
+				}
+
+				continue;
+			}
+
+			_changedFiles.insert(name);
+		}
+	}
+#endif
+
+	// Losing track of changes is reported as well, even without any files
+	if (_changedFiles.empty() && !_reportIncomplete) return;
+
+	// Restart the delay with every batch of events
+	if (_timeoutSource != 0)
+	{
+		g_source_remove(_timeoutSource);
+	}
+
+	_timeoutSource = g_timeout_add(CHANGE_DELAY, onTimeout, this);
+}
+
+void DirectoryWatcher::flushChanges()
+{
+	StringSet changedFiles;
+	changedFiles.swap(_changedFiles);
+
+	if (!changedFiles.empty() || _reportIncomplete)
+	{
+		_reportIncomplete = false;
+		_callback(changedFiles);
+	}
+}
+
+gboolean DirectoryWatcher::onEvents(GIOChannel* source, GIOCondition condition, gpointer data)
+{
+	static_cast<DirectoryWatcher*>(data)->readEvents();
+	return TRUE;
+}
+
+gboolean DirectoryWatcher::onTimeout(gpointer data)
+{
+	DirectoryWatcher* self = static_cast<DirectoryWatcher*>(data);
+
+	self->_timeoutSource = 0;
+	self->flushChanges();
+
+	return FALSE;
+}
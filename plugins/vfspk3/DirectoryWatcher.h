@@ -0,0 +1,90 @@
+#pragma once
+
+#include "imodule.h"
+
+#include <map>
+#include <string>
+#include <glib.h>
+#include <boost/function.hpp>
+
+/**
+ * Watches the loose directories of the VFS for changes to the files in them,
+ * using inotify (on other platforms this class does nothing).
+ *
+ * The changed files are queued and passed to the callback in one batch, once
+ * no further changes came in for a moment. Editors and image tools usually
+ * touch a file several times when saving it. The events are dispatched by the
+ * GLib main loop, so the callback is invoked on the main thread.
+ *
+ * Directories moved away are reported as their path with a trailing slash,
+ * the files in them are not reported on their own.
+ */
+class DirectoryWatcher
+{
+public:
+	// Receives the changed files as VFS paths
+	typedef boost::function<void(const StringSet&)> ChangeCallback;
+
+private:
+	ChangeCallback _callback;
+
+	// The inotify instance and the main loop sources reading from it
+	int _fd;
+	guint _ioSource;
+	guint _timeoutSource;
+
+	// The directory each watch descriptor refers to, relative to its root
+	// and including the trailing slash (empty for the root itself)
+	struct WatchedDirectory
+	{
+		std::string root;
+		std::string path;
+	};
+	typedef std::map<int, WatchedDirectory> Watches;
+	Watches _watches;
+
+	// The changed files not passed to the callback yet
+	StringSet _changedFiles;
+
+	// False once a change might have been missed
+	bool _complete;
+
+	// Set when the callback hasn't been invoked since isComplete() turned false
+	bool _reportIncomplete;
+
+public:
+	DirectoryWatcher(const ChangeCallback& callback);
+	~DirectoryWatcher();
+
+	// Starts watching the given directory (with trailing slash) and all its subdirectories
+	void addRoot(const std::string& root);
+
+	/**
+	 * Returns true if all changes below the roots are reported. This is false
+	 * if watching is not supported, a directory couldn't be watched or the
+	 * kernel dropped events. The callback is invoked (with the files changed
+	 * meanwhile, if any) when this turns false after the roots have been added.
+	 */
+	bool isComplete() const;
+
+private:
+	// Watches the given directory and its subdirectories. If queueFiles is true,
+	// the files already in there are queued as changed, this is used for new
+	// directories, which may have been filled before the watch was added.
+	void addDirectory(const std::string& root, const std::string& path, bool queueFiles);
+
+	// Stops watching the given directory and its subdirectories
+	void removeDirectory(const std::string& root, const std::string& path);
+
+	// Marks the watcher as missing changes, the callback is invoked with the next batch
+	void setIncomplete();
+
+		// Reads the pending events and queues the changed files
+	void readEvents();
+
+	// Passes the queued files to the callback
+	void flushChanges();
+
+	static gboolean onEvents(GIOChannel* source, GIOCondition condition, gpointer data);
+	static gboolean onTimeout(gpointer data);
+};
@@ -63,10 +63,40 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
 
 #include "DirectoryArchive.h"
 #include "SortedFilenames.h"
 
+namespace
+{
+	// Case-insensitive ordering of file names, the same as used by the zip archives
+	struct FileNameLess
+	{
+		bool operator()(const std::string& a, const std::string& b) const
+		{
+			return string_less_nocase(a.c_str(), b.c_str());
+		}
+	};
+
+	// Collects the names of all files in an archive
+	class FileNameCollector :
+		public Archive::Visitor
+	{
+		std::vector<std::string>& _files;
+	public:
+		FileNameCollector(std::vector<std::string>& files) :
+			_files(files)
+		{}
+
+		void visit(const std::string& name)
+		{
+			_files.push_back(name);
+		}
+	};
+}
+
 Doom3FileSystem::Doom3FileSystem() :
     _numDirectories(0)
 {}
@@ -90,7 +120,7 @@ void Doom3FileSystem::initDirectory(const std::string& inputPath)
         entry.name = path;
         entry.archive = DirectoryArchivePtr(new DirectoryArchive(path));
         entry.is_pakfile = false;
-        _archives.push_back(entry);
+        addArchive(entry);
     }
 
     // Instantiate a new sorting container for the filenames
@@ -140,6 +170,10 @@ void Doom3FileSystem::initialise()
         _allowedExtensionsDir.insert(extDir);
     }
 
+    // Watch the loose directories, the index and the observers are kept up
+    // to date with the changes to them
+    _watcher.reset(new DirectoryWatcher(boost::bind(&Doom3FileSystem::onFilesChanged, this, _1)));
+
     // Get the VFS search paths from the game manager
     const game::IGameManager::PathList& paths =
         GlobalGameManager().getVFSSearchPaths();
@@ -151,6 +185,9 @@ void Doom3FileSystem::initialise()
         initDirectory(*i);
     }
 
+    // A directory added later might not be watched completely
+    checkLooseIndex();
+
     for (ObserverList::iterator i = _observers.begin(); i != _observers.end(); ++i)
     {
         (*i)->onFileSystemInitialise();
@@ -165,10 +202,133 @@ void Doom3FileSystem::shutdown() {
 
     rMessage() << "filesystem shutdown" << std::endl;
 
+    _watcher.reset();
+    _fileIndex.clear();
+    _looseArchives.clear();
+    _unindexedArchives.clear();
     _archives.clear();
     _numDirectories = 0;
 }
 
+void Doom3FileSystem::onFilesChanged(const StringSet& filenames)
+{
+    // The watcher reports losing track of changes without any files
+    checkLooseIndex();
+
+    if (filenames.empty()) return;
+
+    rMessage() << "[vfs] " << filenames.size() << " file(s) changed on disk" << std::endl;
+
+    StringSet changedFiles(filenames);
+
+    for (StringSet::const_iterator f = filenames.begin(); f != filenames.end(); ++f)
+    {
+        updateLooseIndex(*f, changedFiles);
+    }
+
+    // The pak files in the search directories are reported as well, reopen
+    // the changed ones. New pak files are picked up on the next VFS refresh.
+    for (StringSet::const_iterator f = filenames.begin(); f != filenames.end(); ++f)
+    {
+        std::string fileExt(os::getExtension(*f));
+        boost::to_lower(fileExt);
+
+        if (_allowedExtensions.find(fileExt) == _allowedExtensions.end())
+        {
+            continue;
+        }
+
+        for (int i = 0; i < _numDirectories; ++i)
+        {
+            invalidateArchive(_directories[i] + *f, changedFiles);
+        }
+    }
+
+    for (ObserverList::iterator i = _observers.begin(); i != _observers.end(); ++i)
+    {
+        (*i)->onFilesChanged(changedFiles);
+    }
+}
+
+void Doom3FileSystem::updateLooseIndex(const std::string& filename, StringSet& changedFiles)
+{
+    bool isDirectory = !filename.empty() && filename[filename.length() - 1] == '/';
+
+    // The observers are told about the files of a moved directory instead
+    if (isDirectory)
+    {
+        changedFiles.erase(filename);
+    }
+
+    // The directories are either all indexed or all asked directly
+    if (!_unindexedArchives.empty())
+    {
+        return;
+    }
+
+    // The watcher doesn't tell which directory the file is in, so each one is
+    // checked. Files in a search path show up in nested pak dirs as well.
+    for (ArchiveCandidates::const_iterator i = _looseArchives.begin(); i != _looseArchives.end(); ++i)
+    {
+        ArchiveDescriptor& descriptor = **i;
+
+        if (!isDirectory)
+        {
+            if (descriptor.archive->containsFile(filename))
+            {
+                addFileToIndex(descriptor, filename);
+            }
+            else
+            {
+                removeFileFromIndex(descriptor, filename);
+            }
+
+            continue;
+        }
+
+        // The files below the directory form a contiguous range in the sorted list
+        std::vector<std::string>::const_iterator first = std::lower_bound(
+            descriptor.files.begin(), descriptor.files.end(), filename, FileNameLess());
+
+        std::vector<std::string> removed;
+
+        for (; first != descriptor.files.end() &&
+               string_equal_nocase_n(first->c_str(), filename.c_str(), filename.length()); ++first)
+        {
+            // Another search path might have a directory of the same name
+            if (first->compare(0, filename.length(), filename) == 0 &&
+                !descriptor.archive->containsFile(*first))
+            {
+                removed.push_back(*first);
+            }
+        }
+
+        for (std::vector<std::string>::const_iterator r = removed.begin(); r != removed.end(); ++r)
+        {
+            removeFileFromIndex(descriptor, *r);
+            changedFiles.insert(*r);
+        }
+    }
+}
+
+void Doom3FileSystem::checkLooseIndex()
+{
+    if (!_watcher || _watcher->isComplete() || _unindexedArchives.size() == _looseArchives.size())
+    {
+        return;
+    }
+
+    rWarning() << "[vfs] Changes to the loose directories might be missed, "
+        << "their files are looked up on disk from now on" << std::endl;
+
+    for (ArchiveCandidates::const_iterator i = _looseArchives.begin(); i != _looseArchives.end(); ++i)
+    {
+        removeFromIndex(**i);
+    }
+
+    _unindexedArchives = _looseArchives;
+}
+
 void Doom3FileSystem::addObserver(Observer& observer) {
     _observers.insert(&observer);
 }
@@ -178,11 +338,13 @@ void Doom3FileSystem::removeObserver(Observer& observer) {
 }
 
 int Doom3FileSystem::getFileCount(const std::string& filename) {
-    int count = 0;
     std::string fixedFilename(os::standardPathWithSlash(filename));
 
-    for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
-        if (i->archive->containsFile(fixedFilename.c_str())) {
+    // Every indexed archive listed for this name contains the file
+    int count = static_cast<int>(findCandidates(fixedFilename).size());
+
+    for (ArchiveCandidates::iterator i = _unindexedArchives.begin(); i != _unindexedArchives.end(); ++i) {
+        if ((*i)->archive->containsFile(fixedFilename)) {
             ++count;
         }
     }
@@ -196,26 +358,58 @@ ArchiveFilePtr Doom3FileSystem::openFile(const std::string& filename) {
         return ArchiveFilePtr();
     }
 
-    for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
-        ArchiveFilePtr file = i->archive->openFile(filename);
+    return openFromArchives(filename, &Archive::openFile);
+}
+
+ArchiveTextFilePtr Doom3FileSystem::openTextFile(const std::string& filename) {
+    return openFromArchives(filename, &Archive::openTextFile);
+}
+
+template<typename FilePtr>
+FilePtr Doom3FileSystem::openFromArchives(const std::string& filename,
+    FilePtr (Archive::*openFunc)(const std::string&))
+{
+    const ArchiveCandidates& indexed = findCandidates(filename);
+
+    // Merge the indexed archives containing the file with the unindexed directories,
+    // which need to be asked in any case, the first one in search order wins
+    ArchiveCandidates::const_iterator i = indexed.begin();
+    ArchiveCandidates::const_iterator loose = _unindexedArchives.begin();
+
+    while (i != indexed.end() || loose != _unindexedArchives.end())
+    {
+        ArchiveDescriptor* descriptor = NULL;
+
+        if (i == indexed.end() ||
+            (loose != _unindexedArchives.end() && (*loose)->priority < (*i)->priority))
+        {
+            descriptor = *loose++;
+        }
+        else
+        {
+            descriptor = *i++;
+        }
+
+        // Directories are opened with the name found on disk
+        FilePtr file = ((*descriptor->archive).*openFunc)(
+            descriptor->is_pakfile ? filename : getIndexedName(*descriptor, filename));
+
         if (file != NULL) {
             return file;
         }
     }
 
     // not found
-    return ArchiveFilePtr();
+    return FilePtr();
 }
 
-ArchiveTextFilePtr Doom3FileSystem::openTextFile(const std::string& filename) {
-    for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
-        ArchiveTextFilePtr file = i->archive->openTextFile(filename);
-        if (file != NULL) {
-            return file;
-        }
-    }
+const Doom3FileSystem::ArchiveCandidates& Doom3FileSystem::findCandidates(const std::string& filename) const
+{
+    static const ArchiveCandidates _emptyCandidates;
+
+    FileIndex::const_iterator found = _fileIndex.find(boost::algorithm::to_lower_copy(filename));
 
-    return ArchiveTextFilePtr();
+    return found != _fileIndex.end() ? found->second : _emptyCandidates;
 }
 
 std::size_t Doom3FileSystem::loadFile(const std::string& filename, void **buffer) {
@@ -259,28 +453,97 @@ void Doom3FileSystem::forEachFile(const std::string& basedir,
     // Wrap around the passed visitor
     FileVisitor visitor2(visitor, basedir, extension, visitedFiles);
 
+    // Indexed archives are visited from their sorted file lists, this is
+    // only possible for directory names (or the root)
+    bool useIndex = basedir.empty() || basedir[basedir.length() - 1] == '/';
+
+    // The directories are either all indexed or all asked directly
+    bool looseIndexed = _unindexedArchives.empty();
+
     // Visit each Archive, applying the FileVisitor to each one (which in
     // turn calls the callback for each matching file.
     for (ArchiveList::iterator i = _archives.begin();
          i != _archives.end();
          ++i)
     {
+        if ((i->is_pakfile || looseIndexed) && useIndex)
+        {
+            visitIndexedFiles(*i, visitor2, basedir, depth);
+            continue;
+        }
+
         i->archive->forEachFile(
                         Archive::VisitorFunc(
                                 visitor2, Archive::eFiles, depth), basedir);
     }
 }
 
+void Doom3FileSystem::visitIndexedFiles(const ArchiveDescriptor& descriptor,
+    Archive::Visitor& visitor, const std::string& basedir, std::size_t depth)
+{
+    // The files below basedir form a contiguous range in the sorted list
+    std::vector<std::string>::const_iterator i = std::lower_bound(
+        descriptor.files.begin(), descriptor.files.end(), basedir, FileNameLess());
+
+    for (; i != descriptor.files.end() &&
+           string_equal_nocase_n(i->c_str(), basedir.c_str(), basedir.length()); ++i)
+    {
+        // Apply the same depth limit as the archive traversal: a depth of 1
+        // means no subdirectories, 0 means unlimited depth
+        if (depth > 0 &&
+            static_cast<std::size_t>(std::count(i->begin() + basedir.length(), i->end(), '/')) >= depth)
+        {
+            continue;
+        }
+
+        visitor.visit(*i);
+    }
+}
+
 std::string Doom3FileSystem::findFile(const std::string& name) {
-    for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
-        if (!i->is_pakfile && i->archive->containsFile(name.c_str())) {
-            return i->name;
+    const ArchiveCandidates& indexed = findCandidates(name);
+
+    for (ArchiveCandidates::const_iterator i = indexed.begin(); i != indexed.end(); ++i) {
+        if (!(*i)->is_pakfile) {
+            return (*i)->name;
+        }
+    }
+
+    for (ArchiveCandidates::iterator i = _unindexedArchives.begin(); i != _unindexedArchives.end(); ++i) {
+        if ((*i)->archive->containsFile(name)) {
+            return (*i)->name;
         }
     }
 
     return "";
 }
 
+std::string Doom3FileSystem::findPhysicalFile(const std::string& filename)
+{
+    const ArchiveCandidates& indexed = findCandidates(filename);
+
+    // Same search order as openFromArchives()
+    ArchiveCandidates::const_iterator i = indexed.begin();
+    ArchiveCandidates::const_iterator loose = _unindexedArchives.begin();
+
+    while (loose != _unindexedArchives.end() &&
+           (i == indexed.end() || (*loose)->priority < (*i)->priority))
+    {
+        if ((*loose)->archive->containsFile(filename)) {
+            return (*loose)->name + filename;
+        }
+
+        ++loose;
+    }
+
+    if (i == indexed.end()) {
+        return "";
+    }
+
+    // The indexed archives are known to contain the file
+    return (*i)->is_pakfile ? (*i)->name : (*i)->name + getIndexedName(**i, filename);
+}
+
 std::string Doom3FileSystem::findRoot(const std::string& name) {
     for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i) {
         if (!i->is_pakfile && path_equal_n(name.c_str(), i->name.c_str(), i->name.size())) {
@@ -304,7 +567,7 @@ void Doom3FileSystem::initPakFile(ArchiveLoader& archiveModule, const std::strin
         entry.name = filename;
         entry.archive = archiveModule.openArchive(filename);
         entry.is_pakfile = true;
-        _archives.push_back(entry);
+        addArchive(entry);
 
         rMessage() << "[vfs] pak file: " << filename << std::endl;
     }
@@ -317,12 +580,178 @@ void Doom3FileSystem::initPakFile(ArchiveLoader& archiveModule, const std::strin
         entry.name = path;
         entry.archive = DirectoryArchivePtr(new DirectoryArchive(path));
         entry.is_pakfile = false;
-        _archives.push_back(entry);
+        addArchive(entry);
 
         rMessage() << "[vfs] pak dir:  " << path << std::endl;
     }
 }
 
+void Doom3FileSystem::addArchive(const ArchiveDescriptor& entry)
+{
+    _archives.push_back(entry);
+
+    ArchiveDescriptor& descriptor = _archives.back();
+    descriptor.priority = _archives.size();
+
+    if (descriptor.is_pakfile)
+    {
+        addToIndex(descriptor);
+        return;
+    }
+
+    _looseArchives.push_back(&descriptor);
+
+    // Directories are indexed as long as the watcher reports all changes to them,
+    // the watch is added first so that nothing changing meanwhile is missed
+    _watcher->addRoot(descriptor.name);
+
+    if (_watcher->isComplete())
+    {
+        addToIndex(descriptor);
+    }
+    else
+    {
+        _unindexedArchives.push_back(&descriptor);
+    }
+}
+
+void Doom3FileSystem::invalidateArchive(const std::string& archiveName, StringSet& changedFiles)
+{
+    for (ArchiveList::iterator i = _archives.begin(); i != _archives.end(); ++i)
+    {
+        if (!i->is_pakfile || i->name != archiveName)
+        {
+            continue;
+        }
+
+        changedFiles.insert(i->files.begin(), i->files.end());
+        removeFromIndex(*i);
+
+        // The open archive still refers to the old file contents, a deleted
+        // or unreadable file leaves an empty archive behind
+        i->archive = GlobalArchive("PK4").openArchive(archiveName);
+
+        addToIndex(*i);
+        changedFiles.insert(i->files.begin(), i->files.end());
+
+        rMessage() << "[vfs] reloaded pak file: " << archiveName << std::endl;
+        return;
+    }
+}
+
+void Doom3FileSystem::addToIndex(ArchiveDescriptor& descriptor)
+{
+    FileNameCollector collector(descriptor.files);
+
+    // A depth of 0 never matches a directory, the whole tree is traversed
+    descriptor.archive->forEachFile(Archive::VisitorFunc(collector, Archive::eFiles, 0), "");
+
+    std::sort(descriptor.files.begin(), descriptor.files.end(), FileNameLess());
+
+    for (std::vector<std::string>::const_iterator f = descriptor.files.begin();
+         f != descriptor.files.end(); ++f)
+    {
+        addCandidate(*f, descriptor);
+    }
+}
+
+void Doom3FileSystem::addCandidate(const std::string& filename, ArchiveDescriptor& descriptor)
+{
+    ArchiveCandidates& candidates = _fileIndex[boost::algorithm::to_lower_copy(filename)];
+
+    // Archives are usually indexed in search order, so this is mostly an append
+    ArchiveCandidates::iterator pos = candidates.end();
+
+    while (pos != candidates.begin() && (*(pos - 1))->priority > descriptor.priority)
+    {
+        --pos;
+    }
+
+    // Names differing in case only map to the same entry
+    if (pos == candidates.begin() || *(pos - 1) != &descriptor)
+    {
+        candidates.insert(pos, &descriptor);
+    }
+}
+
+void Doom3FileSystem::removeFromIndex(ArchiveDescriptor& descriptor)
+{
+    for (std::vector<std::string>::const_iterator f = descriptor.files.begin();
+         f != descriptor.files.end(); ++f)
+    {
+        removeCandidate(*f, descriptor);
+    }
+
+    descriptor.files.clear();
+}
+
+void Doom3FileSystem::removeCandidate(const std::string& filename, ArchiveDescriptor& descriptor)
+{
+    FileIndex::iterator found = _fileIndex.find(boost::algorithm::to_lower_copy(filename));
+
+    if (found == _fileIndex.end()) return;
+
+    ArchiveCandidates& candidates = found->second;
+    candidates.erase(std::remove(candidates.begin(), candidates.end(), &descriptor), candidates.end());
+
+    if (candidates.empty())
+    {
+        _fileIndex.erase(found);
+    }
+}
+
+void Doom3FileSystem::addFileToIndex(ArchiveDescriptor& descriptor, const std::string& filename)
+{
+    std::pair<std::vector<std::string>::iterator, std::vector<std::string>::iterator> range =
+        std::equal_range(descriptor.files.begin(), descriptor.files.end(), filename, FileNameLess());
+
+    if (std::find(range.first, range.second, filename) != range.second)
+    {
+        return; // already indexed
+    }
+
+    descriptor.files.insert(range.second, filename);
+    addCandidate(filename, descriptor);
+}
+
+void Doom3FileSystem::removeFileFromIndex(ArchiveDescriptor& descriptor, const std::string& filename)
+{
+    std::pair<std::vector<std::string>::iterator, std::vector<std::string>::iterator> range =
+        std::equal_range(descriptor.files.begin(), descriptor.files.end(), filename, FileNameLess());
+
+    std::vector<std::string>::iterator found = std::find(range.first, range.second, filename);
+
+    if (found == range.second)
+    {
+        return; // not indexed
+    }
+
+    // The index entry is shared with the names differing in case only
+    bool otherNames = range.second - range.first > 1;
+
+    descriptor.files.erase(found);
+
+    if (!otherNames)
+    {
+        removeCandidate(filename, descriptor);
+    }
+}
+
+const std::string& Doom3FileSystem::getIndexedName(const ArchiveDescriptor& descriptor,
+    const std::string& filename)
+{
+    std::pair<std::vector<std::string>::const_iterator, std::vector<std::string>::const_iterator> range =
+        std::equal_range(descriptor.files.begin(), descriptor.files.end(), filename, FileNameLess());
+
+    // Prefer the exact name, in case there are several differing in case
+    if (range.first == range.second || std::find(range.first, range.second, filename) != range.second)
+    {
+        return filename;
+    }
+
+    return *range.first;
+}
+
 // RegisterableModule implementation
 const std::string& Doom3FileSystem::getName() const {
     static std::string _name(MODULE_VIRTUALFILESYSTEM);
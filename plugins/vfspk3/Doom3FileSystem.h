@@ -32,8 +32,12 @@
 #define INCLUDED_VFS_H
 
 #include <list>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <boost/scoped_ptr.hpp>
 #include "iarchive.h"
 #include "ifilesystem.h"
+#include "DirectoryWatcher.h"
 
 #define VFS_MAXDIRS 8
 
@@ -49,14 +53,38 @@ class Doom3FileSystem :
 		std::string name;
 		ArchivePtr archive;
 		bool is_pakfile;
+
+		// Position in the search order, lower values are searched first
+		std::size_t priority;
+
+		// The files of an indexed archive, sorted case-insensitively
+		std::vector<std::string> files;
 	};
 
 	typedef std::list<ArchiveDescriptor> ArchiveList;
 	ArchiveList _archives;
 
+	typedef std::vector<ArchiveDescriptor*> ArchiveCandidates;
+
+	// Directory archives in search order
+	ArchiveCandidates _looseArchives;
+
+	// The directory archives which are not indexed and need to be asked directly,
+	// because the watcher can't report all the changes to them
+	ArchiveCandidates _unindexedArchives;
+
+	// Maps the lowercase name of each file in the pak archives and the watched
+	// directories to the archives containing it, in search order. The list
+	// nodes are stable, so the descriptors can be referenced by pointer.
+	typedef boost::unordered_map<std::string, ArchiveCandidates> FileIndex;
+	FileIndex _fileIndex;
+
 	typedef std::set<Observer*> ObserverList;
 	ObserverList _observers;
 
+	// Reports the changes to the files in the loose directories
+	boost::scoped_ptr<DirectoryWatcher> _watcher;
+
 public:
 	// Constructor
 	Doom3FileSystem();
@@ -78,6 +106,7 @@ public:
 		Visitor& visitor, std::size_t depth);
 
 	std::string findFile(const std::string& name);
+	std::string findPhysicalFile(const std::string& filename);
 	std::string findRoot(const std::string& name);
 
 	virtual void addObserver(Observer& observer);
@@ -90,6 +119,53 @@ public:
 
 private:
 	void initPakFile(ArchiveLoader& archiveModule, const std::string& filename);
+
+	void addArchive(const ArchiveDescriptor& entry);
+
+	// Passes the changed files reported by the watcher on to the observers
+	void onFilesChanged(const StringSet& filenames);
+
+	// Updates the index of the directory archives with the given changed
+	// file or moved directory (trailing slash). The files of a moved
+	// directory are added to the given set.
+	void updateLooseIndex(const std::string& filename, StringSet& changedFiles);
+
+	// Takes the directory archives out of the index once the watcher might
+	// have missed a change to them, they are asked directly from then on
+	void checkLooseIndex();
+
+	// Reopens the given pak file (as passed to initPakFile) after it has been
+	// changed on disk and re-reads it into the index. The files it contained
+	// before and after are added to the given set.
+	void invalidateArchive(const std::string& archiveName, StringSet& changedFiles);
+
+	void addToIndex(ArchiveDescriptor& descriptor);
+	void removeFromIndex(ArchiveDescriptor& descriptor);
+
+	// Adds the archive to the index entry of the given file, in search order
+	void addCandidate(const std::string& filename, ArchiveDescriptor& descriptor);
+	void removeCandidate(const std::string& filename, ArchiveDescriptor& descriptor);
+
+	// Adds or removes a single file of an indexed archive
+	void addFileToIndex(ArchiveDescriptor& descriptor, const std::string& filename);
+	void removeFileFromIndex(ArchiveDescriptor& descriptor, const std::string& filename);
+
+	// Returns the name of the given file as stored in the index of the archive,
+	// which is the name on disk for directory archives
+	static const std::string& getIndexedName(const ArchiveDescriptor& descriptor,
+		const std::string& filename);
+
+	// Returns the indexed archives containing the given file, in search order
+	const ArchiveCandidates& findCandidates(const std::string& filename) const;
+
+	// Returns the file from the first archive (indexed or loose) it can be opened from
+	template<typename FilePtr>
+	FilePtr openFromArchives(const std::string& filename,
+		FilePtr (Archive::*openFunc)(const std::string&));
+
+	// Visits the files of an indexed archive below the given directory
+	void visitIndexedFiles(const ArchiveDescriptor& descriptor, Archive::Visitor& visitor,
+		const std::string& basedir, std::size_t depth);
 };
 typedef boost::shared_ptr<Doom3FileSystem> Doom3FileSystemPtr;
 
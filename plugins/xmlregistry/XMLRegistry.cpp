@@ -1,6 +1,7 @@
 #include "XMLRegistry.h"		// The Abstract Base Class
 
 #include <iostream>
+#include <algorithm>
 #include <stdexcept>
 #include "itextstream.h"
 
@@ -11,15 +12,28 @@
 #include "string/string.h"
 #include "gtkutil/IConv.h"
 
+namespace
+{
+	// Keys looked up this often without the cache are reported on shutdown
+	const std::size_t UNCACHED_QUERY_REPORT_THRESHOLD = 10;
+
+	// Characters marking a key as XPath expression rather than a plain path
+	const char* const XPATH_SYNTAX_CHARS = "[]*@()|:. ";
+}
+
 XMLRegistry::XMLRegistry() :
 	_topLevelNode("darkradiant"),
 	_standardTree(_topLevelNode),
 	_userTree(_topLevelNode),
-	_queryCounter(0)
+	_queryCounter(0),
+	_uncachedQueryCounter(0)
 {}
 
 XMLRegistry::~XMLRegistry() {
-	rMessage() << "XMLRegistry Shutdown: " << _queryCounter << " queries processed.\n";
+	rMessage() << "XMLRegistry Shutdown: " << _queryCounter << " queries processed, "
+		<< _uncachedQueryCounter << " values looked up without the cache.\n";
+
+	reportUncachedQueries();
 
 	// Don't save these paths into the xml files.
 	deleteXPath(RKEY_APP_PATH);
@@ -63,7 +77,15 @@ XMLRegistry::~XMLRegistry() {
 	}
 }
 
-xml::NodeList XMLRegistry::findXPath(const std::string& path) {
+xml::NodeList XMLRegistry::findXPath(const std::string& path)
+{
+	// The returned nodes might be extended by the caller
+	invalidateCache(path);
+
+	return queryTrees(path);
+}
+
+xml::NodeList XMLRegistry::queryTrees(const std::string& path) {
 	// Query the user tree first
 	xml::NodeList results = _userTree.findXPath(path);
 	xml::NodeList stdResults = _standardTree.findXPath(path);
@@ -98,14 +120,16 @@ const
 }
 
 bool XMLRegistry::keyExists(const std::string& key) {
-	// Pass the query on to findXPath which queries the subtrees
-	xml::NodeList result = findXPath(key);
+	// Pass the query on to queryTrees which queries the subtrees
+	xml::NodeList result = queryTrees(key);
 	return (!result.empty());
 }
 
 void XMLRegistry::deleteXPath(const std::string& path) {
+	invalidateCache(path);
+
 	// Add the toplevel node to the path if required
-	xml::NodeList nodeList = findXPath(path);
+	xml::NodeList nodeList = queryTrees(path);
 
 	for (std::size_t i = 0; i < nodeList.size(); i++) {
 		// unlink and delete the node
@@ -117,25 +141,31 @@ xml::Node XMLRegistry::createKeyWithName(const std::string& path,
 										 const std::string& key,
 										 const std::string& name)
 {
+	invalidateCache(path);
+
 	// The key will be created in the user tree (the default tree is read-only)
 	return _userTree.createKeyWithName(path, key, name);
 }
 
 xml::Node XMLRegistry::createKey(const std::string& key) {
+	invalidateCache(key);
+
 	return _userTree.createKey(key);
 }
 
 void XMLRegistry::setAttribute(const std::string& path,
 	const std::string& attrName, const std::string& attrValue)
 {
+	invalidateCache(path);
+
 	_userTree.setAttribute(path, attrName, attrValue);
 }
 
 std::string XMLRegistry::getAttribute(const std::string& path,
 									  const std::string& attrName)
 {
-	// Pass the query to the findXPath method, which queries the user tree first
-	xml::NodeList nodeList = findXPath(path);
+	// Pass the query to the queryTrees method, which queries the user tree first
+	xml::NodeList nodeList = queryTrees(path);
 
 	if (nodeList.empty())
 	{
@@ -146,21 +176,38 @@ std::string XMLRegistry::getAttribute(const std::string& path,
 }
 
 std::string XMLRegistry::get(const std::string& key) {
-	// Pass the query to the findXPath method, which queries the user tree first
-	xml::NodeList nodeList = findXPath(key);
+	std::string cacheKey = getCacheKey(key);
+
+	if (!cacheKey.empty())
+	{
+		ValueCache::const_iterator cached = _valueCache.find(cacheKey);
+
+		if (cached != _valueCache.end())
+		{
+			_queryCounter++;
+			return cached->second;
+		}
+	}
+
+	_uncachedQueryCounter++;
+	_uncachedQueries[key]++;
+
+	// Pass the query to the queryTrees method, which queries the user tree first
+	xml::NodeList nodeList = queryTrees(key);
 
 	// Does it even exist?
 	// It may well be the case that this returns two or more nodes that match the key criteria
 	// This function always uses the first one, as the user tree should override the default tree
-	if (!nodeList.empty())
+	// Convert the UTF-8 string back to locale, missing keys yield an empty string
+	std::string value = !nodeList.empty() ?
+		gtkutil::IConv::localeFromUTF8(nodeList[0].getAttributeValue("value")) : "";
+
+	if (!cacheKey.empty())
 	{
-		// Convert the UTF-8 string back to locale and return
-		return gtkutil::IConv::localeFromUTF8(nodeList[0].getAttributeValue("value"));
-	}
-	else {
-		//rMessage() << "XMLRegistry: GET: Key " << fullKey.c_str() << " not found, returning empty string!\n";
-		return "";
+		_valueCache[cacheKey] = value;
 	}
+
+	return value;
 }
 
 void XMLRegistry::set(const std::string& key, const std::string& value) {
@@ -168,11 +215,25 @@ void XMLRegistry::set(const std::string& key, const std::string& value) {
 	// Convert the string to UTF-8 before storing it into the RegistryTree
 	_userTree.set(key, gtkutil::IConv::localeToUTF8(value));
 
+	std::string cacheKey = getCacheKey(key);
+
+	if (!cacheKey.empty())
+	{
+		_valueCache[cacheKey] = value;
+	}
+	else
+	{
+		invalidateCache(key);
+	}
+
 	// Notify the observers
 	emitSignalForKey(key);
 }
 
 void XMLRegistry::import(const std::string& importFilePath, const std::string& parentKey, Tree tree) {
+	// Imported keys overwrite previous ones
+	invalidateCache();
+
 	switch (tree) {
 		case treeUser:
 			_userTree.importFromFile(importFilePath, parentKey);
@@ -193,6 +254,93 @@ void XMLRegistry::emitSignalForKey(const std::string& changedKey)
     }
 }
 
+std::string XMLRegistry::getRelativeKey(const std::string& key) const
+{
+	// Absolute paths below the toplevel node refer to the same nodes as relative ones
+	if (key.size() > _topLevelNode.size() + 2 && key[0] == '/' &&
+		key.compare(1, _topLevelNode.size(), _topLevelNode) == 0 &&
+		key[_topLevelNode.size() + 1] == '/')
+	{
+		return key.substr(_topLevelNode.size() + 2);
+	}
+
+	return key;
+}
+
+std::string XMLRegistry::getCacheKey(const std::string& key) const
+{
+	std::string relative = getRelativeKey(key);
+
+	// Only plain paths are cached. A key using XPath syntax might refer to the
+	// same node as some other key, whose cached value set() wouldn't update.
+	if (relative.empty() || relative[0] == '/' || relative[relative.size() - 1] == '/' ||
+		relative.find("//") != std::string::npos ||
+		relative.find_first_of(XPATH_SYNTAX_CHARS) != std::string::npos)
+	{
+		return "";
+	}
+
+	return relative;
+}
+
+void XMLRegistry::invalidateCache()
+{
+	_valueCache.clear();
+}
+
+void XMLRegistry::invalidateCache(const std::string& path)
+{
+	std::string relative = getRelativeKey(path);
+
+	// Only the complete path components in front of any XPath syntax are plain,
+	// all nodes the path can refer to are located below these
+	std::size_t end = std::min(relative.find_first_of(XPATH_SYNTAX_CHARS), relative.find("//"));
+
+	if (end != std::string::npos)
+	{
+		std::size_t slash = relative.rfind('/', end);
+		relative = (slash != std::string::npos) ? relative.substr(0, slash) : "";
+	}
+	else if (!relative.empty() && relative[relative.size() - 1] == '/')
+	{
+		relative.resize(relative.size() - 1);
+	}
+
+	// Paths starting with a slash can refer to nodes anywhere in the trees
+	if (relative.empty() || relative[0] == '/')
+	{
+		_valueCache.clear();
+		return;
+	}
+
+	for (ValueCache::iterator i = _valueCache.begin(); i != _valueCache.end(); /* in-loop increment */)
+	{
+		const std::string& key = i->first;
+
+		if (key.compare(0, relative.size(), relative) == 0 &&
+			(key.size() == relative.size() || key[relative.size()] == '/'))
+		{
+			i = _valueCache.erase(i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+void XMLRegistry::reportUncachedQueries() const
+{
+	for (UncachedQueries::const_iterator i = _uncachedQueries.begin(); i != _uncachedQueries.end(); ++i)
+	{
+		if (i->second >= UNCACHED_QUERY_REPORT_THRESHOLD)
+		{
+			rMessage() << "XMLRegistry: " << i->first << " looked up "
+				<< i->second << " times without the cache.\n";
+		}
+	}
+}
+
 // RegisterableModule implementation
 const std::string& XMLRegistry::getName() const {
 	static std::string _name(MODULE_XMLREGISTRY);
@@ -24,6 +24,7 @@
 
 #include "iregistry.h"		// The Abstract Base Class
 #include <map>
+#include <boost/unordered_map.hpp>
 
 #include "imodule.h"
 #include "RegistryTree.h"
@@ -50,6 +51,19 @@ private:
 	// The query counter for some statistics :)
 	unsigned int _queryCounter;
 
+	// The values returned by get() for plain keys (without XPath syntax),
+	// indexed by the key relative to the toplevel node. set() updates the
+	// cached value, any other change to the trees drops the cached values
+	// below the changed path.
+	typedef boost::unordered_map<std::string, std::string> ValueCache;
+	ValueCache _valueCache;
+
+	// The number of get() calls which had to evaluate the XPath, per key.
+	// Frequently repeated keys are reported on shutdown.
+	typedef std::map<std::string, std::size_t> UncachedQueries;
+	UncachedQueries _uncachedQueries;
+	unsigned int _uncachedQueryCounter;
+
 public:
 	/* Constructor:
 	 * Creates two empty RegistryTrees in the memory with the default toplevel node
@@ -115,6 +129,22 @@ public:
 
 private:
 	void emitSignalForKey(const std::string& changedKey);
+
+	// Queries both trees without invalidating the value cache
+	xml::NodeList queryTrees(const std::string& path);
+
+	// Strips the toplevel node from absolute keys
+	std::string getRelativeKey(const std::string& key) const;
+
+	// Returns the key the value cache uses for the given key, or an empty
+	// string if the key contains XPath syntax and can't be cached
+	std::string getCacheKey(const std::string& key) const;
+
+	void invalidateCache();
+
+	// Drops the cached values of all keys the given XPath might refer to
+	void invalidateCache(const std::string& path);
+	void reportUncachedQueries() const;
 };
 typedef boost::shared_ptr<XMLRegistry> XMLRegistryPtr;
 
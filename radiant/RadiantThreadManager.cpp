@@ -1,5 +1,7 @@
 #include "RadiantThreadManager.h"
 
+#include <stdexcept>
+
 namespace radiant
 {
 
@@ -9,8 +11,92 @@ namespace
     {
         func();
     }
+
+    std::size_t getNumProcessors()
+    {
+        std::size_t numProcessors = static_cast<std::size_t>(g_get_num_processors());
+
+        return numProcessors > 0 ? numProcessors : 1;
+    }
+
+    // The state of a single executeAndWait() call, shared with the workers.
+    // Workers might pick up their task after the call returned, so they
+    // must not touch the jobs once all of them have been taken.
+    struct JobBatch
+    {
+        const ThreadManager::Jobs& jobs;
+        std::size_t numJobs;
+
+        Glib::Mutex mutex;
+
+        // Signalled when the last job has finished
+        Glib::Cond finished;
+
+        std::size_t nextJob;
+        std::size_t numRunning;
+
+        // The first error message thrown by a job
+        std::string errorMessage;
+
+        JobBatch(const ThreadManager::Jobs& jobs_) :
+            jobs(jobs_),
+            numJobs(jobs_.size()),
+            nextJob(0),
+            numRunning(0)
+        {}
+    };
+    typedef boost::shared_ptr<JobBatch> JobBatchPtr;
+
+    // Processes the jobs of the batch until none are left
+    void processJobs(JobBatchPtr batch)
+    {
+        while (true)
+        {
+            std::size_t index;
+
+            {
+                Glib::Mutex::Lock lock(batch->mutex);
+
+                if (batch->nextJob == batch->numJobs)
+                {
+                    return;
+                }
+
+                index = batch->nextJob++;
+                ++batch->numRunning;
+            }
+
+            std::string errorMessage;
+
+            try
+            {
+                batch->jobs[index]();
+            }
+            catch (std::exception& ex)
+            {
+                errorMessage = ex.what();
+            }
+
+            Glib::Mutex::Lock lock(batch->mutex);
+
+            if (!errorMessage.empty() && batch->errorMessage.empty())
+            {
+                batch->errorMessage = errorMessage;
+            }
+
+            if (--batch->numRunning == 0 && batch->nextJob == batch->numJobs)
+            {
+                batch->finished.signal();
+            }
+        }
+    }
 }
 
+RadiantThreadManager::RadiantThreadManager() :
+    // The calling thread of executeAndWait() is one of the workers
+    _workers(static_cast<int>(std::max<std::size_t>(getNumProcessors(), 2) - 1), true)
+{}
+
 void RadiantThreadManager::execute(boost::function<void()> func) const
 {
     // Use adapter function to call our boost::function in a thread (since
@@ -18,4 +104,47 @@ void RadiantThreadManager::execute(boost::function<void()> func) const
     _pool.push(sigc::bind(sigc::ptr_fun(&runFuncInThread), func));
 }
 
+void RadiantThreadManager::executeAndWait(const Jobs& jobs) const
+{
+    if (jobs.empty())
+    {
+        return;
+    }
+
+    JobBatchPtr batch(new JobBatch(jobs));
+
+    // No need to involve any threads for a single job
+    std::size_t numHelpers = std::min(jobs.size() - 1,
+                                      static_cast<std::size_t>(_workers.get_max_threads()));
+
+    for (std::size_t i = 0; i < numHelpers; ++i)
+    {
+        _workers.push(sigc::bind(sigc::ptr_fun(&processJobs), batch));
+    }
+
+    // Work on the batch ourselves, this also makes nested calls safe,
+    // even if all workers are busy
+    processJobs(batch);
+
+    {
+        Glib::Mutex::Lock lock(batch->mutex);
+
+        // Wait for the jobs still running on the workers
+        while (batch->numRunning > 0)
+        {
+            batch->finished.wait(batch->mutex);
+        }
+    }
+
+    if (!batch->errorMessage.empty())
+    {
+        throw std::runtime_error(batch->errorMessage);
+    }
+}
+
+std::size_t RadiantThreadManager::getNumWorkers() const
+{
+    return getNumProcessors();
+}
+
 }
@@ -11,10 +11,17 @@ class RadiantThreadManager : public ThreadManager
     // The threadpool we use for executing jobs
     mutable Glib::ThreadPool _pool;
 
+    // The persistent worker threads processing the jobs of executeAndWait(),
+    // separate from the above, which might be busy with long-running tasks
+    mutable Glib::ThreadPool _workers;
+
 public:
+    RadiantThreadManager();
 
     // ThreadManager implementation
     void execute(boost::function<void()>) const;
+    void executeAndWait(const Jobs& jobs) const;
+    std::size_t getNumWorkers() const;
 };
 
 }
@@ -4,6 +4,9 @@
 #include "irenderable.h"
 #include "itextstream.h"
 #include "iuimanager.h"
+#include "ifilter.h"
+#include "iradiant.h"
+#include "ithread.h"
 #include "shaderlib.h"
 
 #include "BrushModule.h"
@@ -12,6 +15,8 @@
 #include "FixedWinding.h"
 #include "ui/surfaceinspector/SurfaceInspector.h"
 
+#include <boost/bind.hpp>
+
 namespace {
     /// \brief Returns true if edge (\p x, \p y) is smaller than the epsilon used to classify winding points against a plane.
     inline bool Edge_isDegenerate(const Vector3& x, const Vector3& y) {
@@ -32,6 +37,20 @@ namespace {
     {
         return std::max(std::max(extents[0], extents[1]), extents[2]);
     }
+
+    // Below this number of changed brushes the B-Reps are built on the main thread
+    const std::size_t MIN_BREPS_FOR_WORKER_THREADS = 16;
+
+    void evaluateBRepRange(const std::vector<IBrush*>& brushes, std::size_t first, std::size_t last)
+    {
+        // The brushes of a range share the winding storage
+        FixedWindingPool pool;
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            static_cast<Brush*>(brushes[i])->evaluateBRep(pool);
+        }
+    }
 }
 
 const std::size_t Brush::PRISM_MIN_SIDES = 3;
@@ -75,6 +94,8 @@ Brush::Brush(BrushNode& owner, const Brush& other, const Callback& evaluateTrans
 
 Brush::~Brush() {
     ASSERT_MESSAGE(m_observers.empty(), "Brush::~Brush: observers still attached");
+
+    getChangedBrushes().erase(this);
 }
 
 BrushNode& Brush::getBrushNode()
@@ -181,6 +202,11 @@ void Brush::instanceDetach(MapFile* map)
 
 // observer
 void Brush::planeChanged() {
+    if (!m_planeChanged)
+    {
+        getChangedBrushes().insert(this);
+    }
+
     m_planeChanged = true;
     aabbChanged();
     _owner.lightsChanged();
@@ -190,6 +216,9 @@ void Brush::shaderChanged()
 {
     planeChanged();
 
+    // Keep the filter system's material index current
+    GlobalFilterSystem().onShaderChanged(_owner);
+
     // Queue an UI update of the texture tools
     ui::SurfaceInspector::update();
 }
@@ -235,10 +264,71 @@ void Brush::updateFaceVisibility()
 }
 
 void Brush::evaluateBRep() const {
+    if(m_planeChanged) {
+        FixedWindingPool pool;
+        evaluateBRep(pool);
+    }
+}
+
+void Brush::evaluateBRep(FixedWindingPool& pool) const {
     if(m_planeChanged) {
         m_planeChanged = false;
-        const_cast<Brush*>(this)->buildBRep();
+        const_cast<Brush*>(this)->buildBRep(pool);
+    }
+}
+
+Brush::BrushSet& Brush::getChangedBrushes()
+{
+    static BrushSet _changedBrushes;
+    return _changedBrushes;
+}
+
+void Brush::evaluateChangedBReps()
+{
+    BrushSet& changed = getChangedBrushes();
+
+    if (changed.empty()) return;
+
+    // Evaluating the transforms might call back into the scene, do this here
+    for (BrushSet::const_iterator i = changed.begin(); i != changed.end(); ++i)
+    {
+        (*i)->evaluateTransform();
+    }
+
+    // Brushes which have been evaluated in the meantime are skipped
+    std::vector<IBrush*> brushes;
+    brushes.reserve(changed.size());
+
+    for (BrushSet::const_iterator i = changed.begin(); i != changed.end(); ++i)
+    {
+        if ((*i)->m_planeChanged)
+        {
+            brushes.push_back(*i);
+        }
+    }
+
+    changed.clear();
+
+    try
+    {
+        evaluateBReps(brushes);
+    }
+    catch (std::runtime_error& e)
+    {
+        rError() << "Failed to evaluate brushes: " << e.what() << std::endl;
+    }
+}
+
+void Brush::evaluateBReps(const std::vector<IBrush*>& brushes)
+{
+    if (brushes.size() < MIN_BREPS_FOR_WORKER_THREADS)
+    {
+        evaluateBRepRange(brushes, 0, brushes.size());
+        return;
     }
+
+    GlobalRadiant().getThreadManager().executeInChunks(brushes.size(),
+        boost::bind(&evaluateBRepRange, boost::cref(brushes), _1, _2));
 }
 
 void Brush::transformChanged() {
@@ -512,9 +602,23 @@ void Brush::removeEmptyFaces() {
 
 /// \brief Constructs \p winding from the intersection of \p plane with the other planes of the brush.
 void Brush::windingForClipPlane(Winding& winding, const Plane3& plane) const {
-    FixedWinding buffer[2];
+    FixedWindingPool pool;
+
+    std::vector<bool> uniquePlanes(m_faces.size());
+
+    for (std::size_t i = 0; i < m_faces.size(); ++i) {
+        uniquePlanes[i] = plane_unique(i);
+    }
+
+    windingForClipPlane(winding, plane, pool.getBuffers(m_faces.size()), uniquePlanes);
+}
+
+void Brush::windingForClipPlane(Winding& winding, const Plane3& plane,
+                                FixedWinding* buffer, const std::vector<bool>& uniquePlanes) const {
     bool swap = false;
 
+    buffer[swap].clear();
+
     // get a poly that covers an effectively infinite area
     buffer[swap].createInfinite(plane, m_maxWorldCoord + 1);
 
@@ -524,7 +628,7 @@ void Brush::windingForClipPlane(Winding& winding, const Plane3& plane) const {
             const Face& clip = *m_faces[i];
 
             if (clip.plane3() == plane
-                || !clip.plane3().isValid() || !plane_unique(i)
+                || !clip.plane3().isValid() || !uniquePlanes[i]
                 || plane == -clip.plane3())
             {
                 continue;
@@ -965,18 +1069,28 @@ bool Brush::isBounded() {
 }
 
 /// \brief Constructs the polygon windings for each face of the brush. Also updates the brush bounding-box and face texture-coordinates.
-bool Brush::buildWindings() {
+bool Brush::buildWindings(FixedWindingPool& pool) {
     {
         m_aabb_local = AABB();
 
+        // The plane priorities are the same for all faces, determine them once
+        std::vector<bool> uniquePlanes(m_faces.size());
+
+        for (std::size_t i = 0; i < m_faces.size(); ++i) {
+            uniquePlanes[i] = plane_unique(i);
+        }
+
+        // Scratch windings, re-used for every face
+        FixedWinding* buffers = pool.getBuffers(m_faces.size());
+
         for (std::size_t i = 0;  i < m_faces.size(); ++i) {
             Face& f = *m_faces[i];
 
-            if (!f.plane3().isValid() || !plane_unique(i)) {
+            if (!f.plane3().isValid() || !uniquePlanes[i]) {
                 f.getWinding().resize(0);
             }
             else {
-                windingForClipPlane(f.getWinding(), f.plane3());
+                windingForClipPlane(f.getWinding(), f.plane3(), buffers, uniquePlanes);
 
                 // update brush bounds
                 const Winding& winding = f.getWinding();
@@ -1052,12 +1166,10 @@ std::size_t ProximalVertexArray_index(const ProximalVertexArray& array, const Pr
 }
 
 /// \brief Constructs the face windings and updates anything that depends on them.
-void Brush::buildBRep() {
-  bool degenerate = buildWindings();
+void Brush::buildBRep(FixedWindingPool& pool) {
+  bool degenerate = buildWindings(pool);
 
-  static Vector3 colourVertexVec = ColourSchemes().getColour("brush_vertices");
-  static const Colour4b colour_vertex(int(colourVertexVec[0]*255), int(colourVertexVec[1]*255),
-                                   int(colourVertexVec[2]*255), 255);
+  const Colour4b& colour_vertex = m_vertexColour;
 
   std::size_t faces_size = 0;
   std::size_t faceVerticesCount = 0;
@@ -1211,10 +1323,9 @@ void Brush::buildBRep() {
         }
       }
 
-      if((uniqueVertices.size() + faces_size) - uniqueEdges.size() != 2)
-      {
-        rError() << "Final B-Rep: inconsistent vertex count\n";
-      }
+      // Note: (uniqueVertices.size() + faces_size) - uniqueEdges.size() should
+      // be 2 for a valid polyhedron. This isn't reported to the console anymore,
+      // as the B-Reps are built on worker threads.
 
       // edge-index list for wireframe rendering
       {
@@ -1250,3 +1361,4 @@ void Brush::buildBRep() {
 // ----------------------------------------------------------------------------
 
 double Brush::m_maxWorldCoord = 0;
+Colour4b Brush::m_vertexColour(255, 255, 255, 255);
@@ -8,9 +8,12 @@
 #include "RenderableWireFrame.h"
 #include "Translatable.h"
 
+#include <set>
 #include <boost/noncopyable.hpp>
 
 class RenderableCollector;
+class FixedWinding;
+class FixedWindingPool;
 
 const std::size_t c_brush_maxFaces = 1024;
 
@@ -140,6 +143,10 @@ private:
 	mutable bool m_transformChanged; // transform evaluation required
 	// ----
 
+	// The brushes which had their planes changed since the last evaluateChangedBReps() call
+	typedef std::set<Brush*> BrushSet;
+	static BrushSet& getChangedBrushes();
+
 public:
 	// Public constants
 	static const std::size_t PRISM_MIN_SIDES;
@@ -170,6 +177,9 @@ public:
 
 	static double m_maxWorldCoord;
 
+	// The colour of the vertex, edge and face centroid points
+	static Colour4b m_vertexColour;
+
 	// Constructors
 	Brush(BrushNode& owner, const Callback& evaluateTransform, const Callback& boundsChanged);
 	Brush(BrushNode& owner, const Brush& other, const Callback& evaluateTransform, const Callback& boundsChanged);
@@ -222,6 +232,23 @@ public:
 
 	void evaluateBRep() const;
 
+	// Same as above, using the given storage for the clipped windings
+	void evaluateBRep(FixedWindingPool& pool) const;
+
+	/**
+	 * Builds the B-Reps of all brushes which have been changed since the
+	 * last call, such that multi-brush operations are not evaluated one
+	 * brush at a time during rendering. Pending transforms are evaluated
+	 * on the calling thread, the B-Reps are built on the worker threads.
+	 */
+	static void evaluateChangedBReps();
+
+	/**
+	 * Builds the B-Reps of the given brushes, on the worker threads if there
+	 * are enough of them. Throws std::runtime_error if a worker fails.
+	 */
+	static void evaluateBReps(const std::vector<IBrush*>& brushes);
+
 	void transformChanged();
 	void evaluateTransform();
 
@@ -290,6 +317,10 @@ public:
 	/// \brief Constructs \p winding from the intersection of \p plane with the other planes of the brush.
 	void windingForClipPlane(Winding& winding, const Plane3& plane) const;
 
+	/// \brief Same as above, using the given scratch windings and the plane_unique() result for each face.
+	void windingForClipPlane(Winding& winding, const Plane3& plane,
+							 FixedWinding* buffers, const std::vector<bool>& uniquePlanes) const;
+
 	void update_wireframe(RenderableWireframe& wire, const bool* faces_visible) const;
 
 	void update_faces_wireframe(RenderablePointVector& wire,
@@ -339,10 +370,10 @@ private:
 	bool isBounded();
 
 	/// \brief Constructs the polygon windings for each face of the brush. Also updates the brush bounding-box and face texture-coordinates.
-	bool buildWindings();
+	bool buildWindings(FixedWindingPool& pool);
 
 	/// \brief Constructs the face windings and updates anything that depends on them.
-	void buildBRep();
+	void buildBRep(FixedWindingPool& pool);
 }; // class Brush
 
 typedef std::vector<Brush*> BrushVector;
@@ -8,6 +8,7 @@
 #include "igame.h"
 #include "ilayer.h"
 #include "ieventmanager.h"
+#include "iuimanager.h"
 #include "brush/BrushNode.h"
 #include "brush/BrushClipPlane.h"
 #include "brush/BrushVisit.h"
@@ -38,6 +39,11 @@ void BrushModuleImpl::construct()
 	registerBrushCommands();
 
 	Brush::m_maxWorldCoord = registry::getValue<float>("game/defaults/maxWorldCoord");
+
+	// Looked up once here, buildBRep() is running on the worker threads
+	Vector3 vertexColour = ColourSchemes().getColour("brush_vertices");
+	Brush::m_vertexColour = Colour4b(int(vertexColour[0]*255), int(vertexColour[1]*255),
+									 int(vertexColour[2]*255), 255);
 }
 
 void BrushModuleImpl::destroy()
@@ -75,6 +81,16 @@ scene::INodePtr BrushModuleImpl::createBrush()
 	return node;
 }
 
+void BrushModuleImpl::evaluateChangedBReps()
+{
+	Brush::evaluateChangedBReps();
+}
+
+void BrushModuleImpl::evaluateBReps(const std::vector<IBrush*>& brushes)
+{
+	Brush::evaluateBReps(brushes);
+}
+
 // RegisterableModule implementation
 const std::string& BrushModuleImpl::getName() const {
 	static std::string _name(MODULE_BRUSHCREATOR);
@@ -90,6 +106,8 @@ const StringSet& BrushModuleImpl::getDependencies() const {
 		_dependencies.insert(MODULE_XMLREGISTRY);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
 		_dependencies.insert(MODULE_UNDOSYSTEM);
+		_dependencies.insert(MODULE_UIMANAGER);
+		_dependencies.insert(MODULE_FILTERSYSTEM);
 	}
 
 	return _dependencies;
@@ -35,6 +35,9 @@ public:
 	// Creates a new brush node on the heap and returns it
 	scene::INodePtr createBrush();
 
+	void evaluateChangedBReps();
+	void evaluateBReps(const std::vector<IBrush*>& brushes);
+
 	// ----------------------------------------------------------------------------------
 
 	// returns true if the texture lock is enabled
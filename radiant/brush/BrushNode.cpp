@@ -119,6 +119,12 @@ void BrushNode::invertSelected() {
 }
 
 void BrushNode::testSelect(Selector& selector, SelectionTest& test) {
+	// The scene graph passes in all members of the visited octree nodes,
+	// reject the brushes outside the selection volume before testing the faces
+	if (test.getVolume().TestAABB(localAABB(), localToWorld()) == VOLUME_OUTSIDE) {
+		return;
+	}
+
 	test.BeginMesh(localToWorld());
 
 	SelectionIntersection best;
@@ -49,6 +49,24 @@ namespace {
 	}
 }
 
+FixedWinding* FixedWindingPool::getBuffers(std::size_t numFaces)
+{
+	// Clipping a convex winding adds at most one vertex, so the infinite
+	// winding clipped by all the other faces fits. The same again is left
+	// for the rounding errors of nearly coplanar faces.
+	std::size_t capacity = 2 * (numFaces + 4);
+
+	if (_storage.size() < 2 * capacity)
+	{
+		_storage.resize(2 * capacity);
+	}
+
+	_buffers[0] = FixedWinding(&_storage[0], capacity);
+	_buffers[1] = FixedWinding(&_storage[capacity], capacity);
+
+	return _buffers;
+}
+
 void FixedWinding::writeToWinding(Winding& winding)
 {
 	// First, set the target winding to the same size as <self>
@@ -140,6 +158,12 @@ void FixedWinding::clip(const Plane3& plane, const Plane3& clipPlane, std::size_
 		 next != size();
 		 i = next, ++next, classification = nextClassification)
 	{
+		// Each edge adds two vertices at most
+		if (clipped.size() + 2 > clipped.capacity()) {
+			clipped.clear();
+			return;
+		}
+
 		nextClassification = Winding::classifyDistance(clipPlane.distanceToPoint((*this)[next].vertex), ON_EPSILON);
 		const FixedWindingVertex& vertex = (*this)[i];
 
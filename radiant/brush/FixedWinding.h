@@ -4,11 +4,10 @@
 #include "math/Plane3.h"
 
 #include <vector>
+#include <cassert>
 
 class Winding;
 
-#define MAX_POINTS_ON_WINDING 64
-
 class DoubleLine {
 public:
 	Vector3 origin;
@@ -27,28 +26,73 @@ public:
 	DoubleLine edge;
 	std::size_t adjacent;
 
+	// Used for the pooled storage only
+	FixedWindingVertex() :
+		adjacent(0)
+	{}
+
 	FixedWindingVertex(const Vector3& vertex_, const DoubleLine& edge_,	std::size_t adjacent_) :
 		vertex(vertex_),
 		edge(edge_),
 		adjacent(adjacent_)
 	{}
-
-	virtual ~FixedWindingVertex() {}
 };
 
 /**
- * greebo: A FixedWinding is a vector of FixedWindingVertices
- *         with a pre-allocated size of MAX_POINTS_ON_WINDING.
+ * greebo: A FixedWinding is an array of FixedWindingVertices with a fixed
+ *         capacity. It doesn't own its storage, see FixedWindingPool.
  */
-class FixedWinding :
-	public std::vector<FixedWindingVertex>
+class FixedWinding
 {
+	FixedWindingVertex* _vertices;
+	std::size_t _size;
+	std::size_t _capacity;
+
 public:
-	FixedWinding() {
-		reserve(MAX_POINTS_ON_WINDING);
+	FixedWinding() :
+		_vertices(NULL),
+		_size(0),
+		_capacity(0)
+	{}
+
+	FixedWinding(FixedWindingVertex* storage, std::size_t capacity) :
+		_vertices(storage),
+		_size(0),
+		_capacity(capacity)
+	{}
+
+	std::size_t size() const {
+		return _size;
+	}
+
+	std::size_t capacity() const {
+		return _capacity;
 	}
 
-	virtual ~FixedWinding() {}
+	bool empty() const {
+		return _size == 0;
+	}
+
+	void clear() {
+		_size = 0;
+	}
+
+	void push_back(const FixedWindingVertex& vertex) {
+		assert(_size < _capacity);
+		_vertices[_size++] = vertex;
+	}
+
+	FixedWindingVertex& operator[](std::size_t index) {
+		return _vertices[index];
+	}
+
+	const FixedWindingVertex& operator[](std::size_t index) const {
+		return _vertices[index];
+	}
+
+	const FixedWindingVertex& back() const {
+		return _vertices[_size - 1];
+	}
 
 	// Writes the FixedWinding data into the given Winding
 	void writeToWinding(Winding& winding);
@@ -60,5 +104,23 @@ public:
 	/// If \p winding is completely in front of the plane, \p clipped will be identical to \p winding.
 	/// If \p winding is completely in back of the plane, \p clipped will be empty.
 	/// If \p winding intersects the plane, the edge of \p clipped which lies on \p clipPlane will store the value of \p adjacent.
+	/// If \p clipped runs out of capacity, which only happens for broken geometry, it is left empty.
 	void clip(const Plane3& plane, const Plane3& clipPlane, std::size_t adjacent, FixedWinding& clipped);
 };
+
+/**
+ * Owns the storage of the two FixedWindings the face windings of a brush
+ * are clipped with. The storage is re-used for all faces of a brush and,
+ * when passed along, for all brushes built on the same thread, so that
+ * building a B-Rep doesn't allocate per face or per brush.
+ */
+class FixedWindingPool
+{
+	std::vector<FixedWindingVertex> _storage;
+	FixedWinding _buffers[2];
+
+public:
+	// Returns the two windings, with enough room to clip the faces of a
+	// brush with the given number of faces
+	FixedWinding* getBuffers(std::size_t numFaces);
+};
@@ -7,13 +7,14 @@
 #include "itextstream.h"
 #include "imainframe.h"
 #include "icommandsystem.h"
+#include "ientity.h"
+#include "scenelib.h"
 #include "scene/Node.h"
 #include "modulesystem/StaticModule.h"
 
 #include "AddToLayerWalker.h"
 #include "MoveToLayerWalker.h"
 #include "RemoveFromLayerWalker.h"
-#include "SetLayerSelectedWalker.h"
 
 #include "gtkutil/dialog/MessageBox.h"
 #include "gtkutil/IconTextMenuItem.h"
@@ -40,9 +41,34 @@ namespace
 	const char* const REMOVE_FROM_LAYER_TEXT = N_("Remove from Layer...");
 
 	const int DEFAULT_LAYER = 0;
+
+	// Looks for a node in one of the visible layers
+	class VisibleLayerFinder :
+		public NodeVisitor
+	{
+		const LayerMask& _visibleLayers;
+
+	public:
+		bool found;
+
+		VisibleLayerFinder(const LayerMask& visibleLayers) :
+			_visibleLayers(visibleLayers),
+			found(false)
+		{}
+
+		bool pre(const INodePtr& node)
+		{
+			if (found) return false;
+
+			found = node->getLayerMask().intersects(_visibleLayers);
+
+			return !found;
+		}
+	};
 }
 
 LayerSystem::LayerSystem() :
+	_recordChanges(false),
 	_activeLayer(DEFAULT_LAYER)
 {}
 
@@ -73,6 +99,7 @@ int LayerSystem::createLayer(const std::string& name, int layerID)
 
 	// Set the newly created layer to "visible"
 	_layerVisibility[result.first->first] = true;
+	_visibleLayers.set(result.first->first);
 
 	// Return the ID of the inserted layer
 	return result.first->first;
@@ -108,15 +135,22 @@ void LayerSystem::deleteLayer(const std::string& name)
 		return;
 	}
 
-	// Remove all nodes from this layer first, but don't de-select them yet
-	RemoveFromLayerWalker walker(layerID);
-	Node_traverseSubgraph(GlobalSceneGraph().root(), walker);
+	// Remove all nodes from this layer first, but don't de-select them yet.
+	// Iterate over a copy, the removal changes the layer members.
+	NodeSet members = getLayerMembers(layerID);
+
+	for (NodeSet::const_iterator i = members.begin(); i != members.end(); ++i)
+	{
+		(*i)->removeFromLayer(layerID);
+	}
 
 	// Remove the layer
 	_layers.erase(layerID);
+	_layerMembers.erase(layerID);
 
 	// Reset the visibility flag to TRUE
 	_layerVisibility[layerID] = true;
+	_visibleLayers.set(layerID);
 
 	if (layerID == _activeLayer)
 	{
@@ -124,8 +158,10 @@ void LayerSystem::deleteLayer(const std::string& name)
 		_activeLayer = DEFAULT_LAYER;
 	}
 
-	// Fire the visibility changed event to
-	// update the scenegraph and redraw the views
+	// The former members might have ended up in the default layer
+	updateNodesVisibility(members);
+
+	// Fire the visibility changed event to redraw the views
 	onLayerVisibilityChanged();
 }
 
@@ -147,6 +183,9 @@ void LayerSystem::reset()
 	_layerVisibility.resize(1);
 	_layerVisibility[DEFAULT_LAYER] = true;
 
+	_visibleLayers.clear();
+	_visibleLayers.set(DEFAULT_LAYER);
+
 	// Update the LayerControlDialog
 	ui::LayerControlDialog::Instance().refresh();
 }
@@ -241,12 +280,24 @@ void LayerSystem::setLayerVisibility(int layerID, bool visible)
 	// Set the visibility
 	_layerVisibility[layerID] = visible;
 
+	if (visible)
+	{
+		_visibleLayers.set(layerID);
+	}
+	else
+	{
+		_visibleLayers.reset(layerID);
+	}
+
 	if (!visible && layerID == _activeLayer)
 	{
 		// We just hid the active layer, fall back to another one
 		_activeLayer = getFirstVisibleLayer();
 	}
 
+	// Only the members of this layer are affected
+	updateNodesVisibility(getLayerMembers(layerID));
+
 	// Fire the visibility changed event
 	onLayerVisibilityChanged();
 }
@@ -265,15 +316,136 @@ void LayerSystem::setLayerVisibility(const std::string& layerName, bool visible)
 	setLayerVisibility(layerID, visible);
 }
 
-void LayerSystem::updateSceneGraphVisibility() {
-	UpdateNodeVisibilityWalker walker;
-	GlobalSceneGraph().root()->traverse(walker);
+void LayerSystem::updateNodesVisibility(const NodeSet& nodes)
+{
+	// Containers are visible as long as one of their children is visible,
+	// so the ancestors of the given nodes need to be updated as well
+	NodeSet affected(nodes);
+
+	for (NodeSet::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+	{
+		// The root node is not affected by the layer settings
+		for (INodePtr parent = (*i)->getParent(); parent && parent->getParent();
+			 parent = parent->getParent())
+		{
+			if (!affected.insert(parent).second)
+			{
+				break; // the remaining ancestors are known already
+			}
+		}
+	}
+
+	for (NodeSet::const_iterator i = affected.begin(); i != affected.end(); ++i)
+	{
+		const INodePtr& node = *i;
+
+		if (!node->getParent()) continue; // skip the root
+
+		if (isLayerVisible(node))
+		{
+			node->disable(Node::eLayered);
+		}
+		else
+		{
+			node->enable(Node::eLayered);
+		}
+
+		if (!node->visible())
+		{
+			// Node is hidden after update, de-select
+			Node_setSelected(node, false);
+		}
+	}
+}
+
+bool LayerSystem::isLayerVisible(const INodePtr& node) const
+{
+	VisibleLayerFinder finder(_visibleLayers);
+	Node_traverseSubgraph(node, finder);
+
+	return finder.found;
 }
 
-void LayerSystem::onLayerVisibilityChanged() {
-	// Update all nodes
-	updateSceneGraphVisibility();
+bool LayerSystem::isVisibleInScene(const INodePtr& node) const
+{
+	for (INodePtr n = node; n && n->getParent(); n = n->getParent())
+	{
+		if (!n->visible()) return false;
+	}
+
+	return true;
+}
+
+void LayerSystem::applyToSelection(SelectionSystem::Visitor& walker)
+{
+	// Only the nodes which actually changed their layers need an update
+	_recordChanges = true;
+	GlobalSelectionSystem().foreachSelected(walker);
+	_recordChanges = false;
 
+	NodeSet changedNodes;
+	changedNodes.swap(_changedNodes);
+
+	updateNodesVisibility(changedNodes);
+}
+
+const LayerSystem::NodeSet& LayerSystem::getLayerMembers(int layerID) const
+{
+	static const NodeSet _emptyNodeSet;
+
+	LayerMembers::const_iterator found = _layerMembers.find(layerID);
+
+	return found != _layerMembers.end() ? found->second : _emptyNodeSet;
+}
+
+void LayerSystem::onSceneNodeInsert(const INodePtr& node)
+{
+	const LayerMask& layers = node->getLayerMask();
+
+	for (int i = layers.findNext(0); i != -1; i = layers.findNext(i+1))
+	{
+		_layerMembers[i].insert(node);
+	}
+}
+
+void LayerSystem::onSceneNodeErase(const INodePtr& node)
+{
+	const LayerMask& layers = node->getLayerMask();
+
+	for (int i = layers.findNext(0); i != -1; i = layers.findNext(i+1))
+	{
+		LayerMembers::iterator found = _layerMembers.find(i);
+
+		if (found != _layerMembers.end())
+		{
+			found->second.erase(node);
+		}
+	}
+
+	_changedNodes.erase(node);
+}
+
+void LayerSystem::onSceneNodeLayersChanged(const INodePtr& node, const LayerMask& previousLayers)
+{
+	for (int i = previousLayers.findNext(0); i != -1; i = previousLayers.findNext(i+1))
+	{
+		LayerMembers::iterator found = _layerMembers.find(i);
+
+		if (found != _layerMembers.end())
+		{
+			found->second.erase(node);
+		}
+	}
+
+	onSceneNodeInsert(node);
+
+	if (_recordChanges)
+	{
+		_changedNodes.insert(node);
+	}
+}
+
+void LayerSystem::onLayerVisibilityChanged() {
 	// Redraw
 	SceneChangeNotify();
 
@@ -289,9 +461,7 @@ void LayerSystem::addSelectionToLayer(int layerID) {
 
 	// Instantiate a Selectionwalker and traverse the selection
 	AddToLayerWalker walker(layerID);
-	GlobalSelectionSystem().foreachSelected(walker);
-
-	updateSceneGraphVisibility();
+	applyToSelection(walker);
 }
 
 void LayerSystem::addSelectionToLayer(const std::string& layerName) {
@@ -330,9 +500,7 @@ void LayerSystem::moveSelectionToLayer(int layerID) {
 
 	// Instantiate a Selectionwalker and traverse the selection
 	MoveToLayerWalker walker(layerID);
-	GlobalSelectionSystem().foreachSelected(walker);
-
-	updateSceneGraphVisibility();
+	applyToSelection(walker);
 }
 
 void LayerSystem::removeSelectionFromLayer(const std::string& layerName) {
@@ -357,36 +525,45 @@ void LayerSystem::removeSelectionFromLayer(int layerID) {
 
 	// Instantiate a Selectionwalker and traverse the selection
 	RemoveFromLayerWalker walker(layerID);
-	GlobalSelectionSystem().foreachSelected(walker);
-
-	updateSceneGraphVisibility();
+	applyToSelection(walker);
 }
 
 bool LayerSystem::updateNodeVisibility(const scene::INodePtr& node) {
-	// Get the list of layers the node is associated with
-	// greebo: TODO: Check if returning the LayerList by value is taxing.
-	LayerList layers = node->getLayers();
-
-	// We start with the assumption that a node is hidden
-	node->enable(Node::eLayered);
-
-	// Cycle through the Node's layers, and show the node as soon as
-	// a visible layer is found.
-	for (LayerList::const_iterator i = layers.begin(); i != layers.end(); i++) {
-		if (_layerVisibility[*i]) {
-			// The layer is visible, set the visibility to true and quit
-			node->disable(Node::eLayered);
-			return true;
-		}
+	// The node is visible as soon as one of its layers is visible
+	if (node->getLayerMask().intersects(_visibleLayers)) {
+		node->disable(Node::eLayered);
+		return true;
 	}
 
 	// Node is hidden, return FALSE
+	node->enable(Node::eLayered);
 	return false;
 }
 
-void LayerSystem::setSelected(int layerID, bool selected) {
-	SetLayerSelectedWalker walker(layerID, selected);
-	GlobalSceneGraph().root()->traverse(walker);
+void LayerSystem::setSelected(int layerID, bool selected)
+{
+	const NodeSet& members = getLayerMembers(layerID);
+
+	for (NodeSet::const_iterator i = members.begin(); i != members.end(); ++i)
+	{
+		const INodePtr& node = *i;
+
+		// Skip the root and the hidden nodes
+		if (!node->getParent() || !isVisibleInScene(node))
+		{
+			continue;
+		}
+
+		Entity* entity = Node_getEntity(node);
+
+		if (entity != NULL && entity->getKeyValue("classname") == "worldspawn")
+		{
+			// Skip the worldspawn
+			continue;
+		}
+
+		Node_setSelected(node, selected);
+	}
 }
 
 int LayerSystem::getLayerID(const std::string& name) const {
@@ -453,6 +630,7 @@ const StringSet& LayerSystem::getDependencies() const
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
 		_dependencies.insert(MODULE_UIMANAGER);
 		_dependencies.insert(MODULE_ORTHOCONTEXTMENU);
+		_dependencies.insert(MODULE_SCENEGRAPH);
 	}
 
 	return _dependencies;
@@ -465,6 +643,9 @@ void LayerSystem::initialiseModule(const ApplicationContext& ctx)
 	// Create the "master" layer with ID DEFAULT_LAYER
 	createLayer(_(DEFAULT_LAYER_NAME));
 
+	// Keep track of the layer members in the scene
+	GlobalSceneGraph().addSceneObserver(this);
+
 	// Add command targets for the first 10 layer IDs here
 	for (int i = 0; i < 10; i++) {
 		_commandTargets.push_back(
@@ -504,6 +685,14 @@ void LayerSystem::initialiseModule(const ApplicationContext& ctx)
 	GlobalOrthoContextMenu().addItem(removeMenu, ui::IOrthoContextMenu::SECTION_LAYER);
 }
 
+void LayerSystem::shutdownModule()
+{
+	GlobalSceneGraph().removeSceneObserver(this);
+
+	_layerMembers.clear();
+	_changedNodes.clear();
+}
+
 void LayerSystem::createLayerCmd(const cmd::ArgumentList& args)
 {
 	std::string initialName = !args.empty() ? args[0].getString() : "";
@@ -2,7 +2,10 @@
 
 #include <vector>
 #include <map>
+#include <set>
 #include "ilayer.h"
+#include "iscenegraph.h"
+#include "iselection.h"
 #include "LayerCommandTarget.h"
 
 namespace scene {
@@ -16,7 +19,8 @@ namespace
 }
 
 class LayerSystem :
-	public ILayerSystem
+	public ILayerSystem,
+	public Graph::Observer
 {
 private:
 	// greebo: An array of booleans reflects the visibility status
@@ -25,6 +29,19 @@ private:
 	typedef std::vector<bool> LayerVisibilityList;
 	LayerVisibilityList _layerVisibility;
 
+	// The same as bitmask, to be tested against the layers of a node
+	LayerMask _visibleLayers;
+
+	// The members of each layer, maintained from the scenegraph events,
+	// so that toggling a layer only needs to look at its own nodes
+	typedef std::set<INodePtr> NodeSet;
+	typedef std::map<int, NodeSet> LayerMembers;
+	LayerMembers _layerMembers;
+
+	// The nodes changing their layers during a selection operation
+	bool _recordChanges;
+	NodeSet _changedNodes;
+
 	// The list of named layers, indexed by an integer ID
 	typedef std::map<int, std::string> LayerMap;
 	LayerMap _layers;
@@ -124,16 +141,34 @@ public:
 	const std::string& getName() const;
 	const StringSet& getDependencies() const;
 	void initialiseModule(const ApplicationContext& ctx);
+	void shutdownModule();
+
+	// Graph::Observer implementation, keeps track of the layer members
+	void onSceneNodeInsert(const INodePtr& node);
+	void onSceneNodeErase(const INodePtr& node);
+	void onSceneNodeLayersChanged(const INodePtr& node, const LayerMask& previousLayers);
 
 	// Command target
 	void createLayerCmd(const cmd::ArgumentList& args);
 
 private:
-	// Internal event, updates the scenegraph
+	// Internal event, redraws the views and updates the dialog
 	void onLayerVisibilityChanged();
 
-	// Updates the visibility state of the entire scenegraph
-	void updateSceneGraphVisibility();
+	// Updates the visibility state of the given nodes and their ancestors
+	void updateNodesVisibility(const NodeSet& nodes);
+
+	// Returns TRUE if the node or one of its children is in a visible layer
+	bool isLayerVisible(const INodePtr& node) const;
+
+	// Returns TRUE if the node and its ancestors are visible
+	bool isVisibleInScene(const INodePtr& node) const;
+
+	// Runs the given layer walker on the selection and updates the changed nodes
+	void applyToSelection(SelectionSystem::Visitor& walker);
+
+	// The nodes of the given layer, this is empty for unknown layers
+	const NodeSet& getLayerMembers(int layerID) const;
 
 	// Returns the highest used layer Id
 	int getHighestLayerID() const;
@@ -15,6 +15,7 @@
 #include "imainframe.h"
 #include "imapresource.h"
 #include "iselectionset.h"
+#include "ishaders.h"
 
 #include "registry/registry.h"
 #include "stream/textfilestream.h"
@@ -38,6 +39,7 @@
 #include "map/algorithm/Merge.h"
 #include "map/algorithm/Traverse.h"
 #include "map/algorithm/MapExporter.h"
+#include "map/algorithm/MaterialNameCollector.h"
 #include "ui/mru/MRU.h"
 #include "ui/mainframe/ScreenUpdateBlocker.h"
 #include "ui/layers/LayerControlDialog.h"
@@ -176,6 +178,13 @@ void Map::onResourceRealise() {
     {
         ui::ScreenUpdateBlocker blocker(_("Processing..."), _("Loading textures..."), true); // force display
 
+        // Parse the materials of the map on the worker threads up front,
+        // rather than one by one as the nodes capture their shaders
+        MaterialNameCollector collector;
+        m_resource->getNode()->traverse(collector);
+
+        GlobalMaterialManager().preloadMaterials(collector.getNames());
+
         GlobalSceneGraph().root()->setRenderSystem(boost::dynamic_pointer_cast<RenderSystem>(
             module::GlobalModuleRegistry().getModule(MODULE_RENDERSYSTEM)));
     }
@@ -571,11 +580,9 @@ bool Map::import(const std::string& filename)
 
             if (nspace)
             {
-                // Prepare our namespace for import
-                nspace->ensureNoConflicts(otherRoot);
-
-                // Now add the imported names to the local namespace
-                nspace->connect(otherRoot);
+                // Rename the conflicting names and add the imported names
+                // to the local namespace
+                nspace->importNames(otherRoot);
             }
 
             MergeMap(otherRoot);
@@ -474,7 +474,7 @@ bool MapResource::loadFile(std::istream& mapStream, const MapFormat& format, con
 	try
 	{
 		// Start parsing
-		reader->readFromStream(mapStream);
+		reader->readFromFile(mapStream, filename);
 
 		// Prepare child primitives
 		addOriginToChildPrimitives(root);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "inode.h"
+#include "ibrush.h"
+#include "ipatch.h"
+#include "imodule.h"
+
+namespace map
+{
+
+/**
+ * Traverses a subgraph and collects the names of the materials used by the
+ * brush faces and patches in it.
+ */
+class MaterialNameCollector :
+	public scene::NodeVisitor
+{
+	StringSet _names;
+
+public:
+	bool pre(const scene::INodePtr& node)
+	{
+		IBrush* brush = Node_getIBrush(node);
+
+		if (brush != NULL)
+		{
+			for (std::size_t i = 0; i < brush->getNumFaces(); ++i)
+			{
+				_names.insert(brush->getFace(i).getShader());
+			}
+
+			return false;
+		}
+
+		IPatch* patch = Node_getIPatch(node);
+
+		if (patch != NULL)
+		{
+			_names.insert(patch->getShader());
+			return false;
+		}
+
+		return true;
+	}
+
+	const StringSet& getNames() const
+	{
+		return _names;
+	}
+};
+
+} // namespace map
@@ -1,19 +1,53 @@
 #include "ComplexName.h"
 
-#include <boost/algorithm/string/trim.hpp>
-#include <boost/algorithm/string/predicate.hpp>
+#include <climits>
+#include <algorithm>
 #include "string/convert.h"
 
+namespace
+{
+    // Parses the given digits, returns -1 if there are none or if they
+    // don't fit into an int. This is called for every name in the map,
+    // lexical_cast would throw on all names without a postfix.
+    int parsePostfix(const std::string& fullname, std::size_t start)
+    {
+        if (start == fullname.size())
+        {
+            return -1;
+        }
+
+        int postfix = 0;
+
+        for (std::size_t i = start; i < fullname.size(); ++i)
+        {
+            int digit = fullname[i] - '0';
+
+            if (postfix > (INT_MAX - digit) / 10)
+            {
+                return -1; // overflow
+            }
+
+            postfix = postfix * 10 + digit;
+        }
+
+        return postfix;
+    }
+}
+
 ComplexName::ComplexName(const std::string& fullname)
 {
     // Retrieve the name by cutting off the trailing number
-    _name = boost::algorithm::trim_right_copy_if(
-        fullname, boost::algorithm::is_any_of("1234567890")
-    );
+    std::size_t nameLength = fullname.size();
+
+    while (nameLength > 0 && fullname[nameLength - 1] >= '0' && fullname[nameLength - 1] <= '9')
+    {
+        --nameLength;
+    }
+
+    _name = fullname.substr(0, nameLength);
 
-    // Get the trimmed part and take it as postfix
-    std::string postFixStr = fullname.substr(_name.size());
-    _postFix = string::convert<int>(postFixStr, -1);
+    // Take the trimmed part as postfix
+    _postFix = parsePostfix(fullname, nameLength);
 }
 
 std::string ComplexName::getFullname() const
@@ -21,33 +55,30 @@ std::string ComplexName::getFullname() const
     return _name + (_postFix == -1 ? "" : string::to_string(_postFix));
 }
 
-namespace
+int ComplexName::makePostfixUnique(const PostfixSet& postfixes)
 {
-    // Find the first integer not in the given set
-    int findFirstUnusedNumber(const PostfixSet& set)
+    // If our postfix is already in the set, change it to a unique value
+    if (postfixes.contains(_postFix))
     {
-        static const int LOWEST_VAL = 1;
-
-        for (int i = LOWEST_VAL; i < INT_MAX; ++i)
-        {
-            if (set.find(i) == set.end())
-            {
-                // Found an unused value
-                return i;
-            }
-        }
-
-        // Pathological case, could not find a value
-        return INT_MAX;
+        _postFix = postfixes.getFirstUnused();
     }
+
+    return _postFix;
 }
 
-int ComplexName::makePostfixUnique(const PostfixSet& postfixes)
+int ComplexName::makePostfixUnique(const PostfixSet& postfixes, const PostfixSet& reserved)
 {
-    // If our postfix is already in the set, change it to a unique value
-    if (postfixes.find(_postFix) != postfixes.end())
+    if (!postfixes.contains(_postFix) && !reserved.contains(_postFix))
+    {
+        return _postFix;
+    }
+
+    // Everything below the first unused postfix of either set is taken
+    _postFix = std::max(postfixes.getFirstUnused(), reserved.getFirstUnused());
+
+    while (postfixes.contains(_postFix) || reserved.contains(_postFix))
     {
-        _postFix = findFirstUnusedNumber(postfixes);
+        ++_postFix;
     }
 
     return _postFix;
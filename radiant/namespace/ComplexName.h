@@ -1,10 +1,78 @@
 #pragma once
 
 #include <string>
-#include <set>
+#include <boost/unordered_set.hpp>
 
-/// Set of unique integer postfixes
-typedef std::set<int> PostfixSet;
+/**
+ * \brief
+ * Set of unique integer postfixes.
+ *
+ * The set remembers the lowest unused postfix, so acquiring a new unique
+ * postfix doesn't need to scan the set. This keeps naming thousands of
+ * entities with the same prefix (e.g. when pasting prefabs) linear.
+ */
+class PostfixSet
+{
+    typedef boost::unordered_set<int> Postfixes;
+    Postfixes _postfixes;
+
+    // All positive postfixes below this one are in use
+    int _firstUnused;
+
+public:
+    PostfixSet() :
+        _firstUnused(1)
+    {}
+
+    bool empty() const
+    {
+        return _postfixes.empty();
+    }
+
+    bool contains(int postfix) const
+    {
+        return _postfixes.find(postfix) != _postfixes.end();
+    }
+
+    /// Inserts the postfix, returns FALSE if it was already in the set
+    bool insert(int postfix)
+    {
+        if (!_postfixes.insert(postfix).second)
+        {
+            return false;
+        }
+
+        // Move the counter past the range of used postfixes
+        while (contains(_firstUnused))
+        {
+            ++_firstUnused;
+        }
+
+        return true;
+    }
+
+    /// Removes the postfix, returns FALSE if it was not in the set
+    bool erase(int postfix)
+    {
+        if (_postfixes.erase(postfix) == 0)
+        {
+            return false;
+        }
+
+        if (postfix > 0 && postfix < _firstUnused)
+        {
+            _firstUnused = postfix;
+        }
+
+        return true;
+    }
+
+    /// Returns the lowest positive postfix which is not in this set
+    int getFirstUnused() const
+    {
+        return _firstUnused;
+    }
+};
 
 /// Name consisting of initial text and optional unique-making numeric postfix
 class ComplexName
@@ -44,4 +112,11 @@ public:
      * Set of existing postfixes which must not be used.
      */
     int makePostfixUnique(const PostfixSet& postfixes);
+
+    /**
+     * \brief
+     * Change (if necessary) the postfix to make it unique in both of the
+     * given sets, and return the new postfix value.
+     */
+    int makePostfixUnique(const PostfixSet& postfixes, const PostfixSet& reserved);
 };
@@ -4,7 +4,8 @@
 #include "itextstream.h"
 #include "modulesystem/StaticModule.h"
 
-#include <list>
+#include <set>
+#include <algorithm>
 #include <boost/foreach.hpp>
 
 class ConnectNamespacedWalker :
@@ -168,21 +169,37 @@ Namespace::~Namespace()
 
 void Namespace::addNameObserver(const std::string& name, NameObserver& observer) {
     // Just insert the observer
-    _observers.insert(ObserverMap::value_type(name, &observer));
+    _observers[name].push_back(&observer);
 }
 
 void Namespace::removeNameObserver(const std::string& name, NameObserver& observer) {
-    // Lookup the iterator boundaries and find the observer
-    for (ObserverMap::iterator i = _observers.lower_bound(name), upperBound = _observers.upper_bound(name);
-         i != _observers.end() && i != upperBound; i++)
-    {
-        if (i->second == &observer) {
-            _observers.erase(i);
-            break;
-        }
+    ObserverMap::iterator found = _observers.find(name);
+
+    if (found == _observers.end()) {
+        return;
+    }
+
+    Observers& observers = found->second;
+    Observers::iterator i = std::find(observers.begin(), observers.end(), &observer);
+
+    if (i != observers.end()) {
+        observers.erase(i);
+    }
+
+    // Don't keep empty lists around, the observed names are changing all the time
+    if (observers.empty()) {
+        _observers.erase(found);
     }
 }
 
+bool Namespace::isObserving(const std::string& name, NameObserver* observer) const
+{
+    ObserverMap::const_iterator found = _observers.find(name);
+
+    return found != _observers.end() &&
+           std::find(found->second.begin(), found->second.end(), observer) != found->second.end();
+}
+
 void Namespace::nameChanged(const std::string& oldName, const std::string& newName) {
     // Check if we should do anything at all
     if (oldName == newName) {
@@ -197,49 +214,39 @@ void Namespace::nameChanged(const std::string& oldName, const std::string& newNa
     // Insert the new name, the NameObservers expect the new name to be present in the namespace
     _uniqueNames.insert(newName);
 
-    // Notify the observers
+    ObserverMap::iterator found = _observers.find(oldName);
 
-    // greebo: Note, we compare the name after checking upper_bound() once more to catch cases
-    // where a name gets changed from path_2 to path_23 for instance, which could result in a new
-    // upper_bound(). The operator!= subsequently fails as the iterator points to the element
-    // *after* the new upper_bound(), and the wrong observer gets called.
-    // Performance should not be a problem as this only gets executed on name changes, and there
-    // is a finite number of observers watching a single name anyway.
+    if (found == _observers.end()) {
+        return;
+    }
+
+    // Notify the observers. The default observing classes remove themselves
+    // from the namespace when the name changes (and register for the new name),
+    // so we need to iterate over a copy of the list. Observers which have been
+    // removed by a preceding observer in the meantime are not called.
+    Observers observers = found->second;
 
-    for (ObserverMap::iterator i = _observers.lower_bound(oldName);
-         i != _observers.end() && i != _observers.upper_bound(oldName) && i->first == oldName;
-         /* in-loop increment */)
+    for (Observers::const_iterator i = observers.begin(); i != observers.end(); ++i)
     {
-        assert(i->second != NULL);
+        assert(*i != NULL);
 
-        // Call the observer, but increment the iterator beforehand,
-        // as the observer might remove this one.
-        (i++)->second->onNameChange(oldName, newName);
+        if (isObserving(oldName, *i)) {
+            (*i)->onNameChange(oldName, newName);
+        }
     }
 
-    // greebo: usually, there are no more observers left in the multimap at this point
-    // as the default observing classes remove themselves from the namespace when the
-    // name changes. However, it's possible that there are some observers left,
-    // so we need to redirect them to the new name.
+    // greebo: usually, there are no more observers left at this point.
+    // However, it's possible that there are some observers left,
+    // so we need to redirect them to the new name (it has changed after all).
+    found = _observers.find(oldName);
 
-    // This list will temporarily hold observers, as we need to change
-    // their association after the name change.
-    std::list<NameObserver*> temp;
+    if (found != _observers.end()) {
+        Observers remaining;
+        remaining.swap(found->second);
+        _observers.erase(found);
 
-    // Now go through that list again, and rename all remaining observers which
-    // point at the old name (ideally, there are none left at this point)
-    for (ObserverMap::iterator i = _observers.lower_bound(oldName);
-         i != _observers.end() && i != _observers.upper_bound(oldName);
-         /* in-loop increment */)
-    {
-        temp.push_back(i->second);
-        _observers.erase(i++);
-    }
-
-    // greebo: Now, associate each observer with the new name (it has changed after all)
-    for (std::list<NameObserver*>::iterator i = temp.begin(); i != temp.end(); i++)
-    {
-        _observers.insert(ObserverMap::value_type(newName, *i));
+        Observers& target = _observers[newName];
+        target.insert(target.end(), remaining.begin(), remaining.end());
     }
 }
 
@@ -251,51 +258,71 @@ void Namespace::ensureNoConflicts(const scene::INodePtr& root)
     // Move all nodes below (and including) root into this temporary namespace
     foreignNamespace.connect(root);
 
+    resolveConflicts(root, foreignNamespace);
+
+    // at this point, all names in the foreign namespace have been converted to
+    // something unique in this namespace. The calling code can now move the
+    // nodes into this namespace without name conflicts
+
+    // Disconnect the root from the foreign namespace again, it will be destroyed now
+    foreignNamespace.disconnect(root);
+}
+
+void Namespace::importNames(const scene::INodePtr& root)
+{
+    Namespace foreignNamespace;
+
+    foreignNamespace.connect(root);
+
+    resolveConflicts(root, foreignNamespace);
+
+    // Move the nodes over, connect() takes care of detaching them from the
+    // foreign namespace, which is empty afterwards
+    connect(root);
+}
+
+void Namespace::resolveConflicts(const scene::INodePtr& root, Namespace& foreignNamespace)
+{
     // Collect all namespaced items from the foreign root
     GatherNamespacedWalker walker;
     Node_traverseSubgraph(root, walker);
 
-    rDebug() << "Namespace::ensureNoConflicts(): imported set of "
+    rDebug() << "Namespace::resolveConflicts(): imported set of "
              << walker.result.size() << " namespaced nodes" << std::endl;
 
-    // Build a union set containing all imported names and all existing names.
-    // We need to know all existing names to ensure that newly created names are
-    // unique in *both* namespaces
-    UniqueNameSet allNames = _uniqueNames;
-    allNames.merge(foreignNamespace._uniqueNames);
+    std::size_t numRenamed = 0;
 
     // Process each object in the to-be-imported tree of nodes, ensuring that it
     // has a unique name
     BOOST_FOREACH(NamespacedPtr n, walker.result)
     {
+        std::string name = n->getName();
+
         // If the imported node conflicts with a name in THIS namespace, then it
         // needs to be given a new name which is unique in BOTH namespaces.
-        if (_uniqueNames.nameExists(n->getName()))
+        if (!_uniqueNames.nameExists(name))
         {
-            // Name exists in the target namespace, get a new name
-            std::string uniqueName = allNames.insertUnique(n->getName());
+            continue;
+        }
 
-            rMessage() << "Namespace::ensureNoConflicts(): '" << n->getName()
-                       << "' already exists in this namespace. Rename it to '"
-                       << uniqueName << "'\n";
+        // The foreign namespace contains all imported names, acquire the new
+        // name there while skipping the names used in this namespace
+        std::string uniqueName = foreignNamespace._uniqueNames.insertUnique(name, _uniqueNames);
 
-            // Change the name of the imported node, this should trigger all
-            // observers in the foreign namespace
-            n->changeName(uniqueName);
-        }
-        else
-        {
-            // Name does not exist yet, insert it into the local combined
-            // namespace (but not our destination namespace, this will be
-            // populated in the subsequent call to connect()).
-            allNames.insert(n->getName());
-        }
-    }
+        rDebug() << "Namespace::resolveConflicts(): '" << name
+                 << "' already exists in this namespace. Rename it to '"
+                 << uniqueName << "'\n";
 
-    // at this point, all names in the foreign namespace have been converted to
-    // something unique in this namespace. The calling code can now move the
-    // nodes into this namespace without name conflicts
+        // Change the name of the imported node, this should trigger all
+        // observers in the foreign namespace
+        n->changeName(uniqueName);
 
-    // Disconnect the root from the foreign namespace again, it will be destroyed now
-    foreignNamespace.disconnect(root);
+        ++numRenamed;
+    }
+
+    if (numRenamed > 0)
+    {
+        rMessage() << "Namespace: renamed " << numRenamed << " of "
+                   << walker.result.size() << " imported names to avoid conflicts" << std::endl;
+    }
 }
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <map>
 #include <vector>
+#include <boost/unordered_map.hpp>
 #include "inamespace.h"
 #include "iscenegraph.h"
 #include "UniqueNameSet.h"
@@ -12,8 +12,9 @@ class Namespace : public INamespace
 	// The set of unique names in this namespace
 	UniqueNameSet _uniqueNames;
 
-	// The mapping between full names and observers, multiple keys allowed
-	typedef std::multimap<std::string, NameObserver*> ObserverMap;
+	// The mapping between full names and the observers of each name
+	typedef std::vector<NameObserver*> Observers;
+	typedef boost::unordered_map<std::string, Observers> ObserverMap;
 	ObserverMap _observers;
 
 public:
@@ -30,5 +31,13 @@ public:
 	virtual void removeNameObserver(const std::string& name, NameObserver& observer);
 	virtual void nameChanged(const std::string& oldName, const std::string& newName);
 	virtual void ensureNoConflicts(const scene::INodePtr& root);
+	virtual void importNames(const scene::INodePtr& root);
+
+private:
+	// Renames all nodes below root which conflict with this namespace, the nodes
+	// must be connected to the given foreign namespace
+	void resolveConflicts(const scene::INodePtr& root, Namespace& foreignNamespace);
+
+	bool isObserving(const std::string& name, NameObserver* observer) const;
 };
 typedef boost::shared_ptr<Namespace> NamespacePtr;
@@ -1,7 +1,6 @@
 #pragma once
 
-#include <set>
-#include <map>
+#include <boost/unordered_map.hpp>
 
 #include "ComplexName.h"
 
@@ -14,8 +13,9 @@ class UniqueNameSet
 {
     // This maps name prefixes to a set of used postfixes
     // e.g. "func_static_" => [1,3,4,5,10]
-    // Allows fairly quick lookup of used names and postfixes
-    typedef std::map<std::string, PostfixSet> Names;
+    // Hashed, as this is queried for every key value of the imported
+    // entities when pasting or importing a map
+    typedef boost::unordered_map<std::string, PostfixSet> Names;
     Names _names;
 
 public:
@@ -59,15 +59,9 @@ public:
             found = result.first;
         }
 
-        // The prefix is inserted at this point, add the postfix to the set
-        PostfixSet& postfixSet = found->second;
-
-        std::pair<PostfixSet::iterator, bool> result = postfixSet.insert(
-            name.getPostfix()
-        );
-
-        // Return the boolean of the insertion result, it is true on successful insertion
-        return result.second;
+        // The prefix is inserted at this point, add the postfix to the set,
+        // this is false if the postfix is already in use
+        return found->second.insert(name.getPostfix());
     }
 
     /**
@@ -88,8 +82,8 @@ public:
         // The prefix has been found, remove the postfix from the set
         PostfixSet& postfixSet = found->second;
 
-        // Return true if the std::set::erase method removed any elements
-        return (postfixSet.erase(name.getPostfix()) > 0);
+        // Return true if the postfix has been removed
+        return postfixSet.erase(name.getPostfix());
     }
 
     /**
@@ -103,30 +97,41 @@ public:
      */
     std::string insertUnique(const ComplexName& name)
     {
-        // Lookup the name in the map to see if we know this prefix
-        Names::iterator found = _names.find(name.getNameWithoutPostfix());
+        // The operator[] adds an empty postfix set if we don't know the prefix
+        // yet, the name can be added with the given postfix in that case
+        PostfixSet& postfixSet = _names[name.getNameWithoutPostfix()];
 
-        if (found == _names.end()) {
-            // The name is not yet in the list, we can add it with the given postfix
-            std::pair<Names::iterator, bool> result = _names.insert(
-                Names::value_type(name.getNameWithoutPostfix(), PostfixSet())
-            );
+        // Acquire a new unique postfix (if necessary) for this name to make it
+        // unique
+        ComplexName uniqueName(name);
+        int postfix = uniqueName.makePostfixUnique(postfixSet);
+        postfixSet.insert(postfix);
 
-            assert(result.second); // insert must succeed, we didn't find this just before
+        return uniqueName.getFullname();
+    }
 
-            // Overwrite the iterator
-            found = result.first;
-        }
+    /**
+     * \brief
+     * Insert the given ComplexName into this set, changing its postfix if
+     * necessary to ensure that it is unique in this set and not used in the
+     * <reserved> set.
+     *
+     * This saves building the union of both sets when names are imported
+     * into another namespace, the <reserved> set is not changed.
+     */
+    std::string insertUnique(const ComplexName& name, const UniqueNameSet& reserved)
+    {
+        Names::const_iterator foundReserved = reserved._names.find(name.getNameWithoutPostfix());
 
-        // At this point, the "trunk" of the complex name is already in the list
-        // The found iterator points to a valid prefix => PostFixSet mapping
+        if (foundReserved == reserved._names.end())
+        {
+            return insertUnique(name);
+        }
 
-        // Acquire a new unique postfix (if necessary) for this name to make it
-        // unique
-        PostfixSet& postfixSet = found->second;
+        PostfixSet& postfixSet = _names[name.getNameWithoutPostfix()];
 
         ComplexName uniqueName(name);
-        int postfix = uniqueName.makePostfixUnique(postfixSet);
+        int postfix = uniqueName.makePostfixUnique(postfixSet, foundReserved->second);
         postfixSet.insert(postfix);
 
         return uniqueName.getFullname();
@@ -157,35 +162,11 @@ public:
             const PostfixSet& postfixSet = found->second;
 
             // If we know the number too, the full name exists
-            return (postfixSet.find(name.getPostfix()) != postfixSet.end());
+            return postfixSet.contains(name.getPostfix());
         }
         else {
             // Prefix is not known, hence full name is not known
             return false;
         }
     }
-
-    /**
-     * Copies all names from the <other> UniqueNameSet into this one.
-     * This class will contain the union of both sets afterwards.
-     * Duplicate names will be ignored.
-     */
-    void merge(const UniqueNameSet& other)
-    {
-        // cycle through all foreign names and import them
-        for (Names::const_iterator i = other._names.begin(); i != other._names.end(); ++i)
-        {
-            // Check if the prefix exists already in this set
-            Names::iterator local = _names.find(i->first);
-
-            if (local != _names.end()) {
-                // Prefix exists, merge the postfixes
-                local->second.insert(i->second.begin(), i->second.end());
-            }
-            else {
-                // Prefix doesn't exist yet, insert the whole string => PostfixSet pair
-                _names.insert(*i);
-            }
-        }
-    }
 };
@@ -7,6 +7,8 @@
 #include "irenderable.h"
 #include "itextstream.h"
 #include "iselectiontest.h"
+#include "ivolumetest.h"
+#include "ifilter.h"
 
 #include "registry/registry.h"
 #include "math/Frustum.h"
@@ -276,12 +278,25 @@ void Patch::testSelect(Selector& selector, SelectionTest& test)
 	// The updateTesselation routine might have produced a degenerate patch, catch this
 	if (m_tess.vertices.empty()) return;
 
+	if (m_tess.stripBounds.empty())
+	{
+		updateStripBounds();
+	}
+
+	const Matrix4& localToWorld = _node.localToWorld();
+
 	SelectionIntersection best;
 	IndexPointer::index_type* pIndex = &m_tess.indices.front();
 
-	for (std::size_t s=0; s<m_tess.m_numStrips; s++) {
+	for (std::size_t s=0; s<m_tess.m_numStrips; s++, pIndex += m_tess.m_lenStrips)
+	{
+		// Large patches consist of many strips, most of which miss a single click
+		if (test.getVolume().TestAABB(m_tess.stripBounds[s], localToWorld) == VOLUME_OUTSIDE)
+		{
+			continue;
+		}
+
 		test.TestQuadStrip(vertexpointer_arbitrarymeshvertex(&m_tess.vertices.front()), IndexPointer(pIndex, m_tess.m_lenStrips), best);
-		pIndex += m_tess.m_lenStrips;
 	}
 
 	if (best.valid()) {
@@ -289,6 +304,24 @@ void Patch::testSelect(Selector& selector, SelectionTest& test)
 	}
 }
 
+void Patch::updateStripBounds()
+{
+	m_tess.stripBounds.resize(m_tess.m_numStrips);
+
+	const RenderIndex* pIndex = m_tess.indices.empty() ? NULL : &m_tess.indices.front();
+
+	for (std::size_t s = 0; s < m_tess.m_numStrips; ++s)
+	{
+		AABB& bounds = m_tess.stripBounds[s];
+		bounds = AABB();
+
+		for (std::size_t i = 0; i < m_tess.m_lenStrips; ++i, ++pIndex)
+		{
+			bounds.includePoint(m_tess.vertices[*pIndex].vertex);
+		}
+	}
+}
+
 // Transform this patch as defined by the transformation matrix <matrix>
 void Patch::transform(const Matrix4& matrix)
 {
@@ -584,6 +617,8 @@ void Patch::updateTesselation()
 
 	_tesselationChanged = false;
 
+  m_tess.stripBounds.clear();
+
   m_ctrl_vertices.clear();
   m_lattice_indices.clear();
 
@@ -4181,6 +4216,9 @@ void Patch::textureChanged()
 		(*i++)->onPatchTextureChanged();
 	}
 
+	// Keep the filter system's material index current
+	GlobalFilterSystem().onShaderChanged(_node);
+
 	ui::SurfaceInspector::update(); // Triggers TexTool and PatchInspector update
 }
 
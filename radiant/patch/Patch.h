@@ -371,6 +371,9 @@ private:
 
 	void updateTesselation();
 
+	// Calculates the bounds of the tesselation's quad strips
+	void updateStripBounds();
+
 	// greebo: this allocates the shader with the passed name
 	void captureShader();
 
@@ -47,6 +47,7 @@ const StringSet& Doom3PatchCreator::getDependencies() const
 	if (_dependencies.empty())
 	{
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_FILTERSYSTEM);
 	}
 
 	return _dependencies;
@@ -165,6 +166,7 @@ const StringSet& Doom3PatchDef2Creator::getDependencies() const
 	{
 		_dependencies.insert(MODULE_RENDERSYSTEM);
 		_dependencies.insert(MODULE_PREFERENCESYSTEM);
+		_dependencies.insert(MODULE_FILTERSYSTEM);
 	}
 
 	return _dependencies;
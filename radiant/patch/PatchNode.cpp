@@ -1,6 +1,7 @@
 #include "PatchNode.h"
 
 #include "ifilter.h"
+#include "ivolumetest.h"
 #include "ientity.h"
 #include "iradiant.h"
 #include "icounter.h"
@@ -127,6 +128,10 @@ void PatchNode::testSelect(Selector& selector, SelectionTest& test) {
 	if (!isVisible())
 		return;
 
+	// Don't bother with the tesselation if the patch is not inside the selection volume
+	if (test.getVolume().TestAABB(localAABB(), localToWorld()) == VOLUME_OUTSIDE)
+		return;
+
     test.BeginMesh(localToWorld(), true);
     // Pass the selection test call to the patch
     m_patch.testSelect(selector, test);
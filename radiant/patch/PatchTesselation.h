@@ -2,6 +2,7 @@
 #define PATCHTESSELATION_H_
 
 #include "render.h"
+#include "math/AABB.h"
 #include "PatchBezier.h"
 
 /**
@@ -30,6 +31,10 @@ public:
 
 	std::vector<BezierCurveTree*> curveTreeU;
 	std::vector<BezierCurveTree*> curveTreeV;
+
+	// The local bounds of each quad strip, used to skip the strips missing
+	// a selection test. Calculated on demand, cleared on re-tesselation.
+	std::vector<AABB> stripBounds;
 };
 
 #endif /*PATCHTESSELATION_H_*/
@@ -3,15 +3,22 @@
 #include "i18n.h"
 #include "ifilesystem.h"
 #include "imodel.h"
+#include "imodelsurface.h"
 #include "imd5model.h"
 #include "imd5anim.h"
 #include "ifiletypes.h"
 #include "iselection.h"
 #include "ieventmanager.h"
 #include "iparticles.h"
+#include "iradiant.h"
+#include "ithread.h"
+#include "iundo.h"
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <set>
+#include <map>
 #include "os/path.h"
 #include "os/file.h"
 
@@ -20,11 +27,15 @@
 #include "ui/mainframe/ScreenUpdateBlocker.h"
 #include "NullModelLoader.h"
 #include <boost/bind.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 
 namespace model {
 
 namespace {
 
+	// The placeholder bounds are stored in this file in the settings folder
+	const char* const MODEL_BOUNDS_FILE = "modelbounds.txt";
+
 	class ModelRefreshWalker :
 		public scene::NodeVisitor
 	{
@@ -94,10 +105,137 @@ namespace {
 		}
 	};
 
+	// Collects the entities having one of the given models attached
+	class ChangedModelFinder :
+		public scene::NodeVisitor
+	{
+		// The lowercase paths of the changed models
+		const std::set<std::string>& _modelPaths;
+
+		std::set<IEntityNodePtr> _entities;
+
+	public:
+		ChangedModelFinder(const std::set<std::string>& modelPaths) :
+			_modelPaths(modelPaths)
+		{}
+
+		bool pre(const scene::INodePtr& node)
+		{
+			ModelNodePtr model = Node_getModel(node);
+
+			if (model == NULL)
+			{
+				return true;
+			}
+
+			std::string path = boost::algorithm::to_lower_copy(model->getIModel().getModelPath());
+
+			if (_modelPaths.find(path) != _modelPaths.end())
+			{
+				IEntityNodePtr ent = boost::dynamic_pointer_cast<IEntityNode>(node->getParent());
+
+				if (ent != NULL)
+				{
+					_entities.insert(ent);
+				}
+			}
+
+			return false;
+		}
+
+		const std::set<IEntityNodePtr>& getEntities() const
+		{
+			return _entities;
+		}
+	};
+
+	// Collects the model nodes in the scene, grouped by model path
+	class ModelNodeCollector :
+		public scene::NodeVisitor
+	{
+	public:
+		typedef std::multimap<std::string, ModelNodePtr> ModelNodes;
+
+	private:
+		ModelNodes _nodes;
+
+	public:
+		bool pre(const scene::INodePtr& node)
+		{
+			ModelNodePtr model = Node_getModel(node);
+
+			if (model != NULL)
+			{
+				_nodes.insert(ModelNodes::value_type(model->getIModel().getModelPath(), model));
+				return false;
+			}
+
+			return true;
+		}
+
+		const ModelNodes& getNodes() const
+		{
+			return _nodes;
+		}
+	};
+
+	// Geometry memory used by the given surface (vertices and triangle indices)
+	std::size_t getSurfaceBytes(const IModelSurface& surface)
+	{
+		return surface.getNumVertices() * sizeof(ArbitraryMeshVertex) +
+			   surface.getNumTriangles() * 3 * sizeof(unsigned int);
+	}
+
+	// Memory statistics of all instances of a single model
+	struct ModelStats
+	{
+		std::size_t instances;
+		std::size_t surfaces;		// distinct surface objects
+		std::size_t sharedBytes;	// geometry memory of the distinct surfaces
+		std::size_t unsharedBytes;	// memory if every instance had its own copy
+
+		// Surfaces already accounted for
+		std::set<const IModelSurface*> seen;
+
+		ModelStats() :
+			instances(0),
+			surfaces(0),
+			sharedBytes(0),
+			unsharedBytes(0)
+		{}
+
+		void addModel(const IModel& model, bool isInstance)
+		{
+			if (isInstance)
+			{
+				++instances;
+			}
+
+			for (int i = 0; i < model.getSurfaceCount(); ++i)
+			{
+				const IModelSurface& surface = model.getSurface(i);
+				std::size_t bytes = getSurfaceBytes(surface);
+
+				if (isInstance)
+				{
+					unsharedBytes += bytes;
+				}
+
+				if (seen.insert(&surface).second)
+				{
+					++surfaces;
+					sharedBytes += bytes;
+				}
+			}
+		}
+	};
+
 } // namespace
 
 ModelCache::ModelCache() :
-	_enabled(true)
+	_enabled(true),
+	_preloadThreads(0),
+	_runningPreloads(0)
 {}
 
 ModelLoaderPtr ModelCache::getModelLoaderForType(const std::string& type)
@@ -199,6 +337,189 @@ scene::INodePtr ModelCache::getModelNode(const std::string& modelPath)
 	return NullModelLoader::InstancePtr()->loadModel(actualModelPath);
 }
 
+scene::INodePtr ModelCache::getModelNodeAsync(const std::string& modelPath)
+{
+	// Check if we have a reference to a modeldef
+	IModelDefPtr modelDef = GlobalEntityClassManager().findModel(modelPath);
+
+	std::string actualModelPath = modelDef ? modelDef->mesh : modelPath;
+
+	// Models already in the cache and absolute paths are handled by getModelNode()
+	if (!_enabled || !_preloadDispatcher ||
+		path_is_absolute(actualModelPath.c_str()) ||
+		_modelMap.find(actualModelPath) != _modelMap.end() ||
+		_failedPreloads.find(actualModelPath) != _failedPreloads.end())
+	{
+		return getModelNode(modelPath);
+	}
+
+	PendingPreloads::iterator pending = _pendingPreloads.find(actualModelPath);
+
+	if (pending == _pendingPreloads.end())
+	{
+		std::string type = actualModelPath.substr(actualModelPath.rfind(".") + 1);
+
+		ModelPreloadPtr preload = getModelLoaderForType(type)->preloadModelFromPath(actualModelPath);
+
+		if (!preload)
+		{
+			// This loader doesn't support background loading
+			return getModelNode(modelPath);
+		}
+
+		pending = _pendingPreloads.insert(
+			PendingPreloads::value_type(actualModelPath, PendingPreload())
+		).first;
+		pending->second.preload = preload;
+
+		bool startThread = false;
+
+		{
+			Glib::Mutex::Lock lock(_preloadMutex);
+
+			++_runningPreloads;
+			_queuedPreloads.push_back(QueuedPreloads::value_type(actualModelPath, preload));
+
+			// Don't start more parser threads than there are processors,
+			// a map can request hundreds of models at once
+			if (_preloadThreads < GlobalRadiant().getThreadManager().getNumWorkers())
+			{
+				++_preloadThreads;
+				startThread = true;
+			}
+		}
+
+		if (startThread)
+		{
+			GlobalRadiant().getThreadManager().execute(
+				boost::bind(&ModelCache::processPreloadQueue, this)
+			);
+		}
+	}
+
+	// Show a box until the model is there, sized like the last time it was loaded
+	ModelBounds::const_iterator bounds = _modelBounds.find(actualModelPath);
+
+	NullModelPtr nullModel(bounds != _modelBounds.end() ?
+		new NullModel(bounds->second) : new NullModel);
+
+	nullModel->setModelPath(modelPath);
+	nullModel->setFilename(os::getFilename(actualModelPath));
+
+	scene::INodePtr placeholder(new NullModelNode(nullModel));
+	pending->second.placeholders.push_back(placeholder);
+
+	return placeholder;
+}
+
+void ModelCache::processPreloadQueue()
+{
+	while (true)
+	{
+		QueuedPreloads::value_type next;
+
+		{
+			Glib::Mutex::Lock lock(_preloadMutex);
+
+			if (_queuedPreloads.empty())
+			{
+				--_preloadThreads;
+				_preloadCond.signal();
+				return;
+			}
+
+			next = _queuedPreloads.front();
+			_queuedPreloads.pop_front();
+		}
+
+		runPreload(next.first, next.second);
+	}
+}
+
+void ModelCache::runPreload(const std::string& modelPath, const ModelPreloadPtr& preload)
+{
+	preload->parse();
+
+	Glib::Mutex::Lock lock(_preloadMutex);
+
+	_finishedPreloads.push_back(FinishedPreloads::value_type(modelPath, preload));
+
+	// Emit while holding the lock, shutdownModule() waits for us before
+	// destroying the dispatcher
+	(*_preloadDispatcher)();
+
+	--_runningPreloads;
+	_preloadCond.signal();
+}
+
+void ModelCache::onPreloadsFinished()
+{
+	// Swapping the model nodes while an operation is open would record them
+	// into that undo step, keep them queued until the operation is finished
+	if (GlobalUndoSystem().operationStarted())
+	{
+		return;
+	}
+
+	FinishedPreloads finished;
+
+	{
+		Glib::Mutex::Lock lock(_preloadMutex);
+		finished.swap(_finishedPreloads);
+	}
+
+	for (FinishedPreloads::const_iterator i = finished.begin(); i != finished.end(); ++i)
+	{
+		PendingPreloads::iterator pending = _pendingPreloads.find(i->first);
+
+		// The cache might have been cleared in the meantime
+		if (pending == _pendingPreloads.end() || pending->second.preload != i->second)
+		{
+			continue;
+		}
+
+		// The model might have been loaded synchronously in the meantime
+		if (_modelMap.find(i->first) == _modelMap.end())
+		{
+			IModelPtr model = i->second->finish();
+
+			if (model)
+			{
+				_modelMap.insert(ModelMap::value_type(i->first, model));
+				_modelBounds[i->first] = model->localAABB();
+			}
+			else
+			{
+				// Let getModelNode() deal with it (and report the error)
+				_failedPreloads.insert(i->first);
+			}
+		}
+
+		std::vector<scene::INodeWeakPtr> placeholders;
+		placeholders.swap(pending->second.placeholders);
+
+		_pendingPreloads.erase(pending);
+
+		// Let the entities acquire their actual model nodes
+		for (std::vector<scene::INodeWeakPtr>::const_iterator p = placeholders.begin();
+			 p != placeholders.end(); ++p)
+		{
+			scene::INodePtr placeholder = p->lock();
+
+			// Placeholders which have been removed from their entity are ignored
+			if (!placeholder) continue;
+
+			IEntityNodePtr entity =
+				boost::dynamic_pointer_cast<IEntityNode>(placeholder->getParent());
+
+			if (entity)
+			{
+				entity->refreshModel();
+			}
+		}
+	}
+}
+
 IModelPtr ModelCache::getModel(const std::string& modelPath) {
 	// Try to lookup the existing model
 	ModelMap::iterator found = _modelMap.find(modelPath);
@@ -222,6 +543,7 @@ IModelPtr ModelCache::getModel(const std::string& modelPath) {
 	{
 		// Model successfully loaded, insert a reference into the map
 		_modelMap.insert(ModelMap::value_type(modelPath, model));
+		_modelBounds[modelPath] = model->localAABB();
 	}
 
 	return model;
@@ -234,6 +556,19 @@ void ModelCache::clear() {
 
 	_modelMap.clear();
 
+	// Forget about the models being loaded in the background,
+	// the results of the workers are discarded
+	_pendingPreloads.clear();
+	_failedPreloads.clear();
+
+	{
+		// The models not picked up by a worker yet don't need to be parsed at all
+		Glib::Mutex::Lock lock(_preloadMutex);
+
+		_runningPreloads -= _queuedPreloads.size();
+		_queuedPreloads.clear();
+	}
+
 	// Allow usage of the modelnodemap again.
 	_enabled = true;
 }
@@ -287,6 +622,103 @@ void ModelCache::refreshSelectedModels(const cmd::ArgumentList& args)
 	}
 }
 
+void ModelCache::printStats(const cmd::ArgumentList& args)
+{
+	ModelNodeCollector collector;
+	Node_traverseSubgraph(GlobalSceneGraph().root(), collector);
+
+	typedef std::map<std::string, ModelStats> StatsMap;
+	StatsMap stats;
+
+	// Cached models without any instances in the scene are listed too
+	for (ModelMap::const_iterator i = _modelMap.begin(); i != _modelMap.end(); ++i)
+	{
+		stats[i->first].addModel(*i->second, false);
+	}
+
+	const ModelNodeCollector::ModelNodes& nodes = collector.getNodes();
+
+	for (ModelNodeCollector::ModelNodes::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+	{
+		stats[i->first].addModel(i->second->getIModel(), true);
+	}
+
+	ModelStats total;
+
+	rMessage() << "Model cache statistics (" << _modelMap.size() << " cached models):" << std::endl;
+
+	for (StatsMap::const_iterator i = stats.begin(); i != stats.end(); ++i)
+	{
+		rMessage() << "  " << i->first << ": " << i->second.instances << " instances, "
+			<< i->second.surfaces << " surfaces, " << (i->second.sharedBytes / 1024) << " kB" << std::endl;
+
+		total.instances += i->second.instances;
+		total.surfaces += i->second.surfaces;
+		total.sharedBytes += i->second.sharedBytes;
+		total.unsharedBytes += i->second.unsharedBytes;
+	}
+
+	rMessage() << "Total: " << total.instances << " instances, " << total.surfaces
+		<< " surfaces, " << (total.sharedBytes / 1024) << " kB geometry ("
+		<< (total.unsharedBytes / 1024) << " kB without sharing)" << std::endl;
+}
+
+void ModelCache::onFilesChanged(const StringSet& filenames)
+{
+	// Model paths are compared case-insensitively, like the VFS does
+	std::set<std::string> changedPaths;
+
+	for (StringSet::const_iterator i = filenames.begin(); i != filenames.end(); ++i)
+	{
+		changedPaths.insert(boost::algorithm::to_lower_copy(*i));
+	}
+
+	std::set<std::string> changedModels;
+
+	for (ModelMap::iterator i = _modelMap.begin(); i != _modelMap.end(); /* in-loop increment */)
+	{
+		std::string path = boost::algorithm::to_lower_copy(i->first);
+
+		if (changedPaths.find(path) != changedPaths.end())
+		{
+			changedModels.insert(path);
+			_modelBounds.erase(i->first);
+			_modelMap.erase(i++);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	// Give the models which failed to load before another chance
+	for (std::set<std::string>::iterator i = _failedPreloads.begin(); i != _failedPreloads.end(); /* in-loop increment */)
+	{
+		if (changedPaths.find(boost::algorithm::to_lower_copy(*i)) != changedPaths.end())
+		{
+			_failedPreloads.erase(i++);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (changedModels.empty()) return;
+
+	rMessage() << "[ModelCache] Reloading " << changedModels.size() << " changed model(s)" << std::endl;
+
+	// Only the entities using the changed models are refreshed
+	ChangedModelFinder finder(changedModels);
+	Node_traverseSubgraph(GlobalSceneGraph().root(), finder);
+
+	for (std::set<IEntityNodePtr>::const_iterator i = finder.getEntities().begin();
+		 i != finder.getEntities().end(); ++i)
+	{
+		(*i)->refreshModel();
+	}
+}
+
 // RegisterableModule implementation
 const std::string& ModelCache::getName() const {
 	static std::string _name("ModelCache");
@@ -302,6 +734,9 @@ const StringSet& ModelCache::getDependencies() const {
 		_dependencies.insert(MODULE_MODELLOADER + "MD5MESH");
 		_dependencies.insert(MODULE_COMMANDSYSTEM);
 		_dependencies.insert(MODULE_SELECTIONSYSTEM);
+		_dependencies.insert(MODULE_RADIANT);
+		_dependencies.insert(MODULE_VIRTUALFILESYSTEM);
+		_dependencies.insert(MODULE_UNDOSYSTEM);
 	}
 
 	return _dependencies;
@@ -318,12 +753,99 @@ void ModelCache::initialiseModule(const ApplicationContext& ctx) {
 		"RefreshSelectedModels",
 		boost::bind(&ModelCache::refreshSelectedModels, this, _1)
 	);
+	GlobalCommandSystem().addCommand(
+		"ModelCacheStats",
+		boost::bind(&ModelCache::printStats, this, _1)
+	);
+	_preloadDispatcher.reset(new Glib::Dispatcher);
+	_preloadDispatcher->connect(sigc::mem_fun(*this, &ModelCache::onPreloadsFinished));
+
+	_undoFinishedConn = GlobalUndoSystem().signal_operationFinished().connect(
+		sigc::mem_fun(*this, &ModelCache::onPreloadsFinished)
+	);
+
+	_modelBoundsFile = ctx.getSettingsPath() + MODEL_BOUNDS_FILE;
+	loadModelBounds();
+
 	GlobalEventManager().addCommand("RefreshModels", "RefreshModels");
 	GlobalEventManager().addCommand("RefreshSelectedModels", "RefreshSelectedModels");
+
+	GlobalFileSystem().addObserver(*this);
 }
 
 void ModelCache::shutdownModule() {
+	GlobalFileSystem().removeObserver(*this);
+
+	_undoFinishedConn.disconnect();
+
+	{
+		// Drop the queued models and wait for the workers still parsing models
+		Glib::Mutex::Lock lock(_preloadMutex);
+
+		_runningPreloads -= _queuedPreloads.size();
+		_queuedPreloads.clear();
+
+		while (_runningPreloads > 0 || _preloadThreads > 0)
+		{
+			_preloadCond.wait(_preloadMutex);
+		}
+
+		_finishedPreloads.clear();
+	}
+
+	_preloadDispatcher.reset();
+
 	clear();
+
+	saveModelBounds();
+}
+
+void ModelCache::loadModelBounds()
+{
+	std::ifstream file(_modelBoundsFile.c_str());
+
+	// Each line holds the model path, followed by a tab and the origin and extents
+	std::string line;
+
+	while (std::getline(file, line))
+	{
+		std::size_t tab = line.rfind('\t');
+
+		if (tab == std::string::npos) continue;
+
+		std::istringstream values(line.substr(tab + 1));
+		Vector3 origin;
+		Vector3 extents;
+
+		if (values >> origin.x() >> origin.y() >> origin.z() >>
+					  extents.x() >> extents.y() >> extents.z())
+		{
+			_modelBounds[line.substr(0, tab)] = AABB(origin, extents);
+		}
+	}
+}
+
+void ModelCache::saveModelBounds()
+{
+	std::ofstream file(_modelBoundsFile.c_str());
+
+	if (!file.is_open())
+	{
+		rError() << "[ModelCache] Could not write " << _modelBoundsFile << std::endl;
+		return;
+	}
+
+	for (ModelBounds::const_iterator i = _modelBounds.begin(); i != _modelBounds.end(); ++i)
+	{
+		// Invalid bounds (e.g. of empty models) are not worth keeping
+		if (!i->second.isValid()) continue;
+
+		const Vector3& origin = i->second.getOrigin();
+		const Vector3& extents = i->second.getExtents();
+
+		file << i->first << '\t' << origin.x() << ' ' << origin.y() << ' ' << origin.z() << ' '
+			 << extents.x() << ' ' << extents.y() << ' ' << extents.z() << '\n';
+	}
 }
 
 // The static module
@@ -1,14 +1,24 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <deque>
 #include <string>
+#include <vector>
 #include "imodelcache.h"
 #include "icommandsystem.h"
+#include "ifilesystem.h"
+#include "math/AABB.h"
+
+#include <glibmm/thread.h>
+#include <glibmm/dispatcher.h>
+#include <boost/scoped_ptr.hpp>
 
 namespace model {
 
 class ModelCache :
-	public IModelCache
+	public IModelCache,
+	public VirtualFileSystem::Observer
 {
 	// The container maps model names to instances
 	typedef std::map<std::string, IModelPtr> ModelMap;
@@ -17,12 +27,58 @@ class ModelCache :
 	// Flag to disable the cache on demand (used during clear())
 	bool _enabled;
 
+	// A model being parsed on a worker thread, and the placeholder nodes waiting for it
+	struct PendingPreload
+	{
+		ModelPreloadPtr preload;
+		std::vector<scene::INodeWeakPtr> placeholders;
+	};
+	typedef std::map<std::string, PendingPreload> PendingPreloads;
+	PendingPreloads _pendingPreloads;
+
+	// Models which failed to load in the background, these are loaded right away
+	std::set<std::string> _failedPreloads;
+
+	// The bounds of the models loaded so far, used to size the placeholders.
+	// These are kept when the cache is cleared, and saved between sessions.
+	typedef std::map<std::string, AABB> ModelBounds;
+	ModelBounds _modelBounds;
+
+	// The file in the settings folder holding the above bounds
+	std::string _modelBoundsFile;
+
+	// Preloads waiting for a worker thread
+	typedef std::deque<std::pair<std::string, ModelPreloadPtr> > QueuedPreloads;
+	QueuedPreloads _queuedPreloads;
+
+	// Number of threads working on the above queue, at most getNumWorkers()
+	std::size_t _preloadThreads;
+
+	// Preloads parsed by the workers, waiting to be finished on the main thread
+	typedef std::vector<std::pair<std::string, ModelPreloadPtr> > FinishedPreloads;
+	FinishedPreloads _finishedPreloads;
+
+	// Number of preloads queued or still being parsed
+	std::size_t _runningPreloads;
+
+	Glib::Mutex _preloadMutex;
+	Glib::Cond _preloadCond;
+
+	// Notifies the main thread about finished preloads
+	boost::scoped_ptr<Glib::Dispatcher> _preloadDispatcher;
+
+	// Runs the swaps held back while an undo operation was open
+	sigc::connection _undoFinishedConn;
+
 public:
 	ModelCache();
 
 	// greebo: For documentation, see the abstract base class.
 	virtual scene::INodePtr getModelNode(const std::string& modelPath);
 
+	// greebo: For documentation, see the abstract base class.
+	virtual scene::INodePtr getModelNodeAsync(const std::string& modelPath);
+
 	// greebo: For documentation, see the abstract base class.
 	virtual IModelPtr getModel(const std::string& modelPath);
 
@@ -37,12 +93,31 @@ public:
 	void refreshModels(const cmd::ArgumentList& args);
 	// Command target: this reloads all selected models in the map
 	void refreshSelectedModels(const cmd::ArgumentList& args);
+	// Command target: prints the number of instances and the geometry memory per cached model
+	void printStats(const cmd::ArgumentList& args);
+
+	// VirtualFileSystem::Observer implementation, reloads the changed models
+	virtual void onFilesChanged(const StringSet& filenames);
 
 	// RegisterableModule implementation
 	virtual const std::string& getName() const;
 	virtual const StringSet& getDependencies() const;
 	virtual void initialiseModule(const ApplicationContext& ctx);
 	virtual void shutdownModule();
+
+private:
+	// Parses the queued models until the queue is empty, this runs on a worker thread
+	void processPreloadQueue();
+
+	// Parses the given model, this runs on a worker thread
+	void runPreload(const std::string& modelPath, const ModelPreloadPtr& preload);
+
+	// Reads and writes the placeholder bounds from/to the settings folder
+	void loadModelBounds();
+	void saveModelBounds();
+
+	// Creates the models parsed by the workers and swaps them in for the placeholders
+	void onPreloadsFinished();
 };
 
 } // namespace model
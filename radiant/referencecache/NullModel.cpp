@@ -12,6 +12,12 @@ NullModel::NullModel() :
 	_aabbWire(_aabbLocal)
 {}
 
+NullModel::NullModel(const AABB& localAABB) :
+	_aabbLocal(localAABB.isValid() ? localAABB : AABB(Vector3(0, 0, 0), Vector3(8, 8, 8))),
+	_aabbSolid(_aabbLocal),
+	_aabbWire(_aabbLocal)
+{}
+
 NullModel::~NullModel() {
 	_state = ShaderPtr();
 }
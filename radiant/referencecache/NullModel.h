@@ -19,6 +19,9 @@ class NullModel :
 	std::string _modelPath;
 public:
 	NullModel();
+
+	// Constructs a NullModel with the given bounds instead of the default box
+	NullModel(const AABB& localAABB);
 	virtual ~NullModel();
 
 	const AABB& localAABB() const;
@@ -49,6 +49,11 @@ public:
 		return model;
 	}
 
+	// Nothing to load, the NullModel is created right away
+	ModelPreloadPtr preloadModelFromPath(const std::string& name) {
+		return ModelPreloadPtr();
+	}
+
 	// RegisterableModule implementation
 	virtual const std::string& getName() const {
 		static std::string _name(MODULE_MODELLOADER + "NULL");
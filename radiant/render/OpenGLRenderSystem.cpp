@@ -1,6 +1,7 @@
 #include "OpenGLRenderSystem.h"
 
 #include "ishaders.h"
+#include "iscenegraph.h"
 #include "itextstream.h"
 #include "math/Matrix4.h"
 #include "modulesystem/StaticModule.h"
@@ -8,6 +9,7 @@
 
 #include <boost/weak_ptr.hpp>
 #include <boost/bind.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 
 namespace render {
 
@@ -49,6 +51,10 @@ OpenGLRenderSystem::OpenGLRenderSystem() :
 	if (module::getRegistry().moduleExists(MODULE_SHADERSYSTEM))
 	{
 		GlobalMaterialManager().attach(*this);
+
+		_materialsReloadedConn = GlobalMaterialManager().signal_materialsReloaded().connect(
+			sigc::mem_fun(*this, &OpenGLRenderSystem::onMaterialsReloaded)
+		);
 	}
 }
 
@@ -58,6 +64,8 @@ OpenGLRenderSystem::~OpenGLRenderSystem()
 	{
 		GlobalMaterialManager().detach(*this);
 	}
+
+	_materialsReloadedConn.disconnect();
 }
 
 ShaderPtr OpenGLRenderSystem::capture(const std::string& name)
@@ -241,6 +249,32 @@ void OpenGLRenderSystem::unrealise()
 	}
 }
 
+void OpenGLRenderSystem::onMaterialsReloaded(const StringSet& materialNames)
+{
+	if (!_realised) {
+		return; // the shaders are constructed on realisation
+	}
+
+	// Material names are case-insensitive
+	StringSet names;
+
+	for (StringSet::const_iterator i = materialNames.begin(); i != materialNames.end(); ++i)
+	{
+		names.insert(boost::algorithm::to_lower_copy(*i));
+	}
+
+	for (ShaderMap::iterator i = _shaders.begin(); i != _shaders.end(); ++i)
+	{
+		if (names.find(boost::algorithm::to_lower_copy(i->first)) != names.end())
+		{
+			i->second->unrealise();
+			i->second->realise(i->first);
+		}
+	}
+
+	SceneChangeNotify();
+}
+
 std::size_t OpenGLRenderSystem::getTime() const
 {
 	return _time;
@@ -467,6 +501,10 @@ void OpenGLRenderSystem::initialiseModule(const ApplicationContext& ctx)
 
 	GlobalMaterialManager().attach(*this);
 
+	_materialsReloadedConn = GlobalMaterialManager().signal_materialsReloaded().connect(
+		sigc::mem_fun(*this, &OpenGLRenderSystem::onMaterialsReloaded)
+	);
+
 	// greebo: Don't realise the module yet, this must wait
 	// until the shared GL context has been created (this
 	// happens as soon as the first GL widget has been realised).
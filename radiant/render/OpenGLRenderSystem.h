@@ -48,9 +48,14 @@ private:
 	typedef std::map<LitObject*, LinearLightList> LightLists;
 	LightLists m_lightLists;
 
+	sigc::connection _materialsReloadedConn;
+
 private:
 	void propagateLightChangedFlagToAllLights();
 
+	// Rebuilds the shaders of the given reloaded materials
+	void onMaterialsReloaded(const StringSet& materialNames);
+
 public:
 
 	/**
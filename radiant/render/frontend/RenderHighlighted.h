@@ -2,6 +2,7 @@
 
 #include "ientity.h"
 #include "ieclass.h"
+#include "ibrush.h"
 #include "iscenegraph.h"
 #include "scenelib.h"
 #include <boost/bind.hpp>
@@ -93,6 +94,9 @@ public:
 	 */
 	static void collectRenderablesInScene(RenderableCollector& collector, const VolumeTest& volume)
 	{
+		// Build the changed brushes in one go, before the walker is visiting them
+		GlobalBrushCreator().evaluateChangedBReps();
+
 		// Instantiate a new walker class
 		RenderHighlighted renderHighlightWalker(collector, volume);
 
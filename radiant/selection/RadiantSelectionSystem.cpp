@@ -5,6 +5,7 @@
 #include "iundo.h"
 #include "igrid.h"
 #include "iradiant.h"
+#include "ithread.h"
 #include "ieventmanager.h"
 #include "scenelib.h"
 #include "editable.h"
@@ -17,13 +18,129 @@
 #include "registry/registry.h"
 #include "selection/algorithm/Primitives.h"
 
+#include <set>
+#include <vector>
+#include <algorithm>
 #include <boost/bind.hpp>
+#include <boost/ref.hpp>
 
 // Initialise the shader pointer
 ShaderPtr RadiantSelectionSystem::_state;
 
     namespace {
         const std::string RKEY_ROTATION_PIVOT = "user/ui/rotationPivotIsOrigin";
+
+        // Area selections with fewer nodes than this are tested in the calling thread
+        const std::size_t MIN_NODES_FOR_WORKERS = 256;
+
+        typedef std::vector<scene::INodePtr> NodeList;
+
+        // Collects the nodes passed in by the scene graph or the selection system
+        class NodeCollector :
+            public scene::Graph::Walker,
+            public SelectionSystem::Visitor
+        {
+            NodeList& _nodes;
+        public:
+            NodeCollector(NodeList& nodes) :
+                _nodes(nodes)
+            {}
+
+            bool visit(const scene::INodePtr& node) {
+                _nodes.push_back(node);
+                return true;
+            }
+
+            void visit(const scene::INodePtr& node) const {
+                _nodes.push_back(node);
+            }
+        };
+
+        // The parameters of an area selection, shared by all chunks
+        struct AreaSelection
+        {
+            NodeList nodes;
+            render::View view;
+            SelectionSystem::EMode mode;
+            SelectionSystem::EComponentMode componentMode;
+            bool face;
+            bool entitiesFirst;
+
+            AreaSelection(const render::View& view_) :
+                view(view_)
+            {}
+        };
+
+        // The selection results of a chunk of nodes, see testSelectArea()
+        struct AreaSelectionResult
+        {
+            SelectionPool pool;
+            SelectionPool secondary;
+        };
+        typedef std::vector<AreaSelectionResult> AreaSelectionResults;
+
+        template<typename Tester>
+        void testNodes(Tester& tester, const NodeList& nodes, std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; ++i)
+            {
+                tester.visit(nodes[i]);
+            }
+        }
+
+        // Tests the nodes [first, last) of the given area selection, this is
+        // running on a worker thread, hence the thread-local SelectionVolume.
+        void testAreaChunk(const AreaSelection& area, std::size_t first, std::size_t last,
+                           AreaSelectionResult& result)
+        {
+            SelectionVolume volume(area.view);
+
+            if (area.face)
+            {
+                ComponentSelector tester(result.pool, volume, SelectionSystem::eFace);
+                testNodes(tester, area.nodes, first, last);
+                return;
+            }
+
+            switch (area.mode)
+            {
+                case SelectionSystem::eEntity:
+                {
+                    EntitySelector tester(result.pool, volume);
+                    testNodes(tester, area.nodes, first, last);
+                }
+                break;
+
+                case SelectionSystem::ePrimitive:
+                {
+                    if (area.entitiesFirst)
+                    {
+                        EntityAndPrimitiveSelector tester(result.pool, result.secondary, volume);
+                        testNodes(tester, area.nodes, first, last);
+                    }
+                    else
+                    {
+                        AnySelector tester(result.pool, volume);
+                        testNodes(tester, area.nodes, first, last);
+                    }
+                }
+                break;
+
+                case SelectionSystem::eGroupPart:
+                {
+                    GroupChildPrimitiveSelector tester(result.pool, volume);
+                    testNodes(tester, area.nodes, first, last);
+                }
+                break;
+
+                case SelectionSystem::eComponent:
+                {
+                    ComponentSelector tester(result.pool, volume, area.componentMode);
+                    testNodes(tester, area.nodes, first, last);
+                }
+                break;
+            }
+        }
     }
 
 // ------------ Helper Functions --------------------------------------------
@@ -61,6 +178,10 @@ RadiantSelectionSystem::RadiantSelectionSystem() :
     _componentMode(eDefault),
     _countPrimitive(0),
     _countComponent(0),
+    _batchDepth(0),
+    _batchChangedPrimitives(false),
+    _batchChangedComponents(false),
+    _batchSelectable(NULL),
     _translateManipulator(*this, 2, 64),    // initialise the Manipulators with a pointer to self
     _rotateManipulator(*this, 8, 64),
     _scaleManipulator(*this, 0, 64),
@@ -103,6 +224,39 @@ void RadiantSelectionSystem::notifyObservers(const scene::INodePtr& node, bool i
     }
 }
 
+void RadiantSelectionSystem::beginBatch()
+{
+    ++_batchDepth;
+}
+
+void RadiantSelectionSystem::endBatch()
+{
+    ASSERT_MESSAGE(_batchDepth > 0, "endBatch() called without beginBatch()");
+
+    if (--_batchDepth > 0) return;
+
+    const Selectable* selectable = _batchSelectable;
+    bool changedPrimitives = _batchChangedPrimitives;
+    bool changedComponents = _batchChangedComponents;
+
+    _batchSelectable = NULL;
+    _batchChangedPrimitives = false;
+    _batchChangedComponents = false;
+
+    if (selectable != NULL) {
+        _sigSelectionChanged(*selectable);
+    }
+
+    // Pass an empty node, the observers have to look at the whole selection
+    if (changedPrimitives) {
+        notifyObservers(scene::INodePtr(), false);
+    }
+
+    if (changedComponents) {
+        notifyObservers(scene::INodePtr(), true);
+    }
+}
+
 void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, SelectionTest& test,
                                              const render::View& view, SelectionSystem::EMode mode,
                                              SelectionSystem::EComponentMode componentMode)
@@ -137,31 +291,23 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
             }
             else
             {
-                // We have an orthoview, here, select entities first
-
-                // First, obtain all the selectable entities
-                EntitySelector entityTester(selector, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, entityTester);
-
-                // Now retrieve all the selectable primitives
-                PrimitiveSelector primitiveTester(sel2, test);
-                GlobalSceneGraph().foreachVisibleNodeInVolume(view, primitiveTester);
+                // We have an orthoview, here, select entities first, worldspawn
+                // primitives go into the secondary pool. Both are collected in one walk.
+                EntityAndPrimitiveSelector tester(selector, sel2, test);
+                GlobalSceneGraph().foreachVisibleNodeInVolume(view, tester);
             }
 
             // Add the first selection crop to the target vector
+            std::set<Selectable*> added;
+
             for (SelectionPool::iterator i = selector.begin(); i != selector.end(); ++i) {
                 targetList.push_back(i->second);
+                added.insert(i->second);
             }
 
-            // Add the secondary crop to the vector (if it has any entries)
+            // Add the secondary crop to the vector (if it has any entries), skip duplicates
             for (SelectionPool::iterator i = sel2.begin(); i != sel2.end(); ++i) {
-                // Check for duplicates
-                SelectablesList::iterator j;
-                for (j = targetList.begin(); j != targetList.end(); ++j) {
-                    if (*j == i->second) break;
-                }
-                // Insert if not yet in the list
-                if (j == targetList.end()) {
+                if (added.insert(i->second).second) {
                     targetList.push_back(i->second);
                 }
             }
@@ -196,6 +342,82 @@ void RadiantSelectionSystem::testSelectScene(SelectablesList& targetList, Select
     } // switch
 }
 
+void RadiantSelectionSystem::testSelectArea(SelectablesList& targetList, const render::View& view,
+                                            SelectionSystem::EMode mode,
+                                            SelectionSystem::EComponentMode componentMode,
+                                            bool face)
+{
+    AreaSelection area(view);
+    area.mode = mode;
+    area.componentMode = componentMode;
+    area.face = face;
+    area.entitiesFirst = mode == ePrimitive && !view.fill() &&
+                         GlobalXYWnd().higherEntitySelectionPriority();
+
+    // Gather the candidates first, the tests don't change the scene
+    NodeCollector collector(area.nodes);
+
+    if (!face && mode == eComponent) {
+        foreachSelected(collector);
+    }
+    else {
+        GlobalSceneGraph().foreachVisibleNodeInVolume(view, collector);
+    }
+
+    AreaSelectionResults results;
+
+    if (area.nodes.size() < MIN_NODES_FOR_WORKERS) {
+        results.resize(1);
+        testAreaChunk(area, 0, area.nodes.size(), results.front());
+    }
+    else {
+        // Same chunking as ThreadManager::executeInChunks, each chunk gets its own result
+        const ThreadManager& threads = GlobalRadiant().getThreadManager();
+
+        std::size_t count = area.nodes.size();
+        std::size_t numJobs = std::min(count, threads.getNumWorkers() * 4);
+
+        results.resize(numJobs);
+
+        ThreadManager::Jobs jobs;
+        jobs.reserve(numJobs);
+
+        for (std::size_t i = 0; i < numJobs; ++i) {
+            jobs.push_back(boost::bind(testAreaChunk, boost::cref(area),
+                count * i / numJobs, count * (i + 1) / numJobs, boost::ref(results[i])));
+        }
+
+        threads.executeAndWait(jobs);
+    }
+
+    // Merge the chunk results, the same selectable might have been hit in several chunks
+    SelectionPool pool;
+    SelectionPool secondary;
+
+    for (AreaSelectionResults::iterator r = results.begin(); r != results.end(); ++r) {
+        for (SelectionPool::iterator i = r->pool.begin(); i != r->pool.end(); ++i) {
+            pool.addSelectable(i->first, i->second);
+        }
+
+        for (SelectionPool::iterator i = r->secondary.begin(); i != r->secondary.end(); ++i) {
+            secondary.addSelectable(i->first, i->second);
+        }
+    }
+
+    std::set<Selectable*> added;
+
+    for (SelectionPool::iterator i = pool.begin(); i != pool.end(); ++i) {
+        targetList.push_back(i->second);
+        added.insert(i->second);
+    }
+
+    for (SelectionPool::iterator i = secondary.begin(); i != secondary.end(); ++i) {
+        if (added.insert(i->second).second) {
+            targetList.push_back(i->second);
+        }
+    }
+}
+
 /* greebo: This is true if nothing is selected (either in component mode or in primitive mode)
  */
 bool RadiantSelectionSystem::nothingSelected() const
@@ -275,7 +497,6 @@ void RadiantSelectionSystem::onSelectedChanged(const scene::INodePtr& node, cons
     int delta = isSelected ? +1 : -1;
 
     _countPrimitive += delta;
-    _sigSelectionChanged(selectable);
 
     _selectionInfo.totalCount += delta;
 
@@ -297,8 +518,17 @@ void RadiantSelectionSystem::onSelectedChanged(const scene::INodePtr& node, cons
         _selection.erase(node);
     }
 
-    // Notify observers, FALSE = primitive selection change
-    notifyObservers(node, false);
+    if (_batchDepth > 0) {
+        // The signal and the observers are taken care of by endBatch()
+        _batchChangedPrimitives = true;
+        _batchSelectable = &selectable;
+    }
+    else {
+        _sigSelectionChanged(selectable);
+
+        // Notify observers, FALSE = primitive selection change
+        notifyObservers(node, false);
+    }
 
     // Check if the number of selected primitives in the list matches the value of the selection counter
     ASSERT_MESSAGE(_selection.size() == _countPrimitive, "selection-tracking error");
@@ -317,7 +547,6 @@ void RadiantSelectionSystem::onComponentSelection(const scene::INodePtr& node, c
     int delta = selectable.isSelected() ? +1 : -1;
 
     _countComponent += delta;
-    _sigSelectionChanged(selectable);
 
     _selectionInfo.totalCount += delta;
     _selectionInfo.componentCount += delta;
@@ -330,8 +559,16 @@ void RadiantSelectionSystem::onComponentSelection(const scene::INodePtr& node, c
         _componentSelection.erase(node);
     }
 
-    // Notify observers, TRUE => this is a component selection change
-    notifyObservers(node, true);
+    if (_batchDepth > 0) {
+        _batchChangedComponents = true;
+        _batchSelectable = &selectable;
+    }
+    else {
+        _sigSelectionChanged(selectable);
+
+        // Notify observers, TRUE => this is a component selection change
+        notifyObservers(node, true);
+    }
 
     // Check if the number of selected components in the list matches the value of the selection counter
     ASSERT_MESSAGE(_componentSelection.size() == _countComponent, "component selection-tracking error");
@@ -615,6 +852,9 @@ void RadiantSelectionSystem::SelectArea(const render::View& view,
                                         const Vector2& device_delta,
                                         SelectionSystem::EModifier modifier, bool face)
 {
+    // Notify the observers once, after all the candidates have been changed
+    ScopedBatch batch(*this);
+
     // If we are in replace mode, deselect all the components or previous selections
     if (modifier == SelectionSystem::eReplace) {
         if (face) {
@@ -630,26 +870,10 @@ void RadiantSelectionSystem::SelectArea(const render::View& view,
         render::View scissored(view);
         ConstructSelectionTest(scissored, Rectangle::ConstructFromArea(device_point, device_delta));
 
-        SelectionVolume volume(scissored);
-        // The posssible candidates go here
-        SelectionPool pool;
-
+        // The possible candidates go here
         SelectablesList candidates;
 
-        if (face)
-        {
-            ComponentSelector selectionTester(pool, volume, eFace);
-            GlobalSceneGraph().foreachVisibleNodeInVolume(scissored, selectionTester);
-
-            // Load them all into the vector
-            for (SelectionPool::iterator i = pool.begin(); i != pool.end(); ++i)
-            {
-                candidates.push_back(i->second);
-            }
-        }
-        else {
-            testSelectScene(candidates, volume, scissored, Mode(), ComponentMode());
-        }
+        testSelectArea(candidates, scissored, Mode(), ComponentMode(), face);
 
         // Cycle through the selection pool and toggle the candidates, but only if we are in toggle mode
         for (SelectablesList::iterator i = candidates.begin(); i != candidates.end(); i++) {
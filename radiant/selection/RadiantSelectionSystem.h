@@ -110,6 +110,13 @@ private:
 	SelectionListType _selection;
 	SelectionListType _componentSelection;
 
+	// While a batch is active (see beginBatch()), the selection observers are not
+	// notified on each change, they get a single notification when it's done.
+	std::size_t _batchDepth;
+	bool _batchChangedPrimitives;
+	bool _batchChangedComponents;
+	const Selectable* _batchSelectable;
+
 	void ConstructPivot();
 	mutable bool _pivotChanged;
 	bool _pivotMoving;
@@ -238,8 +245,36 @@ protected:
 						 const render::View& view, SelectionSystem::EMode mode,
 						 SelectionSystem::EComponentMode componentMode);
 
+	// Tests all the nodes in the given (area selection) view on the worker threads,
+	// the selectables passing the test are added to the "targetList".
+	void testSelectArea(SelectablesList& targetList, const render::View& view,
+						SelectionSystem::EMode mode, SelectionSystem::EComponentMode componentMode,
+						bool face);
+
 private:
 	void notifyObservers(const scene::INodePtr& node, bool isComponent);
+
+	// Batches of selection changes can be nested, the observers are notified
+	// when the outermost batch is ended.
+	void beginBatch();
+	void endBatch();
+
+	// Ends the batch when going out of scope
+	class ScopedBatch
+	{
+		RadiantSelectionSystem& _owner;
+	public:
+		ScopedBatch(RadiantSelectionSystem& owner) :
+			_owner(owner)
+		{
+			_owner.beginBatch();
+		}
+
+		~ScopedBatch()
+		{
+			_owner.endBatch();
+		}
+	};
 };
 
 #endif /*RADIANTSELECTIONSYSTEM_H_*/
@@ -295,6 +295,14 @@ bool PrimitiveSelector::visit(const scene::INodePtr& node)
 	return true;
 }
 
+bool EntityAndPrimitiveSelector::visit(const scene::INodePtr& node)
+{
+	_entitySelector.visit(node);
+	_primitiveSelector.visit(node);
+
+	return true;
+}
+
 bool GroupChildPrimitiveSelector::visit(const scene::INodePtr& node)
 {
 	// Skip all entities
@@ -94,6 +94,25 @@ public:
 	bool visit(const scene::INodePtr& node);
 };
 
+// Combines the EntitySelector and the PrimitiveSelector in a single scene walk,
+// entities and their child primitives go to the first selector, worldspawn
+// primitives to the second one. Both test disjoint sets of nodes.
+class EntityAndPrimitiveSelector :
+	public SelectionTestWalker
+{
+private:
+	EntitySelector _entitySelector;
+	PrimitiveSelector _primitiveSelector;
+
+public:
+	EntityAndPrimitiveSelector(Selector& entitySelector, Selector& primitiveSelector, SelectionTest& test) :
+		_entitySelector(entitySelector, test),
+		_primitiveSelector(primitiveSelector, test)
+	{}
+
+	bool visit(const scene::INodePtr& node);
+};
+
 // A Selector looking for child primitives of group nodes only, non-worldspawn parent
 class GroupChildPrimitiveSelector :
 	public SelectionTestWalker
@@ -1,14 +1,17 @@
 #ifndef SELECTOR_H_
 #define SELECTOR_H_
 
-#include <map>
-#include <set>
+#include <list>
+#include <vector>
+#include <algorithm>
 #include "iselectiontest.h"
 #include "iselectable.h"
 
-typedef std::multimap<SelectionIntersection, Selectable*> SelectableSortedSet;
+// A (selection intersection, selectable) pair, as delivered by the SelectionPool
+typedef std::pair<SelectionIntersection, Selectable*> SelectableHit;
+typedef std::vector<SelectableHit> SelectableHits;
 
-// A simple set that gets filled after the SelectableSortedSet is populated.
+// A simple list that gets filled after the SelectionPool is populated.
 // greebo: I used this to merge two SelectionPools (entities and primitives)
 // 		   with a preferred sorting (see RadiantSelectionSystem::Scene_TestSelect())
 typedef std::list<Selectable*> SelectablesList;
@@ -19,21 +22,66 @@ typedef std::list<Selectable*> SelectablesList;
  * The addIntersection() method gets called by the tested object between
  * pushSelectable() and popSelectable() and picks the best Intersection out of the crop.
  *
+ * The hits are collected in a flat buffer in the order they come in, the
+ * buffer is sorted and cleaned from duplicates once it's traversed. For each
+ * Selectable the best intersection is kept, ties are resolved in favour of the
+ * earlier one.
  */
 class SelectionPool :
 	public Selector
 {
-	SelectableSortedSet 	_pool;
+	// All valid hits, in insertion order
+	SelectableHits			_hits;
+
+	// The best hit per selectable, sorted by intersection, built on demand
+	SelectableHits			_pool;
+	bool					_poolNeedsUpdate;
+
 	SelectionIntersection	_intersection;
 	Selectable* 			_selectable;
 
-	// A set of all current Selectable* candidates, to prevent double-insertions
-	// The iterator value points to an element in the SelectableSortedSet
-	// to allow for fast removals.
-	typedef std::map<Selectable*, SelectableSortedSet::iterator> SelectablesMap;
-	SelectablesMap _currentSelectables;
+	// Orders the hit indices by selectable, then by intersection and insertion order
+	class SelectableOrder
+	{
+		const SelectableHits& _hits;
+	public:
+		SelectableOrder(const SelectableHits& hits) : _hits(hits) {}
+
+		bool operator()(std::size_t a, std::size_t b) const
+		{
+			if (_hits[a].second != _hits[b].second)
+			{
+				return _hits[a].second < _hits[b].second;
+			}
+
+			if (_hits[a].first < _hits[b].first) return true;
+			if (_hits[b].first < _hits[a].first) return false;
+
+			return a < b;
+		}
+	};
+
+	// Orders the hit indices by intersection, then by insertion order
+	class IntersectionOrder
+	{
+		const SelectableHits& _hits;
+	public:
+		IntersectionOrder(const SelectableHits& hits) : _hits(hits) {}
+
+		bool operator()(std::size_t a, std::size_t b) const
+		{
+			if (_hits[a].first < _hits[b].first) return true;
+			if (_hits[b].first < _hits[a].first) return false;
+
+			return a < b;
+		}
+	};
 
 public:
+	SelectionPool() :
+		_poolNeedsUpdate(false),
+		_selectable(NULL)
+	{}
 
 	/** greebo: This is called before an entity/patch/brush is
 	 * 			tested against selection to notify the SelectionPool
@@ -68,56 +116,73 @@ public:
 
 	/** greebo: This makes sure that only valid Intersections get added, otherwise
 	 * 			we would add Selectables that haven't passed the test.
+	 *
+	 * It's possible that the selectable is the parent of two different child
+	 * primitives, which both add themselves to this pool. Only the better
+	 * intersection of the two survives, see updatePool().
 	 */
 	void addSelectable(const SelectionIntersection& intersection, Selectable* selectable)
 	{
 		if (!intersection.valid()) return; // skip invalid intersections
 
-		SelectablesMap::iterator existing = _currentSelectables.find(selectable);
-
-		if (existing != _currentSelectables.end())
-		{
-			// greebo: We had that selectable before, check if the intersection is a better one
-			// and update it if necessary. It's possible that the selectable is the parent of
-			// two different child primitives, but both may want to add themselves to this pool.
-			// To prevent the "worse" primitive from shadowing the "better" one, perform this check.
-
-			// Check if the intersection is better
-			if (intersection < existing->second->first)
-			{
-				// Yes, update the map, remove old stuff first
-				_pool.erase(existing->second);
-				_currentSelectables.erase(existing);
-			}
-			else
-			{
-				// The existing intersection is better, we're done here
-				return;
-			}
-		}
-
-		// At this point, the selectable is ready for insertion into the pool
-		// Either it's a completely new Selectable, or it is replacing an existing one
-		SelectableSortedSet::iterator result = _pool.insert(
-			SelectableSortedSet::value_type(intersection, selectable)
-		);
-
-		// Memorise the Selectable for fast lookups
-		_currentSelectables.insert(SelectablesMap::value_type(selectable, result));
+		_hits.push_back(SelectableHit(intersection, selectable));
+		_poolNeedsUpdate = true;
 	}
 
-	typedef SelectableSortedSet::iterator iterator;
+	typedef SelectableHits::iterator iterator;
 
 	iterator begin() {
+		updatePool();
 		return _pool.begin();
 	}
 
 	iterator end() {
+		updatePool();
 		return _pool.end();
 	}
 
 	bool failed() {
-		return _pool.empty();
+		return _hits.empty();
+	}
+
+private:
+	// Reduces the collected hits to the best one per selectable, sorted by intersection
+	void updatePool()
+	{
+		if (!_poolNeedsUpdate) return;
+
+		_poolNeedsUpdate = false;
+
+		std::vector<std::size_t> order(_hits.size());
+
+		for (std::size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+
+		// Group the hits by selectable, the best one of each group comes first
+		std::sort(order.begin(), order.end(), SelectableOrder(_hits));
+
+		std::vector<std::size_t> best;
+		best.reserve(order.size());
+
+		for (std::size_t i = 0; i < order.size(); ++i)
+		{
+			if (i == 0 || _hits[order[i]].second != _hits[order[i-1]].second)
+			{
+				best.push_back(order[i]);
+			}
+		}
+
+		std::sort(best.begin(), best.end(), IntersectionOrder(_hits));
+
+		_pool.clear();
+		_pool.reserve(best.size());
+
+		for (std::size_t i = 0; i < best.size(); ++i)
+		{
+			_pool.push_back(_hits[best[i]]);
+		}
 	}
 };
 
@@ -174,10 +174,8 @@ void cloneSelected(const cmd::ArgumentList& args) {
 	INamespacePtr nspace = mapRoot->getNamespace();
 	if (nspace)
     {
-		// Prepare the nodes for import
-		nspace->ensureNoConflicts(cloner.getCloneRoot());
-		// Now move all nodes into the target namespace
-		nspace->connect(cloner.getCloneRoot());
+		// Prepare the nodes for import and move them into the target namespace
+		nspace->importNames(cloner.getCloneRoot());
 	}
 
 	// Unselect the current selection
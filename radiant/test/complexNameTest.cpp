@@ -0,0 +1,168 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE complexNameTest
+#include <boost/test/unit_test.hpp>
+
+#include "radiant/namespace/UniqueNameSet.h"
+
+namespace
+{
+    PostfixSet makePostfixSet(const int* postfixes, std::size_t count)
+    {
+        PostfixSet set;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            set.insert(postfixes[i]);
+        }
+
+        return set;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parsePostfix)
+{
+    ComplexName name("func_static_12");
+    BOOST_CHECK_EQUAL(name.getNameWithoutPostfix(), "func_static_");
+    BOOST_CHECK_EQUAL(name.getPostfix(), 12);
+    BOOST_CHECK_EQUAL(name.getFullname(), "func_static_12");
+
+    ComplexName noPostfix("worldspawn");
+    BOOST_CHECK_EQUAL(noPostfix.getNameWithoutPostfix(), "worldspawn");
+    BOOST_CHECK_EQUAL(noPostfix.getPostfix(), -1);
+    BOOST_CHECK_EQUAL(noPostfix.getFullname(), "worldspawn");
+
+    // Only the trailing digits are taken
+    ComplexName innerDigits("light2_3");
+    BOOST_CHECK_EQUAL(innerDigits.getNameWithoutPostfix(), "light2_");
+    BOOST_CHECK_EQUAL(innerDigits.getPostfix(), 3);
+
+    ComplexName digitsOnly("42");
+    BOOST_CHECK_EQUAL(digitsOnly.getNameWithoutPostfix(), "");
+    BOOST_CHECK_EQUAL(digitsOnly.getPostfix(), 42);
+
+    ComplexName leadingZeros("speaker007");
+    BOOST_CHECK_EQUAL(leadingZeros.getPostfix(), 7);
+    BOOST_CHECK_EQUAL(leadingZeros.getFullname(), "speaker7");
+
+    ComplexName empty("");
+    BOOST_CHECK_EQUAL(empty.getNameWithoutPostfix(), "");
+    BOOST_CHECK_EQUAL(empty.getPostfix(), -1);
+}
+
+BOOST_AUTO_TEST_CASE(parseOverflowingPostfix)
+{
+    ComplexName largest("brush2147483647");
+    BOOST_CHECK_EQUAL(largest.getNameWithoutPostfix(), "brush");
+    BOOST_CHECK_EQUAL(largest.getPostfix(), 2147483647);
+
+    // Postfixes not fitting into an int are treated as no postfix
+    ComplexName overflow("brush2147483648");
+    BOOST_CHECK_EQUAL(overflow.getNameWithoutPostfix(), "brush");
+    BOOST_CHECK_EQUAL(overflow.getPostfix(), -1);
+
+    ComplexName longOverflow("brush99999999999999999999");
+    BOOST_CHECK_EQUAL(longOverflow.getPostfix(), -1);
+}
+
+BOOST_AUTO_TEST_CASE(postfixSetFirstUnused)
+{
+    PostfixSet set;
+    BOOST_CHECK(set.empty());
+    BOOST_CHECK_EQUAL(set.getFirstUnused(), 1);
+
+    BOOST_CHECK(set.insert(1));
+    BOOST_CHECK(set.insert(2));
+    BOOST_CHECK(set.insert(4));
+    BOOST_CHECK(!set.insert(2));
+    BOOST_CHECK_EQUAL(set.getFirstUnused(), 3);
+
+    // Filling the gap moves the counter past all used postfixes
+    BOOST_CHECK(set.insert(3));
+    BOOST_CHECK_EQUAL(set.getFirstUnused(), 5);
+
+    BOOST_CHECK(set.erase(2));
+    BOOST_CHECK(!set.erase(2));
+    BOOST_CHECK_EQUAL(set.getFirstUnused(), 2);
+
+    // Names without postfix don't affect the counter
+    BOOST_CHECK(set.insert(-1));
+    BOOST_CHECK(set.erase(-1));
+    BOOST_CHECK_EQUAL(set.getFirstUnused(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(makePostfixUnique)
+{
+    const int used[] = { 1, 2, 3, 5 };
+    PostfixSet postfixes = makePostfixSet(used, 4);
+
+    // Unused postfixes are kept
+    ComplexName unused("func_static_4");
+    BOOST_CHECK_EQUAL(unused.makePostfixUnique(postfixes), 4);
+    BOOST_CHECK_EQUAL(unused.getFullname(), "func_static_4");
+
+    ComplexName noPostfix("func_static_");
+    BOOST_CHECK_EQUAL(noPostfix.makePostfixUnique(postfixes), -1);
+
+    // Colliding postfixes get the lowest unused one
+    ComplexName colliding("func_static_5");
+    BOOST_CHECK_EQUAL(colliding.makePostfixUnique(postfixes), 4);
+    BOOST_CHECK_EQUAL(colliding.getFullname(), "func_static_4");
+
+    // A name without postfix collides with the name itself
+    postfixes.insert(-1);
+    BOOST_CHECK_EQUAL(noPostfix.makePostfixUnique(postfixes), 4);
+}
+
+BOOST_AUTO_TEST_CASE(makePostfixUniqueWithReserved)
+{
+    const int used[] = { 1, 2 };
+    const int reservedUsed[] = { 3, 4, 6 };
+
+    PostfixSet postfixes = makePostfixSet(used, 2);
+    PostfixSet reserved = makePostfixSet(reservedUsed, 3);
+
+    ComplexName unused("light_7");
+    BOOST_CHECK_EQUAL(unused.makePostfixUnique(postfixes, reserved), 7);
+
+    // The result must not be in either set
+    ComplexName collidingOwn("light_1");
+    BOOST_CHECK_EQUAL(collidingOwn.makePostfixUnique(postfixes, reserved), 5);
+
+    ComplexName collidingReserved("light_6");
+    BOOST_CHECK_EQUAL(collidingReserved.makePostfixUnique(postfixes, reserved), 5);
+
+    // Gaps in the own set are used as long as they are not reserved
+    PostfixSet empty;
+    const int gap[] = { 2 };
+    PostfixSet reservedGap = makePostfixSet(gap, 1);
+
+    ComplexName collidingGap("light_2");
+    BOOST_CHECK_EQUAL(collidingGap.makePostfixUnique(empty, reservedGap), 1);
+}
+
+BOOST_AUTO_TEST_CASE(insertUniqueWithReserved)
+{
+    UniqueNameSet names;
+    names.insert(ComplexName("func_static_3"));
+
+    UniqueNameSet reserved;
+    reserved.insert(ComplexName("func_static_1"));
+    reserved.insert(ComplexName("func_static_2"));
+    reserved.insert(ComplexName("light"));
+
+    BOOST_CHECK_EQUAL(names.insertUnique(ComplexName("func_static_1"), reserved), "func_static_4");
+    BOOST_CHECK_EQUAL(names.insertUnique(ComplexName("func_static_1"), reserved), "func_static_5");
+    BOOST_CHECK_EQUAL(names.insertUnique(ComplexName("func_static_9"), reserved), "func_static_9");
+
+    // A name without postfix gets one if it is reserved
+    BOOST_CHECK_EQUAL(names.insertUnique(ComplexName("light"), reserved), "light1");
+
+    // Prefixes unknown to the reserved set are only checked against the own set
+    BOOST_CHECK_EQUAL(names.insertUnique(ComplexName("speaker"), reserved), "speaker");
+    BOOST_CHECK_EQUAL(names.insertUnique(ComplexName("speaker"), reserved), "speaker1");
+
+    // The reserved set is not changed
+    BOOST_CHECK(!reserved.nameExists("func_static_4"));
+    BOOST_CHECK(!reserved.nameExists("speaker"));
+    BOOST_CHECK(names.nameExists("func_static_4"));
+}
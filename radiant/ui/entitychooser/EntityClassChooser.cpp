@@ -25,6 +25,7 @@
 #include "debugging/ScopedDebugTimer.h"
 
 #include <boost/make_shared.hpp>
+#include <boost/bind.hpp>
 
 namespace ui
 {
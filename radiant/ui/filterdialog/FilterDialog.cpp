@@ -87,9 +87,6 @@ void FilterDialog::save()
 		GlobalFilterSystem().setFilterRules(i->first, i->second->rules);
 	}
 
-	// Trigger an update
-	GlobalFilterSystem().update();
-
 	// Re-build the filters menu
 	ui::FiltersMenu::addItemsToMainMenu();
 }
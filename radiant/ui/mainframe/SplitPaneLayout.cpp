@@ -299,7 +299,7 @@ void SplitPaneLayout::saveStateToPath(const std::string& path)
 	_splitPane.posVPane2.saveToPath(path + "/pane[@name='vertical2']");
 
 	GlobalRegistry().deleteXPath(RKEY_SPLITPANE_VIEWTYPES);
-	xml::Node node = GlobalRegistry().createKey(RKEY_SPLITPANE_VIEWTYPES);
+	GlobalRegistry().createKey(RKEY_SPLITPANE_VIEWTYPES);
 
 	// Camera is assigned -1 as viewtype
 	int topLeft = _quadrants[QuadrantTopLeft].xyWnd != NULL ? _quadrants[QuadrantTopLeft].xyWnd->getViewType() : -1;
@@ -307,10 +307,10 @@ void SplitPaneLayout::saveStateToPath(const std::string& path)
 	int bottomLeft = _quadrants[QuadrantBottomLeft].xyWnd != NULL ? _quadrants[QuadrantBottomLeft].xyWnd->getViewType() : -1;
 	int bottomRight = _quadrants[QuadrantBottomRight].xyWnd != NULL ? _quadrants[QuadrantBottomRight].xyWnd->getViewType() : -1;
 
-	node.setAttributeValue("topleft", string::to_string(topLeft));
-	node.setAttributeValue("topright", string::to_string(topRight));
-	node.setAttributeValue("bottomleft", string::to_string(bottomLeft));
-	node.setAttributeValue("bottomright", string::to_string(bottomRight));
+	GlobalRegistry().setAttribute(RKEY_SPLITPANE_VIEWTYPES, "topleft", string::to_string(topLeft));
+	GlobalRegistry().setAttribute(RKEY_SPLITPANE_VIEWTYPES, "topright", string::to_string(topRight));
+	GlobalRegistry().setAttribute(RKEY_SPLITPANE_VIEWTYPES, "bottomleft", string::to_string(bottomLeft));
+	GlobalRegistry().setAttribute(RKEY_SPLITPANE_VIEWTYPES, "bottomright", string::to_string(bottomRight));
 }
 
 void SplitPaneLayout::toggleFullscreenCameraView()